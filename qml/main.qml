@@ -402,6 +402,20 @@ Item {
 	}
 	*/
 
+	// Per module timings, only visible when the profiler is enabled (devel/flag_profiler)
+	Text {
+		anchors {
+			top: parent.top
+			right: parent.right
+			margins: rootStyle.margin
+		}
+		visible: stellarium.profilerEnabled
+		color: "white"
+		font.pixelSize: rootStyle.fontSmallSize
+		font.family: "Monospace"
+		text: stellarium.profilerEnabled ? stellarium.profilerSummary : ""
+	}
+
 	Item {
 		id: rootStyle
         property double scale: stellarium.guiScaleFactor
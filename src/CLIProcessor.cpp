@@ -20,6 +20,7 @@
 #include "CLIProcessor.hpp"
 #include "StelFileMgr.hpp"
 #include "StelUtils.hpp"
+#include "ZoneArray.hpp"
 
 #include <QSettings>
 #include <QDateTime>
@@ -28,6 +29,7 @@
 
 #include <QGuiApplication>
 #include <QDir>
+#include <QFileInfo>
 
 #include <stdio.h>
 
@@ -72,7 +74,20 @@ void CLIProcessor::parseCLIArgsPreConfig(const QStringList& argList)
 		          << "--projection-type       : Specify projection type, e.g. stereographic\n"
 		          << "--restore-defaults      : Delete existing config.ini and use defaults\n"
 		          << "--multires-image        : With filename / URL argument, specify a\n"
-		          << "                          multi-resolution image to load\n";
+		          << "                          multi-resolution image to load\n"
+		          << "--rise-set              : With a comma separated list of object names,\n"
+		          << "                          write their rise, transit and set times from\n"
+		          << "                          the sky date to a JSON file and exit\n"
+		          << "--rise-set-days         : Duration of the rise/set range in days\n"
+		          << "--rise-set-altitude     : Threshold altitude of the rise/set (degrees)\n"
+		          << "--rise-set-sun-altitude : Limit the visibility windows to when the Sun\n"
+		          << "                          is below this altitude (degrees), e.g. -18\n"
+		          << "--rise-set-output       : Rise/set output file, default rise_set.json\n"
+		          << "--compress-star-catalog : With a star catalog file (stars_*v0_*.cat)\n"
+		          << "                          as argument, write its compressed version\n"
+		          << "                          and exit\n"
+		          << "--compress-star-catalog-output : Compressed catalog file, default is the\n"
+		          << "                          input name with v0 replaced by v1\n";
 		exit(0);
 	}
 
@@ -94,6 +109,32 @@ void CLIProcessor::parseCLIArgsPreConfig(const QStringList& argList)
 		exit(0);
 	}
 
+	QString compressInput, compressOutput;
+	try
+	{
+		compressInput = argsGetOptionWithArg(argList, "", "--compress-star-catalog", "").toString();
+		compressOutput = argsGetOptionWithArg(argList, "", "--compress-star-catalog-output", "").toString();
+	}
+	catch (std::runtime_error& e)
+	{
+		qCritical() << "ERROR: while processing --compress-star-catalog option: " << e.what();
+		exit(1);
+	}
+	if (!compressInput.isEmpty())
+	{
+		if (compressOutput.isEmpty())
+		{
+			QFileInfo info(compressInput);
+			QString name = info.fileName();
+			// e.g. stars_4_1v0_1.cat becomes stars_4_1v1_1.cat
+			name.replace(QRegExp("v0_(\\d+\\.cat)$"), "v1_\\1");
+			if (name==info.fileName())
+				name += ".v1";
+			compressOutput = info.dir().filePath(name);
+		}
+		exit(ZoneArray::compressCatalog(compressInput, compressOutput) ? 0 : 1);
+	}
+
 	try
 	{
 		QString newUserDir;
@@ -116,6 +157,8 @@ void CLIProcessor::parseCLIArgsPostConfig(const QStringList& argList, QSettings*
 	float fov;
 	QString landscapeId, homePlanet, longitude, latitude, skyDate, skyTime;
 	QString projectionType, screenshotDir, multiresImage, startupScript;
+	QString riseSet, riseSetOutput;
+	double riseSetDays, riseSetAltitude, riseSetSunAltitude;
 	try
 	{
 		fullScreen = argsGetYesNoOption(argList, "-f", "--full-screen", -1);
@@ -131,6 +174,11 @@ void CLIProcessor::parseCLIArgsPostConfig(const QStringList& argList, QSettings*
 		screenshotDir = argsGetOptionWithArg(argList, "", "--screenshot-dir", "").toString();
 		multiresImage = argsGetOptionWithArg(argList, "", "--multires-image", "").toString();
 		startupScript = argsGetOptionWithArg(argList, "", "--startup-script", "").toString();
+		riseSet = argsGetOptionWithArg(argList, "", "--rise-set", "").toString();
+		riseSetDays = argsGetOptionWithArg(argList, "", "--rise-set-days", 1.).toDouble();
+		riseSetAltitude = argsGetOptionWithArg(argList, "", "--rise-set-altitude", 0.).toDouble();
+		riseSetSunAltitude = argsGetOptionWithArg(argList, "", "--rise-set-sun-altitude", 90.).toDouble();
+		riseSetOutput = argsGetOptionWithArg(argList, "", "--rise-set-output", "rise_set.json").toString();
 	}
 	catch (std::runtime_error& e)
 	{
@@ -212,6 +260,16 @@ void CLIProcessor::parseCLIArgsPostConfig(const QStringList& argList, QSettings*
 		qApp->setProperty("onetime_startup_script", startupScript);
 	}
 
+	if (!riseSet.isEmpty())
+	{
+		// Computed once the application is initialized, see StelApp::runRiseSetBatch()
+		qApp->setProperty("onetime_rise_set", riseSet);
+		qApp->setProperty("onetime_rise_set_days", riseSetDays);
+		qApp->setProperty("onetime_rise_set_altitude", riseSetAltitude);
+		qApp->setProperty("onetime_rise_set_sun_altitude", riseSetSunAltitude);
+		qApp->setProperty("onetime_rise_set_output", riseSetOutput);
+	}
+
 	if (fov>0.0) confSettings->setValue("navigation/init_fov", fov);
 	if (!projectionType.isEmpty()) confSettings->setValue("projection/type", projectionType);
 	if (!screenshotDir.isEmpty())
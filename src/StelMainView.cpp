@@ -226,7 +226,7 @@ StelMainView::StelMainView(QWidget* parent)
 	  flagInvertScreenShotColors(false),
 	  screenShotPrefix("stellarium-"),
 	  screenShotDir(""),
-	  cursorTimeout(-1.f), flagCursorTimeout(false), minFpsTimer(NULL), maxfps(10000.f)
+	  cursorTimeout(-1.f), flagCursorTimeout(false), minFpsTimer(NULL), maxfps(10000.f), idlefps(0.2f)
 {
 	StelApp::initStatic();
 	
@@ -299,6 +299,7 @@ void StelMainView::init(QSettings* conf)
 	actionMgr->addAction("actionSet_Full_Screen_Global", N_("Display Options"), N_("Full-screen mode"), this, "fullScreen", "F11");
 	
 
+	StelPainter::setFlagGpuProjection(conf->value("video/flag_gpu_projection", true).toBool());
 	StelPainter::initGLShaders();
 
 	setViewportUpdateMode(QGraphicsView::FullViewportUpdate);
@@ -334,6 +335,10 @@ void StelMainView::init(QSettings* conf)
 	setCursorTimeout(conf->value("gui/mouse_cursor_timeout", 10.f).toFloat());
 	maxfps = conf->value("video/maximum_fps",10000.f).toFloat();
 	minfps = conf->value("video/minimum_fps",10000.f).toFloat();
+	idlefps = stelApp->getIdleFps();
+	// Wake up immediately when something needs to be redrawn
+	connect(stelApp, SIGNAL(redrawRequested()), this, SLOT(updateScene()), Qt::QueuedConnection);
+	connect(stelApp, SIGNAL(idleFpsChanged(float)), this, SLOT(setIdleFps(float)));
 
 	// XXX: This should be done in StelApp::init(), unfortunately for the moment we need init the gui before the
 	// plugins, because the gui create the QActions needed by some plugins.
@@ -375,14 +380,23 @@ void StelMainView::drawBackground(QPainter*, const QRectF&)
 	const double now = StelApp::getTotalRunTime();
 
 	// Determines when the next display will need to be triggered
-	// The current policy is that after an event, the FPS is maximum for 2.5 seconds
-	// after that, it switches back to the default minfps value to save power
-	if (now-lastEventTimeSec<2.5)
+	// The current policy is that after an event, the FPS is maximum for 2.5 seconds and as long
+	// as something moves in the sky. After that, it switches back to the default minfps value
+	// to save power, or to the idlefps value if nothing changes at all.
+	const StelApp::RedrawLevel redrawLevel = stelApp->getRedrawLevel();
+	if (now-lastEventTimeSec<2.5 || redrawLevel==StelApp::RedrawAnimating)
 	{
 		double duration = 1./getMaxFps();
 		int dur = (int)(duration*1000);
 		QTimer::singleShot(dur<5 ? 5 : dur, this, SLOT(updateScene()));
 	}
+	if (minFpsTimer!=NULL)
+	{
+		const float fps = redrawLevel==StelApp::RedrawIdle ? qMin(getMinFps(), getIdleFps()) : getMinFps();
+		const int interval = (int)(1./fps*1000.);
+		if (minFpsTimer->interval()!=interval)
+			minFpsTimer->setInterval(interval);
+	}
 
 	// Manage cursor timeout
 	if (cursorTimeout>0.f && (now-lastEventTimeSec>cursorTimeout) && flagCursorTimeout)
@@ -108,6 +108,12 @@ public slots:
 	void setMaxFps(float m) {maxfps = m;}
 	//! Get the current maximum frames per second.
 	float getMaxFps() {return maxfps;}
+	//! Apply the frames per second used when nothing changes in the sky. The value is owned by
+	//! StelApp, use StelApp::setIdleFps() to change it.
+	//! @param m the new idle fps setting.
+	void setIdleFps(float m) {idlefps=m;}
+	//! Get the current idle frames per second.
+	float getIdleFps() {return idlefps;}
 
 	//! Updates the scene and process all events
 	void updateScene() {
@@ -175,6 +181,8 @@ private:
 	float minfps;
 	//! The maximum desired frame rate in frame per second.
 	float maxfps;
+	//! The frame rate used when the scene is static.
+	float idlefps;
 };
 
 #endif // USE_QUICKVIEW
@@ -36,6 +36,7 @@
 #include "StelLocationMgr.hpp"
 #include "StelActionMgr.hpp"
 #include "MilkyWay.hpp"
+#include "StelProfiler.hpp"
 
 #ifdef Q_OS_ANDROID
 #include "StelAndroid.hpp"
@@ -151,6 +152,9 @@ void StelQuickStelItem::update()
 		emit selectedObjectInfoChanged();
 		emit selectedObjectShortInfoChanged();
 	}
+
+	if (getProfilerEnabled())
+		emit profilerChanged();
 }
 
 QString StelQuickStelItem::getSelectedObjectName() const
@@ -620,3 +624,32 @@ void StelQuickStelItem::resetSettings()
 		writeSetting(actions[i][1], value.toBool());
 	}
 }
+
+bool StelQuickStelItem::getProfilerEnabled() const
+{
+	return StelApp::getInstance().getProfiler()->isEnabled();
+}
+
+void StelQuickStelItem::setProfilerEnabled(bool value)
+{
+	StelApp::getInstance().getProfiler()->setEnabled(value);
+	emit profilerChanged();
+}
+
+QString StelQuickStelItem::getProfilerSummary() const
+{
+	return StelApp::getInstance().getProfiler()->getSummary();
+}
+
+QVariantMap StelQuickStelItem::getProfilerReport() const
+{
+	return StelApp::getInstance().getProfiler()->getReport();
+}
+
+bool StelQuickStelItem::dumpProfilerTrace(const QString& fileName) const
+{
+	QString path = fileName;
+	if (path.isEmpty())
+		path = StelFileMgr::getUserDir() + "/stellarium-trace.json";
+	return StelApp::getInstance().getProfiler()->dumpChromeTrace(path);
+}
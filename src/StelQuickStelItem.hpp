@@ -20,6 +20,7 @@
 
 #include <QDateTime>
 #include <QQuickItem>
+#include <QVariantMap>
 
 // Special object that is just there so we can invoke some methods in the main thread.
 class MainThreadProxy : public QObject
@@ -64,6 +65,8 @@ class StelQuickStelItem : public QQuickItem
 	Q_PROPERTY(int lightPollution READ getLightPollution WRITE setLightPollution NOTIFY lightPollutionChanged)
 	Q_PROPERTY(int milkyWayBrightness READ getMilkyWayBrightness WRITE setMilkyWayBrightness NOTIFY milkyWayBrightnessChanged)
 	Q_PROPERTY(int linesThickness READ getLinesThickness WRITE setLinesThickness NOTIFY LinesThicknessChanged)
+	Q_PROPERTY(bool profilerEnabled READ getProfilerEnabled WRITE setProfilerEnabled NOTIFY profilerChanged)
+	Q_PROPERTY(QString profilerSummary READ getProfilerSummary NOTIFY profilerChanged)
 public:
 	StelQuickStelItem();
 	QString getSelectedObjectName() const;
@@ -119,6 +122,11 @@ public:
 	int getLinesThickness() const;
 	void setLinesThickness(int value);
 	Q_INVOKABLE void resetSettings();
+	bool getProfilerEnabled() const;
+	void setProfilerEnabled(bool value);
+	QString getProfilerSummary() const;
+	Q_INVOKABLE QVariantMap getProfilerReport() const;
+	Q_INVOKABLE bool dumpProfilerTrace(const QString& fileName=QString()) const;
 
 protected:
 	bool eventFilter(QObject *, QEvent *) Q_DECL_OVERRIDE;
@@ -142,6 +150,7 @@ signals:
 	void lightPollutionChanged();
 	void milkyWayBrightnessChanged();
 	void LinesThicknessChanged();
+	void profilerChanged();
 
 private slots:
 	void update();
@@ -104,13 +104,15 @@ void QmlGuiActionItem::trigger()
 }
 
 
-StelQuickView::StelQuickView() : stelApp(NULL), nightMode(false), quitRequested(false)
+StelQuickView::StelQuickView() : stelApp(NULL), maxfps(60.f), minfps(2.f), idlefps(0.2f),
+	redrawLevel(StelApp::RedrawAnimating), nightMode(false), quitRequested(false)
 {
 	singleton = this;
 	timer = new QTimer(this);
 	timer->setTimerType(Qt::PreciseTimer);
-	connect(timer, SIGNAL(timeout()), this, SLOT(update()));
+	connect(timer, SIGNAL(timeout()), this, SLOT(onTimer()));
 	timer->setInterval(15);
+	lastEventTimer.start();
 	nightViewShader.prog = NULL;
     blitShader.prog = NULL;
     setSource(QUrl("/usr/share/stellarium/qml/Splash.qml")); // was "qrc:/qml/Splash.qml
@@ -131,6 +133,14 @@ StelQuickView::StelQuickView() : stelApp(NULL), nightMode(false), quitRequested(
 void StelQuickView::init(QSettings* conf)
 {
 	globalConf = conf;
+	// video/maximum_fps is set very high for the desktop view which redraws from its paint
+	// events, but here it drives a timer: never go faster than the screen can display.
+	float refreshRate = screen() ? (float)screen()->refreshRate() : 0.f;
+	if (refreshRate<=0.f)
+		refreshRate = 60.f;
+	maxfps = qMin(conf->value("video/maximum_fps", refreshRate).toFloat(), refreshRate);
+	minfps = qMin(conf->value("video/minimum_fps", 2.f).toFloat(), maxfps);
+	timer->setInterval((int)(1000.f/maxfps));
 #if !(defined(Q_OS_ANDROID) || defined(Q_OS_IOS))  //added
     int width = conf->value("video/screen_w", 480).toInt(); //added
     int height = conf->value("video/screen_h", 700).toInt(); //added
@@ -288,6 +298,7 @@ void StelQuickView::synchronize()
 		stelApp->setGlobalScalingRatio(getScreenDensity());
 		stelApp->init(globalConf);
 		stelApp->getStelActionManager()->addAction("actionNight_Mode", N_("Display Options"), N_("Night mode"), this, "nightMode");
+		StelPainter::setFlagGpuProjection(globalConf->value("video/flag_gpu_projection", true).toBool());
 		StelPainter::initGLShaders();
 		createBlitShader();
 		StelApp::getInstance().getStelObjectMgr().setObjectSearchRadius(25.f*stelApp->getGlobalScalingRatio());
@@ -295,6 +306,10 @@ void StelQuickView::synchronize()
 		stelApp->glWindowHasBeenResized(0, 0, width(), height());
 		setFlags(Qt::Window);
 		setNightMode(globalConf->value("viewing/flag_night", false).toBool());
+		// Wake up from the idle frame rate as soon as something needs to be redrawn
+		connect(stelApp, SIGNAL(redrawRequested()), this, SLOT(wakeUp()), Qt::QueuedConnection);
+		idlefps = stelApp->getIdleFps();
+		connect(stelApp, SIGNAL(idleFpsChanged(float)), this, SLOT(setIdleFps(float)), Qt::QueuedConnection);
 		initState++;
 		emit initialized();
 	}
@@ -338,6 +353,7 @@ void StelQuickView::paint()
 		lastPaint = newTime-0.01;
 	stelApp->update(newTime-lastPaint);
 	lastPaint = newTime;
+	redrawLevel.store(stelApp->getRedrawLevel());
 
 	if (nightMode && !finalFbo)
 	{
@@ -404,6 +420,43 @@ void StelQuickView::afterRendering()
 	}
 }
 
+void StelQuickView::onTimer()
+{
+	// The frame rate is maximum for 2.5 seconds after an input and as long as something moves
+	// in the sky. Otherwise it drops to minfps when the time is running, or to idlefps when
+	// nothing changes at all, to save the battery.
+	float fps = maxfps;
+	if (lastEventTimer.elapsed()>2500)
+	{
+		switch (redrawLevel.load())
+		{
+			case StelApp::RedrawIdle:
+				fps = qMin(minfps, idlefps);
+				break;
+			case StelApp::RedrawSlow:
+				fps = minfps;
+				break;
+			default:
+				break;
+		}
+	}
+	const int interval = qMax(5, (int)(1000.f/fps));
+	if (timer->interval()!=interval)
+		timer->setInterval(interval);
+	update();
+}
+
+void StelQuickView::wakeUp()
+{
+	if (!timer->isActive())
+		return;
+	update();
+	// Go back to the full frame rate until the next frame tells us otherwise
+	const int interval = qMax(5, (int)(1000.f/maxfps));
+	if (timer->interval()>interval)
+		timer->setInterval(interval);
+}
+
 bool StelQuickView::eventFilter(QObject* obj, QEvent* event)
 {
 	switch (event->type())
@@ -413,7 +466,18 @@ bool StelQuickView::eventFilter(QObject* obj, QEvent* event)
 			break;
 		case QEvent::ApplicationActivate:
 		case QEvent::TouchBegin:
+			lastEventTimer.restart();
 			timer->start();
+			wakeUp();
+			break;
+		case QEvent::TouchUpdate:
+		case QEvent::MouseButtonPress:
+		case QEvent::MouseButtonRelease:
+		case QEvent::MouseMove:
+		case QEvent::Wheel:
+		case QEvent::KeyPress:
+			lastEventTimer.restart();
+			wakeUp();
 			break;
 		default:
 			break;
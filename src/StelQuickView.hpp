@@ -20,6 +20,8 @@
 #include <QQuickView>
 #include <QQuickItem>
 #include <QOpenGLFramebufferObject>
+#include <QElapsedTimer>
+#include <QAtomicInt>
 
 class QSettings;
 class StelApp;
@@ -60,11 +62,26 @@ public:
 	static StelQuickView& getInstance() {Q_ASSERT(singleton); return *singleton;}
 	bool getNightMode() const {return nightMode;}
 	void setNightMode(bool value) {nightMode = value; emit nightModeChanged(value);}
+	//! Set the frames per second used when the time is running but nothing else moves.
+	void setMinFps(float m) {minfps = m;}
+	float getMinFps() const {return minfps;}
+	//! Set the frames per second used during user interactions and animations.
+	void setMaxFps(float m) {maxfps = m;}
+	float getMaxFps() const {return maxfps;}
+	float getIdleFps() const {return idlefps;}
+public slots:
+	//! Apply the frames per second used when nothing changes in the sky. The value is owned by
+	//! StelApp, use StelApp::setIdleFps() to change it.
+	void setIdleFps(float m) {idlefps = m;}
 signals:
 	void initialized();
 	void nightModeChanged(bool);
 protected slots:
 	void handleResize();
+	//! Schedule the next frame according to the current redraw level of the sky.
+	void onTimer();
+	//! Redraw as soon as possible, e.g. after an input event or when a texture has been loaded.
+	void wakeUp();
 	void paint();
 	void afterRendering();
 	void synchronize();
@@ -78,6 +95,13 @@ private:
 	static StelQuickView* singleton;
 	class QTimer* timer;
 	StelApp* stelApp;
+
+	//! Frame rates used when the sky is animating, changing slowly (time running) and static.
+	float maxfps, minfps, idlefps;
+	//! Time since the last user input. The frame rate is maximum for a few seconds after an input.
+	QElapsedTimer lastEventTimer;
+	//! The StelApp::RedrawLevel computed during the last frame (set in the render thread).
+	QAtomicInt redrawLevel;
 	float getScreenDensity() const;
 
 	struct Shader {
@@ -18,6 +18,7 @@
 
 #include "MultiLevelJsonBase.hpp"
 #include "StelJsonParser.hpp"
+#include "StelJsonCache.hpp"
 #include "StelApp.hpp"
 #include "StelFileMgr.hpp"
 #include "StelProjector.hpp"
@@ -133,22 +134,25 @@ void MultiLevelJsonBase::initFromUrl(const QString& url)
 		}
 		QFileInfo finf(fileName);
 		baseUrl = finf.absolutePath()+'/';
-		QFile f(fileName);
-		f.open(QIODevice::ReadOnly);
-		const bool compressed = fileName.endsWith(".qZ");
-		const bool gzCompressed = fileName.endsWith(".gz");
+		StelJsonCache::ParseFunction parseFunc = &parseJSONContent;
+		if (fileName.endsWith(".qZ"))
+			parseFunc = &parseQZJSONContent;
+		else if (fileName.endsWith(".gz"))
+			parseFunc = &parseGzJSONContent;
 		try
 		{
-			loadFromQVariantMap(loadFromJSON(f, compressed, gzCompressed));
+			// Local descriptions are loaded through the binary cache so that warm starts skip parsing
+			const QVariantMap map = StelJsonCache::load(fileName, parseFunc).toMap();
+			if (map.isEmpty())
+				throw std::runtime_error("empty JSON file, cannot load");
+			loadFromQVariantMap(map);
 		}
 		catch (std::runtime_error e)
 		{
 			qWarning() << "WARNING : Can't parse JSON description: " << QDir::toNativeSeparators(fileName) << ": " << e.what();
 			errorOccured = true;
-			f.close();
 			return;
 		}
-		f.close();
 	}
 	else
 	{
@@ -286,6 +290,24 @@ QVariantMap MultiLevelJsonBase::loadFromJSON(QIODevice& input, bool qZcompressed
 }
 
 
+// Parse functions used by StelJsonCache for the different local file encodings
+QVariant MultiLevelJsonBase::parseJSONContent(const QByteArray& content)
+{
+	return StelJsonParser::parse(content);
+}
+
+QVariant MultiLevelJsonBase::parseQZJSONContent(const QByteArray& content)
+{
+	if (content.isEmpty())
+		return QVariant();
+	return StelJsonParser::parse(qUncompress(content));
+}
+
+QVariant MultiLevelJsonBase::parseGzJSONContent(const QByteArray& content)
+{
+	return StelJsonParser::parse(StelUtils::uncompress(content));
+}
+
 // Called when the download for the JSON file terminated
 void MultiLevelJsonBase::downloadFinished()
 {
@@ -112,6 +112,12 @@ protected:
 	//! Load the element information from a JSON file
 	static QVariantMap loadFromJSON(QIODevice& input, bool qZcompressed=false, bool gzCompressed=false);
 
+	//! Parse the raw content of a plain, qZ or gz compressed JSON file.
+	//! Used as parse functions for StelJsonCache.
+	static QVariant parseJSONContent(const QByteArray& content);
+	static QVariant parseQZJSONContent(const QByteArray& content);
+	static QVariant parseGzJSONContent(const QByteArray& content);
+
 private:
 	//! Return the base URL prefixed to relative URL
 	QString getBaseUrl() const {return baseUrl;}
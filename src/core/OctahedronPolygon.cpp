@@ -23,6 +23,8 @@
 #include "glues.h"
 
 #include <QFile>
+#include <QCache>
+#include <QMutex>
 
 const Vec3d OctahedronPolygon::sideDirections[] = {	Vec3d(1,1,1), Vec3d(1,1,-1),Vec3d(-1,1,1),Vec3d(-1,1,-1),
 	Vec3d(1,-1,1),Vec3d(1,-1,-1),Vec3d(-1,-1,1),Vec3d(-1,-1,-1)};
@@ -377,52 +379,18 @@ inline void unprojectOctahedron(Vec3d& v, const Vec3d& sideDirection)
 void OctahedronPolygon::updateVertexArray()
 {
 	Q_ASSERT(sides.size()==8);
+	// The fill triangles are only needed for drawing and area computation, tesselate them on demand
 	fillCachedVertexArray.vertex.clear();
+	fillCachedVertexArrayValid = false;
 	outlineCachedVertexArray.vertex.clear();
 
-	Q_ASSERT(sides.size()==8);
-	// Use GLUES tesselation functions to transform the polygon into a list of triangles
-	GLUEStesselator* tess = gluesNewTess();
-#ifndef NDEBUG
-	gluesTessCallback(tess, GLUES_TESS_BEGIN, (GLvoid(*)()) &checkBeginTrianglesCallback);
-#endif
-	gluesTessCallback(tess, GLUES_TESS_VERTEX_DATA, (GLvoid(*)()) &vertexTrianglesCallback);
-	gluesTessCallback(tess, GLUES_TESS_EDGE_FLAG, (GLvoid(*)()) &noOpCallback);
-	gluesTessCallback(tess, GLUES_TESS_ERROR, (GLvoid(*)()) &errorCallback);
-	gluesTessCallback(tess, GLUES_TESS_COMBINE_DATA, (GLvoid(*)()) &combineTrianglesCallback);
-	gluesTessProperty(tess, GLUES_TESS_WINDING_RULE, GLUES_TESS_WINDING_POSITIVE);
-
-	// Call the tesselator on each side
 	for (int sidenb=0;sidenb<8;++sidenb)
 	{
 		if (sides[sidenb].isEmpty())
 			continue;
 		const Vec3d& sideDirection = sideDirections[sidenb];
-		QVector<Vec3d> res = tesselateOneSideTriangles(tess, sidenb);
-		Q_ASSERT(res.size()%3==0);	// There should be only triangles here
-		for (int j=0;j<=res.size()-3;j+=3)
-		{
-			// Post processing, GLU seems to sometimes output triangles oriented in the wrong direction..
-			// Get rid of them in an ugly way. TODO Need to find the real cause.
-			if (((sidenb&1)==0 ?
-			isTriangleConvexPositive2D(res.at(j+2), res.at(j+1), res.at(j)) :
-			isTriangleConvexPositive2D(res.at(j), res.at(j+1), res.at(j+2))))
-			{
-				fillCachedVertexArray.vertex+=res.at(j);
-				unprojectOctahedron(fillCachedVertexArray.vertex.last(), sideDirection);
-				fillCachedVertexArray.vertex+=res.at(j+1);
-				unprojectOctahedron(fillCachedVertexArray.vertex.last(), sideDirection);
-				fillCachedVertexArray.vertex+=res.at(j+2);
-				unprojectOctahedron(fillCachedVertexArray.vertex.last(), sideDirection);
-			}
-			else
-			{
-				//  Discard vertex..
-				//qDebug() << "Found a fucking CW triangle";
-			}
-		}
 
-		// Now compute the outline contours, getting rid of non edge segments
+		// Compute the outline contours, getting rid of non edge segments
 		EdgeVertex previous;
 		foreach (const SubContour& c, sides[sidenb])
 		{
@@ -453,18 +421,159 @@ void OctahedronPolygon::updateVertexArray()
 			}
 		}
 	}
-	gluesDeleteTess(tess);
 	computeBoundingCap();
+}
+
+uint OctahedronPolygon::contoursHash() const
+{
+	uint h = 0;
+	for (int sidenb=0;sidenb<8;++sidenb)
+	{
+		h = qHash(sides[sidenb].size(), h);
+		foreach (const SubContour& c, sides[sidenb])
+		{
+			for (int j=0;j<c.size();++j)
+				h = qHashBits(c.at(j).vertex.v, sizeof(c.at(j).vertex.v), h);
+		}
+	}
+	return h;
+}
+
+// Check whether 2 sets of octahedron sides contain exactly the same vertices
+static bool sameContourVertices(const QVector<QVector<SubContour> >& s1, const QVarLengthArray<QVector<SubContour>,8 >& s2)
+{
+	Q_ASSERT(s1.size()==8 && s2.size()==8);
+	for (int sidenb=0;sidenb<8;++sidenb)
+	{
+		const QVector<SubContour>& c1 = s1.at(sidenb);
+		const QVector<SubContour>& c2 = s2.at(sidenb);
+		if (c1.size()!=c2.size())
+			return false;
+		for (int i=0;i<c1.size();++i)
+		{
+			const SubContour& sc1 = c1.at(i);
+			const SubContour& sc2 = c2.at(i);
+			if (sc1.size()!=sc2.size())
+				return false;
+			for (int j=0;j<sc1.size();++j)
+			{
+				if (sc1.at(j).vertex!=sc2.at(j).vertex)
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Entry of the tesselation cache
+struct OctahedronFillCacheEntry
+{
+	QVector<QVector<SubContour> > sides;
+	QVector<Vec3d> fill;
+};
+
+// Tesselated triangles of recently used regions, indexed by the hash of their contours.
+// Temporary regions created by boolean operations and regions rebuilt with the same
+// contours then don't need to run the tesselator again.
+static QCache<uint, OctahedronFillCacheEntry> fillCache(256);
+static QMutex fillCacheMutex;
+
+void OctahedronPolygon::updateFillVertexArray() const
+{
+	Q_ASSERT(sides.size()==8);
+	if (isEmpty())
+	{
+		fillCachedVertexArray.vertex.clear();
+		fillCachedVertexArrayValid = true;
+		return;
+	}
+
+	const uint key = contoursHash();
+	{
+		QMutexLocker lock(&fillCacheMutex);
+		const OctahedronFillCacheEntry* entry = fillCache.object(key);
+		if (entry!=NULL && sameContourVertices(entry->sides, sides))
+		{
+			fillCachedVertexArray.vertex = entry->fill;
+			fillCachedVertexArrayValid = true;
+			return;
+		}
+	}
+
+	QVector<Vec3d> result;
+	tesselateFillVertexArray(result);
+
+	OctahedronFillCacheEntry* entry = new OctahedronFillCacheEntry();
+	entry->sides.resize(8);
+	for (int i=0;i<8;++i)
+		entry->sides[i] = sides[i];
+	entry->fill = result;
+	{
+		QMutexLocker lock(&fillCacheMutex);
+		fillCache.insert(key, entry, 1+result.size()/64);
+	}
+
+	fillCachedVertexArray.vertex = result;
+	fillCachedVertexArrayValid = true;
+}
+
+void OctahedronPolygon::tesselateFillVertexArray(QVector<Vec3d>& result) const
+{
+	Q_ASSERT(sides.size()==8);
+	result.clear();
+
+	// Use GLUES tesselation functions to transform the polygon into a list of triangles
+	GLUEStesselator* tess = gluesNewTess();
+#ifndef NDEBUG
+	gluesTessCallback(tess, GLUES_TESS_BEGIN, (GLvoid(*)()) &checkBeginTrianglesCallback);
+#endif
+	gluesTessCallback(tess, GLUES_TESS_VERTEX_DATA, (GLvoid(*)()) &vertexTrianglesCallback);
+	gluesTessCallback(tess, GLUES_TESS_EDGE_FLAG, (GLvoid(*)()) &noOpCallback);
+	gluesTessCallback(tess, GLUES_TESS_ERROR, (GLvoid(*)()) &errorCallback);
+	gluesTessCallback(tess, GLUES_TESS_COMBINE_DATA, (GLvoid(*)()) &combineTrianglesCallback);
+	gluesTessProperty(tess, GLUES_TESS_WINDING_RULE, GLUES_TESS_WINDING_POSITIVE);
+
+	// Call the tesselator on each side
+	for (int sidenb=0;sidenb<8;++sidenb)
+	{
+		if (sides[sidenb].isEmpty())
+			continue;
+		const Vec3d& sideDirection = sideDirections[sidenb];
+		QVector<Vec3d> res = tesselateOneSideTriangles(tess, sidenb);
+		Q_ASSERT(res.size()%3==0);	// There should be only triangles here
+		for (int j=0;j<=res.size()-3;j+=3)
+		{
+			// Post processing, GLU seems to sometimes output triangles oriented in the wrong direction..
+			// Get rid of them in an ugly way. TODO Need to find the real cause.
+			if (((sidenb&1)==0 ?
+			isTriangleConvexPositive2D(res.at(j+2), res.at(j+1), res.at(j)) :
+			isTriangleConvexPositive2D(res.at(j), res.at(j+1), res.at(j+2))))
+			{
+				result+=res.at(j);
+				unprojectOctahedron(result.last(), sideDirection);
+				result+=res.at(j+1);
+				unprojectOctahedron(result.last(), sideDirection);
+				result+=res.at(j+2);
+				unprojectOctahedron(result.last(), sideDirection);
+			}
+			else
+			{
+				//  Discard vertex..
+				//qDebug() << "Found a fucking CW triangle";
+			}
+		}
+	}
+	gluesDeleteTess(tess);
 
 #ifndef NDEBUG
 	// Check that all triangles are properly oriented
 	QVector<Vec3d> c;
 	c.resize(3);
-	for (int j=0;j<fillCachedVertexArray.vertex.size()/3;++j)
+	for (int j=0;j<result.size()/3;++j)
 	{
-		c[0]=fillCachedVertexArray.vertex.at(j*3);
-		c[1]=fillCachedVertexArray.vertex.at(j*3+1);
-		c[2]=fillCachedVertexArray.vertex.at(j*3+2);
+		c[0]=result.at(j*3);
+		c[1]=result.at(j*3+1);
+		c[2]=result.at(j*3+2);
 		Q_ASSERT(SphericalConvexPolygon::checkValidContour(c));
 	}
 #else
@@ -632,23 +741,55 @@ bool OctahedronPolygon::contains(const OctahedronPolygon& mpoly) const
 {
 	if (!containsBoundingCap(capN, capD, mpoly.capN, mpoly.capD))
 		return false;
-	OctahedronPolygon resOct(*this);
-	resOct.inPlaceUnion(mpoly);
-	return resOct.getArea()-getArea()<0.00000000001;
+	// The polygon is contained if nothing is left of it once this one is removed. Unlike comparing
+	// the areas, this only tesselates the contours and not the fill triangles.
+	OctahedronPolygon resOct(mpoly);
+	resOct.inPlaceSubtraction(*this);
+	return resOct.isEmpty();
 }
 
 bool OctahedronPolygon::contains(const Vec3d& p) const
 {
-	if (sides[getSideNumber(p)].isEmpty())
+	const int sidenb = getSideNumber(p);
+	if (sides[sidenb].isEmpty())
 		return false;
-	for (int i=0;i<fillCachedVertexArray.vertex.size()/3;++i)
+	if (fillCachedVertexArrayValid)
 	{
-		if (sideHalfSpaceContains(fillCachedVertexArray.vertex.at(i*3+1), fillCachedVertexArray.vertex.at(i*3), p) &&
-			sideHalfSpaceContains(fillCachedVertexArray.vertex.at(i*3+2), fillCachedVertexArray.vertex.at(i*3+1), p) &&
-			sideHalfSpaceContains(fillCachedVertexArray.vertex.at(i*3), fillCachedVertexArray.vertex.at(i*3+2), p))
-			return true;
+		// The triangles are already available, use them
+		for (int i=0;i<fillCachedVertexArray.vertex.size()/3;++i)
+		{
+			if (sideHalfSpaceContains(fillCachedVertexArray.vertex.at(i*3+1), fillCachedVertexArray.vertex.at(i*3), p) &&
+				sideHalfSpaceContains(fillCachedVertexArray.vertex.at(i*3+2), fillCachedVertexArray.vertex.at(i*3+1), p) &&
+				sideHalfSpaceContains(fillCachedVertexArray.vertex.at(i*3), fillCachedVertexArray.vertex.at(i*3+2), p))
+				return true;
+		}
+		return false;
+	}
+	// Else test directly against the contours of the side, without tesselating
+	Vec3d p2d(p);
+	p2d *= 1./(sideDirections[sidenb]*p2d);
+	p2d[2]=0.;
+	return sideContains2D(p2d, sidenb);
+}
+
+// Crossing number test of a point projected on the given octahedron side.
+// The contours of one side never overlap after tesselation, so the even-odd
+// rule gives the same result as the positive winding rule used for filling.
+bool OctahedronPolygon::sideContains2D(const Vec3d& p, int sideNb) const
+{
+	bool inside = false;
+	foreach (const SubContour& c, sides[sideNb])
+	{
+		const int n = c.size();
+		for (int i=0, j=n-1;i<n;j=i++)
+		{
+			const Vec3d& a = c.at(i).vertex;
+			const Vec3d& b = c.at(j).vertex;
+			if (((a[1]>p[1])!=(b[1]>p[1])) && (p[0] < (b[0]-a[0])*(p[1]-a[1])/(b[1]-a[1])+a[0]))
+				inside = !inside;
+		}
 	}
-	return false;
+	return inside;
 }
 
 bool OctahedronPolygon::isEmpty() const
@@ -864,6 +1005,8 @@ OctahedronPolygon OctahedronPolygon::createAllSkyOctahedronPolygon()
 	}
 	projectOnOctahedron(poly.sides);
 	poly.updateVertexArray();
+	// The all sky polygon is shared, compute its triangles once and for all
+	poly.updateFillVertexArray();
 	poly.capD = -2;
 	Q_ASSERT(std::fabs(poly.getArea()-4.*M_PI)<0.0000001);
 	return poly;
@@ -881,7 +1024,7 @@ QDataStream& operator<<(QDataStream& out, const OctahedronPolygon& p)
 	{
 		out << p.sides[i];
 	}
-	out << p.fillCachedVertexArray;
+	out << p.getFillVertexArray();
 	out << p.outlineCachedVertexArray;
 	out << p.capN;
 	out << p.capD;
@@ -897,6 +1040,7 @@ QDataStream& operator>>(QDataStream& in, OctahedronPolygon& p)
 	}
 //	p.updateVertexArray();
 	in >> p.fillCachedVertexArray;
+	p.fillCachedVertexArrayValid = true;
 	in >> p.outlineCachedVertexArray;
 	in >> p.capN;
 	in >> p.capD;
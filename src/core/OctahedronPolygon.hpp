@@ -62,7 +62,7 @@ public:
 class OctahedronPolygon
 {
 public:
-	OctahedronPolygon() : fillCachedVertexArray(StelVertexArray::Triangles), outlineCachedVertexArray(StelVertexArray::Lines), capN(1,0,0), capD(-2.)
+	OctahedronPolygon() : fillCachedVertexArray(StelVertexArray::Triangles), fillCachedVertexArrayValid(true), outlineCachedVertexArray(StelVertexArray::Lines), capN(1,0,0), capD(-2.)
 	{sides.resize(8);}
 
 	//! Create the OctahedronContour by splitting the passed SubContour on the 8 sides of the octahedron.
@@ -76,7 +76,13 @@ public:
 	Vec3d getPointInside() const;
 
 	//! Returns the list of triangles resulting from tesselating the contours.
-	StelVertexArray getFillVertexArray() const {return fillCachedVertexArray;}
+	//! The tesselation is computed on the first call only.
+	StelVertexArray getFillVertexArray() const
+	{
+		if (!fillCachedVertexArrayValid)
+			updateFillVertexArray();
+		return fillCachedVertexArray;
+	}
 	StelVertexArray getOutlineVertexArray() const {return outlineCachedVertexArray;}
 
 	void getBoundingCap(Vec3d& v, double& d) const {v=capN; d=capD;}
@@ -139,9 +145,17 @@ private:
 	QVector<Vec3d> tesselateOneSideTriangles(struct GLUEStesselator* tess, int sidenb) const;
 	QVarLengthArray<QVector<SubContour>,8 > sides;
 
-	//! Update the content of both cached vertex arrays.
+	//! Update the content of the outline vertex array and the bounding cap.
+	//! The fill vertex array is only invalidated, and tesselated again on demand.
 	void updateVertexArray();
-	StelVertexArray fillCachedVertexArray;
+	//! Tesselate the contours into triangles, reusing the result of an identical region if possible.
+	void updateFillVertexArray() const;
+	//! Compute the fill triangles of the contours using the GLUES tesselator.
+	void tesselateFillVertexArray(QVector<Vec3d>& result) const;
+	//! Return a hash of the contour vertices, used as the key of the fill cache.
+	uint contoursHash() const;
+	mutable StelVertexArray fillCachedVertexArray;
+	mutable bool fillCachedVertexArrayValid;
 	StelVertexArray outlineCachedVertexArray;
 	void computeBoundingCap();
 	Vec3d capN;
@@ -23,6 +23,8 @@
 #include "StelApp.hpp"
 #include "RefractionExtinction.hpp"
 
+#include <QOpenGLShaderProgram>
+
 Extinction::Extinction() : ext_coeff(50), undergroundExtinctionMode(UndergroundExtinctionMirror)
 {
 }
@@ -198,6 +200,46 @@ void Refraction::backward(Vec3f& altAzPos) const
 	altAzPos.transfo4d(invertPreTransfoMatf);
 }
 
+const char* Refraction::getForwardShaderSource() const
+{
+	// Same computation as forward(Vec3f&), built once so that the altitude limits stay in sync
+	static const QByteArray source = QString(
+		"uniform highp mat4 refractionPreMatrix;\n"
+		"uniform highp mat4 refractionPostMatrix;\n"
+		"uniform highp vec2 refractionCorrections;\n"
+		"vec3 modelViewForward(vec3 v)\n"
+		"{\n"
+		"    vec3 p = (refractionPreMatrix*vec4(v, 1.)).xyz;\n"
+		"    float len = length(p);\n"
+		"    float alt = degrees(asin(p.z/len));\n"
+		"    if (alt > %1)\n"
+		"    {\n"
+		"        alt = min(alt + refractionCorrections.x/tan(radians(alt+10.3/(alt+5.11))) + 0.0019279, 90.);\n"
+		"        p.z = sin(radians(alt))*len;\n"
+		"    }\n"
+		"    else if (alt > %2)\n"
+		"    {\n"
+		"        alt += refractionCorrections.y*(alt-(%2))/%3;\n"
+		"        p.z = sin(radians(alt))*len;\n"
+		"    }\n"
+		"    return (refractionPostMatrix*vec4(p, 1.)).xyz;\n"
+		"}\n")
+		.arg(QString::number(MIN_GEO_ALTITUDE_DEG, 'f', 6))
+		.arg(QString::number(MIN_GEO_ALTITUDE_DEG-TRANSITION_WIDTH_GEO_DEG, 'f', 6))
+		.arg(QString::number(TRANSITION_WIDTH_GEO_DEG, 'f', 6)).toLatin1();
+	return source.constData();
+}
+
+void Refraction::setForwardShaderUniforms(QOpenGLShaderProgram* program) const
+{
+	// Mat4f is column-major like GL
+	program->setUniformValue("refractionPreMatrix", reinterpret_cast<const GLfloat (*)[4]>((const float*)preTransfoMatf));
+	program->setUniformValue("refractionPostMatrix", reinterpret_cast<const GLfloat (*)[4]>((const float*)postTransfoMatf));
+	// Refraction at the top of the transition zone, interpolated down to 0 inside it
+	const float r_m5 = press_temp_corr_Saemundson / std::tan((MIN_GEO_ALTITUDE_DEG+10.3f/(MIN_GEO_ALTITUDE_DEG+5.11f))*M_PI/180.f) + 0.0019279f;
+	program->setUniformValue("refractionCorrections", press_temp_corr_Saemundson, r_m5);
+}
+
 void Refraction::setPressure(float p)
 {
 	pressure=p;
@@ -152,6 +152,10 @@ public:
 
 	StelProjector::ModelViewTranformP clone() const {Refraction* refr = new Refraction(); *refr=*this; return StelProjector::ModelViewTranformP(refr);}
 
+	//! Return the GLSL version of forward(), so that refracted vertices can be projected by the GPU.
+	const char* getForwardShaderSource() const;
+	void setForwardShaderUniforms(QOpenGLShaderProgram* program) const;
+
 	//! Set surface air pressure (mbars), influences refraction computation.
 	void setPressure(float p_mbar);
 	float getPressure() const {return pressure;}
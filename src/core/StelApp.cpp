@@ -52,12 +52,17 @@
 #include "StelVideoMgr.hpp"
 #include "StelGuiBase.hpp"
 #include "StelPainter.hpp"
+#include "StelProfiler.hpp"
+#include "StelRiseSetCalculator.hpp"
+#include "StelFader.hpp"
+#include "StelMovementMgr.hpp"
 #ifndef DISABLE_SCRIPTING
  #include "StelScriptMgr.hpp"
  #include "StelMainScriptAPIProxy.hpp"
 #endif
 
 
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
 #include <QDebug>
@@ -76,6 +81,8 @@
 #include <QDir>
 #include <QCoreApplication>
 #include <QScreen>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
 
 #ifndef USE_QUICKVIEW
 Q_IMPORT_PLUGIN(StelStandardGuiPluginInterface)
@@ -188,6 +195,11 @@ StelApp::StelApp(QObject* parent)
 	, frame(0)
 	, timefr(0.)
 	, timeBase(0.)
+	, flagRedrawRequested(true)
+	, redrawLevel(RedrawAnimating)
+	, idleFps(0.2f)
+	, lastRedrawJd(0.)
+	, lastRedrawFov(0.)
 	, flagNightVision(false)
 	, confSettings(NULL)
 	, initialized(false)
@@ -215,6 +227,7 @@ StelApp::StelApp(QObject* parent)
 	singleton = this;
 
 	moduleMgr = new StelModuleMgr();
+	profiler = new StelProfiler(this);
 
 	wheelEventTimer = new QTimer(this);
 	wheelEventTimer->setInterval(25);
@@ -341,6 +354,9 @@ void StelApp::initScriptMgr(QSettings *conf) {Q_UNUSED(conf);}
 void StelApp::init(QSettings* conf)
 {
 	confSettings = conf;
+	profiler->setEnabled(conf->value("devel/flag_profiler", false).toBool());
+	profiler->setFlagGpuSync(conf->value("devel/flag_profiler_gpu_sync", false).toBool());
+	idleFps = conf->value("video/idle_fps", 0.2f).toFloat();
 
 	devicePixelsPerPixel = QOpenGLContext::currentContext()->screen()->devicePixelRatio();
 	
@@ -471,6 +487,33 @@ void StelApp::init(QSettings* conf)
 	actionMgr->addAction("actionShow_Night_Mode", N_("Display Options"), N_("Night mode"), this, "nightMode");
 
 	initialized = true;
+
+	if (qApp->property("onetime_rise_set").isValid())
+		QMetaObject::invokeMethod(this, "runRiseSetBatch", Qt::QueuedConnection);
+}
+
+void StelApp::runRiseSetBatch()
+{
+	StelRiseSetCalculator::Params params;
+	params.startJD = core->getJDay();
+	params.endJD = params.startJD + qApp->property("onetime_rise_set_days").toDouble();
+	params.altitude = qApp->property("onetime_rise_set_altitude").toDouble();
+	params.maxSunAltitude = qApp->property("onetime_rise_set_sun_altitude").toDouble();
+	const QStringList names = qApp->property("onetime_rise_set").toString().split(',', QString::SkipEmptyParts);
+	const QVariantList results = StelRiseSetCalculator(core).compute(names, params);
+
+	const QString fileName = qApp->property("onetime_rise_set_output").toString();
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+	{
+		qCritical() << "ERROR: cannot write the rise/set file" << QDir::toNativeSeparators(fileName);
+		QCoreApplication::exit(1);
+		return;
+	}
+	StelJsonParser::write(results, &file);
+	file.close();
+	qDebug() << "Wrote the rise/set times of" << results.size() << "objects to" << QDir::toNativeSeparators(fileName);
+	QCoreApplication::exit(0);
 }
 
 // Load and initialize external modules (plugins)
@@ -535,18 +578,80 @@ void StelApp::update(double deltaTime)
 		frame = 0;
 		timeBase+=1.;
 	}
-		
-	core->update(deltaTime);
+	profiler->nextFrame();
+
+	{
+		StelProfiler::Scope scope(profiler, "update:StelCore");
+		core->update(deltaTime);
+	}
 
 	moduleMgr->update();
 
 	// Send the event to every StelModule
+	const bool profile = profiler->isEnabled();
+	bool moduleNeedsRedraw = false;
 	foreach (StelModule* i, moduleMgr->getCallOrders(StelModule::ActionUpdate))
 	{
+		StelProfiler::Scope scope(profile ? profiler : NULL, profile ? "update:"+i->objectName() : QString());
 		i->update(deltaTime);
+		moduleNeedsRedraw = moduleNeedsRedraw || i->needsRedraw();
 	}
 
 	stelObjectMgr->update(deltaTime);
+
+	updateRedrawLevel(deltaTime, moduleNeedsRedraw);
+}
+
+void StelApp::updateRedrawLevel(double deltaTime, bool moduleNeedsRedraw)
+{
+	bool animating = flagRedrawRequested || moduleNeedsRedraw;
+	flagRedrawRequested = false;
+	// Always take the flag so that it doesn't stay set from a previous frame
+	if (StelFader::takeTransitionFlag())
+		animating = true;
+
+	// The view moved or zoomed
+	const StelMovementMgr* mmgr = core->getMovementMgr();
+	const Vec3d viewDirection = mmgr->getViewDirectionJ2000();
+	const double fov = mmgr->getCurrentFov();
+	if (viewDirection!=lastRedrawViewDirection || fov!=lastRedrawFov)
+		animating = true;
+	lastRedrawViewDirection = viewDirection;
+	lastRedrawFov = fov;
+
+	// The time runs faster than real time, or jumped to another date
+	const double jd = core->getJDay();
+	const double timeRate = core->getTimeRate();
+	if (std::fabs(timeRate)>1.01*StelCore::JD_SECOND || std::fabs(jd-lastRedrawJd-timeRate*deltaTime)>StelCore::JD_SECOND)
+		animating = true;
+	lastRedrawJd = jd;
+
+#ifndef DISABLE_SCRIPTING
+	if (scriptMgr->scriptIsRunning())
+		animating = true;
+#endif
+
+	if (animating)
+		redrawLevel = RedrawAnimating;
+	else
+		redrawLevel = timeRate!=0. ? RedrawSlow : RedrawIdle;
+}
+
+void StelApp::requestRedraw()
+{
+	if (flagRedrawRequested)
+		return;
+	flagRedrawRequested = true;
+	emit redrawRequested();
+}
+
+void StelApp::setIdleFps(float fps)
+{
+	if (fps<=0.f || fps==idleFps)
+		return;
+	idleFps = fps;
+	emit idleFpsChanged(fps);
+	requestRedraw();
 }
 
 //! Main drawing function called at each frame
@@ -556,12 +661,21 @@ void StelApp::draw()
 		return;
 	core->preDraw();
 
+	const bool profile = profiler->isEnabled();
 	const QList<StelModule*> modules = moduleMgr->getCallOrders(StelModule::ActionDraw);
 	foreach(StelModule* module, modules)
 	{
+		StelProfiler::Scope scope(profile ? profiler : NULL, profile ? "draw:"+module->objectName() : QString());
 		module->draw(core);
 	}
 	core->postDraw();
+
+	if (profiler->getFlagGpuSync())
+	{
+		// Wait for the GPU so that its time is attributed to this frame instead of the next swap
+		StelProfiler::Scope scope(profiler, "gl:finish");
+		QOpenGLContext::currentContext()->functions()->glFinish();
+	}
 }
 
 /*************************************************************************
@@ -577,11 +691,13 @@ void StelApp::glWindowHasBeenResized(float x, float y, float w, float h)
 		saveProjW = w;
 		saveProjH = h;
 	}
+	requestRedraw();
 }
 
 // Handle mouse clics
 void StelApp::handleClick(QMouseEvent* inputEvent)
 {
+	requestRedraw();
 	inputEvent->setAccepted(false);
 	
 	QMouseEvent event(inputEvent->type(), QPoint(inputEvent->pos().x()*devicePixelsPerPixel, inputEvent->pos().y()*devicePixelsPerPixel), inputEvent->button(), inputEvent->buttons(), inputEvent->modifiers());
@@ -603,6 +719,7 @@ void StelApp::handleClick(QMouseEvent* inputEvent)
 // This deltaEvent is a work-around for QTBUG-22269
 void StelApp::handleWheel(QWheelEvent* event)
 {
+	requestRedraw();
 	// variables used to track the changes
 	static int delta = 0;
 
@@ -641,6 +758,7 @@ void StelApp::handleWheel(QWheelEvent* event)
 // Handle mouse move
 void StelApp::handleMove(int x, int y, Qt::MouseButtons b)
 {
+	requestRedraw();
 	// Send the event to every StelModule
 	foreach (StelModule* i, moduleMgr->getCallOrders(StelModule::ActionHandleMouseMoves))
 	{
@@ -652,6 +770,7 @@ void StelApp::handleMove(int x, int y, Qt::MouseButtons b)
 // Handle key press and release
 void StelApp::handleKeys(QKeyEvent* event)
 {
+	requestRedraw();
 	event->setAccepted(false);
 	// First try to trigger a shortcut.
 	if (event->type() == QEvent::KeyPress)
@@ -674,6 +793,7 @@ void StelApp::handleKeys(QKeyEvent* event)
 // Handle pinch on multi touch devices
 void StelApp::handlePinch(qreal scale, bool started)
 {
+	requestRedraw();
 	// Send the event to every StelModule
 	foreach (StelModule* i, moduleMgr->getCallOrders(StelModule::ActionHandleMouseMoves))
 	{
@@ -689,6 +809,7 @@ void StelApp::setVisionModeNight(bool b)
 	{
 		flagNightVision=b;
 		emit(visionNightModeChanged(b));
+		requestRedraw();
 	}
 }
 
@@ -22,6 +22,7 @@
 
 #include <QString>
 #include <QObject>
+#include "VecMath.hpp"
 
 // Predeclaration of some classes
 class StelCore;
@@ -44,6 +45,7 @@ class StelMainScriptAPIProxy;
 class StelScriptMgr;
 class StelActionMgr;
 class StelProgressController;
+class StelProfiler;
 
 //! @class StelApp
 //! Singleton main Stellarium application class.
@@ -124,6 +126,9 @@ public:
 	//! Get the video manager
 	StelVideoMgr* getStelVideoMgr() {return videoMgr;}
 
+	//! Get the frame profiler.
+	StelProfiler* getProfiler() {return profiler;}
+
 	//! Get the core of the program.
 	//! It is the one which provide the projection, navigation and tone converter.
 	//! @return the StelCore instance of the program
@@ -154,6 +159,20 @@ public:
 	//! Call this when the size of the GL window has changed.
 	void glWindowHasBeenResized(float x, float y, float w, float h);
 
+	//! How fast the content of the sky is changing, used by the main view to adapt its frame rate.
+	enum RedrawLevel
+	{
+		RedrawIdle,		//!< Nothing changes, the sky only needs to be refreshed very rarely
+		RedrawSlow,		//!< The time runs at about real time, the sky changes slowly
+		RedrawAnimating		//!< Something is moving or fading on screen
+	};
+
+	//! Return the redraw level computed during the last call to update().
+	RedrawLevel getRedrawLevel() const {return redrawLevel;}
+
+	//! Get the frames per second used by the main view when nothing changes in the sky.
+	float getIdleFps() const {return idleFps;}
+
 	//! Get the ratio between real device pixel and "Device Independent Pixel".
 	//! Usually this value is 1, but for a mac with retina screen this will be value 2.
 	float getDevicePixelsPerPixel() const {return devicePixelsPerPixel;}
@@ -203,6 +222,16 @@ public slots:
 	//! Return the time since when stellarium is running in second.
 	static double getTotalRunTime();
 
+	//! Ask for the sky to be redrawn at full frame rate, e.g. after a user input, a script command
+	//! or when some data finished loading. The redrawRequested() signal is emitted so that an idle
+	//! main view can wake up immediately.
+	void requestRedraw();
+
+	//! Set the frames per second used by the main view when nothing changes in the sky (time
+	//! paused, no movement, no fading). It is only used when lower than the minimum frame rate.
+	//! The idleFpsChanged() signal is emitted so that the main view can apply it.
+	void setIdleFps(float fps);
+
 	//! Report that a download occured. This is used for statistics purposes.
 	//! Connect this slot to QNetworkAccessManager::finished() slot to obtain statistics at the end of the program.
 	void reportFileDownloadFinished(QNetworkReply* reply);
@@ -212,12 +241,18 @@ signals:
 	void colorSchemeChanged(const QString&);
 	void languageChanged();
 	void skyCultureChanged(const QString&);
+	//! Emitted when the idle frame rate is changed, e.g. by a script.
+	void idleFpsChanged(float);
 
 	//! Called just after a progress bar is added.
 	void progressBarAdded(const StelProgressController*);
 	//! Called just before a progress bar is removed.
 	void progressBarRemoved(const StelProgressController*);
 
+private slots:
+	//! Compute the rise and set times requested with the --rise-set command line option, then quit.
+	void runRiseSetBatch();
+
 private:
 
 	//! Handle mouse clics.
@@ -233,6 +268,9 @@ private:
 
 	void initScriptMgr(QSettings* conf);
 
+	//! Compute the redraw level for the next frame from the changes of the current one.
+	void updateRedrawLevel(double deltaTime, bool moduleNeedsRedraw);
+
 	// The StelApp singleton
 	static StelApp* singleton;
 
@@ -272,6 +310,9 @@ private:
 	// The video manager.  Must execute in the main thread.
 	StelVideoMgr* videoMgr;
 
+	// Frame profiler
+	StelProfiler* profiler;
+
 	StelSkyLayerMgr* skyImageMgr;
 
 #ifndef DISABLE_SCRIPTING
@@ -300,6 +341,14 @@ private:
 	int frame;
 	double timefr, timeBase;		// Used for fps counter
 
+	// Used to detect the changes of the scene between two frames
+	bool flagRedrawRequested;
+	RedrawLevel redrawLevel;
+	float idleFps;
+	double lastRedrawJd;
+	double lastRedrawFov;
+	Vec3d lastRedrawViewDirection;
+
 	//! Define whether we are in night vision mode
 	bool flagNightVision;
 	
@@ -23,6 +23,7 @@
 #include "StelProjectorClasses.hpp"
 #include "StelToneReproducer.hpp"
 #include "StelSkyDrawer.hpp"
+#include "StelLabelScheduler.hpp"
 #include "StelApp.hpp"
 #include "StelUtils.hpp"
 #include "StelGeodesicGrid.hpp"
@@ -56,7 +57,7 @@ const double StelCore::JD_HOUR  =0.041666666666666666666;
 const double StelCore::JD_DAY   =1.;
 
 
-StelCore::StelCore() : movementMgr(NULL), geodesicGrid(NULL), currentProjectionType(ProjectionStereographic), position(NULL), timeSpeed(JD_SECOND), JDay(0.)
+StelCore::StelCore() : labelScheduler(NULL), movementMgr(NULL), geodesicGrid(NULL), currentProjectionType(ProjectionStereographic), position(NULL), timeSpeed(JD_SECOND), JDay(0.)
 {
 	toneConverter = new StelToneReproducer();
 
@@ -88,6 +89,7 @@ StelCore::~StelCore()
 	delete toneConverter; toneConverter=NULL;
 	delete geodesicGrid; geodesicGrid=NULL;
 	delete skyDrawer; skyDrawer=NULL;
+	delete labelScheduler; labelScheduler=NULL;
 	delete position; position=NULL;
 }
 
@@ -154,6 +156,10 @@ void StelCore::init()
 	skyDrawer = new StelSkyDrawer(this);
 	skyDrawer->init();
 
+	labelScheduler = new StelLabelScheduler();
+	labelScheduler->setEnabled(conf->value("viewing/flag_label_declutter", true).toBool());
+	labelScheduler->setMaxLabelsPerFrame(conf->value("viewing/max_labels_per_frame", 250).toInt());
+
 	QString tmpstr = conf->value("projection/type", "ProjectionStereographic").toString();
 	setCurrentProjectionTypeKey(tmpstr);
 
@@ -316,6 +322,16 @@ const StelSkyDrawer* StelCore::getSkyDrawer() const
 	return skyDrawer;
 }
 
+StelLabelScheduler* StelCore::getLabelScheduler()
+{
+	return labelScheduler;
+}
+
+const StelLabelScheduler* StelCore::getLabelScheduler() const
+{
+	return labelScheduler;
+}
+
 StelMovementMgr* StelCore::getMovementMgr()
 {
 	return movementMgr;
@@ -389,6 +405,7 @@ void StelCore::preDraw()
 	currentProjectorParams.zFar = 50.;
 
 	skyDrawer->preDraw();
+	labelScheduler->beginFrame(getProjection2d()->getViewport());
 
 	// Clear areas not redrawn by main viewport (i.e. fisheye square viewport)
 	glClearColor(0,0,0,0);
@@ -723,6 +740,18 @@ Vec3d StelCore::getObserverHeliocentricEclipticPos() const
 	return Vec3d(matAltAzToHeliocentricEcliptic[12], matAltAzToHeliocentricEcliptic[13], matAltAzToHeliocentricEcliptic[14]);
 }
 
+Vec3d StelCore::getObserverHeliocentricEclipticPos(double jd) const
+{
+	// Same as the translation part of matAltAzToHeliocentricEcliptic
+	const Mat4d rot = position->getRotEquatorialToVsop87() * position->getRotAltAzToEquatorial(jd);
+	return position->getCenterVsop87Pos() + rot.multiplyWithoutTranslation(Vec3d(0., 0., position->getDistanceFromCenter()));
+}
+
+Mat4d StelCore::getAltAzToEquinoxEquMatrix(double jd) const
+{
+	return position->getRotAltAzToEquatorial(jd);
+}
+
 // Set the location to use by default at startup
 void StelCore::setDefaultLocationID(const QString& id)
 {
@@ -30,6 +30,7 @@
 
 class StelToneReproducer;
 class StelSkyDrawer;
+class StelLabelScheduler;
 class StelGeodesicGrid;
 class StelMovementMgr;
 class StelObserver;
@@ -164,6 +165,11 @@ public:
 	//! Get the current StelSkyDrawer used in the core.
 	const StelSkyDrawer* getSkyDrawer() const;
 
+	//! Get the scheduler removing the overlapping object labels.
+	StelLabelScheduler* getLabelScheduler();
+	//! Get the scheduler removing the overlapping object labels.
+	const StelLabelScheduler* getLabelScheduler() const;
+
 	//! Get an instance of StelGeodesicGrid which is garanteed to allow for at least maxLevel levels
 	const StelGeodesicGrid* getGeodesicGrid(int maxLevel) const;
 
@@ -239,6 +245,14 @@ public:
 
 	//! Return the observer heliocentric ecliptic position
 	Vec3d getObserverHeliocentricEclipticPos() const;
+	//! Return the observer heliocentric ecliptic position at the given date.
+	//! The positions of the solar system bodies must have been computed for this date.
+	Vec3d getObserverHeliocentricEclipticPos(double jd) const;
+
+	//! Return the rotation from the observer altazimuthal frame to the equatorial frame at the given date.
+	//! Unlike the transformations above, which are for the current date, it can be used to compute
+	//! positions at other dates, e.g. for rise and set times.
+	Mat4d getAltAzToEquinoxEquMatrix(double jd) const;
 
 	//! Get the informations on the current location
 	const StelLocation& getCurrentLocation() const;
@@ -518,6 +532,7 @@ signals:
 private:
 	StelToneReproducer* toneConverter;		// Tones conversion between stellarium world and display device
 	StelSkyDrawer* skyDrawer;
+	StelLabelScheduler* labelScheduler;	// Removes the overlapping labels, shared by all modules
 	StelMovementMgr* movementMgr;		// Manage vision movements
 
 	// Manage geodesic grid
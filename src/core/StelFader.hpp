@@ -46,7 +46,12 @@ public:
 	virtual void setMaxValue(float _max) {maxValue = _max;}
 	float getMinValue() {return minValue;}
 	float getMaxValue() {return maxValue;}
+	//! Return whether any fader has been in transition since the last call, and reset the flag.
+	//! This is used to know whether the sky needs to be redrawn.
+	static bool takeTransitionFlag() {const bool b = transitionFlag(); transitionFlag() = false; return b;}
 protected:
+	//! Set by the faders each time they are updated during a transition.
+	static bool& transitionFlag() {static bool flag = false; return flag;}
 	bool state;
 	float minValue, maxValue;
 };
@@ -92,6 +97,7 @@ public:
 	void update(int deltaTicks)
 	{
 		if (!isTransiting) return; // We are not in transition
+		transitionFlag() = true;
 		counter+=deltaTicks;
 		if (counter>=duration)
 		{
@@ -175,6 +181,7 @@ public:
 	void update(int deltaTicks)
 	{
 		if (!isTransiting) return; // We are not in transition
+		transitionFlag() = true;
 		counter+=deltaTicks;
 		if (counter>=duration)
 		{
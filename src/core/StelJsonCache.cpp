@@ -0,0 +1,139 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelJsonCache.hpp"
+#include "StelJsonParser.hpp"
+#include "StelFileMgr.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QCryptographicHash>
+#include <stdexcept>
+
+// Increment this each time the layout of a cache entry changes
+static const quint32 JsonCacheMagic = 0x534A4331; // "SJC1"
+static const quint32 JsonCacheFormatVersion = 1;
+
+bool StelJsonCache::enabled = true;
+
+QVariant StelJsonCache::parseJson(const QByteArray& content)
+{
+	return StelJsonParser::parse(content);
+}
+
+QString StelJsonCache::getCacheDir()
+{
+	return StelFileMgr::getCacheDir() + "/jsoncache";
+}
+
+QString StelJsonCache::getCacheFilePath(const QString& absoluteFilePath)
+{
+	const QByteArray key = QCryptographicHash::hash(absoluteFilePath.toUtf8(), QCryptographicHash::Md5).toHex();
+	return getCacheDir() + "/" + QString::fromLatin1(key) + ".bin";
+}
+
+QVariant StelJsonCache::load(const QString& fileName, ParseFunction parseFunc)
+{
+	Q_ASSERT(parseFunc);
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		qWarning() << "StelJsonCache: cannot open" << QDir::toNativeSeparators(fileName);
+		return QVariant();
+	}
+	const QByteArray content = file.readAll();
+	file.close();
+
+	if (!enabled)
+		return parseFunc(content);
+
+	const QFileInfo info(fileName);
+	const QString absolutePath = info.absoluteFilePath();
+	const qint64 size = content.size();
+	const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+	const QByteArray hash = QCryptographicHash::hash(content, QCryptographicHash::Sha1);
+	const QString cachePath = getCacheFilePath(absolutePath);
+
+	// Try to reuse the cached tree
+	QFile cacheFile(cachePath);
+	if (cacheFile.open(QIODevice::ReadOnly))
+	{
+		QDataStream in(&cacheFile);
+		in.setVersion(QDataStream::Qt_5_0);
+		quint32 magic, version;
+		QString cachedPath;
+		qint64 cachedSize, cachedMtime;
+		QByteArray cachedHash;
+		in >> magic >> version;
+		if (in.status()==QDataStream::Ok && magic==JsonCacheMagic && version==JsonCacheFormatVersion)
+		{
+			in >> cachedPath >> cachedSize >> cachedMtime >> cachedHash;
+			if (in.status()==QDataStream::Ok && cachedPath==absolutePath && cachedSize==size && cachedMtime==mtime && cachedHash==hash)
+			{
+				QVariant result;
+				in >> result;
+				if (in.status()==QDataStream::Ok && result.isValid())
+					return result;
+			}
+		}
+		cacheFile.close();
+	}
+
+	// Cache miss: parse and store the result for the next time
+	const QVariant result = parseFunc(content);
+	if (!result.isValid())
+		return result;
+
+	try
+	{
+		StelFileMgr::makeSureDirExistsAndIsWritable(getCacheDir());
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "StelJsonCache: cannot create cache directory:" << e.what();
+		return result;
+	}
+
+	QSaveFile out(cachePath);
+	if (!out.open(QIODevice::WriteOnly))
+	{
+		qWarning() << "StelJsonCache: cannot write" << QDir::toNativeSeparators(cachePath);
+		return result;
+	}
+	QDataStream s(&out);
+	s.setVersion(QDataStream::Qt_5_0);
+	s << JsonCacheMagic << JsonCacheFormatVersion << absolutePath << size << mtime << hash << result;
+	if (s.status()!=QDataStream::Ok || !out.commit())
+		qWarning() << "StelJsonCache: error while writing" << QDir::toNativeSeparators(cachePath);
+	return result;
+}
+
+void StelJsonCache::clear()
+{
+	QDir dir(getCacheDir());
+	if (!dir.exists())
+		return;
+	foreach (const QString& f, dir.entryList(QStringList("*.bin"), QDir::Files))
+		dir.remove(f);
+}
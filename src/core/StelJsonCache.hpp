@@ -0,0 +1,68 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELJSONCACHE_HPP_
+#define _STELJSONCACHE_HPP_
+
+#include <QVariant>
+#include <QByteArray>
+#include <QString>
+
+//! @class StelJsonCache
+//! Transparent binary cache for parsed JSON files.
+//! The parsed QVariant tree of a local file is stored in the user cache directory
+//! using the QDataStream binary format. An entry is keyed by the absolute source path
+//! and is only reused if the size, the modification time and a hash of the content of
+//! the source file all match, so that warm starts skip JSON parsing entirely.
+//! Any error while reading or writing the cache silently falls back to a normal parse.
+class StelJsonCache
+{
+public:
+	//! Function used to convert the raw content of a file into a QVariant tree.
+	//! It may throw std::runtime_error on invalid input.
+	typedef QVariant (*ParseFunction)(const QByteArray& content);
+
+	//! Return the parsed content of the given file.
+	//! The binary cache is used if it is up to date, otherwise the file is parsed with
+	//! the passed function and the result is stored in the cache for the next time.
+	//! @param fileName the path of the local file to load.
+	//! @param parseFunc the function used to parse the file content, defaults to StelJsonParser.
+	//! @return the parsed tree or an invalid QVariant if the file can't be read.
+	static QVariant load(const QString& fileName, ParseFunction parseFunc=&StelJsonCache::parseJson);
+
+	//! Enable or disable the use of the cache. When disabled load() always parses.
+	static void setEnabled(bool b) {enabled=b;}
+	static bool isEnabled() {return enabled;}
+
+	//! Remove all the cached entries from the disk.
+	static void clear();
+
+	//! Default parse function using StelJsonParser.
+	static QVariant parseJson(const QByteArray& content);
+
+private:
+	//! Return the path of the cache directory.
+	static QString getCacheDir();
+	//! Return the path of the cache entry for the given absolute source path.
+	static QString getCacheFilePath(const QString& absoluteFilePath);
+
+	static bool enabled;
+};
+
+#endif // _STELJSONCACHE_HPP_
@@ -0,0 +1,200 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelLabelScheduler.hpp"
+
+#include <QFontMetrics>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+StelLabelScheduler::StelLabelScheduler() : enabled(true), maxLabelsPerFrame(250), nbDrawn(0), nbRejected(0),
+	viewport(0, 0, 0, 0), gridWidth(0), gridHeight(0)
+{
+}
+
+void StelLabelScheduler::beginFrame(const Vec4i& aviewport)
+{
+	Q_ASSERT(candidates.isEmpty());
+	nbDrawn = 0;
+	nbRejected = 0;
+	if (aviewport!=viewport)
+	{
+		// The labels of the previous frame are meaningless in the new viewport
+		viewport = aviewport;
+		gridWidth = qMax(1, (viewport[2]+CellSize-1)/CellSize);
+		gridHeight = qMax(1, (viewport[3]+CellSize-1)/CellSize);
+		grid.resize(gridWidth*gridHeight);
+		reservedRects.clear();
+	}
+	grid.fill(-FLT_MAX);
+
+	// Reserve the places of the labels drawn or rejected in the previous frame with their priority
+	foreach (const CellRect& r, reservedRects)
+	{
+		for (int y=r.y0;y<=r.y1;++y)
+		{
+			float* cell = grid.data()+y*gridWidth;
+			for (int x=r.x0;x<=r.x1;++x)
+				cell[x] = qMax(cell[x], r.priority);
+		}
+	}
+	reservedRects.resize(0);
+}
+
+void StelLabelScheduler::addLabel(float x, float y, const QString& text, const Vec4f& color, float priority, float xshift, float yshift, bool noGravity)
+{
+	Label l;
+	l.x = x;
+	l.y = y;
+	l.xshift = xshift;
+	l.yshift = yshift;
+	l.priority = priority;
+	l.text = text;
+	l.color = color;
+	l.noGravity = noGravity;
+	candidates.append(l);
+}
+
+bool StelLabelScheduler::computeCellRect(const QFontMetrics& fm, bool flagGravityLabels, float textAngle, const Label& label, CellRect& rect) const
+{
+	const float w = fm.width(label.text);
+	const float h = fm.height();
+	float x0, y0, x1, y1;
+	if (flagGravityLabels && !label.noGravity)
+	{
+		// The text is bent around the center of the viewport, use a conservative box
+		const float r = w + qMax(std::fabs(label.xshift), std::fabs(label.yshift));
+		x0 = label.x-r;
+		x1 = label.x+r;
+		y0 = label.y-r;
+		y1 = label.y+r;
+	}
+	else
+	{
+		const float angle = label.noGravity ? 0.f : textAngle;
+		if (std::fabs(angle)>1.f)
+		{
+			// Bounding box of the rotated text
+			const float cosr = std::cos(angle*M_PI/180.);
+			const float sinr = std::sin(angle*M_PI/180.);
+			x0 = y0 = FLT_MAX;
+			x1 = y1 = -FLT_MAX;
+			for (int i=0;i<4;++i)
+			{
+				const float cx = label.xshift + ((i&1) ? w : 0.f);
+				const float cy = label.yshift + ((i&2) ? h : 0.f);
+				const float px = label.x + cx*cosr - cy*sinr;
+				const float py = label.y + cx*sinr + cy*cosr;
+				x0 = qMin(x0, px);
+				x1 = qMax(x1, px);
+				y0 = qMin(y0, py);
+				y1 = qMax(y1, py);
+			}
+		}
+		else
+		{
+			x0 = label.x+label.xshift;
+			x1 = x0+w;
+			y0 = label.y+label.yshift;
+			y1 = y0+h;
+		}
+	}
+
+	// Convert to cells, clamped to the viewport
+	x0 -= viewport[0];
+	x1 -= viewport[0];
+	y0 -= viewport[1];
+	y1 -= viewport[1];
+	if (x1<0.f || y1<0.f || x0>=viewport[2] || y0>=viewport[3])
+		return false;
+	rect.x0 = qMax(0, (int)(x0/CellSize));
+	rect.y0 = qMax(0, (int)(y0/CellSize));
+	rect.x1 = qMin(gridWidth-1, (int)(x1/CellSize));
+	rect.y1 = qMin(gridHeight-1, (int)(y1/CellSize));
+	rect.priority = label.priority;
+	return true;
+}
+
+// Value of the cells covered by a drawn label: strictly above its priority, so that another label
+// of the same priority can't overlap it in the same frame.
+static inline float drawnCellValue(float priority)
+{
+	return priority + qMax(1.f, std::fabs(priority))*FLT_EPSILON;
+}
+
+bool StelLabelScheduler::isFree(const CellRect& rect) const
+{
+	for (int y=rect.y0;y<=rect.y1;++y)
+	{
+		const float* cell = grid.constData()+y*gridWidth;
+		for (int x=rect.x0;x<=rect.x1;++x)
+		{
+			if (cell[x]>rect.priority)
+				return false;
+		}
+	}
+	return true;
+}
+
+void StelLabelScheduler::fill(const CellRect& rect, float value)
+{
+	for (int y=rect.y0;y<=rect.y1;++y)
+	{
+		float* cell = grid.data()+y*gridWidth;
+		for (int x=rect.x0;x<=rect.x1;++x)
+			cell[x] = value;
+	}
+}
+
+QVector<StelLabelScheduler::Label> StelLabelScheduler::schedule(const QFontMetrics& fm, bool flagGravityLabels, float textAngle)
+{
+	QVector<Label> labels;
+	if (!enabled)
+	{
+		labels.swap(candidates);
+		nbDrawn += labels.size();
+		return labels;
+	}
+
+	std::stable_sort(candidates.begin(), candidates.end());
+	CellRect rect;
+	foreach (const Label& l, candidates)
+	{
+		if (nbDrawn>=maxLabelsPerFrame || !computeCellRect(fm, flagGravityLabels, textAngle, l, rect))
+		{
+			++nbRejected;
+			continue;
+		}
+		// A rejected label keeps its place for the next frame so that the lower priority labels
+		// drawn before it in this frame give way
+		reservedRects.append(rect);
+		if (!isFree(rect))
+		{
+			++nbRejected;
+			continue;
+		}
+		// Only a label of higher priority drawn later in the frame can overlap this one
+		fill(rect, drawnCellValue(l.priority));
+		++nbDrawn;
+		labels.append(l);
+	}
+	candidates.resize(0);
+	return labels;
+}
@@ -0,0 +1,135 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELLABELSCHEDULER_HPP_
+#define _STELLABELSCHEDULER_HPP_
+
+#include "VecMath.hpp"
+#include "StelPainter.hpp"
+
+#include <QString>
+#include <QVector>
+
+//! @class StelLabelScheduler
+//! Per frame scheduler removing the overlapping object labels.
+//! Modules submit their candidate labels with addLabel() and draw them with flush(). The
+//! labels are drawn by decreasing priority, and a label overlapping a label of higher or equal
+//! priority already drawn in the frame is rejected before any text texture is created. The screen
+//! occupancy is tracked in a grid of cells of CellSize pixels shared by all the modules during the
+//! frame. Since the modules are drawn one after the other, a label may overlap a label of lower
+//! priority drawn earlier by another module. The places of the labels drawn or rejected in a frame
+//! are therefore reserved with their priority at the beginning of the next one, so that from the
+//! next frame the important labels of a module drawn late (e.g. planets) win over the labels of
+//! a module drawn before (e.g. stars).
+//! The priority is usually the opposite of the object magnitude plus a bonus for the object type.
+class StelLabelScheduler
+{
+public:
+	//! Size of the cells of the occupancy grid in pixels.
+	static const int CellSize = 8;
+
+	StelLabelScheduler();
+
+	//! Start a new frame.
+	//! @param viewport the viewport in pixels: x, y, width, height.
+	void beginFrame(const Vec4i& viewport);
+
+	//! Submit a candidate label, drawn by the next call to flush() if there is room for it.
+	//! The parameters are the same as the ones of StelPainter::drawText().
+	//! @param priority the importance of the label, higher values are drawn first.
+	void addLabel(float x, float y, const QString& text, const Vec4f& color, float priority, float xshift=0.f, float yshift=0.f, bool noGravity=false);
+
+	//! Draw the labels submitted since the last flush using the font of the passed painter.
+	//! Inline so that the scheduling can be tested without linking the painter.
+	void flush(StelPainter& sPainter)
+	{
+		if (candidates.isEmpty())
+			return;
+		const StelProjectorP prj = sPainter.getProjector();
+		const QVector<Label> labels = schedule(sPainter.getFontMetrics(), prj->getFlagGravityLabels(), prj->getDefaultAngleForGravityText());
+		foreach (const Label& l, labels)
+		{
+			sPainter.setColor(l.color[0], l.color[1], l.color[2], l.color[3]);
+			sPainter.drawText(l.x, l.y, l.text, 0.f, l.xshift, l.yshift, l.noGravity);
+		}
+	}
+
+	//! A candidate label.
+	struct Label
+	{
+		float x, y, xshift, yshift;
+		float priority;
+		QString text;
+		Vec4f color;
+		bool noGravity;
+		bool operator<(const Label& other) const {return priority>other.priority;}
+	};
+
+	//! Select the labels submitted since the last flush which can be drawn and clear the
+	//! candidates. This is the part of flush() which does not need OpenGL.
+	//! @param fm the metrics of the font used to draw the labels.
+	//! @param flagGravityLabels whether the labels are bent around the center of the viewport.
+	//! @param textAngle the rotation of the labels in degree when flagGravityLabels is false.
+	//! @return the labels to draw, by decreasing priority.
+	QVector<Label> schedule(const QFontMetrics& fm, bool flagGravityLabels, float textAngle);
+
+	//! Set whether the overlapping labels are removed. When disabled all the labels are drawn.
+	void setEnabled(bool b) {enabled=b;}
+	bool isEnabled() const {return enabled;}
+
+	//! Set the maximum number of labels drawn in a frame.
+	void setMaxLabelsPerFrame(int n) {maxLabelsPerFrame=n;}
+	int getMaxLabelsPerFrame() const {return maxLabelsPerFrame;}
+
+	//! Return the number of labels drawn in the current frame.
+	int getNbDrawnLabels() const {return nbDrawn;}
+	//! Return the number of labels rejected in the current frame.
+	int getNbRejectedLabels() const {return nbRejected;}
+
+private:
+	//! A rectangle of cells of the grid.
+	struct CellRect
+	{
+		int x0, y0, x1, y1;
+		float priority;
+	};
+
+	//! Compute the cells covered by a label, return false if it is outside of the viewport.
+	bool computeCellRect(const QFontMetrics& fm, bool flagGravityLabels, float textAngle, const Label& label, CellRect& rect) const;
+	//! Return whether all the cells of the rectangle are free for the priority of the rectangle.
+	bool isFree(const CellRect& rect) const;
+	//! Set the cells of the rectangle to the given value.
+	void fill(const CellRect& rect, float value);
+
+	bool enabled;
+	int maxLabelsPerFrame;
+	int nbDrawn;
+	int nbRejected;
+
+	Vec4i viewport;
+	int gridWidth, gridHeight;
+	//! For each cell, the minimum priority of a label allowed to use it.
+	QVector<float> grid;
+
+	QVector<Label> candidates;
+	//! The labels drawn or rejected in the current frame, reserved at the beginning of the next one.
+	QVector<CellRect> reservedRects;
+};
+
+#endif // _STELLABELSCHEDULER_HPP_
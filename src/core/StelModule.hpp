@@ -73,6 +73,11 @@ public:
 	//! @param deltaTime the time increment in second since last call.
 	virtual void update(double deltaTime) = 0;
 
+	//! Return whether the module output keeps changing even if the time, the view and the faders don't,
+	//! for example because of an animation. The main view keeps redrawing at full rate while it is true.
+	//! Changes of time, view direction, field of view and fader transitions are detected by StelApp.
+	virtual bool needsRedraw() const {return false;}
+
 	//! Get the version of the module, default is stellarium main version
 	virtual QString getModuleVersion() const;
 
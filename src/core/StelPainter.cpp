@@ -36,8 +36,12 @@
 #include <QCache>
 #include <QOpenGLPaintDevice>
 #include <QOpenGLShader>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLContext>
+#include <QOpenGLBuffer>
 #include <QOpenGLTexture>
 #include <QtEndian>
+#include <cstring>
 
 // QOpenGLTexture has a bug on android, this is a temporary fix using a very simple
 // minimal implemetation of it.
@@ -118,6 +122,10 @@ QMutex* StelPainter::globalMutex = new QMutex();
 #endif
 
 QCache<QByteArray, StringTexture> StelPainter::texCache(TEX_CACHE_LIMIT);
+// Maximum number of vertices kept in the mesh cache
+static const int MESH_CACHE_LIMIT = 400000;
+QCache<QByteArray, StelVertexArray> StelPainter::meshCache(MESH_CACHE_LIMIT);
+StelVertexArray StelPainter::uncachedMesh;
 QOpenGLShaderProgram* StelPainter::texturesShaderProgram=NULL;
 QOpenGLShaderProgram* StelPainter::basicShaderProgram=NULL;
 QOpenGLShaderProgram* StelPainter::colorShaderProgram=NULL;
@@ -126,6 +134,15 @@ StelPainter::BasicShaderVars StelPainter::basicShaderVars;
 StelPainter::TexturesShaderVars StelPainter::texturesShaderVars;
 StelPainter::BasicShaderVars StelPainter::colorShaderVars;
 StelPainter::TexturesColorShaderVars StelPainter::texturesColorShaderVars;
+StelPainter::UniformCache StelPainter::basicShaderUniforms;
+StelPainter::UniformCache StelPainter::colorShaderUniforms;
+StelPainter::UniformCache StelPainter::texturesShaderUniforms;
+StelPainter::UniformCache StelPainter::texturesColorShaderUniforms;
+QOpenGLShaderProgram* StelPainter::currentProgram=NULL;
+QHash<QPair<const char*, const char*>, StelPainter::ProjectionShaders> StelPainter::projectionShaders;
+bool StelPainter::flagGpuProjection=true;
+QOpenGLBuffer* StelPainter::streamBuffer=NULL;
+int StelPainter::streamBufferOffset=0;
 
 StelPainter::GLState::GLState()
 {
@@ -180,6 +197,9 @@ StelPainter::StelPainter(const StelProjectorP& proj) : prj(proj)
 	}
 #endif
 
+	// Other code may have changed the bound program since the last painter
+	currentProgram = NULL;
+
 	glDisable(GL_DEPTH_TEST);
 	glDisable(GL_CULL_FACE);
 	// Fix some problem when using Qt OpenGL2 engine
@@ -209,6 +229,12 @@ StelPainter::~StelPainter()
 	}
 #endif
 
+	if (currentProgram)
+	{
+		currentProgram->release();
+		currentProgram = NULL;
+	}
+
 #ifndef NDEBUG
 	// We are done with this StelPainter
 	globalMutex->unlock();
@@ -464,13 +490,9 @@ void StelPainter::computeFanDisk(float radius, int innerFanSlices, int level, QV
 
 void StelPainter::sRing(float rMin, float rMax, int slices, int stacks, int orientInside)
 {
-	float x,y;
-	int j;
-
 	static Vec3f lightPos3;
 	static Vec4f ambientLight;
 	static Vec4f diffuseLight;
-	float c;
 	const bool isLightOn = light.isEnabled();
 	if (isLightOn)
 	{
@@ -486,7 +508,39 @@ void StelPainter::sRing(float rMin, float rMax, int slices, int stacks, int orie
 		diffuseLight = light.getDiffuse();
 	}
 
-	const float nsign = orientInside?-1.f:1.f;
+	const float params[] = {1.f, rMin, rMax, (float)slices, (float)stacks};
+	const StelVertexArray* mesh = getCachedMesh(QByteArray((const char*)params, sizeof(params)));
+	if (!mesh)
+		mesh = insertCachedMesh(QByteArray((const char*)params, sizeof(params)), tessellateRing(rMin, rMax, slices, stacks));
+
+	static QVector<Vec3f> colorArr;
+	if (isLightOn)
+	{
+		const float nsign = orientInside?-1.f:1.f;
+		colorArr.resize(mesh->vertex.size());
+		for (int i=0;i<mesh->vertex.size();++i)
+		{
+			const Vec3d& v = mesh->vertex.at(i);
+			float c = nsign * (lightPos3[0]*v[0] + lightPos3[1]*v[1]);
+			if (c<0) {c=0;}
+			colorArr[i].set(c*diffuseLight[0] + ambientLight[0], c*diffuseLight[1] + ambientLight[1], c*diffuseLight[2] + ambientLight[2]);
+		}
+		setArrays(mesh->vertex.constData(), mesh->texCoords.constData(), colorArr.constData());
+	}
+	else
+		setArrays(mesh->vertex.constData(), mesh->texCoords.constData());
+
+	// The stacks are stored one after the other, draw them as separate strips
+	const int stripSize = 2*(qAbs(slices)+1);
+	for (int offset=0; offset<mesh->vertex.size(); offset+=stripSize)
+		drawFromArray(TriangleStrip, stripSize, offset);
+}
+
+StelVertexArray StelPainter::tessellateRing(float rMin, float rMax, int slices, int stacks)
+{
+	StelVertexArray result(StelVertexArray::TriangleStrip);
+	float x,y;
+	int j;
 
 	const float dr = (rMax-rMin) / stacks;
 	const float dtheta = 2.f * M_PI / slices;
@@ -495,59 +549,77 @@ void StelPainter::sRing(float rMin, float rMax, int slices, int stacks, int orie
 	ComputeCosSinTheta(dtheta,slices);
 	float *cos_sin_theta_p;
 
-	static QVector<double> vertexArr;
-	static QVector<float> texCoordArr;
-	static QVector<float> colorArr;
-
-	// draw intermediate stacks as quad strips
+	// intermediate stacks as quad strips
 	for (float r = rMin; r < rMax; r+=dr)
 	{
 		const float tex_r0 = (r-rMin)/(rMax-rMin);
 		const float tex_r1 = (r+dr-rMin)/(rMax-rMin);
-		vertexArr.resize(0);
-		texCoordArr.resize(0);
-		colorArr.resize(0);
 		for (j=0,cos_sin_theta_p=cos_sin_theta; j<=slices; ++j,cos_sin_theta_p+=2)
 		{
 			x = r*cos_sin_theta_p[0];
 			y = r*cos_sin_theta_p[1];
-			if (isLightOn)
-			{
-				c = nsign * (lightPos3[0]*x + lightPos3[1]*y);
-				if (c<0) {c=0;}
-				colorArr << c*diffuseLight[0] + ambientLight[0] << c*diffuseLight[1] + ambientLight[1] << c*diffuseLight[2] + ambientLight[2];
-			}
-			texCoordArr << tex_r0 << 0.5f;
-			vertexArr << x << y << 0.f;
+			result.texCoords << Vec2f(tex_r0, 0.5f);
+			result.vertex << Vec3d(x, y, 0.);
 			x = (r+dr)*cos_sin_theta_p[0];
 			y = (r+dr)*cos_sin_theta_p[1];
-			if (isLightOn)
-			{
-				c = nsign * (lightPos3[0]*x + lightPos3[1]*y);
-				if (c<0) {c=0;}
-				colorArr << c*diffuseLight[0] + ambientLight[0] << c*diffuseLight[1] + ambientLight[1] << c*diffuseLight[2] + ambientLight[2];
-			}
-			texCoordArr << tex_r1 << 0.5f;
-			vertexArr << x << y << 0.f;
+			result.texCoords << Vec2f(tex_r1, 0.5f);
+			result.vertex << Vec3d(x, y, 0.);
 		}
+	}
+	return result;
+}
 
-		if (isLightOn)
-			setArrays((Vec3d*)vertexArr.constData(), (Vec2f*)texCoordArr.constData(), (Vec3f*)colorArr.constData());
-		else
-			setArrays((Vec3d*)vertexArr.constData(), (Vec2f*)texCoordArr.constData());
-		drawFromArray(TriangleStrip, vertexArr.size()/3);
+const StelVertexArray* StelPainter::getCachedMesh(const QByteArray& key)
+{
+	return meshCache.object(key);
+}
+
+const StelVertexArray* StelPainter::insertCachedMesh(const QByteArray& key, const StelVertexArray& mesh)
+{
+	const int cost = mesh.vertex.size();
+	if (cost>meshCache.maxCost())
+	{
+		// Too big to be cached, keep it only until the next call
+		uncachedMesh = mesh;
+		return &uncachedMesh;
 	}
+	StelVertexArray* cached = new StelVertexArray(mesh);
+	meshCache.insert(key, cached, cost);
+	return cached;
 }
 
-static void sSphereMapTexCoordFast(float rho_div_fov, float costheta, float sintheta, QVector<float>& out)
+static Vec2f sSphereMapTexCoordFast(float rho_div_fov, float costheta, float sintheta)
 {
 	if (rho_div_fov>0.5f)
 		rho_div_fov=0.5f;
-	out << 0.5f + rho_div_fov * costheta << 0.5f + rho_div_fov * sintheta;
+	return Vec2f(0.5f + rho_div_fov * costheta, 0.5f + rho_div_fov * sintheta);
 }
 
 void StelPainter::sSphereMap(float radius, int slices, int stacks, float textureFov, int orientInside)
 {
+	const StelVertexArray* mesh = getSphereMapMesh(radius, slices, stacks, textureFov, orientInside);
+	setArrays(mesh->vertex.constData(), mesh->texCoords.constData());
+	drawFromArray(Triangles, mesh->indices.size(), 0, true, mesh->indices.constData());
+}
+
+StelVertexArray StelPainter::computeSphereMapNoLight(float radius, int slices, int stacks, float textureFov, int orientInside)
+{
+	return *getSphereMapMesh(radius, slices, stacks, textureFov, orientInside);
+}
+
+const StelVertexArray* StelPainter::getSphereMapMesh(float radius, int slices, int stacks, float textureFov, int orientInside)
+{
+	const float params[] = {3.f, radius, (float)slices, (float)stacks, textureFov, (float)(orientInside ? 1 : 0)};
+	const QByteArray key((const char*)params, sizeof(params));
+	const StelVertexArray* mesh = getCachedMesh(key);
+	if (!mesh)
+		mesh = insertCachedMesh(key, tessellateSphereMap(radius, slices, stacks, textureFov, orientInside));
+	return mesh;
+}
+
+StelVertexArray StelPainter::tessellateSphereMap(float radius, int slices, int stacks, float textureFov, int orientInside)
+{
+	StelVertexArray result(StelVertexArray::Triangles);
 	float rho,x,y,z;
 	int i, j;
 	float drho = M_PI / stacks;
@@ -567,60 +639,48 @@ void StelPainter::sSphereMap(float radius, int slices, int stacks, float texture
 	// t goes from -1.0/+1.0 at z = -radius/+radius (linear along longitudes)
 	// cannot use triangle fan on texturing (s coord. at top/bottom tip varies)
 
-	const int imax = stacks;
-
-	static QVector<double> vertexArr;
-	static QVector<float> texCoordArr;
-
-	// draw intermediate stacks as quad strips
-	if (!orientInside) // nsign==1
+	// Each stack is a strip of 2*(slices+1) vertices, stored as indexed triangles
+	for (i = 0,cos_sin_rho_p=cos_sin_rho,rho=0.f; i < stacks; ++i,cos_sin_rho_p+=2,rho+=drho)
 	{
-		for (i = 0,cos_sin_rho_p=cos_sin_rho,rho=0.f; i < imax; ++i,cos_sin_rho_p+=2,rho+=drho)
+		for (j=0,cos_sin_theta_p=cos_sin_theta;j<=slices;++j,cos_sin_theta_p+=2)
 		{
-			vertexArr.resize(0);
-			texCoordArr.resize(0);
-			for (j=0,cos_sin_theta_p=cos_sin_theta;j<=slices;++j,cos_sin_theta_p+=2)
+			if (!orientInside)
 			{
 				x = -cos_sin_theta_p[1] * cos_sin_rho_p[1];
 				y = cos_sin_theta_p[0] * cos_sin_rho_p[1];
 				z = cos_sin_rho_p[0];
-				sSphereMapTexCoordFast(rho, cos_sin_theta_p[0], cos_sin_theta_p[1], texCoordArr);
-				vertexArr << x*radius << y*radius << z*radius;
+				result.texCoords << sSphereMapTexCoordFast(rho, cos_sin_theta_p[0], cos_sin_theta_p[1]);
+				result.vertex << Vec3d(x*radius, y*radius, z*radius);
 
 				x = -cos_sin_theta_p[1] * cos_sin_rho_p[3];
 				y = cos_sin_theta_p[0] * cos_sin_rho_p[3];
 				z = cos_sin_rho_p[2];
-				sSphereMapTexCoordFast(rho + drho, cos_sin_theta_p[0], cos_sin_theta_p[1], texCoordArr);
-				vertexArr << x*radius << y*radius << z*radius;
+				result.texCoords << sSphereMapTexCoordFast(rho + drho, cos_sin_theta_p[0], cos_sin_theta_p[1]);
+				result.vertex << Vec3d(x*radius, y*radius, z*radius);
 			}
-			setArrays((Vec3d*)vertexArr.constData(), (Vec2f*)texCoordArr.constData());
-			drawFromArray(TriangleStrip, vertexArr.size()/3);
-		}
-	}
-	else
-	{
-		for (i = 0,cos_sin_rho_p=cos_sin_rho,rho=0.f; i < imax; ++i,cos_sin_rho_p+=2,rho+=drho)
-		{
-			vertexArr.resize(0);
-			texCoordArr.resize(0);
-			for (j=0,cos_sin_theta_p=cos_sin_theta;j<=slices;++j,cos_sin_theta_p+=2)
+			else
 			{
 				x = -cos_sin_theta_p[1] * cos_sin_rho_p[3];
 				y = cos_sin_theta_p[0] * cos_sin_rho_p[3];
 				z = cos_sin_rho_p[2];
-				sSphereMapTexCoordFast(rho + drho, cos_sin_theta_p[0], -cos_sin_theta_p[1], texCoordArr);
-				vertexArr << x*radius << y*radius << z*radius;
+				result.texCoords << sSphereMapTexCoordFast(rho + drho, cos_sin_theta_p[0], -cos_sin_theta_p[1]);
+				result.vertex << Vec3d(x*radius, y*radius, z*radius);
 
 				x = -cos_sin_theta_p[1] * cos_sin_rho_p[1];
 				y = cos_sin_theta_p[0] * cos_sin_rho_p[1];
 				z = cos_sin_rho_p[0];
-				sSphereMapTexCoordFast(rho, cos_sin_theta_p[0], -cos_sin_theta_p[1], texCoordArr);
-				vertexArr << x*radius << y*radius << z*radius;
+				result.texCoords << sSphereMapTexCoordFast(rho, cos_sin_theta_p[0], -cos_sin_theta_p[1]);
+				result.vertex << Vec3d(x*radius, y*radius, z*radius);
 			}
-			setArrays((Vec3d*)vertexArr.constData(), (Vec2f*)texCoordArr.constData());
-			drawFromArray(TriangleStrip, vertexArr.size()/3);
+		}
+		unsigned int offset = i*(slices+1)*2;
+		for (j = 2;j<slices*2+2;j+=2)
+		{
+			result.indices << offset+j-2 << offset+j-1 << offset+j;
+			result.indices << offset+j << offset+j-1 << offset+j+1;
 		}
 	}
+	return result;
 }
 
 void StelPainter::drawTextGravity180(float x, float y, const QString& ws, float xshift, float yshift)
@@ -761,7 +821,7 @@ void StelPainter::drawText(float x, float y, const QString& str, float angleDeg,
 		}
 	}
 
-	float* texCoords = new float[8];
+	float texCoords[8];
 	for (int i=0;i<4;i++)
 	{
 		texCoords[i*2+0] = tex->getTexSize().width() * (i % 2);
@@ -775,7 +835,6 @@ void StelPainter::drawText(float x, float y, const QString& str, float angleDeg,
 	drawFromArray(TriangleStrip, 4, 0, false);
 	enableClientStates(false, false);
 	tex->texture->release();
-	delete[] texCoords;
 }
 
 // Recursive method cutting a small circle in small segments
@@ -831,6 +890,9 @@ void StelPainter::drawSmallCircleVertexArray()
 }
 
 static Vec3d pt1, pt2;
+// Projections of the vertices of the vertex array drawn by drawGreatCircleArcs()
+static QVector<Vec3f> arcsProjectedVertices;
+static QVector<bool> arcsValidVertices;
 void StelPainter::drawGreatCircleArc(const Vec3d& start, const Vec3d& stop, const SphericalCap* clippingCap,
 	void (*viewportEdgeIntersectCallback)(const Vec3d& screenPos, const Vec3d& direction, void* userData), void* userData)
  {
@@ -852,12 +914,18 @@ void StelPainter::drawGreatCircleArc(const Vec3d& start, const Vec3d& stop, cons
 *************************************************************************/
 void StelPainter::drawSmallCircleArc(const Vec3d& start, const Vec3d& stop, const Vec3d& rotCenter, void (*viewportEdgeIntersectCallback)(const Vec3d& screenPos, const Vec3d& direction, void* userData), void* userData)
 {
-	Q_ASSERT(smallCircleVertexArray.empty());
-
-	QLinkedList<Vec3d> tessArc;	// Contains the list of projected points from the tesselated arc
 	Vec3d win1, win2;
 	win1[2] = prj->project(start, win1) ? 1.0 : -1.;
 	win2[2] = prj->project(stop, win2) ? 1.0 : -1.;
+	drawSmallCircleArc(start, stop, win1, win2, rotCenter, viewportEdgeIntersectCallback, userData);
+}
+
+void StelPainter::drawSmallCircleArc(const Vec3d& start, const Vec3d& stop, Vec3d win1, Vec3d win2, const Vec3d& rotCenter,
+	void (*viewportEdgeIntersectCallback)(const Vec3d& screenPos, const Vec3d& direction, void* userData), void* userData)
+{
+	Q_ASSERT(smallCircleVertexArray.empty());
+
+	QLinkedList<Vec3d> tessArc;	// Contains the list of projected points from the tesselated arc
 	tessArc.append(win1);
 
 
@@ -931,46 +999,64 @@ void StelPainter::projectSphericalTriangle(const SphericalCap* clippingCap, cons
 	const bool cd2=cDiscontinuity2;
 	const bool cd3=cDiscontinuity3;
 
-	Vec3d e0=vertices[0];
-	Vec3d e1=vertices[1];
-	Vec3d e2=vertices[2];
-	bool valid = prj->projectInPlace(e0);
-	valid = prj->projectInPlace(e1) || valid;
-	valid = prj->projectInPlace(e2) || valid;
+	// Project the vertices and the middles of the segments to check in a single batch
+	Vec3d in[6];
+	Vec3f win[6];
+	bool winValid[6];
+	in[0]=vertices[0];
+	in[1]=vertices[1];
+	in[2]=vertices[2];
+	int nbIn = 3;
+	int mid1=-1, mid2=-1, mid3=-1;
+	if (checkDisc1 && cDiscontinuity1==false)
+	{
+		in[nbIn]=vertices[0]; in[nbIn]+=vertices[1];
+		mid1=nbIn++;
+	}
+	if (checkDisc2 && cDiscontinuity2==false)
+	{
+		in[nbIn]=vertices[1]; in[nbIn]+=vertices[2];
+		mid2=nbIn++;
+	}
+	if (checkDisc3 && cDiscontinuity3==false)
+	{
+		in[nbIn]=vertices[2]; in[nbIn]+=vertices[0];
+		mid3=nbIn++;
+	}
+	prj->project(nbIn, in, win, winValid);
 	// Clip polygons behind the viewer
-	if (!valid)
+	if (!winValid[0] && !winValid[1] && !winValid[2])
 		return;
+	const Vec3f& e0=win[0];
+	const Vec3f& e1=win[1];
+	const Vec3f& e2=win[2];
 
-	if (checkDisc1 && cDiscontinuity1==false)
+	if (mid1>=0)
 	{
 		// If the distortion at segment e0,e1 is too big, flags it for subdivision
-		Vec3d win3 = vertices[0]; win3+=vertices[1];
-		prj->projectInPlace(win3);
-		win3[0]-=(e0[0]+e1[0])*0.5; win3[1]-=(e0[1]+e1[1])*0.5;
-		cDiscontinuity1 = (win3[0]*win3[0]+win3[1]*win3[1])>maxSqDistortion;
+		const float dx = win[mid1][0]-(e0[0]+e1[0])*0.5f;
+		const float dy = win[mid1][1]-(e0[1]+e1[1])*0.5f;
+		cDiscontinuity1 = (dx*dx+dy*dy)>maxSqDistortion;
 	}
-	if (checkDisc2 && cDiscontinuity2==false)
+	if (mid2>=0)
 	{
 		// If the distortion at segment e1,e2 is too big, flags it for subdivision
-		Vec3d win3 = vertices[1]; win3+=vertices[2];
-		prj->projectInPlace(win3);
-		win3[0]-=(e2[0]+e1[0])*0.5; win3[1]-=(e2[1]+e1[1])*0.5;
-		cDiscontinuity2 = (win3[0]*win3[0]+win3[1]*win3[1])>maxSqDistortion;
+		const float dx = win[mid2][0]-(e2[0]+e1[0])*0.5f;
+		const float dy = win[mid2][1]-(e2[1]+e1[1])*0.5f;
+		cDiscontinuity2 = (dx*dx+dy*dy)>maxSqDistortion;
 	}
-	if (checkDisc3 && cDiscontinuity3==false)
+	if (mid3>=0)
 	{
 		// If the distortion at segment e2,e0 is too big, flags it for subdivision
-		Vec3d win3 = vertices[2]; win3+=vertices[0];
-		prj->projectInPlace(win3);
-		win3[0] -= (e0[0]+e2[0])*0.5;
-		win3[1] -= (e0[1]+e2[1])*0.5;
-		cDiscontinuity3 = (win3[0]*win3[0]+win3[1]*win3[1])>maxSqDistortion;
+		const float dx = win[mid3][0]-(e0[0]+e2[0])*0.5f;
+		const float dy = win[mid3][1]-(e0[1]+e2[1])*0.5f;
+		cDiscontinuity3 = (dx*dx+dy*dy)>maxSqDistortion;
 	}
 
 	if (!cDiscontinuity1 && !cDiscontinuity2 && !cDiscontinuity3)
 	{
 		// The triangle is clean, appends it
-		outVertices->append(Vec3f(e0[0], e0[1], e0[2])); outVertices->append(Vec3f(e1[0], e1[1], e1[2])); outVertices->append(Vec3f(e2[0], e2[1], e2[2]));
+		outVertices->append(e0); outVertices->append(e1); outVertices->append(e2);
 		if (outTexturePos)
 			outTexturePos->append(texturePos,3);
 		return;
@@ -1278,25 +1364,55 @@ static QVarLengthArray<Vec3f, 4096> polygonVertexArray;
 static QVarLengthArray<Vec2f, 4096> polygonTextureCoordArray;
 static QVarLengthArray<unsigned int, 4096> indexArray;
 
+void StelPainter::drawProjectedGreatCircleArc(const StelVertexArray& va, int i, int j, const SphericalCap* clippingCap)
+{
+	const Vec3d& start = va.vertex.at(i);
+	const Vec3d& stop = va.vertex.at(j);
+	if (clippingCap)
+	{
+		pt1=start;
+		pt2=stop;
+		if (!clippingCap->clipGreatCircle(pt1, pt2))
+			return;
+		if (pt1!=start || pt2!=stop)
+		{
+			// The arc was clipped, its ends need to be projected again
+			drawSmallCircleArc(pt1, pt2, Vec3d(0), NULL, NULL);
+			return;
+		}
+	}
+	const Vec3f& w1 = arcsProjectedVertices.at(i);
+	const Vec3f& w2 = arcsProjectedVertices.at(j);
+	drawSmallCircleArc(start, stop, Vec3d(w1[0], w1[1], arcsValidVertices.at(i) ? 1. : -1.),
+		Vec3d(w2[0], w2[1], arcsValidVertices.at(j) ? 1. : -1.), Vec3d(0), NULL, NULL);
+}
+
 void StelPainter::drawGreatCircleArcs(const StelVertexArray& va, const SphericalCap* clippingCap)
 {
 	Q_ASSERT(va.vertex.size()!=1);
 	Q_ASSERT(!va.isIndexed());	// Indexed unsupported yet
+	// Project all the vertices at once, each of them is shared by 2 arcs for strips and loops
+	const int n = va.vertex.size();
+	if (n==0)
+		return;
+	arcsProjectedVertices.resize(n);
+	arcsValidVertices.resize(n);
+	prj->project(n, va.vertex.constData(), arcsProjectedVertices.data(), arcsValidVertices.data());
 	switch (va.primitiveType)
 	{
 		case StelVertexArray::Lines:
 			Q_ASSERT(va.vertex.size()%2==0);
-			for (int i=0;i<va.vertex.size();i+=2)
-				drawGreatCircleArc(va.vertex.at(i), va.vertex.at(i+1), clippingCap);
+			for (int i=0;i<n;i+=2)
+				drawProjectedGreatCircleArc(va, i, i+1, clippingCap);
 			return;
 		case StelVertexArray::LineStrip:
-			for (int i=0;i<va.vertex.size()-1;++i)
-				drawGreatCircleArc(va.vertex.at(i), va.vertex.at(i+1), clippingCap);
+			for (int i=0;i<n-1;++i)
+				drawProjectedGreatCircleArc(va, i, i+1, clippingCap);
 			return;
 		case StelVertexArray::LineLoop:
-			for (int i=0;i<va.vertex.size()-1;++i)
-				drawGreatCircleArc(va.vertex.at(i), va.vertex.at(i+1), clippingCap);
-			drawGreatCircleArc(va.vertex.last(), va.vertex.first(), clippingCap);
+			for (int i=0;i<n-1;++i)
+				drawProjectedGreatCircleArc(va, i, i+1, clippingCap);
+			drawProjectedGreatCircleArc(va, n-1, 0, clippingCap);
 			return;
 		default:
 			Q_ASSERT(0); // Unsupported primitive yype
@@ -1381,6 +1497,33 @@ void StelPainter::drawStelVertexArray(const StelVertexArray& arr, bool checkDisc
 	enableClientStates(false);
 }
 
+void StelPainter::drawStelVertexArray(const StelVertexArray& arr, const QVector<Vec3f>& vertexf, bool checkDiscontinuity)
+{
+	Q_ASSERT(vertexf.size()==arr.vertex.size());
+	if ((checkDiscontinuity && prj->hasDiscontinuity()) || !getProjectionShader(arr.isTextured() ? TexturesShader : BasicShader))
+	{
+		drawStelVertexArray(arr, checkDiscontinuity);
+		return;
+	}
+
+	setVertexPointer(3, GL_FLOAT, vertexf.constData());
+	if (arr.isTextured())
+	{
+		setTexCoordPointer(2, GL_FLOAT, arr.texCoords.constData());
+		enableClientStates(true, true);
+	}
+	else
+	{
+		enableClientStates(true, false);
+	}
+	if (arr.isIndexed())
+		drawFromArray((StelPainter::DrawingMode)arr.primitiveType, arr.indices.size(), 0, true, arr.indices.constData());
+	else
+		drawFromArray((StelPainter::DrawingMode)arr.primitiveType, arr.vertex.size());
+
+	enableClientStates(false);
+}
+
 void StelPainter::drawSphericalTriangles(const StelVertexArray& va, bool textured, const SphericalCap* clippingCap, bool doSubDivide, double maxSqDistortion)
 {
 	if (va.vertex.isEmpty())
@@ -1596,7 +1739,6 @@ void StelPainter::sSphere(float radius, float oneMinusOblateness, int slices, in
 	static Vec3f lightPos3;
 	static Vec4f ambientLight;
 	static Vec4f diffuseLight;
-	float c;
 	const bool isLightOn = light.isEnabled();
 	if (isLightOn)
 	{
@@ -1612,97 +1754,48 @@ void StelPainter::sSphere(float radius, float oneMinusOblateness, int slices, in
 		diffuseLight = light.getDiffuse();
 	}
 
-	GLfloat x, y, z;
-	GLfloat s=0.f, t=0.f;
-	GLint i, j;
-	GLfloat nsign;
+	const StelVertexArray* mesh = getSphereMesh(radius, oneMinusOblateness, slices, stacks, orientInside, flipTexture);
 
-	if (orientInside)
-	{
-		nsign = -1.f;
-		t=0.f; // from inside texture is reversed
-	}
-	else
+	static QVector<Vec3f> colorArr;
+	if (isLightOn && radius>0.f && oneMinusOblateness>0.f)
 	{
-		nsign = 1.f;
-		t=1.f;
-	}
-
-	const float drho = M_PI / stacks;
-	Q_ASSERT(stacks<=MAX_STACKS);
-	ComputeCosSinRho(drho,stacks);
-	float* cos_sin_rho_p;
-
-	const float dtheta = 2.f * M_PI / slices;
-	Q_ASSERT(slices<=MAX_SLICES);
-	ComputeCosSinTheta(dtheta,slices);
-	const float *cos_sin_theta_p;
-
-	// texturing: s goes from 0.0/0.25/0.5/0.75/1.0 at +y/+x/-y/-x/+y axis
-	// t goes from -1.0/+1.0 at z = -radius/+radius (linear along longitudes)
-	// cannot use triangle fan on texturing (s coord. at top/bottom tip varies)
-	// If the texture is flipped, we iterate the coordinates backward.
-	const GLfloat ds = (flipTexture ? -1.f : 1.f) / slices;
-	const GLfloat dt = nsign / stacks; // from inside texture is reversed
-
-	// draw intermediate  as quad strips
-	static QVector<double> vertexArr;
-	static QVector<float> texCoordArr;
-	static QVector<float> colorArr;
-	static QVector<unsigned short> indiceArr;
-
-	texCoordArr.resize(0);
-	vertexArr.resize(0);
-	colorArr.resize(0);
-	indiceArr.resize(0);
-
-	for (i = 0,cos_sin_rho_p = cos_sin_rho; i < stacks; ++i,cos_sin_rho_p+=2)
-	{
-		s = !flipTexture ? 0.f : 1.f;
-		for (j = 0,cos_sin_theta_p = cos_sin_theta; j<=slices;++j,cos_sin_theta_p+=2)
-		{
-			x = -cos_sin_theta_p[1] * cos_sin_rho_p[1];
-			y = cos_sin_theta_p[0] * cos_sin_rho_p[1];
-			z = nsign * cos_sin_rho_p[0];
-			texCoordArr << s << t;
-			if (isLightOn)
-			{
-				c = nsign * (lightPos3[0]*x*oneMinusOblateness + lightPos3[1]*y*oneMinusOblateness + lightPos3[2]*z);
-				if (c<0) {c=0;}
-				colorArr << c*diffuseLight[0] + ambientLight[0] << c*diffuseLight[1] + ambientLight[1] << c*diffuseLight[2] + ambientLight[2];
-			}
-			vertexArr << x * radius << y * radius << z * oneMinusOblateness * radius;
-			x = -cos_sin_theta_p[1] * cos_sin_rho_p[3];
-			y = cos_sin_theta_p[0] * cos_sin_rho_p[3];
-			z = nsign * cos_sin_rho_p[2];
-			texCoordArr << s << t - dt;
-			if (isLightOn)
-			{
-				c = nsign * (lightPos3[0]*x*oneMinusOblateness + lightPos3[1]*y*oneMinusOblateness + lightPos3[2]*z);
-				if (c<0) {c=0;}
-				colorArr << c*diffuseLight[0] + ambientLight[0] << c*diffuseLight[1] + ambientLight[1] << c*diffuseLight[2] + ambientLight[2];
-			}
-			vertexArr << x * radius << y * radius << z * oneMinusOblateness * radius;
-			s += ds;
-		}
-		unsigned int offset = i*(slices+1)*2;
-		for (j = 2;j<slices*2+2;j+=2)
+		// The lighting uses the normal of the unit sphere (x*k, y*k, z) where the vertex is
+		// (x*r, y*r, z*k*r), so scale the light direction instead of computing the normals.
+		const float nsign = orientInside ? -1.f : 1.f;
+		const double lx = nsign*lightPos3[0]*oneMinusOblateness/radius;
+		const double ly = nsign*lightPos3[1]*oneMinusOblateness/radius;
+		const double lz = nsign*lightPos3[2]/(oneMinusOblateness*radius);
+		colorArr.resize(mesh->vertex.size());
+		for (int i=0;i<mesh->vertex.size();++i)
 		{
-			indiceArr << offset+j-2 << offset+j-1 << offset+j;
-			indiceArr << offset+j << offset+j-1 << offset+j+1;
+			const Vec3d& v = mesh->vertex.at(i);
+			float c = lx*v[0] + ly*v[1] + lz*v[2];
+			if (c<0) {c=0;}
+			colorArr[i].set(c*diffuseLight[0] + ambientLight[0], c*diffuseLight[1] + ambientLight[1], c*diffuseLight[2] + ambientLight[2]);
 		}
-		t -= dt;
+		setArrays(mesh->vertex.constData(), mesh->texCoords.constData(), colorArr.constData());
 	}
-
-	// Draw the array now
-	if (isLightOn)
-		setArrays((Vec3d*)vertexArr.constData(), (Vec2f*)texCoordArr.constData(), (Vec3f*)colorArr.constData());
 	else
-		setArrays((Vec3d*)vertexArr.constData(), (Vec2f*)texCoordArr.constData());
-	drawFromArray(Triangles, indiceArr.size(), 0, true, indiceArr.constData());
+		setArrays(mesh->vertex.constData(), mesh->texCoords.constData());
+	drawFromArray(Triangles, mesh->indices.size(), 0, true, mesh->indices.constData());
+}
+
+const StelVertexArray* StelPainter::getSphereMesh(float radius, float oneMinusOblateness, int slices, int stacks, int orientInside, bool flipTexture)
+{
+	const float params[] = {0.f, radius, oneMinusOblateness, (float)slices, (float)stacks, (float)((orientInside ? 1 : 0) + (flipTexture ? 2 : 0))};
+	const QByteArray key((const char*)params, sizeof(params));
+	const StelVertexArray* mesh = getCachedMesh(key);
+	if (!mesh)
+		mesh = insertCachedMesh(key, tessellateSphere(radius, oneMinusOblateness, slices, stacks, orientInside, flipTexture));
+	return mesh;
 }
 
 StelVertexArray StelPainter::computeSphereNoLight(float radius, float oneMinusOblateness, int slices, int stacks, int orientInside, bool flipTexture)
+{
+	return *getSphereMesh(radius, oneMinusOblateness, slices, stacks, orientInside, flipTexture);
+}
+
+StelVertexArray StelPainter::tessellateSphere(float radius, float oneMinusOblateness, int slices, int stacks, int orientInside, bool flipTexture)
 {
 	StelVertexArray result(StelVertexArray::Triangles);
 	GLfloat x, y, z;
@@ -1764,8 +1857,6 @@ StelVertexArray StelPainter::computeSphereNoLight(float radius, float oneMinusOb
 		t -= dt;
 	}
 	return result;
-	//setArrays((Vec3d*)vertexArr.constData(), (Vec2f*)texCoordArr.constData());
-	//drawFromArray(Triangles, indiceArr.size(), 0, true, indiceArr.constData());
 }
 
 // Reimplementation of gluCylinder : glu is overrided for non standard projection
@@ -1774,36 +1865,84 @@ void StelPainter::sCylinder(float radius, float height, int slices, int orientIn
 	if (orientInside)
 		glCullFace(GL_FRONT);
 
-	static QVarLengthArray<Vec2f, 512> texCoordArray;
-	static QVarLengthArray<Vec3d, 512> vertexArray;
-	texCoordArray.clear();
-	vertexArray.clear();
-	float s = 0.f;
-	float x, y;
-	const float ds = 1.f / slices;
-	const float da = 2.f * M_PI / slices;
-	for (int i = 0; i <= slices; ++i)
-	{
-		x = std::sin(da*i);
-		y = std::cos(da*i);
-		texCoordArray.append(Vec2f(s, 0.f));
-		vertexArray.append(Vec3d(x*radius, y*radius, 0.));
-		texCoordArray.append(Vec2f(s, 1.f));
-		vertexArray.append(Vec3d(x*radius, y*radius, height));
-		s += ds;
-	}
-	setArrays(vertexArray.constData(), texCoordArray.constData());
-	drawFromArray(TriangleStrip, vertexArray.size());
+	const StelVertexArray* mesh = getCylinderMesh(radius, height, slices);
+	setArrays(mesh->vertex.constData(), mesh->texCoords.constData());
+	drawFromArray(TriangleStrip, mesh->vertex.size());
 
 	if (orientInside)
 		glCullFace(GL_BACK);
 }
 
+StelVertexArray StelPainter::computeCylinderNoLight(float radius, float height, int slices)
+{
+	return *getCylinderMesh(radius, height, slices);
+}
+
+const StelVertexArray* StelPainter::getCylinderMesh(float radius, float height, int slices)
+{
+	const float params[] = {2.f, radius, height, (float)slices};
+	const QByteArray key((const char*)params, sizeof(params));
+	const StelVertexArray* mesh = getCachedMesh(key);
+	if (!mesh)
+	{
+		StelVertexArray cylinder(StelVertexArray::TriangleStrip);
+		float s = 0.f;
+		float x, y;
+		const float ds = 1.f / slices;
+		const float da = 2.f * M_PI / slices;
+		for (int i = 0; i <= slices; ++i)
+		{
+			x = std::sin(da*i);
+			y = std::cos(da*i);
+			cylinder.texCoords << Vec2f(s, 0.f);
+			cylinder.vertex << Vec3d(x*radius, y*radius, 0.);
+			cylinder.texCoords << Vec2f(s, 1.f);
+			cylinder.vertex << Vec3d(x*radius, y*radius, height);
+			s += ds;
+		}
+		mesh = insertCachedMesh(key, cylinder);
+	}
+	return mesh;
+}
+
 void StelPainter::enableTexture2d(bool b)
 {
 	texture2dEnabled = b;
 }
 
+// Fragment shaders, shared by the programs projecting the vertices on the CPU and in the vertex shader
+static const char basicFragmentShaderSource[] =
+	"uniform mediump vec4 color;\n"
+	"void main(void)\n"
+	"{\n"
+	"    gl_FragColor = color;\n"
+	"}\n";
+
+static const char colorFragmentShaderSource[] =
+	"varying mediump vec4 fragcolor;\n"
+	"void main(void)\n"
+	"{\n"
+	"    gl_FragColor = fragcolor;\n"
+	"}\n";
+
+static const char texturesFragmentShaderSource[] =
+	"varying mediump vec2 texc;\n"
+	"uniform sampler2D tex;\n"
+	"uniform mediump vec4 texColor;\n"
+	"void main(void)\n"
+	"{\n"
+	"    gl_FragColor = texture2D(tex, texc)*texColor;\n"
+	"}\n";
+
+static const char texturesColorFragmentShaderSource[] =
+	"varying mediump vec2 texc;\n"
+	"varying mediump vec4 outColor;\n"
+	"uniform sampler2D tex;\n"
+	"void main(void)\n"
+	"{\n"
+	"    gl_FragColor = texture2D(tex, texc)*outColor;\n"
+	"}\n";
+
 void StelPainter::initGLShaders()
 {
 	qWarning() << "StelPainter: initGLShaders()... ";
@@ -1819,13 +1958,7 @@ void StelPainter::initGLShaders()
 	vshader3.compileSourceCode(vsrc3);
 	if (!vshader3.log().isEmpty()) { qWarning() << "StelPainter: Warnings while compiling vshader3: " << vshader3.log(); }
 	QOpenGLShader fshader3(QOpenGLShader::Fragment);
-	const char *fsrc3 =
-		"uniform mediump vec4 color;\n"
-		"void main(void)\n"
-		"{\n"
-		"    gl_FragColor = color;\n"
-		"}\n";
-	fshader3.compileSourceCode(fsrc3);
+	fshader3.compileSourceCode(basicFragmentShaderSource);
 	if (!fshader3.log().isEmpty()) { qWarning() << "StelPainter: Warnings while compiling fshader3: " << fshader3.log(); }
 	basicShaderProgram = new QOpenGLShaderProgram(QOpenGLContext::currentContext());
 	basicShaderProgram->addShader(&vshader3);
@@ -1853,13 +1986,7 @@ void StelPainter::initGLShaders()
 	  qWarning() << "StelPainter: Warnings while compiling vshaderInterpolatedColor: " << vshaderInterpolatedColor.log();
 	}
 	QOpenGLShader fshaderInterpolatedColor(QOpenGLShader::Fragment);
-	const char *fshaderInterpolatedColorSrc =
-		"varying mediump vec4 fragcolor;\n"
-		"void main(void)\n"
-		"{\n"
-		"    gl_FragColor = fragcolor;\n"
-		"}\n";
-	fshaderInterpolatedColor.compileSourceCode(fshaderInterpolatedColorSrc);
+	fshaderInterpolatedColor.compileSourceCode(colorFragmentShaderSource);
 	if (!fshaderInterpolatedColor.log().isEmpty()) {
 	  qWarning() << "StelPainter: Warnings while compiling fshaderInterpolatedColor: " << fshaderInterpolatedColor.log();
 	}
@@ -1887,15 +2014,7 @@ void StelPainter::initGLShaders()
 	if (!vshader2.log().isEmpty()) { qWarning() << "StelPainter: Warnings while compiling vshader2: " << vshader2.log(); }
 
 	QOpenGLShader fshader2(QOpenGLShader::Fragment);
-	const char *fsrc2 =
-		"varying mediump vec2 texc;\n"
-		"uniform sampler2D tex;\n"
-		"uniform mediump vec4 texColor;\n"
-		"void main(void)\n"
-		"{\n"
-		"    gl_FragColor = texture2D(tex, texc)*texColor;\n"
-		"}\n";
-	fshader2.compileSourceCode(fsrc2);
+	fshader2.compileSourceCode(texturesFragmentShaderSource);
 	if (!fshader2.log().isEmpty()) { qWarning() << "StelPainter: Warnings while compiling fshader2: " << fshader2.log(); }
 
 	texturesShaderProgram = new QOpenGLShaderProgram(QOpenGLContext::currentContext());
@@ -1927,15 +2046,7 @@ void StelPainter::initGLShaders()
 	if (!vshader4.log().isEmpty()) { qWarning() << "StelPainter: Warnings while compiling vshader4: " << vshader4.log(); }
 
 	QOpenGLShader fshader4(QOpenGLShader::Fragment);
-	const char *fsrc4 =
-		"varying mediump vec2 texc;\n"
-		"varying mediump vec4 outColor;\n"
-		"uniform sampler2D tex;\n"
-		"void main(void)\n"
-		"{\n"
-		"    gl_FragColor = texture2D(tex, texc)*outColor;\n"
-		"}\n";
-	fshader4.compileSourceCode(fsrc4);
+	fshader4.compileSourceCode(texturesColorFragmentShaderSource);
 	if (!fshader4.log().isEmpty()) { qWarning() << "StelPainter: Warnings while compiling fshader4: " << fshader4.log(); }
 
 	texturesColorShaderProgram = new QOpenGLShaderProgram(QOpenGLContext::currentContext());
@@ -1948,6 +2059,24 @@ void StelPainter::initGLShaders()
 	texturesColorShaderVars.color = texturesColorShaderProgram->attributeLocation("color");
 	texturesColorShaderVars.texture = texturesColorShaderProgram->uniformLocation("tex");
 
+	// Streaming buffer for the vertex data of drawFromArray
+	streamBuffer = new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+	streamBuffer->setUsagePattern(QOpenGLBuffer::StreamDraw);
+	if (streamBuffer->create())
+	{
+		streamBuffer->bind();
+		streamBuffer->allocate(StreamBufferSize);
+		streamBuffer->release();
+		streamBufferOffset = 0;
+	}
+	else
+	{
+		qWarning() << "StelPainter: can't create the streaming vertex buffer, using client side arrays";
+		delete streamBuffer;
+		streamBuffer = NULL;
+	}
+	invalidateGLStateCache();
+
 	qWarning() << "StelPainter: initGLShaders()... done";
 
 }
@@ -1963,9 +2092,64 @@ void StelPainter::deinitGLShaders()
 	texturesShaderProgram = NULL;
 	delete texturesColorShaderProgram;
 	texturesColorShaderProgram = NULL;
+	foreach (const ProjectionShaders& shaders, projectionShaders)
+	{
+		for (int i=0;i<NbShaderKinds;++i)
+			delete shaders.kinds[i].program;
+	}
+	projectionShaders.clear();
+	meshCache.clear();
+	delete streamBuffer;
+	streamBuffer = NULL;
+	invalidateGLStateCache();
 	texCache.clear();
 }
 
+void StelPainter::invalidateGLStateCache()
+{
+	currentProgram = NULL;
+	basicShaderUniforms.valid = false;
+	colorShaderUniforms.valid = false;
+	texturesShaderUniforms.valid = false;
+	texturesColorShaderUniforms.valid = false;
+}
+
+bool StelPainter::streamArrays(const ArrayDesc* const* arrays, int nbArrays, int first, int nbVertices, int* bufferOffsets)
+{
+	if (!streamBuffer)
+		return false;
+	int totalSize = 0;
+	for (int i=0;i<nbArrays;++i)
+	{
+		if (!arrays[i])
+			continue;
+		if (arrays[i]->type!=GL_FLOAT)
+			return false;
+		totalSize += nbVertices*arrays[i]->size*sizeof(GLfloat);
+	}
+	if (totalSize>StreamBufferSize)
+		return false;
+
+	streamBuffer->bind();
+	if (streamBufferOffset+totalSize>StreamBufferSize)
+	{
+		// Orphan the full buffer: the driver gives us a new storage while the
+		// pending draws keep using the old one, so we never wait for the GPU.
+		streamBuffer->allocate(StreamBufferSize);
+		streamBufferOffset = 0;
+	}
+	for (int i=0;i<nbArrays;++i)
+	{
+		if (!arrays[i])
+			continue;
+		const int stride = arrays[i]->size*sizeof(GLfloat);
+		streamBuffer->write(streamBufferOffset, (const char*)arrays[i]->pointer + first*stride, nbVertices*stride);
+		bufferOffsets[i] = streamBufferOffset;
+		streamBufferOffset += nbVertices*stride;
+	}
+	return true;
+}
+
 
 void StelPainter::setArrays(const Vec3d* vertice, const Vec2f* texCoords, const Vec3f* colorArray, const Vec3f* normalArray)
 {
@@ -1996,63 +2180,55 @@ void StelPainter::enableClientStates(bool vertex, bool texture, bool color, bool
 void StelPainter::drawFromArray(DrawingMode mode, int count, int offset, bool doProj, const unsigned short* indices)
 {
 	ArrayDesc projectedVertexArray = vertexArray;
-	if (doProj)
-	{
-		// Project the vertex array using current projection
-		if (indices)
-			projectedVertexArray = projectArray(vertexArray, 0, count, indices + offset);
-		else
-			projectedVertexArray = projectArray(vertexArray, offset, count, NULL);
-	}
-
-	QOpenGLShaderProgram* pr=NULL;
-
-	const Mat4f& m = getProjector()->getProjectionMatrix();
-	const QMatrix4x4 qMat(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
 
+	// Select the program and the attribute locations matching the enabled arrays
+	ShaderKind kind;
+	QOpenGLShaderProgram* pr;
+	UniformCache* uniforms;
+	int projectionMatrixLoc, colorLoc=-1;
+	int locations[3] = {-1, -1, -1};
+	const ArrayDesc* arrays[3] = {&projectedVertexArray, NULL, NULL};
 	if (!texCoordArray.enabled && !colorArray.enabled && !normalArray.enabled)
 	{
+		kind = BasicShader;
 		pr = basicShaderProgram;
-		pr->bind();
-		pr->setAttributeArray(basicShaderVars.vertex, (const GLfloat*)projectedVertexArray.pointer, projectedVertexArray.size);
-		pr->enableAttributeArray(basicShaderVars.vertex);
-		pr->setUniformValue(basicShaderVars.projectionMatrix, qMat);
-		pr->setUniformValue(basicShaderVars.color, currentColor[0], currentColor[1], currentColor[2], currentColor[3]);
+		uniforms = &basicShaderUniforms;
+		projectionMatrixLoc = basicShaderVars.projectionMatrix;
+		colorLoc = basicShaderVars.color;
+		locations[0] = basicShaderVars.vertex;
 	}
 	else if (texCoordArray.enabled && !colorArray.enabled && !normalArray.enabled)
 	{
+		kind = TexturesShader;
 		pr = texturesShaderProgram;
-		pr->bind();
-		pr->setAttributeArray(texturesShaderVars.vertex, (const GLfloat*)projectedVertexArray.pointer, projectedVertexArray.size);
-		pr->enableAttributeArray(texturesShaderVars.vertex);
-		pr->setUniformValue(texturesShaderVars.projectionMatrix, qMat);
-		pr->setUniformValue(texturesShaderVars.texColor, currentColor[0], currentColor[1], currentColor[2], currentColor[3]);
-		pr->setAttributeArray(texturesShaderVars.texCoord, (const GLfloat*)texCoordArray.pointer, 2);
-		pr->enableAttributeArray(texturesShaderVars.texCoord);
-		//pr->setUniformValue(texturesShaderVars.texture, 0);    // use texture unit 0
+		uniforms = &texturesShaderUniforms;
+		projectionMatrixLoc = texturesShaderVars.projectionMatrix;
+		colorLoc = texturesShaderVars.texColor;
+		locations[0] = texturesShaderVars.vertex;
+		locations[1] = texturesShaderVars.texCoord;
+		arrays[1] = &texCoordArray;
 	}
 	else if (texCoordArray.enabled && colorArray.enabled && !normalArray.enabled)
 	{
+		kind = TexturesColorShader;
 		pr = texturesColorShaderProgram;
-		pr->bind();
-		pr->setAttributeArray(texturesColorShaderVars.vertex, (const GLfloat*)projectedVertexArray.pointer, projectedVertexArray.size);
-		pr->enableAttributeArray(texturesColorShaderVars.vertex);
-		pr->setUniformValue(texturesColorShaderVars.projectionMatrix, qMat);
-		pr->setAttributeArray(texturesColorShaderVars.texCoord, (const GLfloat*)texCoordArray.pointer, 2);
-		pr->enableAttributeArray(texturesColorShaderVars.texCoord);
-		pr->setAttributeArray(texturesColorShaderVars.color, (const GLfloat*)colorArray.pointer, colorArray.size);
-		pr->enableAttributeArray(texturesColorShaderVars.color);
-		//pr->setUniformValue(texturesShaderVars.texture, 0);    // use texture unit 0
+		uniforms = &texturesColorShaderUniforms;
+		projectionMatrixLoc = texturesColorShaderVars.projectionMatrix;
+		locations[0] = texturesColorShaderVars.vertex;
+		locations[1] = texturesColorShaderVars.texCoord;
+		locations[2] = texturesColorShaderVars.color;
+		arrays[1] = &texCoordArray;
+		arrays[2] = &colorArray;
 	}
 	else if (!texCoordArray.enabled && colorArray.enabled && !normalArray.enabled)
 	{
+		kind = ColorShader;
 		pr = colorShaderProgram;
-		pr->bind();
-		pr->setAttributeArray(colorShaderVars.vertex, (const GLfloat*)projectedVertexArray.pointer, projectedVertexArray.size);
-		pr->enableAttributeArray(colorShaderVars.vertex);
-		pr->setUniformValue(colorShaderVars.projectionMatrix, qMat);
-		pr->setAttributeArray(colorShaderVars.color, (const GLfloat*)colorArray.pointer, colorArray.size);
-		pr->enableAttributeArray(colorShaderVars.color);
+		uniforms = &colorShaderUniforms;
+		projectionMatrixLoc = colorShaderVars.projectionMatrix;
+		locations[0] = colorShaderVars.vertex;
+		locations[2] = colorShaderVars.color;
+		arrays[2] = &colorArray;
 	}
 	else
 	{
@@ -2061,34 +2237,104 @@ void StelPainter::drawFromArray(DrawingMode mode, int count, int offset, bool do
 		Q_ASSERT(0);
 		return;
 	}
-	
-	if (indices)
-		glDrawElements(mode, count, GL_UNSIGNED_SHORT, indices + offset);
-	else
-		glDrawArrays(mode, offset, count);
 
-	if (pr==texturesColorShaderProgram)
+	// Project the float vertices in the vertex shader if possible, else on the CPU
+	const ProjectionShader* projShader = NULL;
+	if (doProj)
+	{
+		if (vertexArray.type==GL_FLOAT)
+			projShader = getProjectionShader(kind);
+		if (!projShader)
+		{
+			if (indices)
+				projectedVertexArray = projectArray(vertexArray, 0, count, indices + offset);
+			else
+				projectedVertexArray = projectArray(vertexArray, offset, count, NULL);
+		}
+	}
+
+	const Mat4f& m = getProjector()->getProjectionMatrix();
+	if (projShader)
+	{
+		// The projection uniforms change with each projector, upload them every time
+		pr = projShader->program;
+		if (pr!=currentProgram)
+		{
+			pr->bind();
+			currentProgram = pr;
+		}
+		pr->setUniformValue(projShader->projectionMatrix, reinterpret_cast<const GLfloat (*)[4]>((const float*)m));
+		pr->setUniformValue(projShader->viewportCenter, prj->viewportCenter[0], prj->viewportCenter[1]);
+		pr->setUniformValue(projShader->flipPixelPerRad, prj->flipHorz*prj->pixelPerRad, prj->flipVert*prj->pixelPerRad);
+		pr->setUniformValue(projShader->depthRange, prj->zNear, prj->oneOverZNearMinusZFar);
+		prj->modelViewTransform->setForwardShaderUniforms(pr);
+		if (projShader->color>=0)
+			pr->setUniformValue(projShader->color, currentColor[0], currentColor[1], currentColor[2], currentColor[3]);
+		locations[0] = projShader->vertex;
+		locations[1] = projShader->texCoord;
+		locations[2] = projShader->colorArray;
+	}
+	else
 	{
-		pr->disableAttributeArray(texturesColorShaderVars.texCoord);
-		pr->disableAttributeArray(texturesColorShaderVars.vertex);
-		pr->disableAttributeArray(texturesColorShaderVars.color);
+		// Only bind the program and upload the uniforms when they changed since the previous draw
+		if (pr!=currentProgram)
+		{
+			pr->bind();
+			currentProgram = pr;
+		}
+		if (!uniforms->valid || std::memcmp(uniforms->projectionMatrix, (const float*)m, sizeof(uniforms->projectionMatrix))!=0)
+		{
+			// Mat4f is column-major like GL
+			pr->setUniformValue(projectionMatrixLoc, reinterpret_cast<const GLfloat (*)[4]>((const float*)m));
+			std::memcpy(uniforms->projectionMatrix, (const float*)m, sizeof(uniforms->projectionMatrix));
+		}
+		if (colorLoc>=0 && (!uniforms->valid || uniforms->color!=currentColor))
+		{
+			pr->setUniformValue(colorLoc, currentColor[0], currentColor[1], currentColor[2], currentColor[3]);
+			uniforms->color = currentColor;
+		}
+		uniforms->valid = true;
 	}
-	else if (pr==texturesShaderProgram)
+
+	// Range of vertices read by the draw call
+	int firstVertex = offset;
+	int nbVertices = count;
+	if (indices)
 	{
-		pr->disableAttributeArray(texturesShaderVars.texCoord);
-		pr->disableAttributeArray(texturesShaderVars.vertex);
+		unsigned short maxIndex = 0;
+		for (int i=offset;i<offset+count;++i)
+			maxIndex = std::max(maxIndex, indices[i]);
+		firstVertex = 0;
+		nbVertices = maxIndex+1;
 	}
-	else if (pr == basicShaderProgram)
+
+	// Send the vertex data through the streaming buffer if possible, else use client side arrays
+	int bufferOffsets[3];
+	const bool streamed = streamArrays(arrays, 3, firstVertex, nbVertices, bufferOffsets);
+	for (int i=0;i<3;++i)
 	{
-		pr->disableAttributeArray(basicShaderVars.vertex);
+		if (!arrays[i])
+			continue;
+		if (streamed)
+			pr->setAttributeBuffer(locations[i], GL_FLOAT, bufferOffsets[i], arrays[i]->size);
+		else
+			pr->setAttributeArray(locations[i], (const GLfloat*)arrays[i]->pointer, arrays[i]->size);
+		pr->enableAttributeArray(locations[i]);
 	}
-	else if (pr == colorShaderProgram)
+	// The attribute pointers keep referencing the buffer, unbind it so that client side arrays still work
+	if (streamed)
+		streamBuffer->release();
+
+	if (indices)
+		glDrawElements(mode, count, GL_UNSIGNED_SHORT, indices + offset);
+	else
+		glDrawArrays(mode, streamed ? 0 : offset, count);
+
+	for (int i=0;i<3;++i)
 	{
-		pr->disableAttributeArray(colorShaderVars.vertex);
-		pr->disableAttributeArray(colorShaderVars.color);
+		if (arrays[i])
+			pr->disableAttributeArray(locations[i]);
 	}
-	if (pr)
-		pr->release();
 }
 
 
@@ -2101,16 +2347,16 @@ StelPainter::ArrayDesc StelPainter::projectArray(const StelPainter::ArrayDesc& a
 	}
 
 	Q_ASSERT(array.size == 3);
-	Q_ASSERT(array.type == GL_DOUBLE);
-	Vec3d* vecArray = (Vec3d*)array.pointer;
+	Q_ASSERT(array.type == GL_DOUBLE || array.type == GL_FLOAT);
 
 	// We have two different cases :
 	// 1) We are not using an indice array.  In that case the size of the array is known
 	// 2) We are using an indice array.  In that case we have to find the max value by iterating through the indices.
+	int first = offset;
+	int n = count;
 	if (!indices)
 	{
 		polygonVertexArray.resize(offset + count);
-		prj->project(count, vecArray + offset, polygonVertexArray.data() + offset);
 	} else
 	{
 		// we need to find the max value of the indices !
@@ -2120,8 +2366,13 @@ StelPainter::ArrayDesc StelPainter::projectArray(const StelPainter::ArrayDesc& a
 			max = std::max(max, indices[i]);
 		}
 		polygonVertexArray.resize(max+1);
-		prj->project(max + 1, vecArray + offset, polygonVertexArray.data() + offset);
+		n = max + 1;
 	}
+	// Float arrays end up here when they can't be projected by the GPU
+	if (array.type == GL_FLOAT)
+		prj->project(n, (const Vec3f*)array.pointer + first, polygonVertexArray.data() + first);
+	else
+		prj->project(n, (const Vec3d*)array.pointer + first, polygonVertexArray.data() + first);
 
 	ArrayDesc ret;
 	ret.size = 3;
@@ -2131,6 +2382,89 @@ StelPainter::ArrayDesc StelPainter::projectArray(const StelPainter::ArrayDesc& a
 	return ret;
 }
 
+bool StelPainter::hasGpuProjection() const
+{
+	return getProjectionShader(BasicShader)!=NULL;
+}
+
+const StelPainter::ProjectionShader* StelPainter::getProjectionShader(ShaderKind kind) const
+{
+	if (!flagGpuProjection)
+		return NULL;
+	// NULL for the 2d projector and for the transforms which have no GLSL version
+	const char* transfoSource = prj->modelViewTransform->getForwardShaderSource();
+	const char* projectorSource = prj->getForwardShaderSource();
+	if (!transfoSource || !projectorSource)
+		return NULL;
+	ProjectionShader& shader = projectionShaders[qMakePair(transfoSource, projectorSource)].kinds[kind];
+	if (!shader.compiled)
+	{
+		shader.compiled = true;
+		if (!compileProjectionShader(shader, kind, transfoSource, projectorSource))
+			qWarning() << "StelPainter: can't project with shaders for" << prj->getNameI18() << ", using the CPU";
+	}
+	return shader.program ? &shader : NULL;
+}
+
+bool StelPainter::compileProjectionShader(ProjectionShader& shader, ShaderKind kind, const char* transfoSource, const char* projectorSource)
+{
+	const bool textured = kind==TexturesShader || kind==TexturesColorShader;
+	const bool colored = kind==TexturesColorShader || kind==ColorShader;
+	const char* colorVarying = kind==ColorShader ? "fragcolor" : "outColor";
+
+	// Same as the CPU StelProjector::project(): model view transform, projection then viewport scaling
+	QByteArray vsrc =
+		"attribute highp vec3 vertex;\n"
+		"uniform highp mat4 projectionMatrix;\n"
+		"uniform highp vec2 viewportCenter;\n"
+		"uniform highp vec2 flipPixelPerRad;\n"
+		"uniform highp vec2 depthRange;\n";
+	if (textured)
+		vsrc += "attribute mediump vec2 texCoord;\nvarying mediump vec2 texc;\n";
+	if (colored)
+		vsrc += QByteArray("attribute mediump vec4 color;\nvarying mediump vec4 ") + colorVarying + ";\n";
+	vsrc += transfoSource;
+	vsrc += projectorSource;
+	vsrc +=
+		"void main(void)\n"
+		"{\n"
+		"    vec3 win = projectorForward(modelViewForward(vertex));\n"
+		"    gl_Position = projectionMatrix*vec4(viewportCenter + flipPixelPerRad*win.xy, (win.z-depthRange.x)*depthRange.y, 1.);\n";
+	if (textured)
+		vsrc += "    texc = texCoord;\n";
+	if (colored)
+		vsrc += QByteArray("    ") + colorVarying + " = color;\n";
+	vsrc += "}\n";
+
+	const char* fsrc = basicFragmentShaderSource;
+	if (kind==TexturesShader)
+		fsrc = texturesFragmentShaderSource;
+	else if (kind==TexturesColorShader)
+		fsrc = texturesColorFragmentShaderSource;
+	else if (kind==ColorShader)
+		fsrc = colorFragmentShaderSource;
+
+	QOpenGLShaderProgram* program = new QOpenGLShaderProgram(QOpenGLContext::currentContext());
+	if (!program->addShaderFromSourceCode(QOpenGLShader::Vertex, vsrc)
+		|| !program->addShaderFromSourceCode(QOpenGLShader::Fragment, fsrc)
+		|| !linkProg(program, "projectionShaderProgram"))
+	{
+		qWarning() << "StelPainter: error while compiling the projection shader:" << program->log();
+		delete program;
+		return false;
+	}
+	shader.program = program;
+	shader.projectionMatrix = program->uniformLocation("projectionMatrix");
+	shader.viewportCenter = program->uniformLocation("viewportCenter");
+	shader.flipPixelPerRad = program->uniformLocation("flipPixelPerRad");
+	shader.depthRange = program->uniformLocation("depthRange");
+	shader.color = colored ? -1 : program->uniformLocation(textured ? "texColor" : "color");
+	shader.vertex = program->attributeLocation("vertex");
+	shader.texCoord = textured ? program->attributeLocation("texCoord") : -1;
+	shader.colorArray = colored ? program->attributeLocation("color") : -1;
+	return true;
+}
+
 // Light methods
 
 void StelPainterLight::setPosition(const Vec4f& v)
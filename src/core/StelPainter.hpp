@@ -26,6 +26,8 @@
 #include <QString>
 #include <QVarLengthArray>
 #include <QFontMetrics>
+#include <QHash>
+#include <QPair>
 
 class QOpenGLShaderProgram;
 
@@ -190,14 +192,20 @@ public:
 	void drawRect2d(float x, float y, float width, float height, bool textured=true);
 
 	//! Re-implementation of gluSphere : glu is overridden for non-standard projection.
+	//! The tessellated mesh is cached, only the lighting is computed at each call.
 	void sSphere(float radius, float oneMinusOblateness, int slices, int stacks, int orientInside = 0, bool flipTexture = false);
 
 	//! Generate a StelVertexArray for a sphere.
+	//! The returned array shares its data with the mesh cache.
 	static StelVertexArray computeSphereNoLight(float radius, float oneMinusOblateness, int slices, int stacks, int orientInside = 0, bool flipTexture = false);
 
 	//! Re-implementation of gluCylinder : glu is overridden for non-standard projection.
 	void sCylinder(float radius, float height, int slices, int orientInside = 0);
 
+	//! Generate a StelVertexArray for a cylinder, as drawn by sCylinder().
+	//! The returned array shares its data with the mesh cache.
+	static StelVertexArray computeCylinderNoLight(float radius, float height, int slices);
+
 	//! Draw a disk with a special texturing mode having texture center at center of disk.
 	//! The disk is made up of concentric circles with increasing refinement.
 	//! The number of slices of the outmost circle is (innerFanSlices<<level).
@@ -214,6 +222,10 @@ public:
 	//! Draw a fisheye texture in a sphere.
 	void sSphereMap(float radius, int slices, int stacks, float textureFov = 2.f*M_PI, int orientInside = 0);
 
+	//! Generate a StelVertexArray for a fisheye textured sphere, as drawn by sSphereMap().
+	//! The returned array shares its data with the mesh cache.
+	static StelVertexArray computeSphereMapNoLight(float radius, int slices, int stacks, float textureFov = 2.f*M_PI, int orientInside = 0);
+
 	//! Set the font to use for subsequent text drawing.
 	void setFont(const QFont& font);
 
@@ -237,6 +249,21 @@ public:
 	//! This method needs to be called once before exit.
 	static void deinitGLShaders();
 
+	//! Set whether the vertices of float arrays may be projected in the vertex shaders instead of the CPU.
+	static void setFlagGpuProjection(bool b) {flagGpuProjection=b;}
+	//! Get whether the vertices of float arrays may be projected in the vertex shaders instead of the CPU.
+	static bool getFlagGpuProjection() {return flagGpuProjection;}
+
+	//! Return whether float vertex arrays drawn with drawFromArray() are projected in the vertex shaders
+	//! with the current projector. Otherwise they are projected on the CPU like double arrays.
+	//! The GPU projection is done in single precision, so it is only suitable for vertices given as directions
+	//! or in a frame close to the observer.
+	bool hasGpuProjection() const;
+
+	//! Forget the cached GL program binding and uniform values.
+	//! Must be called by code binding its own shader program while a StelPainter is alive.
+	static void invalidateGLStateCache();
+
 	//! Set whether texturing is enabled.
 	void enableTexture2d(bool b);
 
@@ -283,6 +310,13 @@ public:
 	//! @param checkDiscontinuity will check and suppress discontinuities if necessary.
 	void drawStelVertexArray(const StelVertexArray& arr, bool checkDiscontinuity=true);
 
+	//! Draws the primitives defined in the StelVertexArray, using a float copy of its vertices.
+	//! The vertices are projected in the vertex shaders when possible, so that static meshes are not
+	//! touched by the CPU anymore. It falls back to the CPU projection of the double vertices otherwise.
+	//! @param vertexf the vertices of arr converted to float.
+	//! @param checkDiscontinuity will check and suppress discontinuities if necessary.
+	void drawStelVertexArray(const StelVertexArray& arr, const QVector<Vec3f>& vertexf, bool checkDiscontinuity=true);
+
 	//! Link an opengl program and show a message in case of error or warnings.
 	//! @return true if the link was successful.
 	static bool linkProg(class QOpenGLShaderProgram* prog, const QString& name);
@@ -305,6 +339,26 @@ private:
 	};
 
 	static QCache<QByteArray, struct StringTexture> texCache;
+
+	//! Cache of the tessellated spheres, rings, cylinders and sphere maps, keyed by their parameters.
+	//! The cost of an entry is its number of vertices.
+	static QCache<QByteArray, StelVertexArray> meshCache;
+	//! Storage for a mesh too big to be cached.
+	static StelVertexArray uncachedMesh;
+	//! Return the cached mesh for the given key, or NULL.
+	static const StelVertexArray* getCachedMesh(const QByteArray& key);
+	//! Store a mesh in the cache and return the stored copy, which is valid until the next insertion.
+	static const StelVertexArray* insertCachedMesh(const QByteArray& key, const StelVertexArray& mesh);
+	//! Return the mesh of a sphere from the cache, tessellating it if needed.
+	static const StelVertexArray* getSphereMesh(float radius, float oneMinusOblateness, int slices, int stacks, int orientInside, bool flipTexture);
+	static StelVertexArray tessellateSphere(float radius, float oneMinusOblateness, int slices, int stacks, int orientInside, bool flipTexture);
+	//! Tessellate a ring as consecutive triangle strips of 2*(|slices|+1) vertices, one per stack.
+	static StelVertexArray tessellateRing(float rMin, float rMax, int slices, int stacks);
+	//! Return the mesh of a cylinder from the cache, tessellating it if needed.
+	static const StelVertexArray* getCylinderMesh(float radius, float height, int slices);
+	//! Return the mesh of a fisheye textured sphere from the cache, tessellating it if needed.
+	static const StelVertexArray* getSphereMapMesh(float radius, int slices, int stacks, float textureFov, int orientInside);
+	static StelVertexArray tessellateSphereMap(float radius, int slices, int stacks, float textureFov, int orientInside);
 	struct StringTexture* getTexTexture(const QString& str, int pixelSize);
 
 	//! Struct describing one opengl array
@@ -332,6 +386,15 @@ private:
 
 	void drawTextGravity180(float x, float y, const QString& str, float xshift = 0, float yshift = 0);
 
+	//! Same as drawSmallCircleArc() with the already projected start and stop points.
+	//! win1[2] and win2[2] must be 1 if the projected points are valid, -1 otherwise.
+	void drawSmallCircleArc(const Vec3d& start, const Vec3d& stop, Vec3d win1, Vec3d win2, const Vec3d& rotCenter,
+		void (*viewportEdgeIntersectCallback)(const Vec3d& screenPos, const Vec3d& direction, void* userData), void* userData);
+
+	//! Draw the great circle arc of drawGreatCircleArcs() between the vertices i and j of va,
+	//! reusing their projection when the arc is not clipped.
+	void drawProjectedGreatCircleArc(const StelVertexArray& va, int i, int j, const SphericalCap* clippingCap);
+
 	// Used by the method below
 	static QVector<Vec2f> smallCircleVertexArray;
 	void drawSmallCircleVertexArray();
@@ -380,6 +443,73 @@ private:
 	};
 	static TexturesColorShaderVars texturesColorShaderVars;
 
+	//! Last values uploaded to the uniforms of one of the shader programs,
+	//! used to skip redundant uploads between consecutive draws.
+	struct UniformCache {
+		UniformCache() : valid(false) {}
+		bool valid;
+		float projectionMatrix[16];
+		Vec4f color;
+	};
+	static UniformCache basicShaderUniforms;
+	static UniformCache colorShaderUniforms;
+	static UniformCache texturesShaderUniforms;
+	static UniformCache texturesColorShaderUniforms;
+	//! The kinds of shader programs, depending on the enabled arrays.
+	enum ShaderKind
+	{
+		BasicShader,		//!< Plain color
+		TexturesShader,		//!< Texture modulated by a plain color
+		TexturesColorShader,	//!< Texture modulated by a color per vertex
+		ColorShader,		//!< Color per vertex
+		NbShaderKinds
+	};
+
+	//! A program projecting the vertices in the vertex shader, and the locations of its variables.
+	struct ProjectionShader
+	{
+		ProjectionShader() : program(NULL), compiled(false) {}
+		QOpenGLShaderProgram* program;
+		//! Whether the compilation was attempted. The program is NULL if it failed.
+		bool compiled;
+		int projectionMatrix;
+		int viewportCenter;
+		int flipPixelPerRad;
+		int depthRange;
+		int color;
+		int vertex;
+		int texCoord;
+		int colorArray;
+	};
+	//! The projection programs of all the kinds for one couple of model view transform and projector.
+	struct ProjectionShaders
+	{
+		ProjectionShader kinds[NbShaderKinds];
+	};
+	//! The projection programs compiled so far, keyed by the GLSL sources of the model view transform
+	//! and of the projector, which are unique per class.
+	static QHash<QPair<const char*, const char*>, ProjectionShaders> projectionShaders;
+	static bool flagGpuProjection;
+	//! Return the program of the given kind projecting the vertices with the current projector,
+	//! compiling it if needed, or NULL if the projection can't be done in shaders.
+	const ProjectionShader* getProjectionShader(ShaderKind kind) const;
+	static bool compileProjectionShader(ProjectionShader& shader, ShaderKind kind, const char* transfoSource, const char* projectorSource);
+
+	//! The program currently bound by drawFromArray, or NULL if unknown.
+	static QOpenGLShaderProgram* currentProgram;
+
+	//! Size in bytes of the streaming vertex buffer.
+	static const int StreamBufferSize = 1024*1024;
+	//! Vertex buffer used as a ring to send the vertex data of drawFromArray to the GPU.
+	static class QOpenGLBuffer* streamBuffer;
+	//! Position of the next free byte in the streaming buffer.
+	static int streamBufferOffset;
+
+	//! Copy the vertices [first, first+nbVertices) of the given arrays in the streaming buffer.
+	//! NULL entries are skipped. On success the buffer is left bound and the byte offset of each
+	//! array in the buffer is written in bufferOffsets.
+	//! @return false if the data can't be streamed, in which case client side arrays must be used.
+	static bool streamArrays(const ArrayDesc* const* arrays, int nbArrays, int first, int nbVertices, int* bufferOffsets);
 
 	//! The descriptor for the current opengl vertex array
 	ArrayDesc vertexArray;
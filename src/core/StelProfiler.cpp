@@ -0,0 +1,181 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelProfiler.hpp"
+#include "StelJsonParser.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QMap>
+#include <QVariantList>
+
+StelProfiler::StelProfiler(QObject* parent) : QObject(parent), enabled(false), flagGpuSync(false)
+{
+	setObjectName("StelProfiler");
+	timer.start();
+	clear();
+}
+
+void StelProfiler::clear()
+{
+	currentFrameNs.fill(0, sectionNames.size());
+	history.fill(QVector<float>(HistorySize, 0.f), sectionNames.size());
+	frameHistory.fill(0.f, HistorySize);
+	frameStartNs = getTimeNs();
+	frameCount = 0;
+	traceEvents.resize(MaxTraceEvents);
+	traceEventsNext = 0;
+	traceEventsCount = 0;
+}
+
+void StelProfiler::setEnabled(bool b)
+{
+	if (b==enabled)
+		return;
+	enabled = b;
+	// Keep the recorded data after stopping so that it can still be dumped
+	if (enabled)
+		clear();
+}
+
+int StelProfiler::getSectionId(const QString& name)
+{
+	QHash<QString, int>::ConstIterator iter = sectionIds.constFind(name);
+	if (iter!=sectionIds.constEnd())
+		return iter.value();
+	const int id = sectionNames.size();
+	sectionNames.append(name);
+	sectionIds.insert(name, id);
+	currentFrameNs.append(0);
+	history.append(QVector<float>(HistorySize, 0.f));
+	return id;
+}
+
+void StelProfiler::addSample(int sectionId, qint64 startNs, qint64 durationNs)
+{
+	if (!enabled)
+		return;
+	Q_ASSERT(sectionId>=0 && sectionId<currentFrameNs.size());
+	currentFrameNs[sectionId] += durationNs;
+	TraceEvent& e = traceEvents[traceEventsNext];
+	e.sectionId = sectionId;
+	e.startNs = startNs;
+	e.durationNs = durationNs;
+	traceEventsNext = (traceEventsNext+1)%MaxTraceEvents;
+	traceEventsCount = qMin(traceEventsCount+1, (int)MaxTraceEvents);
+}
+
+void StelProfiler::nextFrame()
+{
+	if (!enabled)
+		return;
+	const qint64 now = getTimeNs();
+	const int slot = frameCount%HistorySize;
+	frameHistory[slot] = (now-frameStartNs)*1e-6f;
+	for (int i=0;i<currentFrameNs.size();++i)
+	{
+		history[i][slot] = currentFrameNs.at(i)*1e-6f;
+		currentFrameNs[i] = 0;
+	}
+	frameStartNs = now;
+	++frameCount;
+}
+
+// Compute the last, average and max values of a ring buffer
+static QVariantMap ringStats(const QVector<float>& ring, int frameCount)
+{
+	QVariantMap m;
+	const int n = qMin(frameCount, ring.size());
+	if (n==0)
+		return m;
+	float sum = 0.f, maxVal = 0.f;
+	for (int i=0;i<n;++i)
+	{
+		sum += ring.at(i);
+		maxVal = qMax(maxVal, ring.at(i));
+	}
+	m["last"] = ring.at((frameCount-1)%ring.size());
+	m["average"] = sum/n;
+	m["max"] = maxVal;
+	return m;
+}
+
+QVariantMap StelProfiler::getReport() const
+{
+	QVariantMap report;
+	for (int i=0;i<sectionNames.size();++i)
+		report[sectionNames.at(i)] = ringStats(history.at(i), frameCount);
+	report["frame"] = ringStats(frameHistory, frameCount);
+	return report;
+}
+
+QString StelProfiler::getSummary(int maxLines) const
+{
+	if (!enabled || frameCount==0)
+		return QString();
+	// Sort sections by decreasing average time
+	QMultiMap<float, QString> sorted;
+	const QVariantMap report = getReport();
+	for (QVariantMap::ConstIterator iter=report.constBegin();iter!=report.constEnd();++iter)
+	{
+		if (iter.key()!="frame")
+			sorted.insert(-iter.value().toMap().value("average").toFloat(), iter.key());
+	}
+	const QVariantMap frame = report.value("frame").toMap();
+	QString res = QString("frame: %1 ms (max %2)\n").arg(frame.value("average").toFloat(), 0, 'f', 2).arg(frame.value("max").toFloat(), 0, 'f', 2);
+	int nbLines = 0;
+	for (QMultiMap<float, QString>::ConstIterator iter=sorted.constBegin();iter!=sorted.constEnd() && nbLines<maxLines;++iter, ++nbLines)
+	{
+		const QVariantMap m = report.value(iter.value()).toMap();
+		res += QString("%1: %2 ms (max %3)\n").arg(iter.value()).arg(m.value("average").toFloat(), 0, 'f', 2).arg(m.value("max").toFloat(), 0, 'f', 2);
+	}
+	return res;
+}
+
+bool StelProfiler::dumpChromeTrace(const QString& fileName) const
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+	{
+		qWarning() << "StelProfiler: cannot write trace file" << QDir::toNativeSeparators(fileName);
+		return false;
+	}
+	QVariantList events;
+	const int first = (traceEventsNext-traceEventsCount+MaxTraceEvents)%MaxTraceEvents;
+	for (int i=0;i<traceEventsCount;++i)
+	{
+		const TraceEvent& e = traceEvents.at((first+i)%MaxTraceEvents);
+		QVariantMap ev;
+		ev["name"] = sectionNames.at(e.sectionId);
+		ev["ph"] = "X";
+		ev["ts"] = e.startNs/1000.;
+		ev["dur"] = e.durationNs/1000.;
+		ev["pid"] = 1;
+		ev["tid"] = 1;
+		events.append(ev);
+	}
+	QVariantMap trace;
+	trace["traceEvents"] = events;
+	trace["displayTimeUnit"] = "ms";
+	StelJsonParser::write(trace, &file);
+	file.close();
+	qDebug() << "StelProfiler: wrote" << traceEventsCount << "events to" << QDir::toNativeSeparators(fileName);
+	return true;
+}
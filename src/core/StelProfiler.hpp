@@ -0,0 +1,149 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELPROFILER_HPP_
+#define _STELPROFILER_HPP_
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+
+//! @class StelProfiler
+//! Low overhead frame profiler measuring the time spent in the main parts of a frame.
+//! The time spent in each named section (module update and draw, StelCore update, texture
+//! uploads, GL flush..) is accumulated for the current frame, and the per frame totals are kept
+//! in ring buffers over the last HistorySize frames. The individual timed events of the last
+//! frames are also kept so that they can be dumped in the Chrome trace JSON format
+//! (load the file in chrome://tracing).
+//! When disabled, a Scope only costs a test on a boolean.
+class StelProfiler : public QObject
+{
+	Q_OBJECT
+	Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled)
+	Q_PROPERTY(bool flagGpuSync READ getFlagGpuSync WRITE setFlagGpuSync)
+
+public:
+	//! Number of frames kept in the history ring buffers.
+	static const int HistorySize = 120;
+	//! Maximum number of events kept for the trace dump.
+	static const int MaxTraceEvents = 16384;
+
+	//! @class Scope
+	//! Measure the time spent between its construction and its destruction.
+	class Scope
+	{
+	public:
+		Scope(StelProfiler* p, const QString& name) : profiler(p && p->isEnabled() ? p : NULL), sectionId(-1), startNs(0)
+		{
+			if (profiler)
+			{
+				sectionId = profiler->getSectionId(name);
+				startNs = profiler->getTimeNs();
+			}
+		}
+		~Scope()
+		{
+			if (profiler)
+				profiler->addSample(sectionId, startNs, profiler->getTimeNs()-startNs);
+		}
+	private:
+		StelProfiler* profiler;
+		int sectionId;
+		qint64 startNs;
+	};
+
+	StelProfiler(QObject* parent=NULL);
+
+	//! Return whether the profiler is recording.
+	bool isEnabled() const {return enabled;}
+
+	//! Return whether the GL pipeline is flushed with glFinish() at the end of each frame,
+	//! so that the GPU time appears in the "gl:finish" section.
+	bool getFlagGpuSync() const {return flagGpuSync && enabled;}
+
+	//! Start a new frame, committing the times accumulated during the previous one.
+	//! Called once per frame by StelApp::update().
+	void nextFrame();
+
+	//! Return the index of the section with the given name, creating it if needed.
+	int getSectionId(const QString& name);
+
+	//! Record a timed event for the given section.
+	void addSample(int sectionId, qint64 startNs, qint64 durationNs);
+
+	//! Return the current time in nanoseconds since the profiler creation.
+	qint64 getTimeNs() const {return timer.nsecsElapsed();}
+
+public slots:
+	//! Start or stop recording. The history is cleared when recording starts.
+	void setEnabled(bool b);
+
+	//! Flush the GL pipeline at the end of each frame to measure the GPU time.
+	//! This stalls the CPU so it should only be used while investigating.
+	void setFlagGpuSync(bool b) {flagGpuSync=b;}
+
+	//! Return the timing statistics over the recorded frames.
+	//! The returned map contains for each section name a map with the "last", "average" and
+	//! "max" durations in milliseconds, plus a "frame" entry for the total frame time.
+	QVariantMap getReport() const;
+
+	//! Return a short human readable summary of the most expensive sections, one per line.
+	//! @param maxLines the maximum number of sections to list.
+	QString getSummary(int maxLines=12) const;
+
+	//! Write the recorded events of the last frames in the Chrome trace JSON format.
+	//! @return false if the file could not be written.
+	bool dumpChromeTrace(const QString& fileName) const;
+
+private:
+	struct TraceEvent
+	{
+		int sectionId;
+		qint64 startNs;
+		qint64 durationNs;
+	};
+
+	void clear();
+
+	bool enabled;
+	bool flagGpuSync;
+	QElapsedTimer timer;
+
+	QStringList sectionNames;
+	QHash<QString, int> sectionIds;
+	//! Time accumulated by each section during the current frame.
+	QVector<qint64> currentFrameNs;
+	//! Per section ring buffers of the frame totals, indexed by frame%HistorySize.
+	QVector<QVector<float> > history;
+	//! Ring buffer of the total frame durations.
+	QVector<float> frameHistory;
+	qint64 frameStartNs;
+	int frameCount;
+
+	//! Ring buffer of the individual events for the trace dump.
+	QVector<TraceEvent> traceEvents;
+	int traceEventsNext;
+	int traceEventsCount;
+};
+
+#endif // _STELPROFILER_HPP_
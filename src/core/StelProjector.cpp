@@ -24,6 +24,7 @@
 #include "StelProjectorClasses.hpp"
 
 #include <QDebug>
+#include <QOpenGLShaderProgram>
 #include <QString>
 
 StelProjector::Mat4dTransform::Mat4dTransform(const Mat4d& m)
@@ -87,6 +88,24 @@ StelProjector::ModelViewTranformP StelProjector::Mat4dTransform::clone() const
 	return ModelViewTranformP(new Mat4dTransform(transfoMat));
 }
 
+static const char mat4dTransformShaderSource[] =
+	"uniform highp mat4 modelViewMatrix;\n"
+	"vec3 modelViewForward(vec3 v)\n"
+	"{\n"
+	"    return (modelViewMatrix*vec4(v, 1.)).xyz;\n"
+	"}\n";
+
+const char* StelProjector::Mat4dTransform::getForwardShaderSource() const
+{
+	return mat4dTransformShaderSource;
+}
+
+void StelProjector::Mat4dTransform::setForwardShaderUniforms(QOpenGLShaderProgram* program) const
+{
+	// Mat4f is column-major like GL
+	program->setUniformValue("modelViewMatrix", reinterpret_cast<const GLfloat (*)[4]>((const float*)transfoMatf));
+}
+
 const QString StelProjector::maskTypeToString(StelProjectorMaskType type)
 {
 	if (type == MaskDisk )
@@ -298,31 +317,35 @@ bool StelProjector::project(const Vec3f& v, Vec3f& win) const
 	return projectInPlace(win);
 }
 
-void StelProjector::project(int n, const Vec3d* in, Vec3f* out)
+void StelProjector::projectBatch(int n, const Vec3d* in, Vec3f* out, bool* valid) const
 {
 	Vec3d v;
-	for (int i = 0; i < n; ++i, ++out)
+	for (int i = 0; i < n; ++i)
 	{
 		v = in[i];
 		modelViewTransform->forward(v);
-		out->set(v[0], v[1], v[2]);
-		forward(*out);
-		out->set(viewportCenter[0] + flipHorz * pixelPerRad * (*out)[0],
-			viewportCenter[1] + flipVert * pixelPerRad * (*out)[1],
-			((*out)[2] - zNear) * oneOverZNearMinusZFar);
+		out[i].set(v[0], v[1], v[2]);
+		const bool rval = forward(out[i]);
+		if (valid)
+			valid[i] = rval;
+		out[i].set(viewportCenter[0] + flipHorz * pixelPerRad * out[i][0],
+			viewportCenter[1] + flipVert * pixelPerRad * out[i][1],
+			(out[i][2] - zNear) * oneOverZNearMinusZFar);
 	}
 }
 
-void StelProjector::project(int n, const Vec3f* in, Vec3f* out)
+void StelProjector::projectBatch(int n, const Vec3f* in, Vec3f* out, bool* valid) const
 {
-	for (int i = 0; i < n; ++i, ++out)
+	for (int i = 0; i < n; ++i)
 	{
-		*out=in[i];
-		modelViewTransform->forward(*out);
-		forward(*out);
-		out->set(viewportCenter[0] + flipHorz * pixelPerRad * (*out)[0],
-			viewportCenter[1] + flipVert * pixelPerRad * (*out)[1],
-			((*out)[2] - zNear) * oneOverZNearMinusZFar);
+		out[i] = in[i];
+		modelViewTransform->forward(out[i]);
+		const bool rval = forward(out[i]);
+		if (valid)
+			valid[i] = rval;
+		out[i].set(viewportCenter[0] + flipHorz * pixelPerRad * out[i][0],
+			viewportCenter[1] + flipVert * pixelPerRad * out[i][1],
+			(out[i][2] - zNear) * oneOverZNearMinusZFar);
 	}
 }
 
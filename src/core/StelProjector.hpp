@@ -25,6 +25,8 @@
 #include "VecMath.hpp"
 #include "StelSphereGeometry.hpp"
 
+class QOpenGLShaderProgram;
+
 //! @class StelProjector
 //! Provide the main interface to all operations of projecting coordinates from sky to screen.
 //! The StelProjector also defines the viewport size and position.
@@ -61,6 +63,14 @@ public:
 		virtual ModelViewTranformP clone() const=0;
 
 		virtual Mat4d getApproximateLinearTransfo() const=0;
+
+		//! Return the GLSL source of the function "vec3 modelViewForward(vec3 v)" performing forward() in a
+		//! vertex shader, or NULL if the transformation can only be applied on the CPU.
+		//! The returned pointer must stay valid and identical for all the instances of a class, it is used
+		//! to identify the compiled shader programs.
+		virtual const char* getForwardShaderSource() const {return NULL;}
+		//! Set the values of the uniforms declared in the source returned by getForwardShaderSource().
+		virtual void setForwardShaderUniforms(QOpenGLShaderProgram*) const {;}
 	};
 
 	class Mat4dTransform: public ModelViewTranform
@@ -74,6 +84,11 @@ public:
         void combine(const Mat4d& m);
         Mat4d getApproximateLinearTransfo() const;
         ModelViewTranformP clone() const;
+        const char* getForwardShaderSource() const;
+        void setForwardShaderUniforms(QOpenGLShaderProgram* program) const;
+        //! Return the transformation matrix in double and single precision.
+        const Mat4d& getMatrix() const {return transfoMat;}
+        const Mat4f& getMatrixf() const {return transfoMatf;}
 
 	private:
 		//! transfo matrix and invert
@@ -136,6 +151,11 @@ public:
 	virtual bool forward(Vec3f& v) const = 0;
 	//! Apply the transformation in the backward projection in place.
 	virtual bool backward(Vec3d& v) const = 0;
+	//! Return the GLSL source of the function "vec3 projectorForward(vec3 v)" performing forward() in a
+	//! vertex shader, or NULL if the projection can only be done on the CPU.
+	//! The result must match forward() to the pixel, and the returned pointer must be the same for all
+	//! the instances of a class.
+	virtual const char* getForwardShaderSource() const {return NULL;}
 	//! Return the small zoom increment to use at the given FOV for nice movements
 	virtual float deltaZoom(float fov) const = 0;
 
@@ -155,6 +175,9 @@ public:
 	//! screen, or a 3d dome.
 	bool getFlagGravityLabels() const;
 
+	//! Get the rotation angle in degree applied to the labels when the gravity labels are off.
+	float getDefaultAngleForGravityText() const {return defautAngleForGravityText;}
+
 	//! Get the lower left corner of the viewport and the width, height.
 	const Vec4i& getViewport() const;
 
@@ -218,9 +241,18 @@ public:
 	//! @return true if the projected coordinate is valid.
 	bool project(const Vec3f& v, Vec3f& win) const;
 
-	virtual void project(int n, const Vec3d* in, Vec3f* out);
+	//! Project an array of vectors from the current frame into the viewport.
+	//! The concrete projection and model view transformation are selected once for the whole array,
+	//! so this is much faster than calling project() for each vector.
+	//! @param n the number of vectors.
+	//! @param in the vectors in the current frame.
+	//! @param out the projected vectors in the viewport 2D frame.
+	//! @param valid if not NULL, receives for each vector whether its projected coordinate is valid.
+	void project(int n, const Vec3d* in, Vec3f* out, bool* valid=NULL) const {projectBatch(n, in, out, valid);}
 
-	virtual void project(int n, const Vec3f* in, Vec3f* out);
+	//! Project an array of vectors from the current frame into the viewport.
+	//! @see project(int, const Vec3d*, Vec3f*, bool*)
+	void project(int n, const Vec3f* in, Vec3f* out, bool* valid=NULL) const {projectBatch(n, in, out, valid);}
 
 	//! Project the vector v from the current frame into the viewport.
 	//! @param vd the vector in the current frame.
@@ -291,6 +323,18 @@ protected:
 	//! Initialize the bounding cap.
 	virtual void computeBoundingCap();
 
+	//! Project an array of vectors, see project(int, const Vec3d*, Vec3f*, bool*).
+	//! The default implementation calls the virtual forward() methods for each vector. The projection
+	//! classes override it with projectBatchImpl() to get a loop specialized for their own forward().
+	virtual void projectBatch(int n, const Vec3d* in, Vec3f* out, bool* valid) const;
+	virtual void projectBatch(int n, const Vec3f* in, Vec3f* out, bool* valid) const;
+
+	//! Batch projection loop specialized at compile time for the projection class P.
+	//! The model view transformation is selected once for the whole array: the linear and refraction
+	//! transformations are applied without virtual call, and the viewport mapping is done in the same loop.
+	//! Only instantiated in StelProjectorClasses.cpp.
+	template <class P, class V> static void projectBatchImpl(const P& prj, int n, const V* in, Vec3f* out, bool* valid);
+
 	ModelViewTranformP modelViewTransform;	// Operator to apply (if not NULL) before the modelview projection step
 
 	float flipHorz,flipVert;            // Whether to flip in horizontal or vertical directions
@@ -19,6 +19,116 @@
 
 #include "StelProjectorClasses.hpp"
 #include "StelTranslator.hpp"
+#include "RefractionExtinction.hpp"
+
+/*************************************************************************
+ Batch projection. The model view transformation functors below are applied
+ without virtual call, and projectKernel() is instantiated for each projection
+ class so that its forward() method can be inlined in the loop.
+*************************************************************************/
+
+struct BatchLinearForward
+{
+	BatchLinearForward(const StelProjector::Mat4dTransform* t) : m(t->getMatrix()), mf(t->getMatrixf()) {;}
+	void operator()(Vec3d& v) const {v.transfo4d(m);}
+	void operator()(Vec3f& v) const {v.transfo4d(mf);}
+	const Mat4d& m;
+	const Mat4f& mf;
+};
+
+struct BatchRefractionForward
+{
+	BatchRefractionForward(const Refraction* r) : refraction(r) {;}
+	template <class V> void operator()(V& v) const {refraction->Refraction::forward(v);}
+	const Refraction* refraction;
+};
+
+struct BatchGenericForward
+{
+	BatchGenericForward(const StelProjector::ModelViewTranform* t) : transfo(t) {;}
+	template <class V> void operator()(V& v) const {transfo->forward(v);}
+	const StelProjector::ModelViewTranform* transfo;
+};
+
+//! Parameters of the mapping from the projection plane to the viewport.
+struct BatchViewportMapping
+{
+	float centerX, centerY;
+	float scaleX, scaleY;
+	float zNear, zScale;
+};
+
+template <class MV> static inline void modelViewForward(const MV& mv, const Vec3d& in, Vec3f& out)
+{
+	Vec3d v(in);
+	mv(v);
+	out.set(v[0], v[1], v[2]);
+}
+
+template <class MV> static inline void modelViewForward(const MV& mv, const Vec3f& in, Vec3f& out)
+{
+	out = in;
+	mv(out);
+}
+
+template <class P, class MV, class V>
+static void projectKernel(const P& prj, const MV& mv, const BatchViewportMapping& vm, int n, const V* in, Vec3f* out, bool* valid)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		Vec3f& w = out[i];
+		modelViewForward(mv, in[i], w);
+		const bool rval = prj.P::forward(w);
+		if (valid)
+			valid[i] = rval;
+		w[0] = vm.centerX + vm.scaleX * w[0];
+		w[1] = vm.centerY + vm.scaleY * w[1];
+		w[2] = (w[2] - vm.zNear) * vm.zScale;
+	}
+}
+
+template <class P, class V>
+void StelProjector::projectBatchImpl(const P& prj, int n, const V* in, Vec3f* out, bool* valid)
+{
+	BatchViewportMapping vm;
+	vm.centerX = prj.viewportCenter[0];
+	vm.centerY = prj.viewportCenter[1];
+	vm.scaleX = prj.flipHorz * prj.pixelPerRad;
+	vm.scaleY = prj.flipVert * prj.pixelPerRad;
+	vm.zNear = prj.zNear;
+	vm.zScale = prj.oneOverZNearMinusZFar;
+
+	// Select the model view transformation once for the whole array
+	const ModelViewTranform* transfo = prj.modelViewTransform.data();
+	if (const Mat4dTransform* t = dynamic_cast<const Mat4dTransform*>(transfo))
+		projectKernel(prj, BatchLinearForward(t), vm, n, in, out, valid);
+	else if (const Refraction* r = dynamic_cast<const Refraction*>(transfo))
+		projectKernel(prj, BatchRefractionForward(r), vm, n, in, out, valid);
+	else
+		projectKernel(prj, BatchGenericForward(transfo), vm, n, in, out, valid);
+}
+
+#define STEL_PROJECTOR_BATCH(ProjectorClass) \
+void ProjectorClass::projectBatch(int n, const Vec3d* in, Vec3f* out, bool* valid) const \
+{ \
+	projectBatchImpl(*this, n, in, out, valid); \
+} \
+void ProjectorClass::projectBatch(int n, const Vec3f* in, Vec3f* out, bool* valid) const \
+{ \
+	projectBatchImpl(*this, n, in, out, valid); \
+}
+
+STEL_PROJECTOR_BATCH(StelProjectorPerspective)
+STEL_PROJECTOR_BATCH(StelProjectorEqualArea)
+STEL_PROJECTOR_BATCH(StelProjectorStereographic)
+STEL_PROJECTOR_BATCH(StelProjectorFisheye)
+STEL_PROJECTOR_BATCH(StelProjectorHammer)
+STEL_PROJECTOR_BATCH(StelProjectorCylinder)
+STEL_PROJECTOR_BATCH(StelProjectorMercator)
+STEL_PROJECTOR_BATCH(StelProjectorOrthographic)
+STEL_PROJECTOR_BATCH(StelProjector2d)
+#undef STEL_PROJECTOR_BATCH
+
 
 QString StelProjectorPerspective::getNameI18() const
 {
@@ -408,3 +518,122 @@ float StelProjector2d::deltaZoom(float fov) const
 	return fov;
 }
 
+/*************************************************************************
+ GLSL versions of the forward() methods, used by StelPainter to project
+ the vertices on the GPU. They must give the same results as the CPU code.
+ The invalid positions which are set to FLT_MAX on the CPU use a large
+ value which does not overflow once scaled to pixels.
+*************************************************************************/
+
+static const char perspectiveShaderSource[] =
+	"vec3 projectorForward(vec3 v)\n"
+	"{\n"
+	"    float r = length(v);\n"
+	"    if (v.z != 0.)\n"
+	"        return vec3(v.xy/abs(v.z), r);\n"
+	"    return vec3(1e30, 1e30, r);\n"
+	"}\n";
+
+const char* StelProjectorPerspective::getForwardShaderSource() const
+{
+	return perspectiveShaderSource;
+}
+
+static const char equalAreaShaderSource[] =
+	"vec3 projectorForward(vec3 v)\n"
+	"{\n"
+	"    float r = length(v);\n"
+	"    float f = sqrt(2./(r*(r-v.z)));\n"
+	"    return vec3(v.xy*f, r);\n"
+	"}\n";
+
+const char* StelProjectorEqualArea::getForwardShaderSource() const
+{
+	return equalAreaShaderSource;
+}
+
+static const char stereographicShaderSource[] =
+	"vec3 projectorForward(vec3 v)\n"
+	"{\n"
+	"    float r = length(v);\n"
+	"    float h = 0.5*(r-v.z);\n"
+	"    if (h <= 0.)\n"
+	"        return vec3(1e30, 1e30, 0.);\n"
+	"    return vec3(v.xy/h, r);\n"
+	"}\n";
+
+const char* StelProjectorStereographic::getForwardShaderSource() const
+{
+	return stereographicShaderSource;
+}
+
+static const char fisheyeShaderSource[] =
+	"vec3 projectorForward(vec3 v)\n"
+	"{\n"
+	"    float rq1 = dot(v.xy, v.xy);\n"
+	"    if (rq1 > 0.)\n"
+	"    {\n"
+	"        float h = sqrt(rq1);\n"
+	"        return vec3(v.xy*(atan(h, -v.z)/h), sqrt(rq1 + v.z*v.z));\n"
+	"    }\n"
+	"    if (v.z < 0.)\n"
+	"        return vec3(0., 0., 1.);\n"
+	"    return vec3(1e30, 1e30, 0.);\n"
+	"}\n";
+
+const char* StelProjectorFisheye::getForwardShaderSource() const
+{
+	return fisheyeShaderSource;
+}
+
+static const char hammerShaderSource[] =
+	"vec3 projectorForward(vec3 v)\n"
+	"{\n"
+	"    float r = length(v);\n"
+	"    float alpha = atan(v.x, -v.z);\n"
+	"    float cosDelta = sqrt(1. - v.y*v.y/(r*r));\n"
+	"    float z = sqrt(1. + cosDelta*cos(alpha/2.));\n"
+	"    return vec3(2.*1.4142135623730951*cosDelta*sin(alpha/2.)/z, 1.4142135623730951*v.y/r/z, r);\n"
+	"}\n";
+
+const char* StelProjectorHammer::getForwardShaderSource() const
+{
+	return hammerShaderSource;
+}
+
+static const char cylinderShaderSource[] =
+	"vec3 projectorForward(vec3 v)\n"
+	"{\n"
+	"    float r = length(v);\n"
+	"    return vec3(atan(v.x, -v.z), asin(v.y/r), r);\n"
+	"}\n";
+
+const char* StelProjectorCylinder::getForwardShaderSource() const
+{
+	return cylinderShaderSource;
+}
+
+static const char mercatorShaderSource[] =
+	"vec3 projectorForward(vec3 v)\n"
+	"{\n"
+	"    float r = length(v);\n"
+	"    float sinDelta = v.y/r;\n"
+	"    return vec3(atan(v.x, -v.z), 0.5*log((1.+sinDelta)/(1.-sinDelta)), r);\n"
+	"}\n";
+
+const char* StelProjectorMercator::getForwardShaderSource() const
+{
+	return mercatorShaderSource;
+}
+
+static const char orthographicShaderSource[] =
+	"vec3 projectorForward(vec3 v)\n"
+	"{\n"
+	"    float r = length(v);\n"
+	"    return vec3(v.xy/r, r);\n"
+	"}\n";
+
+const char* StelProjectorOrthographic::getForwardShaderSource() const
+{
+	return orthographicShaderSource;
+}
@@ -51,10 +51,13 @@ public:
 		return false;
 	}
 	bool backward(Vec3d &v) const;
+	const char* getForwardShaderSource() const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void projectBatch(int n, const Vec3d* in, Vec3f* out, bool* valid) const;
+	virtual void projectBatch(int n, const Vec3f* in, Vec3f* out, bool* valid) const;
 	virtual bool hasDiscontinuity() const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, const Vec3d&) const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, double) const {return false;}
@@ -77,10 +80,13 @@ public:
 		return true;
 	}
 	bool backward(Vec3d &v) const;
+	const char* getForwardShaderSource() const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void projectBatch(int n, const Vec3d* in, Vec3f* out, bool* valid) const;
+	virtual void projectBatch(int n, const Vec3f* in, Vec3f* out, bool* valid) const;
 	virtual bool hasDiscontinuity() const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, const Vec3d&) const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, double) const {return false;}
@@ -110,26 +116,14 @@ public:
 		return true;
 	}
 
-	virtual void project(int n, const Vec3d* in, Vec3f* out)
-	{
-		Vec3d v;
-		for (int i = 0; i < n; ++i, ++out)
-		{
-			v = in[i];
-			modelViewTransform->forward(v);
-			out->set(v[0], v[1], v[2]);
-			StelProjectorStereographic::forward(*out);
-			out->set(viewportCenter[0] + flipHorz * pixelPerRad * (*out)[0],
-				viewportCenter[1] + flipVert * pixelPerRad * (*out)[1],
-				((*out)[2] - zNear) * oneOverZNearMinusZFar);
-		}
-	}
-
 	bool backward(Vec3d &v) const;
+	const char* getForwardShaderSource() const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void projectBatch(int n, const Vec3d* in, Vec3f* out, bool* valid) const;
+	virtual void projectBatch(int n, const Vec3f* in, Vec3f* out, bool* valid) const;
 	virtual bool hasDiscontinuity() const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, const Vec3d&) const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, double) const {return false;}
@@ -165,10 +159,13 @@ public:
 		return false;
 	}
 	bool backward(Vec3d &v) const;
+	const char* getForwardShaderSource() const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void projectBatch(int n, const Vec3d* in, Vec3f* out, bool* valid) const;
+	virtual void projectBatch(int n, const Vec3f* in, Vec3f* out, bool* valid) const;
 	virtual bool hasDiscontinuity() const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, const Vec3d&) const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, double) const {return false;}
@@ -181,20 +178,6 @@ public:
 	virtual QString getNameI18() const;
 	virtual QString getDescriptionI18() const;
 	virtual float getMaxFov() const {return 360.f;}
-	virtual void project(int n, const Vec3d* in, Vec3f* out)
-	{
-		Vec3d v;
-		for (int i = 0; i < n; ++i)
-		{
-			v = in[i];
-			modelViewTransform->forward(v);
-			out[i].set(v[0], v[1], v[2]);
-			StelProjectorHammer::forward(out[i]);
-			out[i][0] = viewportCenter[0] + flipHorz * pixelPerRad * out[i][0];
-			out[i][1] = viewportCenter[1] + flipVert * pixelPerRad * out[i][1];
-			out[i][2] = (out[i][2] - zNear) * oneOverZNearMinusZFar;
-		}
-	}
 	bool forward(Vec3f &v) const
 	{
 		// Hammer Aitoff
@@ -208,10 +191,13 @@ public:
 		return true;
 	}
 	bool backward(Vec3d &v) const;
+	const char* getForwardShaderSource() const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void projectBatch(int n, const Vec3d* in, Vec3f* out, bool* valid) const;
+	virtual void projectBatch(int n, const Vec3f* in, Vec3f* out, bool* valid) const;
 	virtual bool hasDiscontinuity() const {return true;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d& p1, const Vec3d& p2) const {return p1[0]*p2[0]<0 && !(p1[2]<0 && p2[2]<0);}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d& capN, double capD) const
@@ -233,10 +219,13 @@ public:
 	virtual float getMaxFov() const {return 175.f * 4.f/3.f;} // assume aspect ration of 4/3 for getting a full 360 degree horizon
 	bool forward(Vec3f &win) const;
 	bool backward(Vec3d &v) const;
+	const char* getForwardShaderSource() const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void projectBatch(int n, const Vec3d* in, Vec3f* out, bool* valid) const;
+	virtual void projectBatch(int n, const Vec3f* in, Vec3f* out, bool* valid) const;
 	virtual bool hasDiscontinuity() const {return true;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d& p1, const Vec3d& p2) const
 	{
@@ -261,10 +250,13 @@ public:
 	virtual float getMaxFov() const {return 175.f * 4.f/3.f;} // assume aspect ration of 4/3 for getting a full 360 degree horizon
 	bool forward(Vec3f &win) const;
 	bool backward(Vec3d &v) const;
+	const char* getForwardShaderSource() const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void projectBatch(int n, const Vec3d* in, Vec3f* out, bool* valid) const;
+	virtual void projectBatch(int n, const Vec3f* in, Vec3f* out, bool* valid) const;
 	virtual bool hasDiscontinuity() const {return true;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d& p1, const Vec3d& p2) const
 	{
@@ -289,10 +281,13 @@ public:
 	virtual float getMaxFov() const {return 179.9999f;}
 	bool forward(Vec3f &win) const;
 	bool backward(Vec3d &v) const;
+	const char* getForwardShaderSource() const;
 	float fovToViewScalingFactor(float fov) const;
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void projectBatch(int n, const Vec3d* in, Vec3f* out, bool* valid) const;
+	virtual void projectBatch(int n, const Vec3f* in, Vec3f* out, bool* valid) const;
 	virtual bool hasDiscontinuity() const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, const Vec3d&) const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, double) const {return false;}
@@ -311,6 +306,8 @@ public:
 	float viewScalingFactorToFov(float vsf) const;
 	float deltaZoom(float fov) const;
 protected:
+	virtual void projectBatch(int n, const Vec3d* in, Vec3f* out, bool* valid) const;
+	virtual void projectBatch(int n, const Vec3f* in, Vec3f* out, bool* valid) const;
 	virtual bool hasDiscontinuity() const {return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, const Vec3d&) const {Q_ASSERT(0); return false;}
 	virtual bool intersectViewportDiscontinuityInternal(const Vec3d&, double) const {Q_ASSERT(0); return false;}
@@ -0,0 +1,246 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelRecordReader.hpp"
+
+#include <cstring>
+
+static inline bool isSpace(char c)
+{
+	return c==' ' || c=='\t' || c=='\r' || c=='\n' || c=='\f' || c=='\v';
+}
+
+StelRecordReader::Field StelRecordReader::Field::trimmed() const
+{
+	const char* first = b;
+	const char* last = e;
+	while (first<last && isSpace(*first))
+		++first;
+	while (last>first && isSpace(*(last-1)))
+		--last;
+	return Field(first, last);
+}
+
+StelRecordReader::Field StelRecordReader::Field::mid(int pos, int n) const
+{
+	if (pos<0)
+		pos = 0;
+	if (pos>=size())
+		return Field(e, e);
+	if (n<0 || pos+n>size())
+		return Field(b+pos, e);
+	return Field(b+pos, b+pos+n);
+}
+
+StelRecordReader::Field StelRecordReader::Field::columns(int pos, int n) const
+{
+	// Count the characters by skipping the UTF-8 continuation bytes
+	const char* first = b;
+	for (int i=0;i<pos && first<e;++i)
+	{
+		++first;
+		while (first<e && (*first & 0xc0)==0x80)
+			++first;
+	}
+	if (n<0)
+		return Field(first, e);
+	const char* last = first;
+	for (int i=0;i<n && last<e;++i)
+	{
+		++last;
+		while (last<e && (*last & 0xc0)==0x80)
+			++last;
+	}
+	return Field(first, last);
+}
+
+bool StelRecordReader::Field::startsWith(const char* s) const
+{
+	const int n = (int)strlen(s);
+	return n<=size() && memcmp(b, s, n)==0;
+}
+
+bool StelRecordReader::Field::endsWith(const char* s) const
+{
+	const int n = (int)strlen(s);
+	return n<=size() && memcmp(e-n, s, n)==0;
+}
+
+int StelRecordReader::Field::indexOf(char c) const
+{
+	const char* p = (const char*)memchr(b, c, size());
+	return p ? (int)(p-b) : -1;
+}
+
+int StelRecordReader::Field::lastIndexOf(const char* s) const
+{
+	const int n = (int)strlen(s);
+	for (const char* p=e-n;p>=b;--p)
+	{
+		if (memcmp(p, s, n)==0)
+			return (int)(p-b);
+	}
+	return -1;
+}
+
+int StelRecordReader::Field::count(char c) const
+{
+	int res = 0;
+	for (const char* p=b;p<e;++p)
+	{
+		if (*p==c)
+			++res;
+	}
+	return res;
+}
+
+StelRecordReader::Field StelRecordReader::Field::takeUntil(char sep)
+{
+	const int i = indexOf(sep);
+	if (i<0)
+	{
+		const Field res(*this);
+		b = e;
+		return res;
+	}
+	const Field res(b, b+i);
+	b += i+1;
+	return res;
+}
+
+StelRecordReader::Field StelRecordReader::Field::takeWord()
+{
+	while (b<e && isSpace(*b))
+		++b;
+	const char* first = b;
+	while (b<e && !isSpace(*b))
+		++b;
+	return Field(first, b);
+}
+
+StelRecordReader::Field StelRecordReader::Field::unwrapped(const char* prefix, const char* suffix, bool* ok) const
+{
+	const int prefixSize = (int)strlen(prefix);
+	const int suffixSize = (int)strlen(suffix);
+	const bool enclosed = prefixSize+suffixSize<=size() && startsWith(prefix) && endsWith(suffix);
+	if (ok)
+		*ok = enclosed;
+	return enclosed ? Field(b+prefixSize, e-suffixSize) : *this;
+}
+
+int StelRecordReader::Field::toInt(bool* ok) const
+{
+	const Field f = trimmed();
+	const char* p = f.b;
+	bool negative = false;
+	if (p<f.e && (*p=='-' || *p=='+'))
+	{
+		negative = *p=='-';
+		++p;
+	}
+	qint64 v = 0;
+	bool valid = p<f.e;
+	for (;p<f.e && valid;++p)
+	{
+		valid = *p>='0' && *p<='9' && v<=0x7fffffffLL;
+		v = v*10 + (*p-'0');
+	}
+	if (negative)
+		v = -v;
+	valid = valid && v>=-0x80000000LL && v<=0x7fffffffLL;
+	if (ok)
+		*ok = valid;
+	return valid ? (int)v : 0;
+}
+
+unsigned int StelRecordReader::Field::toUInt(bool* ok) const
+{
+	const Field f = trimmed();
+	const char* p = f.b;
+	if (p<f.e && *p=='+')
+		++p;
+	quint64 v = 0;
+	bool valid = p<f.e;
+	for (;p<f.e && valid;++p)
+	{
+		valid = *p>='0' && *p<='9' && v<=0xffffffffULL;
+		v = v*10 + (*p-'0');
+	}
+	valid = valid && v<=0xffffffffULL;
+	if (ok)
+		*ok = valid;
+	return valid ? (unsigned int)v : 0;
+}
+
+double StelRecordReader::Field::toDouble(bool* ok) const
+{
+	const Field f = trimmed();
+	// QByteArray::toDouble() is independent of the locale
+	return QByteArray::fromRawData(f.b, f.size()).toDouble(ok);
+}
+
+StelRecordReader::StelRecordReader(const QString& fileName)
+	: file(fileName), pos(NULL), end(NULL), lineNumber(0), opened(false)
+{
+	if (!file.open(QIODevice::ReadOnly))
+		return;
+	opened = true;
+	const qint64 size = file.size();
+	if (size<=0)
+		return;
+	// Files from the resources or the Android assets can't be mapped
+	const uchar* data = file.map(0, size);
+	if (data)
+	{
+		pos = (const char*)data;
+		end = pos+size;
+	}
+	else
+	{
+		content = file.readAll();
+		file.close();
+		pos = content.constData();
+		end = pos+content.size();
+	}
+	// Skip the UTF-8 byte order mark
+	if (end-pos>=3 && memcmp(pos, "\xef\xbb\xbf", 3)==0)
+		pos += 3;
+}
+
+bool StelRecordReader::readLine(Field& line)
+{
+	if (pos>=end)
+		return false;
+	const char* eol = (const char*)memchr(pos, '\n', end-pos);
+	const char* next = eol ? eol+1 : end;
+	if (!eol)
+		eol = end;
+	if (eol>pos && *(eol-1)=='\r')
+		--eol;
+	line = Field(pos, eol);
+	pos = next;
+	++lineNumber;
+	return true;
+}
+
+bool StelRecordReader::isComment(const Field& line)
+{
+	const Field f = line.trimmed();
+	return f.isEmpty() || *f.begin()=='#';
+}
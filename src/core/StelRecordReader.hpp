@@ -0,0 +1,131 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELRECORDREADER_HPP_
+#define _STELRECORDREADER_HPP_
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+//! @class StelRecordReader
+//! Single pass reader of the line oriented UTF-8 data files such as the star, constellation
+//! and nebula names. The file is memory mapped when possible, else it is read at once, and
+//! the lines and their fields are returned as ranges of bytes of this buffer so that no
+//! string is created until a field is actually stored.
+//! Typical use:
+//! @code
+//! StelRecordReader reader(fileName);
+//! StelRecordReader::Field line;
+//! while (reader.readLine(line))
+//! {
+//! 	if (StelRecordReader::isComment(line))
+//! 		continue;
+//! 	const int hip = line.takeUntil('|').toInt();
+//! 	const QString name = line.trimmed().toString();
+//! }
+//! @endcode
+class StelRecordReader
+{
+public:
+	//! A range of bytes of the buffer of a reader, only valid while the reader exists.
+	//! Positions and sizes are in bytes, except for columns() which counts characters.
+	class Field
+	{
+	public:
+		Field() : b(NULL), e(NULL) {}
+		Field(const char* begin, const char* end) : b(begin), e(end) {}
+
+		const char* begin() const {return b;}
+		const char* end() const {return e;}
+		int size() const {return (int)(e-b);}
+		bool isEmpty() const {return b==e;}
+
+		//! Return the field without the leading and trailing spaces, tabs and carriage returns.
+		Field trimmed() const;
+		//! Return the n bytes starting at pos, or up to the end if n is negative.
+		Field mid(int pos, int n=-1) const;
+		//! Return the n characters starting at the character pos for fixed width records
+		//! containing multi-bytes UTF-8 characters, or up to the end if n is negative.
+		Field columns(int pos, int n=-1) const;
+
+		bool startsWith(const char* s) const;
+		bool endsWith(const char* s) const;
+		//! Return the position of the first occurrence of c, or -1.
+		int indexOf(char c) const;
+		//! Return the position of the last occurrence of s, or -1.
+		int lastIndexOf(const char* s) const;
+		//! Return the number of occurrences of c.
+		int count(char c) const;
+
+		//! Return the text before the first occurrence of sep, and remove it together
+		//! with the separator from this field. If sep is not found the whole field is
+		//! returned and this field becomes empty.
+		Field takeUntil(char sep);
+		//! Skip the leading whitespaces, then return and remove the following word.
+		Field takeWord();
+		//! Return the content between prefix and suffix if the field starts with prefix and
+		//! ends with suffix, e.g. unwrapped("_(\"", "\")") for a translatable string.
+		//! @param ok set to false and the whole field returned if it is not enclosed.
+		Field unwrapped(const char* prefix, const char* suffix, bool* ok=NULL) const;
+
+		//! Convert the field to numbers ignoring the surrounding whitespaces.
+		//! They return 0 and set ok to false if the field is not a valid number.
+		int toInt(bool* ok=NULL) const;
+		unsigned int toUInt(bool* ok=NULL) const;
+		double toDouble(bool* ok=NULL) const;
+		float toFloat(bool* ok=NULL) const {return (float)toDouble(ok);}
+
+		//! Decode the field as UTF-8.
+		QString toString() const {return QString::fromUtf8(b, size());}
+		//! Return the raw bytes of the field.
+		QByteArray toByteArray() const {return QByteArray(b, size());}
+
+	private:
+		const char* b;
+		const char* e;
+	};
+
+	//! Open the file. Use isOpen() to check for errors.
+	StelRecordReader(const QString& fileName);
+
+	//! Return false if the file could not be opened or read.
+	bool isOpen() const {return opened;}
+
+	//! Return the next line without its end of line characters.
+	//! @return false at the end of the file.
+	bool readLine(Field& line);
+
+	//! Return the 1-based number of the last line returned by readLine().
+	int getLineNumber() const {return lineNumber;}
+
+	//! Return true if the line is empty, contains only whitespaces or is a # comment.
+	static bool isComment(const Field& line);
+
+private:
+	QFile file;
+	//! The content of the file when it can't be mapped
+	QByteArray content;
+	const char* pos;
+	const char* end;
+	int lineNumber;
+	bool opened;
+};
+
+#endif // _STELRECORDREADER_HPP_
@@ -0,0 +1,427 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelRiseSetCalculator.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelObject.hpp"
+#include "StelObjectMgr.hpp"
+#include "StelSkyDrawer.hpp"
+#include "StelUtils.hpp"
+#include "LandscapeMgr.hpp"
+#include "Planet.hpp"
+#include "SolarSystem.hpp"
+
+#include <QDebug>
+#include <QRunnable>
+#include <QThreadPool>
+#include <cmath>
+
+// Precision of the computed dates, 0.5 second
+static const double dateTolerance = 0.5/86400.;
+
+static double getAltitude(const Vec3d& altAzPos)
+{
+	return std::asin(altAzPos[2]/altAzPos.length());
+}
+
+static QVariantList datesToVariant(const QVector<double>& dates)
+{
+	QVariantList list;
+	foreach (double jd, dates)
+		list.append(StelUtils::julianDayToISO8601String(jd));
+	return list;
+}
+
+QVariantMap StelRiseSetCalculator::Result::toVariantMap() const
+{
+	QVariantMap map;
+	map.insert("name", object ? object->getEnglishName() : QString());
+	map.insert("rise", datesToVariant(rises));
+	map.insert("transit", datesToVariant(transits));
+	map.insert("set", datesToVariant(sets));
+	QVariantList altitudes;
+	foreach (double alt, transitAltitudes)
+		altitudes.append(alt);
+	map.insert("transit-altitude", altitudes);
+	QVariantList windowList;
+	foreach (const Vec2d& w, windows)
+	{
+		QVariantMap window;
+		window.insert("start", StelUtils::julianDayToISO8601String(w[0]));
+		window.insert("end", StelUtils::julianDayToISO8601String(w[1]));
+		window.insert("hours", (w[1]-w[0])*24.);
+		windowList.append(window);
+	}
+	map.insert("windows", windowList);
+	map.insert("circumpolar", circumpolar);
+	map.insert("never-rises", neverRises);
+	return map;
+}
+
+// Compute the events of a range of tracks in a worker thread
+class StelRiseSetCalculator::ComputeTask : public QRunnable
+{
+public:
+	ComputeTask(const StelRiseSetCalculator* calculator, const Track* tracks, Result* results, int count)
+		: calculator(calculator), tracks(tracks), results(results), count(count) {}
+	virtual void run()
+	{
+		for (int i=0;i<count;++i)
+			calculator->computeTrack(tracks[i], results[i]);
+	}
+private:
+	const StelRiseSetCalculator* calculator;
+	const Track* tracks;
+	Result* results;
+	int count;
+};
+
+StelRiseSetCalculator::StelRiseSetCalculator(StelCore* acore) : core(acore), landscapeMgr(NULL), ephemStartJD(0.), ephemStep(1./24.)
+{
+}
+
+void StelRiseSetCalculator::prepare(const QList<StelObjectP>& objects, QVector<Track>& tracks)
+{
+	// The observer frame at each sample. The rotation of the observer around the polar axis
+	// is interpolated between the samples, the nutation changing too slowly to matter.
+	ephemStartJD = params.startJD;
+	const int nbSamples = (int)std::ceil((params.endJD-params.startJD)/ephemStep)+2;
+	equToAltAz.resize(nbSamples);
+	rotationSteps.resize(nbSamples-1);
+	double prevAngle = 0.;
+	for (int k=0;k<nbSamples;++k)
+	{
+		const Mat4d m = core->getAltAzToEquinoxEquMatrix(ephemStartJD+k*ephemStep);
+		equToAltAz[k] = m.transpose();
+		// The alt-az Y axis stays in the equatorial plane
+		const Vec3d y = m.multiplyWithoutTranslation(Vec3d(0., 1., 0.));
+		const double angle = std::atan2(-y[0], y[1]);
+		if (k>0)
+		{
+			double step = angle-prevAngle;
+			while (step>M_PI)
+				step -= 2.*M_PI;
+			while (step<=-M_PI)
+				step += 2.*M_PI;
+			rotationSteps[k-1] = step;
+		}
+		prevAngle = angle;
+	}
+
+	QVector<int> moving;
+	QVector<Planet*> planets;
+	tracks.resize(objects.size());
+	for (int i=0;i<objects.size();++i)
+	{
+		const StelObjectP& obj = objects.at(i);
+		Planet* planet = dynamic_cast<Planet*>(obj.data());
+		if (planet==core->getCurrentPlanet().data() || obj->getType()=="Satellite")
+		{
+			qWarning() << "StelRiseSetCalculator: cannot compute the events of" << obj->getEnglishName();
+			continue;
+		}
+		if (planet)
+		{
+			moving.append(i);
+			planets.append(planet);
+			tracks[i].directions.resize(nbSamples);
+			continue;
+		}
+		Vec3d v = core->j2000ToEquinoxEqu(obj->getJ2000EquatorialPos(core));
+		v.normalize();
+		tracks[i].directions.append(v);
+	}
+	if (moving.isEmpty())
+		return;
+
+	// Compute the solar system at each sample, then restore the current date
+	SolarSystem* ssystem = GETSTELMODULE(SolarSystem);
+	const Vec3d savedObserverPos = core->getCurrentPlanet()->getHeliocentricEclipticPos();
+	// The light time correction of each sample uses the observer position of the previous one.
+	// Prime it with the observer at the first sample rather than at the current sky date.
+	ssystem->computePositions(ephemStartJD, savedObserverPos);
+	Vec3d observerPos = core->getObserverHeliocentricEclipticPos(ephemStartJD);
+	for (int k=0;k<nbSamples;++k)
+	{
+		const double jd = ephemStartJD+k*ephemStep;
+		ssystem->computePositions(jd, observerPos);
+		observerPos = core->getObserverHeliocentricEclipticPos(jd);
+		for (int i=0;i<moving.size();++i)
+		{
+			const Vec3d j2000Pos = StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(planets.at(i)->getHeliocentricEclipticPos()-observerPos);
+			Vec3d v = core->j2000ToEquinoxEqu(j2000Pos);
+			v.normalize();
+			tracks[moving.at(i)].directions[k] = v;
+		}
+	}
+	ssystem->computePositions(core->getJDay(), savedObserverPos);
+}
+
+Vec3d StelRiseSetCalculator::getAltAzPos(const Track& track, double jd) const
+{
+	const double x = (jd-ephemStartJD)/ephemStep;
+	const int k = qBound(0, (int)std::floor(x), equToAltAz.size()-2);
+	const double u = x-k;
+	Vec3d d = track.directions.at(0);
+	if (track.directions.size()>1)
+		d = track.directions.at(k)*(1.-u) + track.directions.at(k+1)*u;
+	// Rotate back by the rotation of the observer since the sample
+	const double a = u*rotationSteps.at(k);
+	const double c = std::cos(a);
+	const double s = std::sin(a);
+	Vec3d v = equToAltAz.at(k).multiplyWithoutTranslation(Vec3d(d[0]*c+d[1]*s, d[1]*c-d[0]*s, d[2]));
+	if (params.flagRefraction)
+		refraction.forward(v);
+	return v;
+}
+
+double StelRiseSetCalculator::getMargin(const Track& track, const Vec3d& altAzPos) const
+{
+	double threshold = track.threshold;
+	if (track.flagLandscape && landscapeMgr)
+	{
+		const double azimuth = 180.-std::atan2(altAzPos[1], altAzPos[0])*180./M_PI;
+		threshold = qMax(threshold, landscapeMgr->getHorizonAltitude(azimuth)*M_PI/180.);
+	}
+	return getAltitude(altAzPos)-threshold;
+}
+
+double StelRiseSetCalculator::findCrossing(const Track& track, double jd0, double f0, double jd1, double f1) const
+{
+	// Regula falsi with the Illinois modification, the crossing stays bracketed
+	int side = 0;
+	for (int i=0;i<50 && jd1-jd0>dateTolerance;++i)
+	{
+		const double jd = jd1-f1*(jd1-jd0)/(f1-f0);
+		const double f = getMargin(track, getAltAzPos(track, jd));
+		if ((f>0.)==(f1>0.))
+		{
+			jd1 = jd;
+			f1 = f;
+			if (side==-1)
+				f0 *= 0.5;
+			side = -1;
+		}
+		else
+		{
+			jd0 = jd;
+			f0 = f;
+			if (side==1)
+				f1 *= 0.5;
+			side = 1;
+		}
+	}
+	return 0.5*(jd0+jd1);
+}
+
+double StelRiseSetCalculator::findTransit(const Track& track, double jd0, double jd1) const
+{
+	// Golden section search of the maximum altitude
+	static const double invPhi = 0.6180339887498949;
+	double a = jd1-(jd1-jd0)*invPhi;
+	double b = jd0+(jd1-jd0)*invPhi;
+	double fa = getAltitude(getAltAzPos(track, a));
+	double fb = getAltitude(getAltAzPos(track, b));
+	while (jd1-jd0>dateTolerance)
+	{
+		if (fa>fb)
+		{
+			jd1 = b;
+			b = a;
+			fb = fa;
+			a = jd1-(jd1-jd0)*invPhi;
+			fa = getAltitude(getAltAzPos(track, a));
+		}
+		else
+		{
+			jd0 = a;
+			a = b;
+			fa = fb;
+			b = jd0+(jd1-jd0)*invPhi;
+			fb = getAltitude(getAltAzPos(track, b));
+		}
+	}
+	return 0.5*(jd0+jd1);
+}
+
+void StelRiseSetCalculator::computeTrack(const Track& track, Result& result) const
+{
+	if (track.directions.isEmpty())
+		return;
+	const int n = qMax(2, (int)std::ceil((params.endJD-params.startJD)/params.scanStep)+1);
+	const double step = (params.endJD-params.startJD)/(n-1);
+	QVector<double> altitudes(n), margins(n);
+	for (int i=0;i<n;++i)
+	{
+		const Vec3d v = getAltAzPos(track, params.startJD+i*step);
+		altitudes[i] = getAltitude(v);
+		margins[i] = getMargin(track, v);
+	}
+
+	bool above = margins.at(0)>0.;
+	double windowStart = params.startJD;
+	for (int i=1;i<n;++i)
+	{
+		if ((margins.at(i)>0.)==above)
+			continue;
+		const double jd0 = params.startJD+(i-1)*step;
+		const double jd = findCrossing(track, jd0, margins.at(i-1), jd0+step, margins.at(i));
+		if (above)
+		{
+			result.sets.append(jd);
+			result.windows.append(Vec2d(windowStart, jd));
+		}
+		else
+		{
+			result.rises.append(jd);
+			windowStart = jd;
+		}
+		above = !above;
+	}
+	if (above)
+		result.windows.append(Vec2d(windowStart, params.endJD));
+	const bool noCrossing = result.rises.isEmpty() && result.sets.isEmpty();
+	result.circumpolar = noCrossing && margins.at(0)>0.;
+	result.neverRises = noCrossing && !result.circumpolar;
+
+	for (int i=1;i<n-1;++i)
+	{
+		if (altitudes.at(i)>altitudes.at(i-1) && altitudes.at(i)>=altitudes.at(i+1))
+		{
+			const double jd = findTransit(track, params.startJD+(i-1)*step, params.startJD+(i+1)*step);
+			result.transits.append(jd);
+			result.transitAltitudes.append(getAltitude(getAltAzPos(track, jd))*180./M_PI);
+		}
+	}
+}
+
+QVector<Vec2d> StelRiseSetCalculator::subtractWindows(const QVector<Vec2d>& windows, const QVector<Vec2d>& excluded)
+{
+	QVector<Vec2d> res;
+	foreach (const Vec2d& w, windows)
+	{
+		double start = w[0];
+		foreach (const Vec2d& e, excluded)
+		{
+			if (e[1]<=start)
+				continue;
+			if (e[0]>=w[1])
+				break;
+			if (e[0]>start)
+				res.append(Vec2d(start, e[0]));
+			start = e[1];
+			if (start>=w[1])
+				break;
+		}
+		if (start<w[1])
+			res.append(Vec2d(start, w[1]));
+	}
+	return res;
+}
+
+QVector<StelRiseSetCalculator::Result> StelRiseSetCalculator::compute(const QList<StelObjectP>& objects, const Params& aparams)
+{
+	params = aparams;
+	QVector<Result> results(objects.size());
+	for (int i=0;i<objects.size();++i)
+		results[i].object = objects.at(i);
+	if (objects.isEmpty() || params.endJD<=params.startJD || params.scanStep<=0.)
+		return results;
+
+	refraction = core->getSkyDrawer()->getRefraction();
+	refraction.setPreTransfoMat(Mat4d::identity());
+	refraction.setPostTransfoMat(Mat4d::identity());
+	landscapeMgr = params.flagLandscape ? GETSTELMODULE(LandscapeMgr) : NULL;
+
+	// The Sun is computed with the objects when the windows are limited to the night
+	QList<StelObjectP> allObjects(objects);
+	const bool limitToNight = params.maxSunAltitude<90.;
+	if (limitToNight)
+		allObjects.append(GETSTELMODULE(SolarSystem)->getSun());
+
+	QVector<Track> tracks;
+	prepare(allObjects, tracks);
+	for (int i=0;i<objects.size();++i)
+	{
+		tracks[i].threshold = params.altitude*M_PI/180.;
+		tracks[i].flagLandscape = params.flagLandscape;
+	}
+	if (limitToNight)
+		tracks.last().threshold = params.maxSunAltitude*M_PI/180.;
+
+	// The main thread computes the last chunk while the pool computes the others
+	QVector<Result> allResults(tracks.size());
+	const int n = tracks.size();
+	QThreadPool pool;
+	const int nbTasks = qMin(pool.maxThreadCount()+1, n);
+	const int chunk = (n+nbTasks-1)/nbTasks;
+	for (int start=0; start<n-chunk; start+=chunk)
+		pool.start(new ComputeTask(this, tracks.constData()+start, allResults.data()+start, chunk));
+	const int last = ((n-1)/chunk)*chunk;
+	ComputeTask(this, tracks.constData()+last, allResults.data()+last, n-last).run();
+	pool.waitForDone();
+
+	for (int i=0;i<objects.size();++i)
+	{
+		Result& r = results[i];
+		r.rises = allResults.at(i).rises;
+		r.transits = allResults.at(i).transits;
+		r.sets = allResults.at(i).sets;
+		r.transitAltitudes = allResults.at(i).transitAltitudes;
+		r.windows = limitToNight ? subtractWindows(allResults.at(i).windows, allResults.last().windows) : allResults.at(i).windows;
+		r.circumpolar = allResults.at(i).circumpolar;
+		r.neverRises = allResults.at(i).neverRises;
+	}
+	return results;
+}
+
+QVariantList StelRiseSetCalculator::compute(const QStringList& names, const Params& aparams)
+{
+	const StelObjectMgr* omgr = GETSTELMODULE(StelObjectMgr);
+	QList<StelObjectP> objects;
+	QVector<int> indices;
+	foreach (const QString& name, names)
+	{
+		const StelObjectP obj = omgr->searchByName(name);
+		indices.append(obj ? objects.size() : -1);
+		if (obj)
+			objects.append(obj);
+	}
+	const QVector<Result> results = compute(objects, aparams);
+
+	QVariantList list;
+	for (int i=0;i<names.size();++i)
+	{
+		QVariantMap map;
+		if (indices.at(i)<0)
+		{
+			map.insert("name", names.at(i));
+			map.insert("found", false);
+		}
+		else
+		{
+			map = results.at(indices.at(i)).toVariantMap();
+			map.insert("found", true);
+		}
+		list.append(map);
+	}
+	return list;
+}
@@ -0,0 +1,138 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELRISESETCALCULATOR_HPP_
+#define _STELRISESETCALCULATOR_HPP_
+
+#include "RefractionExtinction.hpp"
+#include "StelObjectType.hpp"
+#include "VecMath.hpp"
+
+#include <QList>
+#include <QStringList>
+#include <QVariantList>
+#include <QVector>
+
+class StelCore;
+class LandscapeMgr;
+
+//! @class StelRiseSetCalculator
+//! Compute the rise, transit and set times and the visibility windows of many objects over a date range,
+//! without changing the current date of the StelCore.
+//! The apparent altitude of each object is scanned with a fixed step and the crossings of the threshold
+//! altitude are refined by root finding, so that the events of objects staying above the threshold for
+//! less than the scan step can be missed.
+//! The directions of the solar system bodies are computed in the main thread on an hourly grid and
+//! interpolated, other objects are considered fixed on the sky during the range. The precession is the
+//! one of the current date, which is accurate to a few arc seconds over months.
+//! The objects are then processed in parallel by a thread pool.
+class StelRiseSetCalculator
+{
+public:
+	struct Params
+	{
+		Params() : startJD(0.), endJD(0.), altitude(0.), maxSunAltitude(90.), flagRefraction(true),
+			flagLandscape(false), scanStep(10./1440.) {}
+		//! The date range in Julian days (UTC).
+		double startJD, endJD;
+		//! The threshold altitude in degrees.
+		double altitude;
+		//! The visibility windows are limited to when the Sun is below this altitude in degrees,
+		//! e.g. -18 for the astronomical night. 90 means no limit.
+		double maxSunAltitude;
+		//! Whether the atmospheric refraction is applied, as in StelObject::getAltAzPosApparent().
+		bool flagRefraction;
+		//! Whether the objects must also be above the horizon profile of the current landscape.
+		bool flagLandscape;
+		//! The scan step in days.
+		double scanStep;
+	};
+
+	struct Result
+	{
+		Result() : circumpolar(false), neverRises(false) {}
+		StelObjectP object;
+		//! The dates of the events in Julian days.
+		QVector<double> rises, transits, sets;
+		//! The apparent altitude in degrees at each transit.
+		QVector<double> transitAltitudes;
+		//! The start and end dates of the intervals when the object is visible.
+		QVector<Vec2d> windows;
+		//! The object stays above the threshold during the whole range.
+		bool circumpolar;
+		//! The object stays below the threshold during the whole range.
+		bool neverRises;
+
+		//! Return the result in a form suitable for scripts and JSON files. The dates are ISO 8601 UTC strings.
+		QVariantMap toVariantMap() const;
+	};
+
+	StelRiseSetCalculator(StelCore* core);
+
+	//! Compute the events of the passed objects. Must be called from the main thread.
+	QVector<Result> compute(const QList<StelObjectP>& objects, const Params& params);
+
+	//! Compute the events of the objects with the given English names.
+	//! @return a list of maps as returned by Result::toVariantMap(), with an additional "found" key.
+	QVariantList compute(const QStringList& names, const Params& params);
+
+private:
+	//! The apparent positions of an object needed by the computation.
+	struct Track
+	{
+		Track() : threshold(0.), flagLandscape(false) {}
+		//! Unit vectors in the equinox equatorial frame, at each ephemeris sample or a single one for fixed objects.
+		QVector<Vec3d> directions;
+		//! The threshold altitude in radians.
+		double threshold;
+		//! Whether the object must also be above the landscape horizon.
+		bool flagLandscape;
+	};
+
+	class ComputeTask;
+
+	//! Compute the ephemeris samples of the observer frame, and of the solar system bodies among the objects.
+	void prepare(const QList<StelObjectP>& objects, QVector<Track>& tracks);
+	//! Return the apparent alt-az position of a track at the given date.
+	Vec3d getAltAzPos(const Track& track, double jd) const;
+	//! Return the altitude in radians of an alt-az position above the threshold of a track.
+	double getMargin(const Track& track, const Vec3d& altAzPos) const;
+	//! Compute the events of a track. Called from the worker threads.
+	void computeTrack(const Track& track, Result& result) const;
+	//! Refine the threshold crossing between 2 scan samples.
+	double findCrossing(const Track& track, double jd0, double f0, double jd1, double f1) const;
+	//! Refine the date of the maximum altitude between 2 dates.
+	double findTransit(const Track& track, double jd0, double jd1) const;
+	//! Remove from sorted windows the parts overlapping other sorted windows, e.g. the daylight.
+	static QVector<Vec2d> subtractWindows(const QVector<Vec2d>& windows, const QVector<Vec2d>& excluded);
+
+	StelCore* core;
+	Params params;
+	Refraction refraction;
+	const LandscapeMgr* landscapeMgr;
+
+	//! Date of the first ephemeris sample and interval between samples in days.
+	double ephemStartJD, ephemStep;
+	//! Rotation from the equinox equatorial frame to the alt-az frame at each ephemeris sample.
+	QVector<Mat4d> equToAltAz;
+	//! Rotation angle of the observer around the polar axis between 2 consecutive samples.
+	QVector<double> rotationSteps;
+};
+
+#endif // _STELRISESETCALCULATOR_HPP_
@@ -406,6 +406,7 @@ void StelSkyDrawer::postDrawPointSource(StelPainter* sPainter)
 	starShaderProgram->disableAttributeArray(starShaderVars.color);
 	starShaderProgram->disableAttributeArray(starShaderVars.texCoord);
 	starShaderProgram->release();
+	StelPainter::invalidateGLStateCache();
 	
 	nbPointSources = 0;
 }
@@ -421,6 +422,16 @@ bool StelSkyDrawer::drawPointSource(StelPainter* sPainter, const Vec3f& v, const
 	Vec3f win;
 	if (!(checkInScreen ? sPainter->getProjector()->projectCheck(v, win) : sPainter->getProjector()->project(v, win)))
 		return false;
+	return drawPointSourceProjected(sPainter, win, rcMag, color);
+}
+
+// Draw a point source halo at an already projected position.
+bool StelSkyDrawer::drawPointSourceProjected(StelPainter* sPainter, const Vec3f& win, const RCMag& rcMag, const Vec3f& color)
+{
+	Q_ASSERT(sPainter);
+
+	if (rcMag.radius<=0.f)
+		return false;
 
 	const float radius = rcMag.radius;
 	// Random coef for star twinkling
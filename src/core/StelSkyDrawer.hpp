@@ -78,6 +78,15 @@ public:
 
 	bool drawPointSource(StelPainter* sPainter, const Vec3f& v, const RCMag &rcMag, const Vec3f& bcolor, bool checkInScreen=false);
 
+	//! Same as drawPointSource() for a source already projected on the screen, e.g. with the batch
+	//! StelProjector::project() method.
+	//! @param win the position of the source in the viewport 2D frame.
+	//! @return true if the source was actually drawn
+	bool drawPointSourceProjected(StelPainter* sPainter, const Vec3f& win, const RCMag &rcMag, unsigned int bV)
+		{return drawPointSourceProjected(sPainter, win, rcMag, colorTable[bV]);}
+
+	bool drawPointSourceProjected(StelPainter* sPainter, const Vec3f& win, const RCMag &rcMag, const Vec3f& bcolor);
+
 	//! Terminate drawing of a 3D model, draw the halo
 	//! @param p the StelPainter instance to use for this drawing operation
 	//! @param v the 3d position of the source in J2000 reference frame
@@ -24,6 +24,7 @@
 #include "StelApp.hpp"
 #include "StelUtils.hpp"
 #include "StelPainter.hpp"
+#include "StelProfiler.hpp"
 
 #include <QImageReader>
 #include <QSize>
@@ -33,8 +34,10 @@
 #include <QNetworkReply>
 #include <QtEndian>
 #include <QFuture>
+#include <QRunnable>
+#include <QThreadPool>
 
-StelTexture::StelTexture() : networkReply(NULL), errorOccured(false), id(0), avgLuminance(-1.f)
+StelTexture::StelTexture() : networkReply(NULL), errorOccured(false), loadInThread(false), id(0), avgLuminance(-1.f)
 {
 	width = -1;
 	height = -1;
@@ -101,6 +104,21 @@ bool StelTexture::bind()
 	if (errorOccured)
 		return false;
 
+	// The image is being decoded in a thread
+	if (loadedImage)
+	{
+		if (!loadedImage->ready.loadAcquire())
+			return false;
+		const GLData data = loadedImage->data;
+		loadedImage.clear();
+		if (data.data.isEmpty())
+		{
+			reportError(QString("Cannot load image %1").arg(fullPath));
+			return false;
+		}
+		return glLoad(data);
+	}
+
 	// If the file is remote, start a network connection.
 	if (networkReply == NULL && fullPath.startsWith("http://")) {
 		QNetworkRequest req = QNetworkRequest(QUrl(fullPath));
@@ -115,7 +133,14 @@ bool StelTexture::bind()
 	if (networkReply != NULL)
 		return false;
 	if (!fullPath.startsWith("http://"))
+	{
+		if (loadInThread)
+		{
+			startImageLoader();
+			return false;
+		}
 		image.load(fullPath);
+	}
 
 	if (image.isNull())
 		return false;
@@ -124,6 +149,29 @@ bool StelTexture::bind()
 	return true;
 }
 
+//! Decode an image file into the openGL format in a thread of the texture manager.
+class ImageLoader : public QRunnable
+{
+public:
+	ImageLoader(const QString& path, const QSharedPointer<StelTexture::LoadedImage>& result) : path(path), result(result) {}
+	virtual void run()
+	{
+		result->data = StelTexture::imageToGLData(QImage(path));
+		result->ready.storeRelease(1);
+		// Wake up an idle view so that bind() gets called again
+		QMetaObject::invokeMethod(&StelApp::getInstance(), "requestRedraw", Qt::QueuedConnection);
+	}
+private:
+	QString path;
+	QSharedPointer<StelTexture::LoadedImage> result;
+};
+
+void StelTexture::startImageLoader()
+{
+	loadedImage = QSharedPointer<LoadedImage>(new LoadedImage());
+	StelApp::getInstance().getTextureManager().loaderThreadPool->start(new ImageLoader(fullPath, loadedImage));
+}
+
 void StelTexture::onNetworkReply()
 {
 	if (networkReply->error() != QNetworkReply::NoError)
@@ -242,6 +290,7 @@ bool StelTexture::glLoad(const GLData& data)
 		reportError("Unknown error");
 		return false;
 	}
+	StelProfiler::Scope scope(StelApp::getInstance().getProfiler(), "gl:textureUpload");
 	width = data.width;
 	height = data.height;
 	glActiveTexture(GL_TEXTURE0);
@@ -261,6 +310,8 @@ bool StelTexture::glLoad(const GLData& data)
 	}
 	// Report success of texture loading
 	emit(loadingProcessFinished(false));
+	// Make sure that the frame showing the new texture gets drawn even if the view is idle
+	StelApp::getInstance().requestRedraw();
 	return true;
 }
 
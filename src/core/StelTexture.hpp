@@ -24,6 +24,7 @@
 
 #include <QObject>
 #include <QImage>
+#include <QAtomicInt>
 #include <QOpenGLFunctions>
 
 class QFile;
@@ -82,7 +83,7 @@ public:
 	const QString& getFullPath() const {return fullPath;}
 
 	//! Return whether the image is currently being loaded
-	bool isLoading() const {return networkReply && !canBind();}
+	bool isLoading() const {return (networkReply || loadedImage) && !canBind();}
 
 signals:
 	//! Emitted when the texture is ready to be bind(), i.e. when downloaded, imageLoading and	glLoading is over
@@ -96,6 +97,7 @@ private slots:
 
 private:
 	friend class StelTextureMgr;
+	friend class ImageLoader;
 
 	//! structure returned by the loader threads, containing all the
 	//! data and information to create the OpenGL texture.
@@ -107,6 +109,16 @@ private:
 		GLint format;
 		GLint type;
 	};
+
+	//! Image decoded by an ImageLoader. It is shared with the loader so that the
+	//! texture can be destroyed while the image is being decoded.
+	struct LoadedImage
+	{
+		LoadedImage() : ready(0) {}
+		//! Set to 1 by the loader once data is filled
+		QAtomicInt ready;
+		GLData data;
+	};
 	static GLData imageToGLData(const QImage &image);
 
 	//! Private constructor
@@ -126,6 +138,10 @@ private:
 	//! Same as glLoad(QImage), but with an image already in OpenGl format
 	bool glLoad(const GLData& data);
 
+	//! Start decoding the local image file in a thread of the texture manager.
+	//! bind() uploads the image to the openGL memory once it is decoded.
+	void startImageLoader();
+
 	StelTextureParams loadParams;
 
 	//! Used to handle the connection for remote textures.
@@ -139,6 +155,11 @@ private:
 	//! True when something when wrong in the loading process
 	bool errorOccured;
 
+	//! Define whether a local image file is decoded in a thread instead of in bind()
+	bool loadInThread;
+	//! The image being decoded in a thread, or NULL
+	QSharedPointer<LoadedImage> loadedImage;
+
 	//! Human friendly error message if loading failed
 	QString errorMessage;
 
@@ -28,11 +28,24 @@
 #include <QDebug>
 #include <QNetworkRequest>
 #include <QThread>
+#include <QThreadPool>
 #include <QSettings>
 #include <cstdlib>
 #include <QOpenGLContext>
 
 
+StelTextureMgr::StelTextureMgr()
+{
+	// Leave a core to the rendering
+	loaderThreadPool = new QThreadPool(this);
+	loaderThreadPool->setMaxThreadCount(qMax(1, QThread::idealThreadCount()-1));
+}
+
+StelTextureMgr::~StelTextureMgr()
+{
+	loaderThreadPool->waitForDone();
+}
+
 void StelTextureMgr::init()
 {
 }
@@ -65,6 +78,7 @@ StelTextureSP StelTextureMgr::createTextureThread(const QString& url, const Stel
 	StelTextureSP tex = StelTextureSP(new StelTexture());
 	tex->loadParams = params;
 	tex->fullPath = url;
+	tex->loadInThread = true;
 	if (!lazyLoading)
 	{
 		tex->bind();
@@ -25,6 +25,7 @@
 
 class QNetworkReply;
 class QThread;
+class QThreadPool;
 
 
 //! @class StelTextureMgr
@@ -33,6 +34,10 @@ class QThread;
 class StelTextureMgr : QObject
 {
 public:
+	StelTextureMgr();
+	//! Wait for the images being decoded.
+	~StelTextureMgr();
+
 	//! Initialize some variable from the openGL contex.
 	//! Must be called after the creation of the GLContext.
 	void init();
@@ -44,6 +49,8 @@ public:
 	StelTextureSP createTexture(const QString& filename, const StelTexture::StelTextureParams& params=StelTexture::StelTextureParams());
 
 	//! Load an image from a file and create a new texture from it in a new thread.
+	//! Local files are decoded in a thread of the texture manager, and remote files downloaded
+	//! asynchronously, so bind() returns false until the texture is ready.
 	//! @param url the texture file name or URL, can be absolute path if starts with '/' otherwise
 	//!    the file will be looked in stellarium standard textures directories.
 	//! @param params the texture creation parameters.
@@ -53,6 +60,9 @@ public:
 private:
 	friend class StelTexture;
 	friend class ImageLoader;
+
+	//! Threads decoding the local images of the textures created by createTextureThread()
+	QThreadPool* loaderThreadPool;
 };
 
 
@@ -24,41 +24,55 @@
 #include "StelObject.hpp"
 #include "Planet.hpp"
 
-TrailGroup::TrailGroup(float te) : timeExtent(te), opacity(1.f)
+#include <cmath>
+
+const double TrailGroup::MinSampleAngle = 0.25*M_PI/180.;
+
+TrailGroup::Trail::Trail(const StelObjectP& obj, const Vec3f& col) : stelObject(obj), color(col)
+{
+	const Planet* pl = dynamic_cast<const Planet*>(obj.data());
+	if (pl!=NULL)
+		planetName = pl->getEnglishName();
+}
+
+TrailGroup::TrailGroup(float te) : timeExtent(te), firstPoint(0), nbPoints(0), opacity(1.f)
 {
 	j2000ToTrailNative=Mat4d::identity();
 	j2000ToTrailNativeInverted=Mat4d::identity();
 }
 
-static QVector<Vec3d> vertexArray;
-static QVector<Vec4f> colorArray;
 void TrailGroup::draw(StelCore* core, StelPainter* sPainter)
 {
+	if (nbPoints==0)
+		return;
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	float currentTime = core->getJDay();
+	const double currentTime = core->getJDay();
 	StelProjector::ModelViewTranformP transfo = core->getJ2000ModelViewTransform();
 	transfo->combine(j2000ToTrailNativeInverted);
 	sPainter->setProjector(core->getProjection(transfo));
+
+	// The points of all the trails share the same dates, so compute their fading once
+	fadeArray.resize(nbPoints+1);
+	for (int i=0;i<nbPoints;++i)
+		fadeArray[i] = (1.f-(currentTime-times.at(ringIndex(i)))/timeExtent)*opacity;
+	fadeArray[nbPoints] = opacity;
+
+	// Avoid drawing the trails if the object is the home planet
+	const QString& homePlanetName = core->getCurrentLocation().planetName;
+	vertexArray.resize(nbPoints+1);
+	colorArray.resize(nbPoints+1);
 	foreach (const Trail& trail, allTrails)
 	{
-		Planet* hpl = dynamic_cast<Planet*>(trail.stelObject.data());
-		if (hpl!=NULL)
+		if (!trail.planetName.isEmpty() && trail.planetName==homePlanetName)
+			continue;
+		for (int i=0;i<nbPoints;++i)
 		{
-			// Avoid drawing the trails if the object is the home planet
-			QString homePlanetName = hpl==NULL ? "" : hpl->getEnglishName();
-			if (homePlanetName==StelApp::getInstance().getCore()->getCurrentLocation().planetName)
-				continue;
-		}
-		const QList<Vec3d>& posHistory = trail.posHistory;
-		vertexArray.resize(posHistory.size());
-		colorArray.resize(posHistory.size());
-		for (int i=0;i<posHistory.size();++i)
-		{
-			float colorRatio = 1.f-(currentTime-times.at(i))/timeExtent;
-			colorArray[i].set(trail.color[0], trail.color[1], trail.color[2], colorRatio*opacity);
-			vertexArray[i]=posHistory.at(i);
+			vertexArray[i] = trail.posHistory.at(ringIndex(i));
+			colorArray[i].set(trail.color[0], trail.color[1], trail.color[2], fadeArray.at(i));
 		}
+		vertexArray[nbPoints] = trail.currentPos;
+		colorArray[nbPoints].set(trail.color[0], trail.color[1], trail.color[2], fadeArray.at(nbPoints));
 		sPainter->setVertexPointer(3, GL_DOUBLE, vertexArray.constData());
 		sPainter->setColorPointer(4, GL_FLOAT, colorArray.constData());
 		sPainter->enableClientStates(true, false, true);
@@ -67,21 +81,48 @@ void TrailGroup::draw(StelCore* core, StelPainter* sPainter)
 	}
 }
 
-// Add 1 point to all the curves at current time and suppress too old points
+// Update the current point of all the curves, store a new point if needed and suppress too old points
 void TrailGroup::update()
 {
-	times.append(StelApp::getInstance().getCore()->getJDay());
+	StelCore* core = StelApp::getInstance().getCore();
+	const double currentTime = core->getJDay();
+	const double minCos = std::cos(MinSampleAngle);
+	bool moved = nbPoints==0;
 	for (QList<Trail>::Iterator iter=allTrails.begin();iter!=allTrails.end();++iter)
 	{
-		iter->posHistory.append(j2000ToTrailNative*iter->stelObject->getJ2000EquatorialPos(StelApp::getInstance().getCore()));
+		iter->currentPos = j2000ToTrailNative*iter->stelObject->getJ2000EquatorialPos(core);
+		if (!moved)
+		{
+			const Vec3d& last = iter->posHistory.at(ringIndex(nbPoints-1));
+			const double norms = iter->currentPos.length()*last.length();
+			moved = iter->currentPos.dot(last) < minCos*norms;
+		}
 	}
-	if (StelApp::getInstance().getCore()->getJDay()-times.at(0)>timeExtent)
+
+	if (moved)
 	{
-		times.pop_front();
-		for (QList<Trail>::Iterator iter=allTrails.begin();iter!=allTrails.end();++iter)
+		// Store the current points, overwriting the oldest ones when the buffers are full
+		if (nbPoints==MaxPoints)
 		{
-			iter->posHistory.pop_front();
+			firstPoint = ringIndex(1);
+			--nbPoints;
 		}
+		else if (nbPoints==times.size())
+		{
+			grow();
+		}
+		const int idx = ringIndex(nbPoints);
+		times[idx] = currentTime;
+		for (QList<Trail>::Iterator iter=allTrails.begin();iter!=allTrails.end();++iter)
+			iter->posHistory[idx] = iter->currentPos;
+		++nbPoints;
+	}
+
+	// Drop the points older than the time extent
+	while (nbPoints>0 && currentTime-times.at(firstPoint)>timeExtent)
+	{
+		firstPoint = ringIndex(1);
+		--nbPoints;
 	}
 }
 
@@ -95,13 +136,33 @@ void TrailGroup::setJ2000ToTrailNative(const Mat4d& m)
 void TrailGroup::addObject(const StelObjectP& obj, const Vec3f* col)
 {
 	allTrails.append(TrailGroup::Trail(obj, col==NULL ? obj->getInfoColor() : *col));
+	// The new trail has no history, restart all of them so that they stay aligned
+	reset();
 }
 
 void TrailGroup::reset()
 {
+	// Release the buffers, they are allocated again when points are stored
 	times.clear();
 	for (QList<Trail>::Iterator iter=allTrails.begin();iter!=allTrails.end();++iter)
-	{
 		iter->posHistory.clear();
+	firstPoint = 0;
+	nbPoints = 0;
+}
+
+void TrailGroup::grow()
+{
+	const int size = qMin(qMax(2*times.size(), (int)MinPoints), (int)MaxPoints);
+	for (QList<Trail>::Iterator iter=allTrails.begin();iter!=allTrails.end();++iter)
+	{
+		QVector<Vec3d> posHistory(size);
+		for (int i=0;i<nbPoints;++i)
+			posHistory[i] = iter->posHistory.at(ringIndex(i));
+		iter->posHistory = posHistory;
 	}
+	QVector<double> newTimes(size);
+	for (int i=0;i<nbPoints;++i)
+		newTimes[i] = times.at(ringIndex(i));
+	times = newTimes;
+	firstPoint = 0;
 }
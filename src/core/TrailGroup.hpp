@@ -24,6 +24,10 @@
 #include "StelCore.hpp"
 #include "StelObjectType.hpp"
 
+#include <QList>
+#include <QString>
+#include <QVector>
+
 class StelPainter;
 
 class TrailGroup
@@ -33,7 +37,9 @@ public:
 
 	void draw(StelCore* core, StelPainter*);
 
-	// Add 1 point to all the curves at current time and suppress too old points
+	// Update the current point of all the curves and suppress too old points.
+	// A new point is only stored when one of the objects moved by more than MinSampleAngle
+	// since the last stored point, so that slow moving objects don't fill the history.
 	void update();
 
 	// Set the matrix to use to post process J2000 positions before storing in the trail
@@ -47,27 +53,51 @@ public:
 	void reset();
 
 private:
+	//! Maximum number of points stored per trail, the oldest are dropped when full.
+	static const int MaxPoints = 4096;
+	//! Number of points allocated for the first stored points, the buffers then grow up to MaxPoints.
+	static const int MinPoints = 64;
+	//! Minimum angular change of one of the objects between two stored points, in radians.
+	static const double MinSampleAngle;
+
 	class Trail
 	{
 	public:
-		Trail(const StelObjectP& obj, const Vec3f& col) : stelObject(obj), color(col) {;}
+		Trail(const StelObjectP& obj, const Vec3f& col);
 		StelObjectP stelObject;
-		// All previous positions
-		QList<Vec3d> posHistory;
+		// Ring buffer of the previous positions, sharing its indices and size with the times ring buffer
+		QVector<Vec3d> posHistory;
+		// Position at the current time, drawn after the stored points
+		Vec3d currentPos;
 		Vec3f color;
+		// English name of the object if it is a planet, used to skip the home planet
+		QString planetName;
 	};
 
+	//! Return the index in the ring buffers of the i-th stored point, 0 being the oldest.
+	int ringIndex(int i) const {return (firstPoint+i)%times.size();}
+	//! Enlarge the ring buffers when they are full, moving the oldest point at index 0.
+	void grow();
+
 	QList<Trail> allTrails;
 
 	// Maximum time extent in days
 	float timeExtent;
 
-	QList<float> times;
+	// Ring buffer of the dates of the stored points, allocated when the first point is stored
+	QVector<double> times;
+	int firstPoint;
+	int nbPoints;
 
 	Mat4d j2000ToTrailNative;
 	Mat4d j2000ToTrailNativeInverted;
 
 	float opacity;
+
+	// Arrays reused at each draw
+	QVector<Vec3d> vertexArray;
+	QVector<Vec4f> colorArray;
+	QVector<float> fadeArray;
 };
 
 #endif // TRAILMGR_HPP
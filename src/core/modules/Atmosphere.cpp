@@ -34,12 +34,15 @@ inline bool myisnan(double value)
 	return value != value;
 }
 
-Atmosphere::Atmosphere(void) :viewport(0,0,0,0), posGrid(NULL), posGridBuffer(QOpenGLBuffer::VertexBuffer), 
+Atmosphere::Atmosphere(void) :viewport(0,0,0,0), skyResolutionY(0), skyResolutionX(0), posGrid(NULL), posGridBuffer(QOpenGLBuffer::VertexBuffer), 
 	indicesBuffer(QOpenGLBuffer::IndexBuffer), colorGrid(NULL), colorGridBuffer(QOpenGLBuffer::VertexBuffer),
-	averageLuminance(0.f), eclipseFactor(1.f), lightPollutionLuminance(0)
+	gridBuffersChanged(false), colorGridChanged(false), averageLuminance(0.f), eclipseFactor(1.f), lightPollutionLuminance(0), atmoShaderProgram(NULL)
 {
 	setFadeDuration(1.5f);
+}
 
+void Atmosphere::initShaderProgram()
+{
 	qDebug() << "Use vertex shader for atmosphere rendering.";
 	QOpenGLShader vShader(QOpenGLShader::Vertex);
 	if (!vShader.compileSourceFile(":/shaders/xyYToRGB.glsl"))
@@ -107,13 +110,20 @@ void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moo
 							   StelCore* core, float latitude, float altitude, float temperature, float relativeHumidity)
 {
 	const StelProjectorP prj = core->getProjection(StelCore::FrameAltAz, StelCore::RefractionOff);
-	if (viewport != prj->getViewport())
+	const int resolutionY = StelApp::getInstance().getSettings()->value("landscape/atmosphereybin", 44).toInt();
+	computeColor(JD, _sunPos, moonPos, moonPhase, prj, resolutionY, latitude, altitude, temperature, relativeHumidity);
+}
+
+void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moonPhase, const StelProjectorP& prj,
+							   int resolutionY, float latitude, float altitude, float temperature, float relativeHumidity)
+{
+	if (viewport != prj->getViewport() || skyResolutionY != resolutionY)
 	{
 		// The viewport changed: update the number of point of the grid
 		viewport = prj->getViewport();
 		delete[] colorGrid;
 		delete [] posGrid;
-		skyResolutionY = StelApp::getInstance().getSettings()->value("landscape/atmosphereybin", 44).toInt();
+		skyResolutionY = resolutionY;
 		skyResolutionX = (int)floor(0.5+skyResolutionY*(0.5*sqrt(3.0))*prj->getViewportWidth()/prj->getViewportHeight());
 		posGrid = new Vec2f[(1+skyResolutionX)*(1+skyResolutionY)];
 		colorGrid = new Vec4f[(1+skyResolutionX)*(1+skyResolutionY)];
@@ -131,45 +141,8 @@ void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moo
 				v[1] = viewport_bottom+y*stepY;
 			}
 		}
-		posGridBuffer.destroy();
-		//posGridBuffer = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
-		Q_ASSERT(posGridBuffer.type()==QOpenGLBuffer::VertexBuffer);
-		posGridBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
-		posGridBuffer.create();
-		posGridBuffer.bind();
-		posGridBuffer.allocate(posGrid, (1+skyResolutionX)*(1+skyResolutionY)*8);
-		posGridBuffer.release();
-		
-		// Generate the indices used to draw the quads
-		unsigned short* indices = new unsigned short[(skyResolutionX+1)*skyResolutionY*2];
-		int i=0;
-		for (int y2=0; y2<skyResolutionY; ++y2)
-		{
-			unsigned int g0 = y2*(1+skyResolutionX);
-			unsigned int g1 = (y2+1)*(1+skyResolutionX);
-			for (int x2=0; x2<=skyResolutionX; ++x2)
-			{
-				indices[i++]=g0++;
-				indices[i++]=g1++;
-			}
-		}
-		indicesBuffer.destroy();
-		//indicesBuffer = QOpenGLBuffer(QOpenGLBuffer::IndexBuffer);
-		Q_ASSERT(indicesBuffer.type()==QOpenGLBuffer::IndexBuffer);
-		indicesBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
-		indicesBuffer.create();
-		indicesBuffer.bind();
-		indicesBuffer.allocate(indices, (skyResolutionX+1)*skyResolutionY*2*2);
-		indicesBuffer.release();
-		delete[] indices;
-		indices=NULL;
-		
-		colorGridBuffer.destroy();
-		colorGridBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
-		colorGridBuffer.create();
-		colorGridBuffer.bind();
-		colorGridBuffer.allocate(posGrid, (1+skyResolutionX)*(1+skyResolutionY)*4*4);
-		colorGridBuffer.release();
+		// The buffers are created again in draw() where the openGL context is current
+		gridBuffersChanged = true;
 	}
 
 	if (myisnan(_sunPos.length()))
@@ -285,15 +258,55 @@ void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moo
 		colorGrid[i].set(point[0], point[1], point[2], lumi);
 	}
 	
-	colorGridBuffer.bind();
-	colorGridBuffer.write(0, colorGrid, (1+skyResolutionX)*(1+skyResolutionY)*4*4);
-	colorGridBuffer.release();
-	
+	colorGridChanged = true;
+
 	// Update average luminance
 	averageLuminance = sum_lum/((1+skyResolutionX)*(1+skyResolutionY));
 }
 
-
+// Create the openGL buffers of the grid positions and colors after a change of viewport
+void Atmosphere::createGridBuffers()
+{
+	posGridBuffer.destroy();
+	//posGridBuffer = QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+	Q_ASSERT(posGridBuffer.type()==QOpenGLBuffer::VertexBuffer);
+	posGridBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+	posGridBuffer.create();
+	posGridBuffer.bind();
+	posGridBuffer.allocate(posGrid, (1+skyResolutionX)*(1+skyResolutionY)*8);
+	posGridBuffer.release();
+	
+	// Generate the indices used to draw the quads
+	unsigned short* indices = new unsigned short[(skyResolutionX+1)*skyResolutionY*2];
+	int i=0;
+	for (int y2=0; y2<skyResolutionY; ++y2)
+	{
+		unsigned int g0 = y2*(1+skyResolutionX);
+		unsigned int g1 = (y2+1)*(1+skyResolutionX);
+		for (int x2=0; x2<=skyResolutionX; ++x2)
+		{
+			indices[i++]=g0++;
+			indices[i++]=g1++;
+		}
+	}
+	indicesBuffer.destroy();
+	//indicesBuffer = QOpenGLBuffer(QOpenGLBuffer::IndexBuffer);
+	Q_ASSERT(indicesBuffer.type()==QOpenGLBuffer::IndexBuffer);
+	indicesBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+	indicesBuffer.create();
+	indicesBuffer.bind();
+	indicesBuffer.allocate(indices, (skyResolutionX+1)*skyResolutionY*2*2);
+	indicesBuffer.release();
+	delete[] indices;
+	indices=NULL;
+	
+	colorGridBuffer.destroy();
+	colorGridBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+	colorGridBuffer.create();
+	colorGridBuffer.bind();
+	colorGridBuffer.allocate(posGrid, (1+skyResolutionX)*(1+skyResolutionY)*4*4);
+	colorGridBuffer.release();
+}
 
 // Draw the atmosphere using the precalc values stored in tab_sky
 void Atmosphere::draw(StelCore* core)
@@ -306,6 +319,21 @@ void Atmosphere::draw(StelCore* core)
 	if (!fader.getInterstate())
 		return;
 
+	if (!atmoShaderProgram)
+		initShaderProgram();
+	if (gridBuffersChanged)
+	{
+		createGridBuffers();
+		gridBuffersChanged = false;
+	}
+	if (colorGridChanged)
+	{
+		colorGridBuffer.bind();
+		colorGridBuffer.write(0, colorGrid, (1+skyResolutionX)*(1+skyResolutionY)*4*4);
+		colorGridBuffer.release();
+		colorGridChanged = false;
+	}
+
 	StelPainter sPainter(core->getProjection2d());
 	glBlendFunc(GL_ONE, GL_ONE);
 	sPainter.enableTexture2d(false);
@@ -362,4 +390,5 @@ void Atmosphere::draw(StelCore* core)
 	atmoShaderProgram->disableAttributeArray(shaderAttribLocations.skyVertex);
 	atmoShaderProgram->disableAttributeArray(shaderAttribLocations.skyColor);
 	atmoShaderProgram->release();
+	StelPainter::invalidateGLStateCache();
 }
@@ -26,6 +26,7 @@
 
 #include "Skybright.hpp"
 #include "StelFader.hpp"
+#include "StelProjectorType.hpp"
 
 #include <QOpenGLBuffer>
 
@@ -45,6 +46,11 @@ public:
 	void computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moonPhase, StelCore* core,
 		float latitude = 45.f, float altitude = 200.f,
 		float temperature = 15.f, float relativeHumidity = 40.f);
+	//! Compute the luminance of the sky grid for the viewport of the passed alt-azimuthal projector,
+	//! with resolutionY rows of points. It doesn't use openGL: the grid is uploaded by the next draw().
+	void computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moonPhase, const StelProjectorP& prj,
+		int resolutionY, float latitude = 45.f, float altitude = 200.f,
+		float temperature = 15.f, float relativeHumidity = 40.f);
 	void draw(StelCore* core);
 	void update(double deltaTime) {fader.update((int)(deltaTime*1000));}
 
@@ -77,6 +83,11 @@ public:
 	float getLightPollutionLuminance() const { return lightPollutionLuminance; }
 
 private:
+	//! Compile the shader, done at the first draw so that the grid can be computed without openGL.
+	void initShaderProgram();
+	//! Create the openGL buffers of the grid after a change of viewport.
+	void createGridBuffers();
+
 	Vec4i viewport;
 	Skylight sky;
 	Skybright skyb;
@@ -87,6 +98,9 @@ private:
 	QOpenGLBuffer indicesBuffer;
 	Vec4f* colorGrid;
 	QOpenGLBuffer colorGridBuffer;
+	//! Whether the grid or its colors changed since they were last uploaded in the buffers.
+	bool gridBuffersChanged;
+	bool colorGridChanged;
 
 	//! The average luminance of the atmosphere in cd/m2
 	float averageLuminance;
@@ -32,6 +32,7 @@
 #include "StelPainter.hpp"
 #include "StelApp.hpp"
 #include "StelCore.hpp"
+#include "StelLabelScheduler.hpp"
 
 Vec3f Constellation::lineColor = Vec3f(0.4,0.4,0.8);
 Vec3f Constellation::labelColor = Vec3f(0.4,0.4,0.8);
@@ -119,8 +120,9 @@ void Constellation::drawName(StelPainter& sPainter) const
 {
 	if (!nameFader.getInterstate())
 		return;
-	sPainter.setColor(labelColor[0], labelColor[1], labelColor[2], nameFader.getInterstate());
-	sPainter.drawText(XYname[0], XYname[1], nameI18, 0., -sPainter.getFontMetrics().width(nameI18)/2, 0, false);
+	// The constellation names are more important than the object labels they may overlap
+	StelApp::getInstance().getCore()->getLabelScheduler()->addLabel(XYname[0], XYname[1], nameI18,
+		Vec4f(labelColor[0], labelColor[1], labelColor[2], nameFader.getInterstate()), 10.f, -sPainter.getFontMetrics().width(nameI18)/2);
 }
 
 void Constellation::drawArtOptim(StelPainter& sPainter, const SphericalRegion& region) const
@@ -174,6 +176,14 @@ void Constellation::update(int deltaTime)
 	boundaryFader.update(deltaTime);
 }
 
+void Constellation::hide()
+{
+	lineFader = LinearFader();
+	nameFader = LinearFader();
+	artFader = LinearFader();
+	boundaryFader = LinearFader();
+}
+
 void Constellation::drawBoundaryOptim(StelPainter& sPainter) const
 {
 	if (!boundaryFader.getInterstate())
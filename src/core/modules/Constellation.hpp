@@ -123,6 +123,8 @@ private:
 	//! Turn on and off Constellation art rendering.
 	//! @param b new state for art drawing.
 	void setFlagArt(const bool b) {artFader=b;}
+	//! Turn off the lines, boundary, name and art immediately, without transition.
+	void hide();
 	//! Get the current state of Constellation line rendering.
 	//! @return true if Constellation line rendering it turned on, else false.
 	bool getFlagLines() const {return lineFader;}
@@ -19,6 +19,7 @@
  */
 
 #include <vector>
+#include <algorithm>
 #include <QDebug>
 #include <QFile>
 #include <QSettings>
@@ -41,7 +42,10 @@
 #include "StelFileMgr.hpp"
 #include "StelCore.hpp"
 #include "StelPainter.hpp"
+#include "StelLabelScheduler.hpp"
 #include "StelSkyDrawer.hpp"
+#include "StelRegionObject.hpp"
+#include "StelRecordReader.hpp"
 
 static int CONSTELLATION_ART_SCALE = 1; //was 2
 
@@ -50,6 +54,8 @@ using namespace std;
 // constructor which loads all data from appropriate files
 ConstellationMgr::ConstellationMgr(StarMgr *_hip_stars)
 	: hipStarMgr(_hip_stars),
+	  boundaryIndex(16, 8),
+	  boundaryIndexBuilt(false),
 	  artFadeDuration(1.),
 	  artIntensity(0),
 	  artDisplayed(0),
@@ -81,6 +87,14 @@ ConstellationMgr::~ConstellationMgr()
 	allBoundarySegments.clear();
 }
 
+ConstellationMgr::SkyCultureBundle::~SkyCultureBundle()
+{
+	for (vector<Constellation*>::iterator iter = asterisms.begin(); iter != asterisms.end(); ++iter)
+		delete (*iter);
+	for (vector<vector<Vec3f> *>::iterator iter = boundarySegments.begin(); iter != boundarySegments.end(); ++iter)
+		delete (*iter);
+}
+
 void ConstellationMgr::init()
 {
 	QSettings* conf = StelApp::getInstance().getSettings();
@@ -97,6 +111,7 @@ void ConstellationMgr::init()
 	setFlagIsolateSelected(conf->value("viewing/flag_constellation_isolate_selected",
 					   conf->value("viewing/flag_constellation_pick", false).toBool() ).toBool());
 	setConstellationLineThickness(conf->value("viewing/constellation_line_thickness", 1.f).toFloat());
+	skyCultureCache.setMaxCost(conf->value("viewing/sky_culture_cache_size", 2).toInt());
 
 	StelObjectMgr *objectManager = GETSTELMODULE(StelObjectMgr);
 	objectManager->registerStelObjectMgr(this);
@@ -141,6 +156,33 @@ void ConstellationMgr::updateSkyCulture(const QString& skyCultureDir)
 	// first of all, remove constellations from the list of selected objects in StelObjectMgr, since we are going to delete them
 	deselectConstellations();
 
+	// Keep the current culture in the cache and reuse the new one if it was recently displayed
+	SkyCultureBundle* cached = skyCultureCache.take(skyCultureDir);
+	if (!asterisms.empty())
+	{
+		SkyCultureBundle* current = new SkyCultureBundle;
+		current->asterisms.swap(asterisms);
+		current->boundarySegments.swap(allBoundarySegments);
+		for (vector<Constellation*>::iterator iter = current->asterisms.begin(); iter != current->asterisms.end(); ++iter)
+			(*iter)->hide();
+		skyCultureCache.insert(lastLoadedSkyCulture, current);
+	}
+	boundaryIndex.clear();
+	boundaryIndexBuilt = false;
+	if (cached)
+	{
+		asterisms.swap(cached->asterisms);
+		allBoundarySegments.swap(cached->boundarySegments);
+		delete cached;
+		// The constellations fade in as after a normal load
+		for (vector<Constellation*>::iterator iter = asterisms.begin(); iter != asterisms.end(); ++iter)
+			initConstellationState(*iter);
+		updateI18n();
+		lastLoadedSkyCulture = skyCultureDir;
+		qDebug() << "Reused the constellations of sky culture" << skyCultureDir;
+		return;
+	}
+
 	QString fic = StelFileMgr::findFile("skycultures/"+skyCultureDir+"/constellationship.fab");
 	if (fic.isEmpty())
 		qWarning() << "ERROR loading constellation lines and art from file: " << fic;
@@ -307,6 +349,15 @@ void ConstellationMgr::setConstellationLineThickness(const double thickness)
 		constellationLineThickness = 1.f;
 }
 
+void ConstellationMgr::initConstellationState(Constellation* cons) const
+{
+	cons->artFader.setMaxValue(artIntensity);
+	cons->setFlagArt(artDisplayed);
+	cons->setFlagBoundaries(boundariesDisplayed);
+	cons->setFlagLines(linesDisplayed);
+	cons->setFlagLabels(namesDisplayed);
+}
+
 void ConstellationMgr::loadLinesAndArt(const QString &fileName, const QString &artfileName, const QString& cultureName)
 {
 	QFile in(fileName);
@@ -328,6 +379,8 @@ void ConstellationMgr::loadLinesAndArt(const QString &fileName, const QString &a
 	in.seek(0);
 
 	// delete existing data, if any
+	boundaryIndex.clear();
+	boundaryIndexBuilt = false;
 	vector < Constellation * >::iterator iter;
 	for (iter = asterisms.begin(); iter != asterisms.end(); ++iter)
 		delete(*iter);
@@ -348,11 +401,7 @@ void ConstellationMgr::loadLinesAndArt(const QString &fileName, const QString &a
 		cons = new Constellation;
 		if(cons->read(record, hipStarMgr))
 		{
-			cons->artFader.setMaxValue(artIntensity);
-			cons->setFlagArt(artDisplayed);
-			cons->setFlagBoundaries(boundariesDisplayed);
-			cons->setFlagLines(linesDisplayed);
-			cons->setFlagLabels(namesDisplayed);
+			initConstellationState(cons);
 			asterisms.push_back(cons);
 			++readOk;
 		}
@@ -448,7 +497,8 @@ void ConstellationMgr::loadLinesAndArt(const QString &fileName, const QString &a
 				qWarning() << "ERROR: could not find texture, " << QDir::toNativeSeparators(texfile);
 			}
 
-			cons->artTexture = StelApp::getInstance().getTextureManager().createTexture(texturePath);
+			// The image is only decoded, in a thread, when the art is first drawn
+			cons->artTexture = StelApp::getInstance().getTextureManager().createTextureThread(texturePath);
 
 			int texSizeX = 0, texSizeY = 0;
 			if (cons->artTexture==NULL || !cons->artTexture->getDimensions(texSizeX, texSizeY))
@@ -456,10 +506,21 @@ void ConstellationMgr::loadLinesAndArt(const QString &fileName, const QString &a
 				qWarning() << "Texture dimension not available";
 			}
 
+			const StelObjectP star1 = hipStarMgr->searchHP(hp1);
+			const StelObjectP star2 = hipStarMgr->searchHP(hp2);
+			const StelObjectP star3 = hipStarMgr->searchHP(hp3);
+			if (!star1 || !star2 || !star3)
+			{
+				qWarning() << "ERROR in constellation art file at line" << currentLineNumber << "for culture" << cultureName
+					   << "- anchor star not found for constellation" << shortname;
+				cons->artTexture.clear();
+				continue;
+			}
+
 			StelCore* core = StelApp::getInstance().getCore();
-			Vec3d s1 = hipStarMgr->searchHP(hp1)->getJ2000EquatorialPos(core);
-			Vec3d s2 = hipStarMgr->searchHP(hp2)->getJ2000EquatorialPos(core);
-			Vec3d s3 = hipStarMgr->searchHP(hp3)->getJ2000EquatorialPos(core);
+			Vec3d s1 = star1->getJ2000EquatorialPos(core);
+			Vec3d s2 = star2->getJ2000EquatorialPos(core);
+			Vec3d s3 = star3->getJ2000EquatorialPos(core);
 
 			// To transform from texture coordinate to 2d coordinate we need to find X with XA = B
 			// A formed of 4 points in texture coordinate, B formed with 4 points in 3d coordinate
@@ -581,6 +642,7 @@ void ConstellationMgr::drawNames(StelPainter& sPainter) const
 		if (sPainter.getProjector()->projectCheck((*iter)->XYZname, (*iter)->XYname))
 			(*iter)->drawName(sPainter);
 	}
+	StelApp::getInstance().getCore()->getLabelScheduler()->flush(sPainter);
 }
 
 Constellation *ConstellationMgr::isStarIn(const StelObject* s) const
@@ -630,62 +692,59 @@ void ConstellationMgr::loadNames(const QString& namesFile)
 	}
 
 	// Open file
-	QFile commonNameFile(namesFile);
-	if (!commonNameFile.open(QIODevice::ReadOnly | QIODevice::Text))
+	StelRecordReader commonNameFile(namesFile);
+	if (!commonNameFile.isOpen())
 	{
 		qDebug() << "Cannot open file" << QDir::toNativeSeparators(namesFile);
 		return;
 	}
 
-	// Now parse the file
-	// lines to ignore which start with a # or are empty
-	QRegExp commentRx("^(\\s*#.*|\\s*)$");
-
-	// lines which look like records - we use the RE to extract the fields
-	// which will be available in recRx.capturedTexts()
-	QRegExp recRx("^\\s*(\\w+)\\s+\"(.*)\"\\s+_[(]\"(.*)\"[)]\\n");
+	// Now parse the file. Records look like:
+	// And	"Andromeda"	_("Andromeda")
+	// lines which start with a # or are empty are ignored.
 
 	// Some more variables to use in the parsing
 	Constellation *aster;
-	QString record, shortName;
+	StelRecordReader::Field record;
 
 	// keep track of how many records we processed.
 	int totalRecords=0;
 	int readOk=0;
-	int lineNumber=0;
-	while (!commonNameFile.atEnd())
+	while (commonNameFile.readLine(record))
 	{
-		record = QString::fromUtf8(commonNameFile.readLine());
-		lineNumber++;
-
 		// Skip comments
-		if (commentRx.exactMatch(record))
+		if (StelRecordReader::isComment(record))
 			continue;
 
 		totalRecords++;
 
-		if (!recRx.exactMatch(record))
+		const StelRecordReader::Field shortName = record.takeWord();
+		const StelRecordReader::Field names = record.trimmed();
+		const int englishPos = names.lastIndexOf("_(\"");
+		bool nativeOk = false;
+		bool englishOk = false;
+		const StelRecordReader::Field nativeName = names.mid(0, qMax(englishPos, 0)).trimmed().unwrapped("\"", "\"", &nativeOk);
+		const StelRecordReader::Field englishName = names.mid(englishPos).unwrapped("_(\"", "\")", &englishOk);
+		if (shortName.isEmpty() || englishPos<0 || !nativeOk || !englishOk)
 		{
-			qWarning() << "ERROR - cannot parse record at line" << lineNumber << "in constellation names file" << QDir::toNativeSeparators(namesFile);
+			qWarning() << "ERROR - cannot parse record at line" << commonNameFile.getLineNumber() << "in constellation names file" << QDir::toNativeSeparators(namesFile);
 		}
 		else
 		{
-			shortName = recRx.capturedTexts().at(1);
-			aster = findFromAbbreviation(shortName);
+			aster = findFromAbbreviation(shortName.toString());
 			// If the constellation exists, set the English name
 			if (aster != NULL)
 			{
-				aster->nativeName = recRx.capturedTexts().at(2);
-				aster->englishName = recRx.capturedTexts().at(3);
+				aster->nativeName = nativeName.toString();
+				aster->englishName = englishName.toString();
 				readOk++;
 			}
 			else
 			{
-				qWarning() << "WARNING - constellation abbreviation" << shortName << "not found when loading constellation names";
+				qWarning() << "WARNING - constellation abbreviation" << shortName.toString() << "not found when loading constellation names";
 			}
 		}
 	}
-	commonNameFile.close();
 	qDebug() << "Loaded" << readOk << "/" << totalRecords << "constellation names";
 }
 
@@ -1036,6 +1095,8 @@ bool ConstellationMgr::loadBoundaries(const QString& boundaryFile)
 		delete (*iter);
 	}
 	allBoundarySegments.clear();
+	boundaryIndex.clear();
+	boundaryIndexBuilt = false;
 
 	qDebug() << "Loading constellation boundary data ... ";
 
@@ -1105,6 +1166,184 @@ bool ConstellationMgr::loadBoundaries(const QString& boundaryFile)
 	return true;
 }
 
+//! Triangle of the area of a constellation, stored in the boundary index.
+class ConstellationBoundaryTriangle : public StelRegionObject
+{
+public:
+	ConstellationBoundaryTriangle(const Vec3d& v0, const Vec3d& v1, const Vec3d& v2, const Constellation* c)
+		: triangle(new SphericalConvexPolygon(v0, v1, v2)), constellation(c) {;}
+	virtual SphericalRegionP getRegion() const {return triangle;}
+	virtual Vec3d getPointInRegion() const {return triangle->getPointInside();}
+	SphericalRegionP triangle;
+	const Constellation* constellation;
+};
+
+// Insert the triangles of a constellation area in the boundary index
+struct BoundaryTriangleInserter
+{
+	BoundaryTriangleInserter(StelSphericalIndex* aindex, const Constellation* c) : index(aindex), constellation(c), nbTriangles(0) {;}
+	void operator()(const Vec3d* v0, const Vec3d* v1, const Vec3d* v2,
+			const Vec2f*, const Vec2f*, const Vec2f*,
+			unsigned int, unsigned int, unsigned int)
+	{
+		// Skip degenerated triangles and make sure the others are counterclockwise
+		const double det = ((*v1)^(*v0))*(*v2);
+		if (std::fabs(det)<1e-14)
+			return;
+		if (det>0.)
+			index->insert(StelRegionObjectP(new ConstellationBoundaryTriangle(*v0, *v1, *v2, constellation)));
+		else
+			index->insert(StelRegionObjectP(new ConstellationBoundaryTriangle(*v0, *v2, *v1, constellation)));
+		++nbTriangles;
+	}
+	StelSphericalIndex* index;
+	const Constellation* constellation;
+	int nbTriangles;
+};
+
+// Find the triangle of the boundary index containing a point
+struct BoundaryTriangleFinder
+{
+	BoundaryTriangleFinder() : result(NULL) {;}
+	void operator()(const StelRegionObject* obj)
+	{
+		if (!result)
+			result = obj;
+	}
+	const StelRegionObject* result;
+};
+
+static bool isSameBoundaryPoint(const Vec3f& a, const Vec3f& b)
+{
+	return (a-b).lengthSquared()<1e-12f;
+}
+
+// Chain the boundary segments of a constellation into closed contours
+static QVector<QVector<Vec3d> > chainBoundarySegments(const vector<vector<Vec3f> *>& segments, const QString& name)
+{
+	QVector<QVector<Vec3d> > contours;
+	QVector<bool> used(segments.size(), false);
+	for (unsigned int s=0; s<segments.size(); ++s)
+	{
+		if (used[s] || segments[s]->size()<2)
+			continue;
+		used[s] = true;
+		QVector<Vec3f> contour = QVector<Vec3f>::fromStdVector(*segments[s]);
+		bool closed = contour.size()>2 && isSameBoundaryPoint(contour.first(), contour.last());
+		while (!closed)
+		{
+			bool found = false;
+			for (unsigned int i=0; i<segments.size() && !found; ++i)
+			{
+				if (used[i])
+					continue;
+				const vector<Vec3f>& seg = *segments[i];
+				if (isSameBoundaryPoint(seg.front(), contour.last()))
+				{
+					for (unsigned int j=1; j<seg.size(); ++j)
+						contour.append(seg[j]);
+					found = true;
+				}
+				else if (isSameBoundaryPoint(seg.back(), contour.last()))
+				{
+					for (int j=(int)seg.size()-2; j>=0; --j)
+						contour.append(seg[j]);
+					found = true;
+				}
+				if (found)
+					used[i] = true;
+			}
+			if (!found)
+				break;
+			closed = isSameBoundaryPoint(contour.first(), contour.last());
+		}
+		if (!closed)
+		{
+			qWarning() << "Constellation boundary of" << name << "is not closed, ignored";
+			continue;
+		}
+		contour.removeLast();
+		QVector<Vec3d> c;
+		c.reserve(contour.size());
+		foreach (const Vec3f& v, contour)
+		{
+			Vec3d vd(v[0], v[1], v[2]);
+			vd.normalize();
+			c.append(vd);
+		}
+		contours.append(c);
+	}
+	return contours;
+}
+
+void ConstellationMgr::buildBoundaryIndex() const
+{
+	boundaryIndex.clear();
+	boundaryIndexBuilt = true;
+	int nbTriangles = 0;
+	vector<Constellation*>::const_iterator iter;
+	for (iter = asterisms.begin(); iter != asterisms.end(); ++iter)
+	{
+		const QVector<QVector<Vec3d> > contours = chainBoundarySegments((*iter)->isolatedBoundarySegments, (*iter)->abbreviation);
+		foreach (QVector<Vec3d> contour, contours)
+		{
+			// The area of a constellation is on the left of its contour and is always smaller than a hemisphere
+			SphericalPolygon area(QVector<QVector<Vec3d> >() << contour);
+			double a = area.getArea();
+			if (a<=0. || a>2.*M_PI)
+			{
+				std::reverse(contour.begin(), contour.end());
+				area = SphericalPolygon(QVector<QVector<Vec3d> >() << contour);
+				a = area.getArea();
+				if (a<=0. || a>2.*M_PI)
+				{
+					qWarning() << "Invalid constellation boundary for" << (*iter)->abbreviation;
+					continue;
+				}
+			}
+			BoundaryTriangleInserter inserter(&boundaryIndex, *iter);
+			inserter = area.getFillVertexArray().foreachTriangle(inserter);
+			nbTriangles += inserter.nbTriangles;
+		}
+	}
+	qDebug() << "Indexed" << nbTriangles << "constellation boundary triangles";
+}
+
+const StelRegionObject* ConstellationMgr::findBoundaryTriangle(const Vec3d& j2000Pos, const StelRegionObject* hint) const
+{
+	if (!boundaryIndexBuilt)
+		buildBoundaryIndex();
+	Vec3d v(j2000Pos);
+	v.normalize();
+	if (hint && hint->getRegion()->contains(v))
+		return hint;
+	const SphericalPoint point(v);
+	BoundaryTriangleFinder finder;
+	boundaryIndex.processIntersectingRegions(&point, finder);
+	return finder.result;
+}
+
+QString ConstellationMgr::getConstellationAt(const Vec3d& j2000Pos) const
+{
+	const StelRegionObject* triangle = findBoundaryTriangle(j2000Pos, NULL);
+	return triangle ? static_cast<const ConstellationBoundaryTriangle*>(triangle)->constellation->getShortName() : QString();
+}
+
+QStringList ConstellationMgr::getConstellationsAt(const QVector<Vec3d>& j2000Pos) const
+{
+	QStringList res;
+	res.reserve(j2000Pos.size());
+	const StelRegionObject* triangle = NULL;
+	foreach (const Vec3d& v, j2000Pos)
+	{
+		const StelRegionObject* found = findBoundaryTriangle(v, triangle);
+		if (found)
+			triangle = found;
+		res.append(found ? static_cast<const ConstellationBoundaryTriangle*>(found)->constellation->getShortName() : QString());
+	}
+	return res;
+}
+
 void ConstellationMgr::drawBoundaries(StelPainter& sPainter) const
 {
 	sPainter.enableTexture2d(false);
@@ -25,16 +25,19 @@
 #include <QString>
 #include <QStringList>
 #include <QFont>
+#include <QCache>
 
 #include "StelObjectType.hpp"
 #include "StelObjectModule.hpp"
 #include "StelProjectorType.hpp"
+#include "StelSphericalIndex.hpp"
 
 class StelToneReproducer;
 class StarMgr;
 class Constellation;
 class StelProjector;
 class StelPainter;
+class StelRegionObject;
 
 //! @class ConstellationMgr
 //! Display and manage the constellations.
@@ -139,6 +142,18 @@ public:
 	virtual QStringList listAllObjects(bool inEnglish) const;
 	virtual QString getName() const { return "Constellations"; }
 
+	//! Return the abbreviation of the constellation whose boundaries contain the given position.
+	//! The boundaries are compiled in a spatial index the first time this is called.
+	//! @param j2000Pos a unit vector in the J2000 equatorial frame.
+	//! @return the constellation abbreviation, or an empty string if no boundaries are loaded.
+	QString getConstellationAt(const Vec3d& j2000Pos) const;
+
+	//! Return the abbreviations of the constellations containing each of the given positions.
+	//! Positions close to the previous one in the list are classified faster, so sorting
+	//! a catalog spatially speeds up the classification.
+	//! @param j2000Pos unit vectors in the J2000 equatorial frame.
+	QStringList getConstellationsAt(const QVector<Vec3d>& j2000Pos) const;
+
 	///////////////////////////////////////////////////////////////////////////
 	// Properties setters and getters
 public slots:	
@@ -242,6 +257,9 @@ private:
 	//! @param namesFile Name of the file containing the constellation names in english
 	void loadNames(const QString& namesFile);
 
+	//! Set the fader states of a loaded constellation from the master settings.
+	void initConstellationState(Constellation* cons) const;
+
 	//! Load constellation line shapes, art textures and boundaries shapes from data files.
 	//! @param fileName The name of the constellation data file
 	//! @param artFileName The name of the constellation art data file
@@ -262,6 +280,12 @@ private:
 	//!    the boundary separates.
 	//! @param conCatFile the path to the file which contains the constellation boundary data.
 	bool loadBoundaries(const QString& conCatFile);
+	//! Compile the boundary segments of each constellation into closed contours and
+	//! insert the triangles covering their areas in the boundary index.
+	void buildBoundaryIndex() const;
+	//! Return the triangle of the boundary index containing the given position, or NULL.
+	//! @param hint a triangle tested before searching the index, may be NULL.
+	const StelRegionObject* findBoundaryTriangle(const Vec3d& j2000Pos, const StelRegionObject* hint) const;
         //! Draw the constellation lines at the epoch given by the StelCore.
 	void drawLines(StelPainter& sPainter, const StelCore* core) const;
 	//! Draw the constellation art.
@@ -299,9 +323,22 @@ private:
 
 	bool isolateSelected;
 	std::vector<std::vector<Vec3f> *> allBoundarySegments;
+	//! Triangles covering the area of each constellation, built on first use.
+	mutable StelSphericalIndex boundaryIndex;
+	mutable bool boundaryIndexBuilt;
 
 	QString lastLoadedSkyCulture;	// Store the last loaded sky culture directory name
 
+	//! Constellations and boundaries of a sky culture which is not displayed.
+	struct SkyCultureBundle
+	{
+		~SkyCultureBundle();
+		std::vector<Constellation*> asterisms;
+		std::vector<std::vector<Vec3f> *> boundarySegments;
+	};
+	//! The recently used sky cultures, so that switching back to one doesn't reload its files.
+	QCache<QString, SkyCultureBundle> skyCultureCache;
+
 	// These are THE master settings - individual constellation settings can vary based on selection status
 	float artFadeDuration;
 	float artIntensity;
@@ -21,6 +21,7 @@
 #include <QSettings>
 #include <QDebug>
 #include <QFontMetrics>
+#include <QVector>
 
 #include "GridLinesMgr.hpp"
 #include "StelApp.hpp"
@@ -35,6 +36,81 @@
 #include "StelPainter.hpp"
 #include "StelSkyDrawer.hpp"
 
+struct ViewportEdgeIntersectCallbackData;
+
+//! @class SkyArcCache
+//! Arcs of a grid or line tessellated in the native coordinates of their frame.
+//! The arcs covering a cap larger than the viewport are sampled once for a given grid step
+//! and angular resolution, and reused as long as the viewport stays inside the covered cap.
+//! At each frame only the chunks of samples intersecting the viewport are projected, and
+//! all the visible segments are drawn in one batch.
+class SkyArcCache
+{
+public:
+	SkyArcCache() : sampleStep(0.), stepA(0.), stepB(0.) {;}
+
+	//! Return whether the cached arcs can be used to draw the given viewport.
+	//! @param viewportCap the bounding cap of the viewport.
+	//! @param wantedSampleStep the wanted angular distance between 2 samples in radian.
+	//! @param a,b the grid steps used when the arcs were computed.
+	bool isValid(const SphericalCap& viewportCap, double wantedSampleStep, double a=0., double b=0.) const;
+
+	//! Remove all the arcs and set the parameters of the new geometry.
+	//! The arcs added after this call must cover the returned cap.
+	const SphericalCap& reset(const SphericalCap& viewportCap, double aSampleStep, double a=0., double b=0.);
+
+	//! Sample and store the arc going from start to stop around the axis passing through rotCenter.
+	//! rotCenter is null for great circles. The arc must be shorter than 180 deg.
+	//! @param raAngle,text the label parameters passed to the viewport edge callback.
+	void addArc(const Vec3d& start, const Vec3d& stop, const Vec3d& rotCenter, double raAngle, const QString& text);
+
+	//! Project and draw the visible arcs, then draw the labels where the arcs cross the viewport edges.
+	void draw(StelPainter& sPainter, ViewportEdgeIntersectCallbackData& userData) const;
+
+	//! Force the recomputation of the arcs at the next draw.
+	void invalidate() {sampleStep=0.;}
+
+	//! Return the angular distance between 2 samples giving smooth lines for the given projector.
+	static double getWantedSampleStep(const StelProjectorP& prj);
+
+private:
+	//! Number of segments per chunk used for the visibility test.
+	static const int ChunkSize = 16;
+
+	struct Arc
+	{
+		double raAngle;
+		QString text;
+	};
+	struct Chunk
+	{
+		//! Bounding cap of the samples.
+		Vec3d n;
+		double d;
+		int arc;
+		int first;
+		//! Number of samples, including the first sample of the next chunk.
+		int nbPoints;
+	};
+	struct LabelPos
+	{
+		Vec3d screenPos;
+		Vec3d direction;
+		int arc;
+	};
+
+	SphericalCap coveredCap;
+	double sampleStep;
+	double stepA, stepB;
+	QVector<Vec3d> points;
+	QVector<Chunk> chunks;
+	QVector<Arc> arcs;
+
+	//! Per frame buffers.
+	mutable QVector<Vec2f> lineVertices;
+	mutable QVector<LabelPos> labels;
+};
+
 //! @class SkyGrid
 //! Class which manages a grid to display in the sky.
 //! TODO needs support for DMS/DMS labelling, not only HMS/DMS
@@ -53,10 +129,14 @@ public:
 	void setDisplayed(const bool displayed){fader = displayed;}
 	bool isDisplayed(void) const {return fader;}
 private:
+	//! Compute the meridians and parallels crossing the given cap.
+	void computeArcs(const SphericalCap& cap, const Vec3d& firstPoint, double gridStepMeridianRad, double gridStepParallelRad) const;
+
 	Vec3f color;
 	StelCore::FrameType frameType;
 	QFont font;
 	LinearFader fader;
+	mutable SkyArcCache arcCache;
 };
 
 
@@ -93,6 +173,7 @@ private:
 	LinearFader fader;
 	QFont font;
 	QString label;
+	mutable SkyArcCache arcCache;
 };
 
 // rms added color as parameter
@@ -260,6 +341,144 @@ void viewportEdgeIntersectCallback(const Vec3d& screenPos, const Vec3d& directio
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
+double SkyArcCache::getWantedSampleStep(const StelProjectorP& prj)
+{
+	// About 4 pixels per segment at the center of the screen
+	return qMin(M_PI/360., 4./prj->getPixelPerRadAtCenter());
+}
+
+bool SkyArcCache::isValid(const SphericalCap& viewportCap, double wantedSampleStep, double a, double b) const
+{
+	if (sampleStep<=0. || a!=stepA || b!=stepB)
+		return false;
+	// Keep the samples while the resolution doesn't change too much
+	if (sampleStep>wantedSampleStep*1.5 || sampleStep*1.5<wantedSampleStep)
+		return false;
+	return coveredCap.contains(viewportCap);
+}
+
+const SphericalCap& SkyArcCache::reset(const SphericalCap& viewportCap, double aSampleStep, double a, double b)
+{
+	// Cover twice the viewport radius so that the arcs can be reused while panning
+	const double radius = 2.*viewportCap.getRadius();
+	coveredCap.n = viewportCap.n;
+	coveredCap.n.normalize();
+	coveredCap.d = radius>=M_PI ? -1. : std::cos(radius);
+	sampleStep = aSampleStep;
+	stepA = a;
+	stepB = b;
+	points.resize(0);
+	chunks.resize(0);
+	arcs.resize(0);
+	return coveredCap;
+}
+
+void SkyArcCache::addArc(const Vec3d& start, const Vec3d& stop, const Vec3d& rotCenter, double raAngle, const QString& text)
+{
+	const Vec3d u = start-rotCenter;
+	const Vec3d v = stop-rotCenter;
+	const double radius = u.length();
+	if (radius<=0.)
+		return;
+	const double cosAngle = qBound(-1., u*v/(radius*v.length()), 1.);
+	const double angle = std::acos(cosAngle);
+	// Vector in the plane of the circle, orthogonal to u and of the same length
+	Vec3d w = v-u*(u*v/(radius*radius));
+	if (w.lengthSquared()<=0.)
+		return;
+	w.normalize();
+	w*=radius;
+
+	const int arc = arcs.size();
+	Arc a;
+	a.raAngle = raAngle;
+	a.text = text;
+	arcs.append(a);
+
+	// The arc radius reduces the angular distance between 2 samples
+	const int nbSegments = qMax(1, (int)std::ceil(angle*radius/sampleStep));
+	const int first = points.size();
+	for (int i=0;i<=nbSegments;++i)
+	{
+		const double t = angle*i/nbSegments;
+		points.append(rotCenter+u*std::cos(t)+w*std::sin(t));
+	}
+
+	for (int i=0;i<nbSegments;i+=ChunkSize)
+	{
+		Chunk c;
+		c.arc = arc;
+		c.first = first+i;
+		c.nbPoints = qMin(ChunkSize, nbSegments-i)+1;
+		c.n = points.at(c.first)+points.at(c.first+c.nbPoints-1);
+		if (c.n.lengthSquared()<=0.)
+			c.n = points.at(c.first+c.nbPoints/2);
+		c.n.normalize();
+		c.d = 1.;
+		for (int j=0;j<c.nbPoints;++j)
+			c.d = qMin(c.d, c.n*points.at(c.first+j));
+		chunks.append(c);
+	}
+}
+
+void SkyArcCache::draw(StelPainter& sPainter, ViewportEdgeIntersectCallbackData& userData) const
+{
+	const StelProjectorP prj = sPainter.getProjector();
+	const SphericalCap& viewportCap = prj->getBoundingCap();
+	lineVertices.resize(0);
+	labels.resize(0);
+
+	Vec3d win1, win2;
+	foreach (const Chunk& c, chunks)
+	{
+		const SphericalCap chunkCap(c.n, c.d);
+		if (!viewportCap.intersects(chunkCap))
+			continue;
+		const bool checkDiscontinuity = prj->intersectViewportDiscontinuity(chunkCap);
+		bool valid1 = prj->project(points.at(c.first), win1);
+		bool in1 = prj->checkInViewport(win1);
+		for (int i=c.first+1;i<c.first+c.nbPoints;++i)
+		{
+			const bool valid2 = prj->project(points.at(i), win2);
+			const bool in2 = prj->checkInViewport(win2);
+			if (valid1 && valid2 && (in1 || in2) && !(checkDiscontinuity && prj->intersectViewportDiscontinuity(points.at(i-1), points.at(i))))
+			{
+				lineVertices.append(Vec2f(win1[0], win1[1]));
+				lineVertices.append(Vec2f(win2[0], win2[1]));
+				if (in1!=in2)
+				{
+					// We crossed the edge of the viewport
+					LabelPos l;
+					l.screenPos = in1 ? prj->viewPortIntersect(win1, win2) : prj->viewPortIntersect(win2, win1);
+					l.direction = in1 ? win2-win1 : win1-win2;
+					l.direction[2] = 0.;
+					l.arc = c.arc;
+					labels.append(l);
+				}
+			}
+			win1 = win2;
+			valid1 = valid2;
+			in1 = in2;
+		}
+	}
+
+	if (!lineVertices.isEmpty())
+	{
+		sPainter.enableClientStates(true);
+		sPainter.setVertexPointer(2, GL_FLOAT, lineVertices.constData());
+		sPainter.drawFromArray(StelPainter::Lines, lineVertices.size(), 0, false);
+		sPainter.enableClientStates(false);
+	}
+
+	foreach (const LabelPos& l, labels)
+	{
+		const Arc& a = arcs.at(l.arc);
+		userData.raAngle = a.raAngle;
+		userData.text = a.text;
+		viewportEdgeIntersectCallback(l.screenPos, l.direction, &userData);
+	}
+}
+
 //! Draw the sky grid in the current frame
 void SkyGrid::draw(const StelCore* core) const
 {
@@ -295,15 +514,20 @@ void SkyGrid::draw(const StelCore* core) const
 	// Get the bounding halfspace
 	const SphericalCap& viewPortSphericalCap = prj->getBoundingCap();
 
-	// Compute the first grid starting point. This point is close to the center of the screen
-	// and lays at the intersection of a meridien and a parallel
-	lon2 = gridStepMeridianRad*((int)(lon2/gridStepMeridianRad+0.5));
-	lat2 = gridStepParallelRad*((int)(lat2/gridStepParallelRad+0.5));
-	Vec3d firstPoint;
-	StelUtils::spheToRect(lon2, lat2, firstPoint);
-	firstPoint.normalize();
-
-	// Q_ASSERT(viewPortSphericalCap.contains(firstPoint));
+	// Recompute the arcs only when the steps, the resolution or the covered region change
+	const double sampleStep = SkyArcCache::getWantedSampleStep(prj);
+	if (!arcCache.isValid(viewPortSphericalCap, sampleStep, gridStepMeridianRad, gridStepParallelRad))
+	{
+		// Compute the first grid starting point. This point is close to the center of the screen
+		// and lays at the intersection of a meridien and a parallel
+		lon2 = gridStepMeridianRad*((int)(lon2/gridStepMeridianRad+0.5));
+		lat2 = gridStepParallelRad*((int)(lat2/gridStepParallelRad+0.5));
+		Vec3d firstPoint;
+		StelUtils::spheToRect(lon2, lat2, firstPoint);
+		firstPoint.normalize();
+		const SphericalCap& cap = arcCache.reset(viewPortSphericalCap, sampleStep, gridStepMeridianRad, gridStepParallelRad);
+		computeArcs(cap, firstPoint, gridStepMeridianRad, gridStepParallelRad);
+	}
 
 	// Initialize a painter and set openGL state
 	StelPainter sPainter(prj);
@@ -319,9 +543,15 @@ void SkyGrid::draw(const StelCore* core) const
 	ViewportEdgeIntersectCallbackData userData(&sPainter);
 	userData.textColor = textColor;
 	userData.frameType = frameType;
+	arcCache.draw(sPainter, userData);
+}
+
+void SkyGrid::computeArcs(const SphericalCap& coveredCap, const Vec3d& firstPoint, double gridStepMeridianRad, double gridStepParallelRad) const
+{
+	double lon2, lat2;
 
 	/////////////////////////////////////////////////
-	// Draw all the meridians (great circles)
+	// Compute all the meridians (great circles)
 	SphericalCap meridianSphericalCap(Vec3d(1,0,0), 0);
 	Mat4d rotLon = Mat4d::zrotation(gridStepMeridianRad);
 	Vec3d fpt = firstPoint;
@@ -331,23 +561,23 @@ void SkyGrid::draw(const StelCore* core) const
 	for (i=0; i<maxNbIter; ++i)
 	{
 		StelUtils::rectToSphe(&lon2, &lat2, fpt);
-		userData.raAngle = lon2;
+		const double raAngle = lon2;
 
 		meridianSphericalCap.n = fpt^Vec3d(0,0,1);
 		meridianSphericalCap.n.normalize();
-		if (!SphericalCap::intersectionPoints(viewPortSphericalCap, meridianSphericalCap, p1, p2))
+		if (!SphericalCap::intersectionPoints(coveredCap, meridianSphericalCap, p1, p2))
 		{
-			if (viewPortSphericalCap.d<meridianSphericalCap.d && viewPortSphericalCap.contains(meridianSphericalCap.n))
+			if (coveredCap.d<meridianSphericalCap.d && coveredCap.contains(meridianSphericalCap.n))
 			{
-				// The meridian is fully included in the viewport, draw it in 3 sub-arcs to avoid length > 180.
+				// The meridian is fully included in the viewport, split it in 3 sub-arcs to avoid length > 180.
 				const Mat4d& rotLon120 = Mat4d::rotation(meridianSphericalCap.n, 120.*M_PI/180.);
 				Vec3d rotFpt=fpt;
 				rotFpt.transfo4d(rotLon120);
 				Vec3d rotFpt2=rotFpt;
 				rotFpt2.transfo4d(rotLon120);
-				sPainter.drawGreatCircleArc(fpt, rotFpt, NULL, viewportEdgeIntersectCallback, &userData);
-				sPainter.drawGreatCircleArc(rotFpt, rotFpt2, NULL, viewportEdgeIntersectCallback, &userData);
-				sPainter.drawGreatCircleArc(rotFpt2, fpt, NULL, viewportEdgeIntersectCallback, &userData);
+				arcCache.addArc(fpt, rotFpt, Vec3d(0.), raAngle, QString());
+				arcCache.addArc(rotFpt, rotFpt2, Vec3d(0.), raAngle, QString());
+				arcCache.addArc(rotFpt2, fpt, Vec3d(0.), raAngle, QString());
 				fpt.transfo4d(rotLon);
 				continue;
 			}
@@ -357,12 +587,12 @@ void SkyGrid::draw(const StelCore* core) const
 
 		Vec3d middlePoint = p1+p2;
 		middlePoint.normalize();
-		if (!viewPortSphericalCap.contains(middlePoint))
+		if (!coveredCap.contains(middlePoint))
 			middlePoint*=-1.;
 
-		// Draw the arc in 2 sub-arcs to avoid lengths > 180 deg
-		sPainter.drawGreatCircleArc(p1, middlePoint, NULL, viewportEdgeIntersectCallback, &userData);
-		sPainter.drawGreatCircleArc(p2, middlePoint, NULL, viewportEdgeIntersectCallback, &userData);
+		// Split the arc in 2 sub-arcs to avoid lengths > 180 deg
+		arcCache.addArc(p1, middlePoint, Vec3d(0.), raAngle, QString());
+		arcCache.addArc(p2, middlePoint, Vec3d(0.), raAngle, QString());
 
 		fpt.transfo4d(rotLon);
 	}
@@ -375,27 +605,27 @@ void SkyGrid::draw(const StelCore* core) const
 		for (int j=0; j<maxNbIter-i; ++j)
 		{
 			StelUtils::rectToSphe(&lon2, &lat2, fpt);
-			userData.raAngle = lon2;
+			const double raAngle = lon2;
 
 			meridianSphericalCap.n = fpt^Vec3d(0,0,1);
 			meridianSphericalCap.n.normalize();
-			if (!SphericalCap::intersectionPoints(viewPortSphericalCap, meridianSphericalCap, p1, p2))
+			if (!SphericalCap::intersectionPoints(coveredCap, meridianSphericalCap, p1, p2))
 				break;
 
 			Vec3d middlePoint = p1+p2;
 			middlePoint.normalize();
-			if (!viewPortSphericalCap.contains(middlePoint))
+			if (!coveredCap.contains(middlePoint))
 				middlePoint*=-1;
 
-			sPainter.drawGreatCircleArc(p1, middlePoint, NULL, viewportEdgeIntersectCallback, &userData);
-			sPainter.drawGreatCircleArc(p2, middlePoint, NULL, viewportEdgeIntersectCallback, &userData);
+			arcCache.addArc(p1, middlePoint, Vec3d(0.), raAngle, QString());
+			arcCache.addArc(p2, middlePoint, Vec3d(0.), raAngle, QString());
 
 			fpt.transfo4d(rotLon);
 		}
 	}
 
 	/////////////////////////////////////////////////
-	// Draw all the parallels (small circles)
+	// Compute all the parallels (small circles)
 	SphericalCap parallelSphericalCap(Vec3d(0,0,1), 0);
 	rotLon = Mat4d::rotation(firstPoint^Vec3d(0,0,1), gridStepParallelRad);
 	fpt = firstPoint;
@@ -403,27 +633,27 @@ void SkyGrid::draw(const StelCore* core) const
 	for (i=0; i<maxNbIter; ++i)
 	{
 		StelUtils::rectToSphe(&lon2, &lat2, fpt);
-		userData.text = StelUtils::radToDmsStrAdapt(lat2);
+		const QString text = StelUtils::radToDmsStrAdapt(lat2);
 
 		parallelSphericalCap.d = fpt[2];
 		if (parallelSphericalCap.d>0.9999999)
 			break;
 
 		const Vec3d rotCenter(0,0,parallelSphericalCap.d);
-		if (!SphericalCap::intersectionPoints(viewPortSphericalCap, parallelSphericalCap, p1, p2))
+		if (!SphericalCap::intersectionPoints(coveredCap, parallelSphericalCap, p1, p2))
 		{
-			if ((viewPortSphericalCap.d<parallelSphericalCap.d && viewPortSphericalCap.contains(parallelSphericalCap.n))
-				|| (viewPortSphericalCap.d<-parallelSphericalCap.d && viewPortSphericalCap.contains(-parallelSphericalCap.n)))
+			if ((coveredCap.d<parallelSphericalCap.d && coveredCap.contains(parallelSphericalCap.n))
+				|| (coveredCap.d<-parallelSphericalCap.d && coveredCap.contains(-parallelSphericalCap.n)))
 			{
-				// The parallel is fully included in the viewport, draw it in 3 sub-arcs to avoid lengths >= 180 deg
+				// The parallel is fully included in the viewport, split it in 3 sub-arcs to avoid lengths >= 180 deg
 				static const Mat4d rotLon120 = Mat4d::zrotation(120.*M_PI/180.);
 				Vec3d rotFpt=fpt;
 				rotFpt.transfo4d(rotLon120);
 				Vec3d rotFpt2=rotFpt;
 				rotFpt2.transfo4d(rotLon120);
-				sPainter.drawSmallCircleArc(fpt, rotFpt, rotCenter, viewportEdgeIntersectCallback, &userData);
-				sPainter.drawSmallCircleArc(rotFpt, rotFpt2, rotCenter, viewportEdgeIntersectCallback, &userData);
-				sPainter.drawSmallCircleArc(rotFpt2, fpt, rotCenter, viewportEdgeIntersectCallback, &userData);
+				arcCache.addArc(fpt, rotFpt, rotCenter, 0., text);
+				arcCache.addArc(rotFpt, rotFpt2, rotCenter, 0., text);
+				arcCache.addArc(rotFpt2, fpt, rotCenter, 0., text);
 				fpt.transfo4d(rotLon);
 				continue;
 			}
@@ -431,20 +661,20 @@ void SkyGrid::draw(const StelCore* core) const
 				break;
 		}
 
-		// Draw the arc in 2 sub-arcs to avoid lengths > 180 deg
+		// Split the arc in 2 sub-arcs to avoid lengths > 180 deg
 		Vec3d middlePoint = p1-rotCenter+p2-rotCenter;
 		middlePoint.normalize();
 		middlePoint*=(p1-rotCenter).length();
 		middlePoint+=rotCenter;
-		if (!viewPortSphericalCap.contains(middlePoint))
+		if (!coveredCap.contains(middlePoint))
 		{
 			middlePoint-=rotCenter;
 			middlePoint*=-1.;
 			middlePoint+=rotCenter;
 		}
 
-		sPainter.drawSmallCircleArc(p1, middlePoint, rotCenter, viewportEdgeIntersectCallback, &userData);
-		sPainter.drawSmallCircleArc(p2, middlePoint, rotCenter, viewportEdgeIntersectCallback, &userData);
+		arcCache.addArc(p1, middlePoint, rotCenter, 0., text);
+		arcCache.addArc(p2, middlePoint, rotCenter, 0., text);
 
 		fpt.transfo4d(rotLon);
 	}
@@ -457,24 +687,24 @@ void SkyGrid::draw(const StelCore* core) const
 		for (int j=0; j<maxNbIter-i; ++j)
 		{
 			StelUtils::rectToSphe(&lon2, &lat2, fpt);
-			userData.text = StelUtils::radToDmsStrAdapt(lat2);
+			const QString text = StelUtils::radToDmsStrAdapt(lat2);
 
 			parallelSphericalCap.d = fpt[2];
 			const Vec3d rotCenter(0,0,parallelSphericalCap.d);
-			if (!SphericalCap::intersectionPoints(viewPortSphericalCap, parallelSphericalCap, p1, p2))
+			if (!SphericalCap::intersectionPoints(coveredCap, parallelSphericalCap, p1, p2))
 			{
-				if ((viewPortSphericalCap.d<parallelSphericalCap.d && viewPortSphericalCap.contains(parallelSphericalCap.n))
-					 || (viewPortSphericalCap.d<-parallelSphericalCap.d && viewPortSphericalCap.contains(-parallelSphericalCap.n)))
+				if ((coveredCap.d<parallelSphericalCap.d && coveredCap.contains(parallelSphericalCap.n))
+					 || (coveredCap.d<-parallelSphericalCap.d && coveredCap.contains(-parallelSphericalCap.n)))
 				{
-					// The parallel is fully included in the viewport, draw it in 3 sub-arcs to avoid lengths >= 180 deg
+					// The parallel is fully included in the viewport, split it in 3 sub-arcs to avoid lengths >= 180 deg
 					static const Mat4d rotLon120 = Mat4d::zrotation(120.*M_PI/180.);
 					Vec3d rotFpt=fpt;
 					rotFpt.transfo4d(rotLon120);
 					Vec3d rotFpt2=rotFpt;
 					rotFpt2.transfo4d(rotLon120);
-					sPainter.drawSmallCircleArc(fpt, rotFpt, rotCenter, viewportEdgeIntersectCallback, &userData);
-					sPainter.drawSmallCircleArc(rotFpt, rotFpt2, rotCenter, viewportEdgeIntersectCallback, &userData);
-					sPainter.drawSmallCircleArc(rotFpt2, fpt, rotCenter, viewportEdgeIntersectCallback, &userData);
+					arcCache.addArc(fpt, rotFpt, rotCenter, 0., text);
+					arcCache.addArc(rotFpt, rotFpt2, rotCenter, 0., text);
+					arcCache.addArc(rotFpt2, fpt, rotCenter, 0., text);
 					fpt.transfo4d(rotLon);
 					continue;
 				}
@@ -482,20 +712,20 @@ void SkyGrid::draw(const StelCore* core) const
 					break;
 			}
 
-			// Draw the arc in 2 sub-arcs to avoid lengths > 180 deg
+			// Split the arc in 2 sub-arcs to avoid lengths > 180 deg
 			Vec3d middlePoint = p1-rotCenter+p2-rotCenter;
 			middlePoint.normalize();
 			middlePoint*=(p1-rotCenter).length();
 			middlePoint+=rotCenter;
-			if (!viewPortSphericalCap.contains(middlePoint))
+			if (!coveredCap.contains(middlePoint))
 			{
 				middlePoint-=rotCenter;
 				middlePoint*=-1.;
 				middlePoint+=rotCenter;
 			}
 
-			sPainter.drawSmallCircleArc(p1, middlePoint, rotCenter, viewportEdgeIntersectCallback, &userData);
-			sPainter.drawSmallCircleArc(p2, middlePoint, rotCenter, viewportEdgeIntersectCallback, &userData);
+			arcCache.addArc(p1, middlePoint, rotCenter, 0., text);
+			arcCache.addArc(p2, middlePoint, rotCenter, 0., text);
 
 			fpt.transfo4d(rotLon);
 		}
@@ -545,6 +775,8 @@ void SkyLine::updateLabel()
 			label = q_("Galactic Plane");
 			break;
 	}
+	// The label is stored with the arcs
+	arcCache.invalidate();
 }
 
 void SkyLine::draw(StelCore *core) const
@@ -557,63 +789,63 @@ void SkyLine::draw(StelCore *core) const
 	// Get the bounding halfspace
 	const SphericalCap& viewPortSphericalCap = prj->getBoundingCap();
 
-	// Initialize a painter and set openGL state
-	StelPainter sPainter(prj);
-	sPainter.setColor(color[0], color[1], color[2], fader.getInterstate());
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Normal transparency mode
-
-	Vec4f textColor(color[0], color[1], color[2], 0);		
-	textColor[3]=fader.getInterstate();
-
-	ViewportEdgeIntersectCallbackData userData(&sPainter);	
-	sPainter.setFont(font);
-	userData.textColor = textColor;	
-	userData.text = label;
-	/////////////////////////////////////////////////
-	// Draw the line
-	SphericalCap meridianSphericalCap(Vec3d(0,0,1), 0);	
-	Vec3d fpt(1,0,0);
-	if (line_type==MERIDIAN)
+	const double sampleStep = SkyArcCache::getWantedSampleStep(prj);
+	if (!arcCache.isValid(viewPortSphericalCap, sampleStep))
 	{
-		meridianSphericalCap.n.set(0,1,0);
-	}
+		const SphericalCap& coveredCap = arcCache.reset(viewPortSphericalCap, sampleStep);
 
-	Vec3d p1, p2;
-	if (!SphericalCap::intersectionPoints(viewPortSphericalCap, meridianSphericalCap, p1, p2))
-	{
-		if ((viewPortSphericalCap.d<meridianSphericalCap.d && viewPortSphericalCap.contains(meridianSphericalCap.n))
-			|| (viewPortSphericalCap.d<-meridianSphericalCap.d && viewPortSphericalCap.contains(-meridianSphericalCap.n)))
+		/////////////////////////////////////////////////
+		// Compute the line
+		SphericalCap meridianSphericalCap(Vec3d(0,0,1), 0);
+		Vec3d fpt(1,0,0);
+		if (line_type==MERIDIAN)
 		{
-			// The meridian is fully included in the viewport, draw it in 3 sub-arcs to avoid length > 180.
-			const Mat4d& rotLon120 = Mat4d::rotation(meridianSphericalCap.n, 120.*M_PI/180.);
-			Vec3d rotFpt=fpt;
-			rotFpt.transfo4d(rotLon120);
-			Vec3d rotFpt2=rotFpt;
-			rotFpt2.transfo4d(rotLon120);
-			sPainter.drawGreatCircleArc(fpt, rotFpt, NULL, viewportEdgeIntersectCallback, &userData);
-			sPainter.drawGreatCircleArc(rotFpt, rotFpt2, NULL, viewportEdgeIntersectCallback, &userData);
-			sPainter.drawGreatCircleArc(rotFpt2, fpt, NULL, viewportEdgeIntersectCallback, &userData);
-			return;
+			meridianSphericalCap.n.set(0,1,0);
 		}
-		else
-			return;
-	}
 
+		Vec3d p1, p2;
+		if (!SphericalCap::intersectionPoints(coveredCap, meridianSphericalCap, p1, p2))
+		{
+			if ((coveredCap.d<meridianSphericalCap.d && coveredCap.contains(meridianSphericalCap.n))
+				|| (coveredCap.d<-meridianSphericalCap.d && coveredCap.contains(-meridianSphericalCap.n)))
+			{
+				// The meridian is fully included in the covered cap, split it in 3 sub-arcs to avoid length > 180.
+				const Mat4d& rotLon120 = Mat4d::rotation(meridianSphericalCap.n, 120.*M_PI/180.);
+				Vec3d rotFpt=fpt;
+				rotFpt.transfo4d(rotLon120);
+				Vec3d rotFpt2=rotFpt;
+				rotFpt2.transfo4d(rotLon120);
+				arcCache.addArc(fpt, rotFpt, Vec3d(0.), 0., label);
+				arcCache.addArc(rotFpt, rotFpt2, Vec3d(0.), 0., label);
+				arcCache.addArc(rotFpt2, fpt, Vec3d(0.), 0., label);
+			}
+		}
+		else
+		{
+			Vec3d middlePoint = p1+p2;
+			middlePoint.normalize();
+			if (!coveredCap.contains(middlePoint))
+				middlePoint*=-1.;
 
-	Vec3d middlePoint = p1+p2;
-	middlePoint.normalize();
-	if (!viewPortSphericalCap.contains(middlePoint))
-		middlePoint*=-1.;
+			// Split the arc in 2 sub-arcs to avoid lengths > 180 deg
+			arcCache.addArc(p1, middlePoint, Vec3d(0.), 0., label);
+			arcCache.addArc(p2, middlePoint, Vec3d(0.), 0., label);
+		}
+	}
 
-	// Draw the arc in 2 sub-arcs to avoid lengths > 180 deg
-	sPainter.drawGreatCircleArc(p1, middlePoint, NULL, viewportEdgeIntersectCallback, &userData);
-	sPainter.drawGreatCircleArc(p2, middlePoint, NULL, viewportEdgeIntersectCallback, &userData);
+	// Initialize a painter and set openGL state
+	StelPainter sPainter(prj);
+	sPainter.setColor(color[0], color[1], color[2], fader.getInterstate());
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Normal transparency mode
 
-// 	// Johannes: use a big radius as a dirty workaround for the bug that the
-// 	// ecliptic line is not drawn around the observer, but around the sun:
-// 	const Vec3d vv(1000000,0,0);
+	Vec4f textColor(color[0], color[1], color[2], 0);
+	textColor[3]=fader.getInterstate();
 
+	ViewportEdgeIntersectCallbackData userData(&sPainter);
+	sPainter.setFont(font);
+	userData.textColor = textColor;
+	arcCache.draw(sPainter, userData);
 }
 
 GridLinesMgr::GridLinesMgr()
@@ -28,9 +28,16 @@
 #include "StelPainter.hpp"
 
 #include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QImageReader>
 #include <QSettings>
+#include <QTextStream>
 #include <QVarLengthArray>
 
+#include <cfloat>
+
 Landscape::Landscape(float _radius) : radius(_radius), skyBrightness(1.), nightBrightness(0.8), angleRotateZOffset(0.)
 {
 	validLandscape = 0;
@@ -116,6 +123,175 @@ const QString Landscape::getTexturePath(const QString& basename, const QString&
 	return path;
 }
 
+// Return the index of the horizon profile bin containing the given longitude, and the position in the bin
+static int horizonBin(double longitude, double* frac=NULL)
+{
+	double f = longitude/(2.*M_PI);
+	f = (f-std::floor(f))*Landscape::HorizonProfileSize;
+	const int i = qMin((int)f, Landscape::HorizonProfileSize-1);
+	if (frac)
+		*frac = f-i;
+	return i;
+}
+
+float Landscape::getHorizonAltitude(double longitude) const
+{
+	if (horizonProfile.isEmpty())
+		return 0.f;
+	double frac;
+	const int i = horizonBin(longitude + angleRotateZOffset*M_PI/180., &frac);
+	const float a0 = horizonProfile.at(i);
+	const float a1 = horizonProfile.at((i+1)%HorizonProfileSize);
+	return a0 + (a1-a0)*frac;
+}
+
+bool Landscape::isVisibleDirection(const Vec3d& altAzPos) const
+{
+	const double r = altAzPos.length();
+	if (r<=0.)
+		return false;
+	if (horizonProfile.isEmpty())
+		return altAzPos[2]>=0.;
+	return std::asin(altAzPos[2]/r) >= getHorizonAltitude(std::atan2(altAzPos[1], altAzPos[0]));
+}
+
+void Landscape::isVisibleDirection(int n, const Vec3d* altAzPos, bool* visible) const
+{
+	for (int i=0;i<n;++i)
+		visible[i] = isVisibleDirection(altAzPos[i]);
+}
+
+void Landscape::beginHorizonProfile()
+{
+	horizonProfile.fill(-FLT_MAX, HorizonProfileSize);
+}
+
+void Landscape::addHorizonPoint(double longitude, float altitude)
+{
+	Q_ASSERT(horizonProfile.size()==HorizonProfileSize);
+	double frac;
+	int i = horizonBin(longitude, &frac);
+	if (frac>0.5)
+		i = (i+1)%HorizonProfileSize;
+	horizonProfile[i] = qMax(horizonProfile.at(i), altitude);
+}
+
+void Landscape::endHorizonProfile()
+{
+	QVector<int> filled;
+	for (int i=0;i<horizonProfile.size();++i)
+	{
+		if (horizonProfile.at(i)>-FLT_MAX)
+			filled.append(i);
+	}
+	if (filled.isEmpty())
+	{
+		horizonProfile.clear();
+		return;
+	}
+	// Linear interpolation between the filled bins, wrapping around North
+	for (int k=0;k<filled.size();++k)
+	{
+		const int i0 = filled.at(k);
+		const int i1 = filled.at((k+1)%filled.size());
+		const int gap = (i1-i0+HorizonProfileSize-1)%HorizonProfileSize;
+		const float a0 = horizonProfile.at(i0);
+		const float a1 = horizonProfile.at(i1);
+		for (int j=1;j<=gap;++j)
+			horizonProfile[(i0+j)%HorizonProfileSize] = a0 + (a1-a0)*j/(gap+1);
+	}
+}
+
+bool Landscape::loadHorizonPolygon(const QSettings& landscapeIni, const QString& landscapeId)
+{
+	const QString fileName = landscapeIni.value("landscape/polygonal_horizon_list").toString();
+	if (fileName.isEmpty())
+		return false;
+	const QString path = StelFileMgr::findFile("landscapes/" + landscapeId + "/" + fileName);
+	QFile file(path);
+	if (path.isEmpty() || !file.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		qWarning() << "Landscape: cannot read the horizon file" << fileName << "of landscape" << landscapeId;
+		return false;
+	}
+	const double rotateZ = landscapeIni.value("landscape/polygonal_angle_rotatez", 0.).toDouble();
+	beginHorizonProfile();
+	QTextStream in(&file);
+	while (!in.atEnd())
+	{
+		const QString line = in.readLine().trimmed();
+		if (line.isEmpty() || line.startsWith('#'))
+			continue;
+		const QStringList fields = line.split(' ', QString::SkipEmptyParts);
+		bool okAz, okAlt;
+		const double az = fields.value(0).toDouble(&okAz);
+		const double alt = fields.value(1).toDouble(&okAlt);
+		if (!okAz || !okAlt)
+		{
+			qWarning() << "Landscape: invalid line in horizon file" << fileName << ":" << line;
+			continue;
+		}
+		// Azimuth from North towards East to the longitude of the alt-az frame
+		addHorizonPoint((180.-az-rotateZ)*M_PI/180., alt*M_PI/180.);
+	}
+	endHorizonProfile();
+	return hasHorizonProfile();
+}
+
+QImage Landscape::readHorizonImage(const QString& path, int maxSize)
+{
+	QImageReader reader(path);
+	const QSize size = reader.size();
+	if (size.isValid() && (size.width()>maxSize || size.height()>maxSize))
+		reader.setScaledSize(size.scaled(maxSize, maxSize, Qt::KeepAspectRatio));
+	QImage image = reader.read();
+	if (image.isNull())
+		qWarning() << "Landscape: cannot read" << QDir::toNativeSeparators(path) << "for the horizon profile";
+	return image;
+}
+
+float Landscape::findOpaqueTexCoord(const QImage& image, float s, float tTop, float tBottom)
+{
+	if (image.isNull())
+		return -1.f;
+	if (!image.hasAlphaChannel())
+		return tTop;
+	const int w = image.width();
+	const int h = image.height();
+	const int x = qBound(0, (int)(s*(w-1)+0.5f), w-1);
+	// The textures are flipped: t=0 is the last line of the image
+	const int yTop = qBound(0, (int)((1.f-tTop)*(h-1)+0.5f), h-1);
+	const int yBottom = qBound(0, (int)((1.f-tBottom)*(h-1)+0.5f), h-1);
+	for (int y=yTop;y<=yBottom;++y)
+	{
+		if (qAlpha(image.pixel(x, y))>=128)
+			return 1.f-(float)y/(h-1);
+	}
+	return -1.f;
+}
+
+void Landscape::LandscapeMesh::setArray(const StelVertexArray& a)
+{
+	arr = a;
+	vertexf.resize(0);
+	vertexf.reserve(arr.vertex.size());
+	foreach (const Vec3d& v, arr.vertex)
+		vertexf.append(Vec3f(v[0], v[1], v[2]));
+}
+
+void Landscape::LandscapeMesh::append(const StelVertexArray& a)
+{
+	Q_ASSERT(a.primitiveType==arr.primitiveType && a.isIndexed() && arr.isIndexed());
+	Q_ASSERT(arr.vertex.size()+a.vertex.size()<=65536);
+	const unsigned short offset = arr.vertex.size();
+	foreach (unsigned short i, a.indices)
+		arr.indices << offset+i;
+	arr.vertex << a.vertex;
+	arr.texCoords << a.texCoords;
+	foreach (const Vec3d& v, a.vertex)
+		vertexf.append(Vec3f(v[0], v[1], v[2]));
+}
+
 LandscapeOldStyle::LandscapeOldStyle(float _radius) : Landscape(_radius), sideTexs(NULL), sides(NULL), tanMode(false), calibrated(false)
 {}
 
@@ -154,12 +330,14 @@ void LandscapeOldStyle::load(const QSettings& landscapeIni, const QString& lands
 	// Load sides textures
 	nbSideTexs = landscapeIni.value("landscape/nbsidetex", 0).toInt();
 	sideTexs = new StelTextureSP[nbSideTexs];
+	QStringList sideTexPaths;
 	for (int i=0; i<nbSideTexs; ++i)
 	{
 		QString textureKey = QString("landscape/tex%1").arg(i);
 		QString textureName = landscapeIni.value(textureKey).toString();
 		const QString texturePath = getTexturePath(textureName, landscapeId);
 		sideTexs[i] = StelApp::getInstance().getTextureManager().createTexture(texturePath);
+		sideTexPaths << texturePath;
 	}
 
 	QMap<int, int> texToSide;
@@ -244,7 +422,20 @@ void LandscapeOldStyle::load(const QSettings& landscapeIni, const QString& lands
 		++level;
 		slices_inside>>=1;
 	}
+	QVector<double> groundVertexArr;
+	QVector<float> groundTexCoordArr;
 	StelPainter::computeFanDisk(radius, slices_inside, level, groundVertexArr, groundTexCoordArr);
+	StelVertexArray ground(StelVertexArray::Triangles);
+	for (int i=0;i<groundVertexArr.size()/3;++i)
+	{
+		ground.vertex << Vec3d(groundVertexArr.at(i*3), groundVertexArr.at(i*3+1), groundVertexArr.at(i*3+2));
+		ground.texCoords << Vec2f(groundTexCoordArr.at(i*2), groundTexCoordArr.at(i*2+1));
+	}
+	groundMesh.setArray(ground);
+
+	// Precompute the fog cylinder
+	const float fogHeight = (tanMode||calibrated) ? radius*std::tan(fogAltAngle*M_PI/180.) : radius*std::sin(fogAltAngle*M_PI/180.);
+	fogMesh.setArray(StelPainter::computeCylinderNoLight(radius, fogHeight, 64));
 
 
 	// Precompute the vertex arrays for side display
@@ -263,8 +454,18 @@ void LandscapeOldStyle::load(const QSettings& landscapeIni, const QString& lands
 	float y0 = radius*std::cos(angleRotateZ*M_PI/180.f);
 	float x0 = radius*std::sin(angleRotateZ*M_PI/180.f);
 
-	LOSSide precompSide;
-	precompSide.arr.primitiveType=StelVertexArray::Triangles;
+	StelVertexArray sideArr(StelVertexArray::Triangles);
+
+	// The horizon profile is given by a file, or found from the alpha channel of the side textures
+	const bool horizonFromTextures = !loadHorizonPolygon(landscapeIni, landscapeId);
+	QVector<QImage> sideImages(nbSideTexs);
+	if (horizonFromTextures)
+	{
+		beginHorizonProfile();
+		for (int i=0;i<nbSideTexs;++i)
+			sideImages[i] = readHorizonImage(sideTexPaths.at(i));
+	}
+	const int horizonSamples = qMax(1, 2*HorizonProfileSize/(nbDecorRepeat*nbSide*slices_per_side));
 	for (int n=0;n<nbDecorRepeat;n++)
 	{
 		for (int i=0;i<nbSide;i++)
@@ -277,10 +478,9 @@ void LandscapeOldStyle::load(const QSettings& landscapeIni, const QString& lands
 				qDebug() << QString("LandscapeOldStyle::load ERROR: found no corresponding tex value for side%1").arg(i);
 				break;
 			}
-			precompSide.arr.vertex.resize(0);
-			precompSide.arr.texCoords.resize(0);
-			precompSide.arr.indices.resize(0);
-			precompSide.tex=sideTexs[ti];
+			sideArr.vertex.resize(0);
+			sideArr.texCoords.resize(0);
+			sideArr.indices.resize(0);
 
 			float tx0 = sides[ti].texCoords[0];
 			const float d_tx0 = (sides[ti].texCoords[2]-sides[ti].texCoords[0]) / slices_per_side;
@@ -290,18 +490,32 @@ void LandscapeOldStyle::load(const QSettings& landscapeIni, const QString& lands
 				const float y1 = y0*ca - x0*sa;
 				const float x1 = y0*sa + x0*ca;
 				const float tx1 = tx0 + d_tx0;
+				if (horizonFromTextures)
+				{
+					const float tBottom = sides[ti].texCoords[1];
+					const float tTop = sides[ti].texCoords[3];
+					for (int h=0;h<horizonSamples;++h)
+					{
+						const float u = (h+0.5f)/horizonSamples;
+						const float t = findOpaqueTexCoord(sideImages.at(ti), tx0+(tx1-tx0)*u, tTop, tBottom);
+						// Fraction of the decor height hidden by the terrain
+						const float f = t<0.f ? 0.f : (tTop!=tBottom ? (t-tBottom)/(tTop-tBottom) : 1.f);
+						const float alt = calibrated ? (decorAngleShift+f*decorAltAngle)*M_PI/180. : std::atan2(z0+f*stacks*d_z, (double)radius);
+						addHorizonPoint(std::atan2(y0+(y1-y0)*u, x0+(x1-x0)*u), alt);
+					}
+				}
 				float z = z0;
 				float ty0 = sides[ti].texCoords[1];
 				for (int k=0;k<=stacks*2;k+=2)
 				{
-					precompSide.arr.texCoords << Vec2f(tx0, ty0) << Vec2f(tx1, ty0);
+					sideArr.texCoords << Vec2f(tx0, ty0) << Vec2f(tx1, ty0);
 					if (calibrated)
 					{
 						float tanZ=radius * std::tan(z*M_PI/180.f);
-						precompSide.arr.vertex << Vec3d(x0, y0, tanZ) << Vec3d(x1, y1, tanZ);
+						sideArr.vertex << Vec3d(x0, y0, tanZ) << Vec3d(x1, y1, tanZ);
 					} else
 					{
-						precompSide.arr.vertex << Vec3d(x0, y0, z) << Vec3d(x1, y1, z);
+						sideArr.vertex << Vec3d(x0, y0, z) << Vec3d(x1, y1, z);
 					}
 					z += d_z;
 					ty0 += d_ty;
@@ -309,16 +523,37 @@ void LandscapeOldStyle::load(const QSettings& landscapeIni, const QString& lands
 				unsigned int offset = j*(stacks+1)*2;
 				for (int k = 2;k<stacks*2+2;k+=2)
 				{
-					precompSide.arr.indices << offset+k-2 << offset+k-1 << offset+k;
-					precompSide.arr.indices << offset+k << offset+k-1 << offset+k+1;
+					sideArr.indices << offset+k-2 << offset+k-1 << offset+k;
+					sideArr.indices << offset+k << offset+k-1 << offset+k+1;
 				}
 				y0 = y1;
 				x0 = x1;
 				tx0 = tx1;
 			}
-			precomputedSides.append(precompSide);
+
+			// Merge the sides sharing the same texture so that they are drawn at once
+			bool merged = false;
+			for (int m=0;m<precomputedSides.size();++m)
+			{
+				LOSSide& side = precomputedSides[m];
+				if (side.tex==sideTexs[ti] && side.mesh.arr.vertex.size()+sideArr.vertex.size()<=65536)
+				{
+					side.mesh.append(sideArr);
+					merged = true;
+					break;
+				}
+			}
+			if (!merged)
+			{
+				LOSSide precompSide;
+				precompSide.tex = sideTexs[ti];
+				precompSide.mesh.setArray(sideArr);
+				precomputedSides.append(precompSide);
+			}
 		}
 	}
+	if (horizonFromTextures)
+		endHorizonProfile();
 }
 
 void LandscapeOldStyle::draw(StelCore* core)
@@ -355,8 +590,10 @@ void LandscapeOldStyle::drawFog(StelCore* core, StelPainter& sPainter) const
 			  fogFader.getInterstate()*(0.1f+0.1f*skyBrightness),
 			  fogFader.getInterstate()*(0.1f+0.1f*skyBrightness));
 	fogTex->bind();
-	const float height = (tanMode||calibrated) ? radius*std::tan(fogAltAngle*M_PI/180.) : radius*std::sin(fogAltAngle*M_PI/180.);
-	sPainter.sCylinder(radius, height, 64, 1);
+	// The cylinder is seen from inside
+	glCullFace(GL_FRONT);
+	sPainter.drawStelVertexArray(fogMesh.arr, fogMesh.vertexf, false);
+	glCullFace(GL_BACK);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
@@ -383,7 +620,7 @@ void LandscapeOldStyle::drawDecor(StelCore* core, StelPainter& sPainter) const
 	foreach (const LOSSide& side, precomputedSides)
 	{
 		side.tex->bind();
-		sPainter.drawSphericalTriangles(side.arr, true, NULL, false);
+		sPainter.drawStelVertexArray(side.mesh.arr, side.mesh.vertexf);
 	}
 }
 
@@ -403,8 +640,7 @@ void LandscapeOldStyle::drawGround(StelCore* core, StelPainter& sPainter) const
 	sPainter.setColor(skyBrightness, skyBrightness, skyBrightness, landFader.getInterstate());
 
 	groundTex->bind();
-	sPainter.setArrays((Vec3d*)groundVertexArr.constData(), (Vec2f*)groundTexCoordArr.constData());
-	sPainter.drawFromArray(StelPainter::Triangles, groundVertexArr.size()/3);
+	sPainter.drawStelVertexArray(groundMesh.arr, groundMesh.vertexf, false);
 }
 
 LandscapeFisheye::LandscapeFisheye(float _radius) : Landscape(_radius)
@@ -428,6 +664,8 @@ void LandscapeFisheye::load(const QSettings& landscapeIni, const QString& landsc
 	create(name, getTexturePath(landscapeIni.value("landscape/maptex").toString(), landscapeId),
 		landscapeIni.value("landscape/texturefov", 360).toFloat(),
 		landscapeIni.value("landscape/angle_rotatez", 0.).toFloat());
+	// An horizon file replaces the profile found from the texture
+	loadHorizonPolygon(landscapeIni, landscapeId);
 }
 
 
@@ -440,6 +678,40 @@ void LandscapeFisheye::create(const QString _name, const QString& _maptex, float
 	mapTex = StelApp::getInstance().getTextureManager().createTexture(_maptex, StelTexture::StelTextureParams(true));
 	texFov = atexturefov*M_PI/180.f;
 	angleRotateZ = aangleRotateZ*M_PI/180.f;
+	// Patch GZ: (40,20)->(cols,rows)
+	mesh.setArray(StelPainter::computeSphereMapNoLight(radius, cols, rows, texFov, 1));
+
+	// Find the horizon profile by going down from the zenith at the center of the texture
+	const QImage image = readHorizonImage(_maptex);
+	if (image.isNull())
+	{
+		horizonProfile.clear();
+		return;
+	}
+	const int nbSteps = qMax(1, qMin(image.width(), image.height())/2);
+	const float drho = 0.5f*texFov/nbSteps;
+	beginHorizonProfile();
+	for (int i=0;i<HorizonProfileSize;++i)
+	{
+		const double longitude = 2.*M_PI*i/HorizonProfileSize;
+		const float theta = longitude + angleRotateZ - M_PI_2;
+		const float costheta = std::cos(theta);
+		const float sintheta = std::sin(theta);
+		float alt = -M_PI_2;
+		for (int k=0;k<=nbSteps && k*drho<=M_PI;++k)
+		{
+			// Same texture coordinates as StelPainter::sSphereMap() seen from inside
+			const float r = k*drho/texFov;
+			const float t = findOpaqueTexCoord(image, 0.5f+r*costheta, 0.5f-r*sintheta, 0.5f-r*sintheta);
+			if (t>=0.f)
+			{
+				alt = M_PI_2-k*drho;
+				break;
+			}
+		}
+		addHorizonPoint(longitude, alt);
+	}
+	endHorizonProfile();
 }
 
 
@@ -462,8 +734,7 @@ void LandscapeFisheye::draw(StelCore* core)
 	sPainter.enableTexture2d(true);
 	glEnable(GL_BLEND);
 	mapTex->bind();
-	// Patch GZ: (40,20)->(cols,rows)
-	sPainter.sSphereMap(radius,cols,rows,texFov,1);
+	sPainter.drawStelVertexArray(mesh.arr, mesh.vertexf, false);
 
 	glDisable(GL_CULL_FACE);
 }
@@ -494,6 +765,8 @@ void LandscapeSpherical::load(const QSettings& landscapeIni, const QString& land
 
 	create(name, getTexturePath(landscapeIni.value("landscape/maptex").toString(), landscapeId),
 		landscapeIni.value("landscape/angle_rotatez", 0.f).toFloat());
+	// An horizon file replaces the profile found from the texture
+	loadHorizonPolygon(landscapeIni, landscapeId);
 }
 
 
@@ -505,6 +778,29 @@ void LandscapeSpherical::create(const QString _name, const QString& _maptex, flo
 	name = _name;
 	mapTex = StelApp::getInstance().getTextureManager().createTexture(_maptex, StelTexture::StelTextureParams(true));
 	angleRotateZ = _angleRotateZ*M_PI/180.f;
+	// TODO: verify that this works correctly for custom projections
+	// seam is at East
+	// GZ: Want better angle resolution, optional!
+	mesh.setArray(StelPainter::computeSphereNoLight(radius, 1.0, cols, rows, 1, true));
+
+	// Find the horizon profile by going down from the zenith in each column of the texture.
+	// The texture is mapped with s=1-theta/2pi and t=(altitude+pi/2)/pi, where theta=longitude-pi/2.
+	const QImage image = readHorizonImage(_maptex);
+	if (image.isNull())
+	{
+		horizonProfile.clear();
+		return;
+	}
+	beginHorizonProfile();
+	for (int i=0;i<HorizonProfileSize;++i)
+	{
+		const double longitude = 2.*M_PI*i/HorizonProfileSize;
+		double theta = (longitude + angleRotateZ - M_PI_2)/(2.*M_PI);
+		theta -= std::floor(theta);
+		const float t = findOpaqueTexCoord(image, 1.f-theta, 1.f, 0.f);
+		addHorizonPoint(longitude, t<0.f ? -M_PI_2 : t*M_PI-M_PI_2);
+	}
+	endHorizonProfile();
 }
 
 
@@ -526,12 +822,7 @@ void LandscapeSpherical::draw(StelCore* core)
 	sPainter.enableTexture2d(true);
 	glEnable(GL_BLEND);
 	mapTex->bind();
-
-	// TODO: verify that this works correctly for custom projections
-	// seam is at East
-	//sPainter.sSphere(radius, 1.0, 40, 20, 1, true);
-	// GZ: Want better angle resolution, optional!
-	sPainter.sSphere(radius, 1.0, cols, rows, 1, true);
+	sPainter.drawStelVertexArray(mesh.arr, mesh.vertexf, false);
 
 	glDisable(GL_CULL_FACE);
 }
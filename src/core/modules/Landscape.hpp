@@ -30,6 +30,7 @@
 #include "StelTextureTypes.hpp"
 #include "StelLocation.hpp"
 
+class QImage;
 class QSettings;
 class StelLocation;
 class StelCore;
@@ -91,6 +92,25 @@ public:
 
 	//! Get whether the landscape is currently fully visible (i.e. opaque).
 	bool getIsFullyVisible() const {return landFader.getInterstate() >= 0.999f;}
+
+	//! Number of azimuth bins of the horizon profile.
+	static const int HorizonProfileSize = 720;
+
+	//! Return whether a horizon profile could be built for the landscape.
+	//! Without profile, the horizon is the mathematical horizon.
+	bool hasHorizonProfile() const {return !horizonProfile.isEmpty();}
+	//! Return the altitude of the landscape horizon in the given direction, taking the z rotation into account.
+	//! @param longitude the azimuth in radians in the alt-az frame, as returned by StelUtils::rectToSphere().
+	//! @return the altitude in radians.
+	float getHorizonAltitude(double longitude) const;
+	//! Return whether the given direction is above the landscape horizon, i.e. not hidden by the terrain.
+	//! @param altAzPos the direction in the alt-az frame, does not need to be normalized.
+	bool isVisibleDirection(const Vec3d& altAzPos) const;
+	//! Batch version of isVisibleDirection().
+	//! @param n the number of directions.
+	//! @param altAzPos the directions in the alt-az frame.
+	//! @param visible receives for each direction whether it is above the landscape horizon.
+	void isVisibleDirection(int n, const Vec3d* altAzPos, bool* visible) const;
 	
 protected:
 	//! Load attributes common to all landscapes
@@ -98,6 +118,27 @@ protected:
 	//! @param landscapeId The name of the directory for the landscape files (e.g. "ocean")
 	void loadCommon(const QSettings& landscapeIni, const QString& landscapeId);
 
+	//! Reset the horizon profile before adding points with addHorizonPoint().
+	void beginHorizonProfile();
+	//! Raise the horizon profile at the given azimuth to at least the given altitude.
+	//! @param longitude the azimuth in radians in the alt-az frame without z rotation offset.
+	//! @param altitude the altitude in radians.
+	void addHorizonPoint(double longitude, float altitude);
+	//! Interpolate the horizon profile in the azimuths where no point was added.
+	//! The profile is removed if no point was added at all.
+	void endHorizonProfile();
+	//! Build the horizon profile from the file given by the landscape/polygonal_horizon_list key.
+	//! Each line of the file contains an azimuth (from North towards East) and an altitude in degrees,
+	//! lines starting with # are ignored. The landscape/polygonal_angle_rotatez key rotates the azimuths.
+	//! @return false if the landscape has no horizon file or if it could not be read.
+	bool loadHorizonPolygon(const QSettings& landscapeIni, const QString& landscapeId);
+	//! Read a landscape texture image to build the horizon profile from its alpha channel.
+	//! Big images are scaled down to at most maxSize pixels wide and high.
+	static QImage readHorizonImage(const QString& path, int maxSize=1024);
+	//! Return the texture vertical coordinate of the first opaque pixel of the image found when going
+	//! down from tTop to tBottom at the texture horizontal coordinate s, or a value <0 if all are transparent.
+	static float findOpaqueTexCoord(const QImage& image, float s, float tTop, float tBottom);
+
 	//! search for a texture in landscape directory, else global textures directory
 	//! @param basename The name of a texture file, e.g. "fog.png"
 	//! @param landscapeId The landscape ID (directory name) to which the texture belongs
@@ -128,9 +169,25 @@ protected:
 		float texCoords[4];
 	} landscapeTexCoord;
 
+	//! A mesh built once when the landscape is loaded. The landscape is static in the alt-az frame,
+	//! so only the model view transformation changes at each frame. The float copy of the vertices
+	//! allows StelPainter to project them in the vertex shaders.
+	struct LandscapeMesh
+	{
+		void setArray(const StelVertexArray& a);
+		//! Append the vertices of another mesh using the same primitive type.
+		void append(const StelVertexArray& a);
+		StelVertexArray arr;
+		QVector<Vec3f> vertexf;
+	};
+
 	StelLocation location;
 	float angleRotateZ;
 	float angleRotateZOffset;
+
+	//! Altitude in radians of the horizon for HorizonProfileSize azimuths evenly spaced from
+	//! longitude 0, in the alt-az frame without z rotation offset. Empty if there is no profile.
+	QVector<float> horizonProfile;
 };
 
 
@@ -146,8 +203,8 @@ private:
 	void drawFog(StelCore* core, StelPainter&) const;
 	void drawDecor(StelCore* core, StelPainter&) const;
 	void drawGround(StelCore* core, StelPainter&) const;
-	QVector<double> groundVertexArr;
-	QVector<float> groundTexCoordArr;
+	LandscapeMesh groundMesh;
+	LandscapeMesh fogMesh;
 	StelTextureSP* sideTexs;
 	int nbSideTexs;
 	int nbSide;
@@ -168,10 +225,11 @@ private:
 	bool calibrated;	// if true, the documented altitudes are inded correct (the original code is buggy!)
 	struct LOSSide
 	{
-		StelVertexArray arr;
+		LandscapeMesh mesh;
 		StelTextureSP tex;
 	};
 
+	//! The sides of the decor, merged in a single mesh for each texture.
 	QList<LOSSide> precomputedSides;
 };
 
@@ -187,6 +245,7 @@ private:
 
 	StelTextureSP mapTex;
 	float texFov;
+	LandscapeMesh mesh;
 };
 
 
@@ -201,6 +260,7 @@ public:
 private:
 
 	StelTextureSP mapTex;
+	LandscapeMesh mesh;
 };
 
 #endif // _LANDSCAPE_HPP_
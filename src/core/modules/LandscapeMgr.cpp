@@ -627,6 +627,41 @@ void LandscapeMgr::setZRotation(float d)
 		landscape->setZRotation(d);
 }
 
+bool LandscapeMgr::isVisibleDirection(const Vec3d& altAzPos) const
+{
+	if (!landscape)
+		return altAzPos[2]>=0.;
+	return landscape->isVisibleDirection(altAzPos);
+}
+
+QVector<bool> LandscapeMgr::isVisibleDirection(const QVector<Vec3d>& altAzPos) const
+{
+	QVector<bool> visible(altAzPos.size());
+	if (!landscape)
+	{
+		for (int i=0;i<altAzPos.size();++i)
+			visible[i] = altAzPos.at(i)[2]>=0.;
+		return visible;
+	}
+	landscape->isVisibleDirection(altAzPos.size(), altAzPos.constData(), visible.data());
+	return visible;
+}
+
+double LandscapeMgr::getHorizonAltitude(double azimuth) const
+{
+	if (!landscape)
+		return 0.;
+	// Azimuth from North towards East to the longitude of the alt-az frame
+	return landscape->getHorizonAltitude((180.-azimuth)*M_PI/180.)*180./M_PI;
+}
+
+bool LandscapeMgr::isVisibleAzAlt(double azimuth, double altitude) const
+{
+	Vec3d v;
+	StelUtils::spheToRect((180.-azimuth)*M_PI/180., altitude*M_PI/180., v);
+	return isVisibleDirection(v);
+}
+
 float LandscapeMgr::getLuminance()
 {
 	return atmosphere->getRealDisplayIntensityFactor();
@@ -27,6 +27,7 @@
 
 #include <QMap>
 #include <QStringList>
+#include <QVector>
 
 class Landscape;
 class Atmosphere;
@@ -104,6 +105,16 @@ public:
 	//! @return A pointer to the newly created landscape object.
 	Landscape* createFromFile(const QString& landscapeFile, const QString& landscapeId);
 
+	//! Return whether the given direction is above the horizon of the current landscape, i.e. not
+	//! hidden by the terrain. The horizon profile is built when the landscape is loaded, so this
+	//! does not depend on the landscape being displayed.
+	//! @param altAzPos the direction in the alt-az frame, does not need to be normalized.
+	bool isVisibleDirection(const Vec3d& altAzPos) const;
+	//! Batch version of isVisibleDirection(), e.g. to compute the visibility windows of many targets.
+	//! @param altAzPos the directions in the alt-az frame.
+	//! @return for each direction whether it is above the horizon of the current landscape.
+	QVector<bool> isVisibleDirection(const QVector<Vec3d>& altAzPos) const;
+
 public slots:
 	///////////////////////////////////////////////////////////////////////////
 	// Methods callable from script and GUI
@@ -197,6 +208,15 @@ public slots:
 	//! Get the light pollution following the Bortle Scale
 	int getAtmosphereBortleLightPollution();
 
+	//! Return the altitude of the horizon of the current landscape in the given azimuth.
+	//! @param azimuth the azimuth in degrees, from North towards East.
+	//! @return the altitude in degrees.
+	double getHorizonAltitude(double azimuth) const;
+	//! Return whether the given position is above the horizon of the current landscape.
+	//! @param azimuth the azimuth in degrees, from North towards East.
+	//! @param altitude the altitude in degrees.
+	bool isVisibleAzAlt(double azimuth, double altitude) const;
+
 	//! Set the rotation of the landscape about the z-axis.
 	//! This is intended for special uses such as when the landscape consists of
 	//! a vehicle which might change orientation over time (e.g. a ship).
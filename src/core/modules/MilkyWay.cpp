@@ -60,6 +60,9 @@ void MilkyWay::init()
 	setIntensity(conf->value("astro/milky_way_intensity",1.f).toFloat());
 
 	vertexArray = new StelVertexArray(StelPainter::computeSphereNoLight(1.f,1.f,20,20,1));
+	vertexArrayf.reserve(vertexArray->vertex.size());
+	foreach (const Vec3d& v, vertexArray->vertex)
+		vertexArrayf.append(Vec3f(v[0], v[1], v[2]));
 }
 
 
@@ -108,6 +111,6 @@ void MilkyWay::draw(StelCore* core)
 	sPainter.enableTexture2d(true);
 	glDisable(GL_BLEND);
 	tex->bind();
-	sPainter.drawStelVertexArray(*vertexArray);
+	sPainter.drawStelVertexArray(*vertexArray, vertexArrayf);
 	glDisable(GL_CULL_FACE);
 }
@@ -24,6 +24,8 @@
 #include "VecMath.hpp"
 #include "StelTextureTypes.hpp"
 
+#include <QVector>
+
 //! @class MilkyWay 
 //! Manages the displaying of the Milky Way.
 class MilkyWay : public StelModule
@@ -77,6 +79,8 @@ private:
 	class LinearFader* fader;
 
 	struct StelVertexArray* vertexArray;
+	//! The vertices of vertexArray in float, projected by the GPU when possible.
+	QVector<Vec3f> vertexArrayf;
 };
 
 #endif // _MILKYWAY_HPP_
@@ -32,6 +32,7 @@
 #include "StelModuleMgr.hpp"
 #include "StelCore.hpp"
 #include "StelPainter.hpp"
+#include "StelLabelScheduler.hpp"
 
 #include <QDebug>
 #include <QBuffer>
@@ -206,9 +207,6 @@ void Nebula::drawLabel(StelPainter& sPainter, float maxMagLabel)
 	if (lim>maxMagLabel)
 		return;
 
-	Vec3f col(labelColor[0], labelColor[1], labelColor[2]);
-
-	sPainter.setColor(col[0], col[1], col[2], hintsBrightness);
 	float size = getAngularSize(NULL)*M_PI/180.*sPainter.getProjector()->getPixelPerRadAtCenter();
 	float shift = 4.f + size/1.8f;
 	QString str;
@@ -226,7 +224,9 @@ void Nebula::drawLabel(StelPainter& sPainter, float maxMagLabel)
 			str = QString("IC %1").arg(IC_nb);		
 	}
 
-	sPainter.drawText(XY[0]+shift, XY[1]+shift, str, 0, 0, 0, false);
+	// Drawn by NebulaMgr if it does not overlap a brighter object label
+	StelApp::getInstance().getCore()->getLabelScheduler()->addLabel(XY[0]+shift, XY[1]+shift, str,
+		Vec4f(labelColor[0], labelColor[1], labelColor[2], hintsBrightness), -lim);
 }
 
 
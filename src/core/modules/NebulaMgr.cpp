@@ -45,8 +45,10 @@
 #include "StelCore.hpp"
 #include "StelSkyImageTile.hpp"
 #include "StelPainter.hpp"
+#include "StelLabelScheduler.hpp"
 #include "RefractionExtinction.hpp"
 #include "StelActionMgr.hpp"
+#include "StelRecordReader.hpp"
 
 void NebulaMgr::setLabelsColor(const Vec3f& c) {Nebula::labelColor = c;}
 const Vec3f &NebulaMgr::getLabelsColor(void) const {return Nebula::labelColor;}
@@ -181,11 +183,18 @@ void NebulaMgr::draw(StelCore* core)
 	sPainter.setFont(nebulaFont);
 	DrawNebulaFuncObject func(maxMagHints, maxMagLabels, &sPainter, core, hintsFader.getInterstate()>0.0001);
 	nebGrid.processIntersectingPointInRegions(p.data(), func);
+	core->getLabelScheduler()->flush(sPainter);
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
 		drawPointer(core, sPainter);
 }
 
+bool NebulaMgr::needsRedraw() const
+{
+	StelObjectMgr* omgr = GETSTELMODULE(StelObjectMgr);
+	return omgr->getFlagSelectedObjectPointer() && !omgr->getSelectedObject("Nebula").isEmpty();
+}
+
 void NebulaMgr::drawPointer(const StelCore* core, StelPainter& sPainter)
 {
 	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
@@ -424,32 +433,31 @@ bool NebulaMgr::loadNGC(const QString& catNGC)
 bool NebulaMgr::loadNGCNames(const QString& catNGCNames)
 {
 	qDebug() << "Loading NGC name data ...";
-	QFile ngcNameFile(catNGCNames);
-	if (!ngcNameFile.open(QIODevice::ReadOnly | QIODevice::Text))
+	StelRecordReader ngcNameFile(catNGCNames);
+	if (!ngcNameFile.isOpen())
 	{
 		qWarning() << "NGC name data file" << QDir::toNativeSeparators(catNGCNames) << "not found.";
 		return false;
 	}
 
-	// Read the names of the NGC objects
-	QString name, record;
+	// Read the names of the NGC objects. The records have fixed width columns counted
+	// in characters, some names contain non ASCII characters.
+	QString name;
+	StelRecordReader::Field record;
 	int totalRecords=0;
 	int lineNumber=0;
 	int readOk=0;
 	int nb;
 	NebulaP e;
-	QRegExp commentRx("^(\\s*#.*|\\s*)$");
-	QRegExp transRx("_[(]\"(.*)\"[)]");
-	while (!ngcNameFile.atEnd())
+	while (ngcNameFile.readLine(record))
 	{
-		record = QString::fromUtf8(ngcNameFile.readLine());
-		lineNumber++;
-		if (commentRx.exactMatch(record))
+		lineNumber = ngcNameFile.getLineNumber();
+		if (StelRecordReader::isComment(record))
 			continue;
 
 		totalRecords++;
-		nb = record.mid(38,4).toInt();
-		if (record[37] == 'I')
+		nb = record.columns(38,4).toInt();
+		if (record.columns(37,1).startsWith("I"))
 		{
 			e = searchIC(nb);
 		}
@@ -459,7 +467,8 @@ bool NebulaMgr::loadNGCNames(const QString& catNGCNames)
 		}
 
 		// get name, trimmed of whitespace
-		name = record.left(36).trimmed();
+		const StelRecordReader::Field nameField = record.columns(0,36).trimmed();
+		name = nameField.toString();
 
 		if (e)
 		{
@@ -467,10 +476,13 @@ bool NebulaMgr::loadNGCNames(const QString& catNGCNames)
 			// defined for this object
 			if (name.left(2).toUpper() != "M " && name.left(2).toUpper() != "C ")
 			{
-				if (transRx.exactMatch(name)) {
-					e->englishName = transRx.capturedTexts().at(1).trimmed();
+				bool translatable;
+				const StelRecordReader::Field englishName = nameField.unwrapped("_(\"", "\")", &translatable);
+				if (translatable)
+				{
+					e->englishName = englishName.trimmed().toString();
 				}
-				 else 
+				else
 				{
 					e->englishName = name;
 				}
@@ -518,7 +530,6 @@ bool NebulaMgr::loadNGCNames(const QString& catNGCNames)
 		else
 			qWarning() << "no position data for " << name << "at line" << lineNumber << "of" << QDir::toNativeSeparators(catNGCNames);
 	}
-	ngcNameFile.close();
 	qDebug() << "Loaded" << readOk << "/" << totalRecords << "NGC name records successfully";
 
 	return true;
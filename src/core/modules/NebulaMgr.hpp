@@ -71,6 +71,9 @@ public:
 	//! Update state which is time dependent.
 	virtual void update(double deltaTime) {hintsFader.update((int)(deltaTime*1000)); flagShow.update((int)(deltaTime*1000));}
 
+	//! Return true while the animated pointer of a selected nebula is displayed.
+	virtual bool needsRedraw() const;
+
 	//! Determines the order in which the various modules are drawn.
 	virtual double getCallOrder(StelModuleActionName actionName) const;
 
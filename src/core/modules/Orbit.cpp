@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <vector>
 
 #include "Solve.hpp"
 #include "Orbit.hpp"
@@ -125,6 +126,18 @@ CometOrbit::CometOrbit(double pericenterDistance,
   rotateToVsop87[6] =                 s_obl*sj;
   rotateToVsop87[7] =                 s_obl*cj;
   rotateToVsop87[8] =                 c_obl;
+  // Same as Init3D: the angles are constant so only do the trigonometry once
+  Init3D(i,Om,o,1.0,0.0,orbitPlane[0],orbitPlane[2],orbitPlane[4]);
+  Init3D(i,Om,o,0.0,1.0,orbitPlane[1],orbitPlane[3],orbitPlane[5]);
+}
+
+void CometOrbit::planeToVsop87(double a1, double a2, double* v) const {
+  const double p0 = orbitPlane[0]*a1 + orbitPlane[1]*a2;
+  const double p1 = orbitPlane[2]*a1 + orbitPlane[3]*a2;
+  const double p2 = orbitPlane[4]*a1 + orbitPlane[5]*a2;
+  v[0] = rotateToVsop87[0]*p0 + rotateToVsop87[1]*p1 + rotateToVsop87[2]*p2;
+  v[1] = rotateToVsop87[3]*p0 + rotateToVsop87[4]*p1 + rotateToVsop87[5]*p2;
+  v[2] = rotateToVsop87[6]*p0 + rotateToVsop87[7]*p1 + rotateToVsop87[8]*p2;
 }
 
 void CometOrbit::positionAtTimevInVSOP87Coordinates(double JD,double *v) const {
@@ -135,11 +148,22 @@ void CometOrbit::positionAtTimevInVSOP87Coordinates(double JD,double *v) const {
   if (e < 0.9999) InitEll(q,n,e,JD,a1,a2);
   else if (e > 1.0) InitHyp(q,n,e,JD,a1,a2);
   else InitPar(q,n,JD,a1,a2);
-  double p0,p1,p2;
-  Init3D(i,Om,o,a1,a2,p0,p1,p2);
-  v[0] = rotateToVsop87[0]*p0 + rotateToVsop87[1]*p1 + rotateToVsop87[2]*p2;
-  v[1] = rotateToVsop87[3]*p0 + rotateToVsop87[4]*p1 + rotateToVsop87[5]*p2;
-  v[2] = rotateToVsop87[6]*p0 + rotateToVsop87[7]*p1 + rotateToVsop87[8]*p2;
+  planeToVsop87(a1,a2,v);
+}
+
+void CometOrbit::positionsAtTimesInVSOP87Coordinates(const double* JD, double* v, int nb) const {
+  if (e >= 0.9999 || nb <= 0) {
+    // near-parabolic and hyperbolic orbits: scalar fallback
+    for (int k=0;k<nb;k++) positionAtTimevInVSOP87Coordinates(JD[k],v+3*k);
+    return;
+  }
+  std::vector<double> ecc(nb,e), M(nb), E(nb);
+  for (int k=0;k<nb;k++) M[k] = n*(JD[k]-t0);
+  solveKeplerEllipticBatch(nb,&ecc[0],&M[0],&E[0]);
+  // Same as InitEll
+  const double a = q/(1.0-e);
+  const double h1 = q*sqrt((1.0+e)/(1.0-e));
+  for (int k=0;k<nb;k++) planeToVsop87(a*(cos(E[k])-e),h1*sin(E[k]),v+3*k);
 }
 
 
@@ -182,6 +206,16 @@ EllipticalOrbit::EllipticalOrbit(double pericenterDistance,
   rotateToVsop87[6] =                 s_obl*sj;
   rotateToVsop87[7] =                 s_obl*cj;
   rotateToVsop87[8] =                 c_obl;
+
+  Mat4d R = (Mat4d::zrotation(ascendingNode) *
+             Mat4d::xrotation(inclination) *
+             Mat4d::zrotation(argOfPeriapsis));
+  orbitPlane[0] = R[0];
+  orbitPlane[1] = R[1];
+  orbitPlane[2] = R[2];
+  orbitPlane[3] = R[4];
+  orbitPlane[4] = R[5];
+  orbitPlane[5] = R[6];
 }
 
 // Standard iteration for solving Kepler's Equation
@@ -316,6 +350,34 @@ double EllipticalOrbit::eccentricAnomaly(double M) const
 }
 
 
+// Number of Laguerre-Conway iterations done by the batch solver. The method
+// converges cubically from Conway's starter for all eccentricities below 1.
+static const int KeplerBatchIterations = 6;
+
+void solveKeplerEllipticBatch(int n, const double* ecc, const double* M, double* E)
+{
+    // Reduce the mean anomalies to [-pi, pi) and start from Conway's guess
+    std::vector<double> m(n);
+    for (int k = 0; k < n; k++)
+    {
+        m[k] = M[k] - 2.0 * M_PI * floor((M[k] + M_PI) / (2.0 * M_PI));
+        E[k] = m[k] + 0.85 * ecc[k] * (m[k] < 0.0 ? -1.0 : 1.0);
+    }
+    // The loop over the elements is inside so that it can be vectorized
+    for (int it = 0; it < KeplerBatchIterations; it++)
+    {
+        for (int k = 0; k < n; k++)
+        {
+            const double s = ecc[k] * sin(E[k]);
+            const double c = ecc[k] * cos(E[k]);
+            const double f = E[k] - s - m[k];
+            const double f1 = 1.0 - c; // always positive for elliptical orbits
+            E[k] += -5.0 * f / (f1 + sqrt(fabs(16.0 * f1 * f1 - 20.0 * f * s)));
+        }
+    }
+}
+
+
 Vec3d EllipticalOrbit::positionAtE(double E) const
 {
     double x, z;
@@ -339,11 +401,10 @@ Vec3d EllipticalOrbit::positionAtE(double E) const
         z = 0.0;
     }
 
-    Mat4d R = (Mat4d::zrotation(ascendingNode) *
-               Mat4d::xrotation(inclination) *
-               Mat4d::zrotation(argOfPeriapsis));
-
-    return R * Vec3d(x, -z, 0);
+    // Rotation of (x, -z, 0) from the orbital plane
+    return Vec3d(orbitPlane[0] * x - orbitPlane[3] * z,
+                 orbitPlane[1] * x - orbitPlane[4] * z,
+                 orbitPlane[2] * x - orbitPlane[5] * z);
 }
 
 
@@ -374,14 +435,36 @@ Vec3d EllipticalOrbit::positionAtTime(double t) const
 //	v[2]=pos[1];
 //}
 
-void EllipticalOrbit::positionAtTimevInVSOP87Coordinates(double JD, double* v) const
+void EllipticalOrbit::rotateToVsop87Coordinates(const Vec3d& pos, double* v) const
 {
-  Vec3d pos = positionAtTime(JD);
   v[0] = rotateToVsop87[0]*pos[0] + rotateToVsop87[1]*pos[1] + rotateToVsop87[2]*pos[2];
   v[1] = rotateToVsop87[3]*pos[0] + rotateToVsop87[4]*pos[1] + rotateToVsop87[5]*pos[2];
   v[2] = rotateToVsop87[6]*pos[0] + rotateToVsop87[7]*pos[1] + rotateToVsop87[8]*pos[2];
 }
 
+void EllipticalOrbit::positionAtTimevInVSOP87Coordinates(double JD, double* v) const
+{
+  rotateToVsop87Coordinates(positionAtTime(JD), v);
+}
+
+void EllipticalOrbit::positionsAtTimesInVSOP87Coordinates(const double* JD, double* v, int n) const
+{
+    if (eccentricity >= 1.0 || n <= 0)
+    {
+        // Parabolic and hyperbolic orbits: scalar fallback
+        for (int i = 0; i < n; i++)
+            positionAtTimevInVSOP87Coordinates(JD[i], v + 3 * i);
+        return;
+    }
+    const double meanMotion = 2.0 * M_PI / period;
+    std::vector<double> ecc(n, eccentricity), M(n), E(n);
+    for (int i = 0; i < n; i++)
+        M[i] = meanAnomalyAtEpoch + (JD[i] - epoch) * meanMotion;
+    solveKeplerEllipticBatch(n, &ecc[0], &M[0], &E[0]);
+    for (int i = 0; i < n; i++)
+        rotateToVsop87Coordinates(positionAtE(E[i]), v + 3 * i);
+}
+
 double EllipticalOrbit::getPeriod() const
 {
     return period;
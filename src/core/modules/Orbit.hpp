@@ -16,6 +16,12 @@
 
 class OrbitSampleProc;
 
+// Solve Kepler's equation M = E - e*sin(E) for n elliptical orbits (0 <= e < 1).
+// The same fixed number of Laguerre-Conway iterations is done for all the
+// elements, without data dependent branches, so that the compiler can
+// vectorize the loops. Parabolic and hyperbolic orbits must use the scalar code.
+void solveKeplerEllipticBatch(int n, const double* ecc, const double* M, double* E);
+
 //! @internal
 //! Orbit computations used for comet and asteroids
 class Orbit
@@ -52,6 +58,10 @@ public:
 	// parentRotObliquity and parentRotAscendingnode must be supplied.
     void positionAtTimevInVSOP87Coordinates(double JD, double* v) const;
 
+	// Same as above for n dates at once, v receiving 3*n coordinates.
+	// Elliptical orbits are solved with solveKeplerEllipticBatch.
+    void positionsAtTimesInVSOP87Coordinates(const double* JD, double* v, int n) const;
+
 	// Original one
     Vec3d positionAtTime(double) const;
     double getPeriod() const;
@@ -61,6 +71,7 @@ public:
 private:
     double eccentricAnomaly(double) const;
     Vec3d positionAtE(double) const;
+    void rotateToVsop87Coordinates(const Vec3d& pos, double* v) const;
 
     double pericenterDistance;
     double eccentricity;
@@ -71,6 +82,9 @@ private:
     double period;
     double epoch;
     double rotateToVsop87[9];
+    // The first two columns of the rotation from the orbital plane,
+    // precomputed because positionAtE is called for each sample
+    double orbitPlane[6];
 };
 
 
@@ -89,7 +103,13 @@ public:
 
     // Compute the orbit for a specified Julian date and return a "stellarium compliant" function
   void positionAtTimevInVSOP87Coordinates(double JD, double* v) const;
+
+  // Same as above for nb dates at once, v receiving 3*nb coordinates.
+  void positionsAtTimesInVSOP87Coordinates(const double* JD, double* v, int nb) const;
 private:
+  // Rotate the position (a1,a2) in the orbital plane to VSOP87 coordinates
+  void planeToVsop87(double a1, double a2, double* v) const;
+
   const double q;
   const double e;
   const double i;
@@ -98,6 +118,8 @@ private:
   const double t0;
   const double n;
   double rotateToVsop87[9];
+  // Rotation from the orbital plane as computed by Init3D, precomputed in the constructor
+  double orbitPlane[6];
 };
 
 
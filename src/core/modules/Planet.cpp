@@ -38,6 +38,7 @@
 #include "StarMgr.hpp"
 #include "StelMovementMgr.hpp"
 #include "StelPainter.hpp"
+#include "StelLabelScheduler.hpp"
 #include "StelTranslator.hpp"
 #include "StelUtils.hpp"
 
@@ -66,6 +67,7 @@ Planet::Planet(const QString& englishName,
 	  sphereScale(1.f),
 	  lastJD(J2000),
 	  coordFunc(coordFunc),
+	  coordBatchFunc(NULL),
 	  userDataPtr(auserDataPtr),
 	  osculatingFunc(osculatingFunc),
 	  parent(NULL),
@@ -76,6 +78,9 @@ Planet::Planet(const QString& englishName,
 	texMapName = atexMapName;
 	lastOrbitJD =0;
 	deltaJD = StelCore::JD_SECOND;
+	deltaOrbitJD = 0;
+	orbitStart = 0;
+	orbitSegments = ORBIT_SEGMENTS;
 	orbitCached = 0;
 	closeOrbit = acloseOrbit;
 
@@ -281,7 +286,8 @@ void Planet::setRotationElements(float _period, float _offset, double _epoch, fl
 	re.precessionRate = _precessionRate;
 	re.siderealPeriod = _siderealPeriod;  // used for drawing orbit lines
 
-	deltaOrbitJD = re.siderealPeriod/ORBIT_SEGMENTS;
+	deltaOrbitJD = re.siderealPeriod/orbitSegments;
+	orbitCached = 0;
 }
 
 Vec3d Planet::getJ2000EquatorialPos(const StelCore *core) const
@@ -302,129 +308,114 @@ void Planet::computePositionWithoutOrbits(const double date)
 
 void Planet::computePosition(const double date)
 {
-
-	if (orbitFader.getInterstate()>0.000001 && deltaOrbitJD > 0 && (fabs(lastOrbitJD-date)>deltaOrbitJD || !orbitCached))
+	if (orbitFader.getInterstate()>0.000001 && deltaOrbitJD > 0 && (fabs(lastOrbitJD-date)>deltaOrbitJD || !orbitCached || orbitP.size()!=orbitSegments))
 	{
-		double calc_date;
-		// int delta_points = (int)(0.5 + (date - lastOrbitJD)/date_increment);
-		int delta_points;
-
-		if( date > lastOrbitJD )
-		{
-			delta_points = (int)(0.5 + (date - lastOrbitJD)/deltaOrbitJD);
-		}
-		else
-		{
-			delta_points = (int)(-0.5 + (date - lastOrbitJD)/deltaOrbitJD);
-		}
-		double new_date = lastOrbitJD + delta_points*deltaOrbitJD;
-
-		// qDebug( "Updating orbit coordinates for %s (delta %f) (%d points)\n", name.c_str(), deltaOrbitJD, delta_points);
-
-		if( delta_points > 0 && delta_points < ORBIT_SEGMENTS && orbitCached)
-		{
-
-			for( int d=0; d<ORBIT_SEGMENTS-1; d++ )
-			{
-				if(d + delta_points >= ORBIT_SEGMENTS )
-				{
-					// calculate new points
-					calc_date = new_date + (d-ORBIT_SEGMENTS/2)*deltaOrbitJD;
-
-					// date increments between points will not be completely constant though
-					computeTransMatrix(calc_date);
-					if (osculatingFunc)
-					{
-						(*osculatingFunc)(date,calc_date,eclipticPos);
-					}
-					else
-					{
-						coordFunc(calc_date, eclipticPos, userDataPtr);
-					}
-					orbitP[d] = eclipticPos;
-					orbit[d] = getHeliocentricEclipticPos();
-				}
-				else
-				{
-					orbitP[d] = orbitP[d+delta_points];
-					orbit[d] = getHeliocentricPos(orbitP[d]);
-				}
-			}
-
-			lastOrbitJD = new_date;
-		}
-		else if( delta_points < 0 && abs(delta_points) < ORBIT_SEGMENTS  && orbitCached)
-		{
-
-			for( int d=ORBIT_SEGMENTS-1; d>=0; d-- )
-			{
-				if(d + delta_points < 0 )
-				{
-					// calculate new points
-					calc_date = new_date + (d-ORBIT_SEGMENTS/2)*deltaOrbitJD;
-
-					computeTransMatrix(calc_date);
-					if (osculatingFunc) {
-						(*osculatingFunc)(date,calc_date,eclipticPos);
-					}
-					else
-					{
-						coordFunc(calc_date, eclipticPos, userDataPtr);
-					}
-					orbitP[d] = eclipticPos;
-					orbit[d] = getHeliocentricEclipticPos();
-				}
-				else
-				{
-					orbitP[d] = orbitP[d+delta_points];
-					orbit[d] = getHeliocentricPos(orbitP[d]);
-				}
-			}
-
-			lastOrbitJD = new_date;
-
-		}
-		else if( delta_points || !orbitCached)
-		{
-
-			// update all points (less efficient)
-			for( int d=0; d<ORBIT_SEGMENTS; d++ )
-			{
-				calc_date = date + (d-ORBIT_SEGMENTS/2)*deltaOrbitJD;
-				computeTransMatrix(calc_date);
-				if (osculatingFunc)
-				{
-					(*osculatingFunc)(date,calc_date,eclipticPos);
-				}
-				else
-				{
-					coordFunc(calc_date, eclipticPos, userDataPtr);
-				}
-				orbitP[d] = eclipticPos;
-				orbit[d] = getHeliocentricEclipticPos();
-			}
-
-			lastOrbitJD = date;
-			if (!osculatingFunc) orbitCached = 1;
-		}
-
+		computeOrbit(date);
 
 		// calculate actual Planet position
 		coordFunc(date, eclipticPos, userDataPtr);
 
 		lastJD = date;
-
 	}
 	else if (fabs(lastJD-date)>deltaJD)
 	{
 		// calculate actual Planet position
 		coordFunc(date, eclipticPos, userDataPtr);
-		// XXX: do we need to do that even when the orbit is not visible?
-		for( int d=0; d<ORBIT_SEGMENTS; d++ )
-			orbit[d]=getHeliocentricPos(orbitP[d]);
 		lastJD = date;
 	}
+}
+
+void Planet::computeOrbit(double date)
+{
+	const int nbSegments = orbitSegments;
+	if (orbitP.size()!=nbSegments)
+	{
+		// (Re)allocate the samples when the orbit is shown or when its wanted resolution changed
+		orbitP.resize(nbSegments);
+		orbitStart = 0;
+		deltaOrbitJD = re.siderealPeriod/nbSegments;
+		orbitCached = 0;
+	}
 
+	int delta_points;
+	if( date > lastOrbitJD )
+	{
+		delta_points = (int)(0.5 + (date - lastOrbitJD)/deltaOrbitJD);
+	}
+	else
+	{
+		delta_points = (int)(-0.5 + (date - lastOrbitJD)/deltaOrbitJD);
+	}
+
+	// Only the samples entering the window need to be computed when the window moves by less
+	// than its length: the ring buffer start is shifted instead of moving all the samples.
+	int firstNew, lastNew;
+	double new_date;
+	if (orbitCached && delta_points > 0 && delta_points < nbSegments)
+	{
+		new_date = lastOrbitJD + delta_points*deltaOrbitJD;
+		orbitStart = (orbitStart+delta_points)%nbSegments;
+		firstNew = nbSegments-delta_points;
+		lastNew = nbSegments;
+	}
+	else if (orbitCached && delta_points < 0 && -delta_points < nbSegments)
+	{
+		new_date = lastOrbitJD + delta_points*deltaOrbitJD;
+		orbitStart = (orbitStart+delta_points+nbSegments)%nbSegments;
+		firstNew = 0;
+		lastNew = -delta_points;
+	}
+	else if (delta_points || !orbitCached)
+	{
+		// update all points (less efficient)
+		new_date = date;
+		firstNew = 0;
+		lastNew = nbSegments;
+		if (!osculatingFunc) orbitCached = 1;
+	}
+	else
+	{
+		return;
+	}
+
+	if (coordBatchFunc && !osculatingFunc)
+	{
+		// Compute all the new samples in a single call
+		const int nbNew = lastNew-firstNew;
+		QVarLengthArray<double, ORBIT_SEGMENTS> dates(nbNew);
+		QVarLengthArray<double, 3*ORBIT_SEGMENTS> positions(3*nbNew);
+		for (int d=0; d<nbNew; ++d)
+			dates[d] = new_date + (firstNew+d-nbSegments/2)*deltaOrbitJD;
+		coordBatchFunc(dates.constData(), positions.data(), nbNew, userDataPtr);
+		for (int d=0; d<nbNew; ++d)
+			orbitP[(orbitStart+firstNew+d)%nbSegments] = Vec3d(positions[3*d], positions[3*d+1], positions[3*d+2]);
+		lastOrbitJD = new_date;
+		return;
+	}
+
+	for (int d=firstNew; d<lastNew; ++d)
+	{
+		const double calc_date = new_date + (d-nbSegments/2)*deltaOrbitJD;
+		// date increments between points will not be completely constant though
+		computeTransMatrix(calc_date);
+		if (osculatingFunc)
+		{
+			(*osculatingFunc)(date,calc_date,eclipticPos);
+		}
+		else
+		{
+			coordFunc(calc_date, eclipticPos, userDataPtr);
+		}
+		orbitP[(orbitStart+d)%nbSegments] = eclipticPos;
+	}
+	lastOrbitJD = new_date;
+}
+
+void Planet::releaseOrbit()
+{
+	orbitP = QVector<Vec3d>();
+	orbitStart = 0;
+	orbitCached = 0;
 }
 
 // Compute the transformation matrix from the local Planet coordinate to the parent Planet coordinate
@@ -1078,8 +1069,9 @@ void Planet::drawHints(const StelCore* core, const QFont& planetNameFont)
 	sPainter.setFont(planetNameFont);
 	// Draw nameI18 + scaling if it's not == 1.
 	float tmp = (hintFader.getInterstate()<=0 ? 7.f : 10.f) + getAngularSize(core)*M_PI/180.f*prj->getPixelPerRadAtCenter()/1.44f; // Shift for nameI18 printing
-	sPainter.setColor(labelColor[0], labelColor[1], labelColor[2],labelsFader.getInterstate());
-	sPainter.drawText(screenPos[0],screenPos[1], getSkyLabel(core), 0, tmp, tmp, false);
+	// Drawn by SolarSystem with a bonus over the stars and nebulae of the same magnitude
+	StelApp::getInstance().getCore()->getLabelScheduler()->addLabel(screenPos[0], screenPos[1], getSkyLabel(core),
+		Vec4f(labelColor[0], labelColor[1], labelColor[2], labelsFader.getInterstate()), 5.f-getVMagnitude(core), tmp, tmp);
 
 	// hint disapears smoothly on close view
 	if (hintFader.getInterstate()<=0)
@@ -1152,21 +1144,33 @@ void Planet::drawOrbit(const StelCore* core)
 	glEnable(GL_BLEND);
 
 	sPainter.setColor(orbitColor[0], orbitColor[1], orbitColor[2], orbitFader.getInterstate());
-	Vec3d onscreen;
-	// special case - use current Planet position as center vertex so that draws
-	// on it's orbit all the time (since segmented rather than smooth curve)
-	Vec3d savePos = orbit[ORBIT_SEGMENTS/2];
-	orbit[ORBIT_SEGMENTS/2]=getHeliocentricEclipticPos();
-	orbit[ORBIT_SEGMENTS]=orbit[0];
-	int nbIter = closeOrbit ? ORBIT_SEGMENTS : ORBIT_SEGMENTS-1;
+	const int nbSegments = orbitP.size();
+	if (nbSegments==0)
+		return;
+	// The samples are stored in the parent coordinate, add the current position of the parents
+	const Vec3d heliocentricEclipticPos = getHeliocentricEclipticPos();
+	const Vec3d parentPos = heliocentricEclipticPos - eclipticPos;
+	const int nbIter = closeOrbit ? nbSegments : nbSegments-1;
 	QVarLengthArray<float, 1024> vertexArray;
+	Vec3d onscreen, prevOnscreen;
+	Vec3d pos, prevPos;
+	// On-screen length of the visible parts of the orbit, used to adapt its sampling
+	float screenLength = 0.f;
 
 	sPainter.enableClientStates(true, false, false);
 
 	for (int n=0; n<=nbIter; ++n)
 	{
-		if (prj->project(orbit[n],onscreen) && (vertexArray.size()==0 || !prj->intersectViewportDiscontinuity(orbit[n-1], orbit[n])))
+		// special case - use current Planet position as center vertex so that draws
+		// on it's orbit all the time (since segmented rather than smooth curve)
+		if (n==nbSegments/2)
+			pos = heliocentricEclipticPos;
+		else
+			pos = parentPos + getOrbitSample(n%nbSegments);
+		if (prj->project(pos,onscreen) && (vertexArray.size()==0 || !prj->intersectViewportDiscontinuity(prevPos, pos)))
 		{
+			if (!vertexArray.isEmpty())
+				screenLength += (onscreen-prevOnscreen).length();
 			vertexArray.append(onscreen[0]);
 			vertexArray.append(onscreen[1]);
 		}
@@ -1176,14 +1180,21 @@ void Planet::drawOrbit(const StelCore* core)
 			sPainter.drawFromArray(StelPainter::LineStrip, vertexArray.size()/2, 0, false);
 			vertexArray.clear();
 		}
+		prevPos = pos;
+		prevOnscreen = onscreen;
 	}
-	orbit[ORBIT_SEGMENTS/2]=savePos;
 	if (!vertexArray.isEmpty())
 	{
 		sPainter.setVertexPointer(2, GL_FLOAT, vertexArray.constData());
 		sPainter.drawFromArray(StelPainter::LineStrip, vertexArray.size()/2, 0, false);
 	}
 	sPainter.enableClientStates(false);
+
+	// Aim at about 8 pixels per segment, refining quickly but coarsening only when
+	// clearly too fine, so that the samples are not recomputed at each zoom step.
+	int wanted = qBound(MIN_ORBIT_SEGMENTS, ((int)(screenLength/8.f)+7)/8*8, ORBIT_SEGMENTS);
+	if (wanted>orbitSegments || wanted<orbitSegments/2)
+		orbitSegments = wanted;
 }
 
 void Planet::update(int deltaTime)
@@ -1191,4 +1202,6 @@ void Planet::update(int deltaTime)
 	hintFader.update(deltaTime);
 	labelsFader.update(deltaTime);
 	orbitFader.update(deltaTime);
+	if (!orbitFader.getInterstate() && !orbitP.isEmpty())
+		releaseOrbit();
 }
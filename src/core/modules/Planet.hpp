@@ -21,6 +21,7 @@
 #define _PLANET_HPP_
 
 #include <QString>
+#include <QVector>
 
 #include "StelObject.hpp"
 #include "StelProjector.hpp"
@@ -33,11 +34,17 @@
 // The last variable is the userData pointer.
 typedef void (*posFuncType)(double, double*, void*);
 
+// The callback type for computing the positions at several dates at once:
+// dates, 3 coordinates per date, number of dates and the userData pointer.
+typedef void (*posBatchFuncType)(const double*, double*, int, void*);
+
 typedef void (OsculatingFunctType)(double jd0,double jd,double xyz[3]);
 
 // epoch J2000: 12 UT on 1 Jan 2000
 #define J2000 2451545.0
+// Maximum and minimum number of samples used to draw an orbit
 #define ORBIT_SEGMENTS 360
+#define MIN_ORBIT_SEGMENTS 48
 
 class StelFont;
 class StelPainter;
@@ -184,6 +191,13 @@ public:
 	//! Get the Planet position in the parent Planet ecliptic coordinate in AU
 	Vec3d getEclipticPos() const;
 
+	//! Get the function used to compute the position of the Planet.
+	posFuncType getCoordFunc() const {return coordFunc;}
+
+	//! Set an optional function computing the positions at several dates at once, used
+	//! for the orbit samples. It must give the same results as the coordinates function.
+	void setCoordBatchFunc(posBatchFuncType func) {coordBatchFunc = func;}
+
 	// Return the heliocentric ecliptical position
 	Vec3d getHeliocentricEclipticPos() const;
 
@@ -222,8 +236,15 @@ public:
 	LinearFader orbitFader;
 	// draw orbital path of Planet
 	void drawOrbit(const StelCore*);
-	Vec3d orbit[ORBIT_SEGMENTS+1];   // store heliocentric coordinates for drawing the orbit
-	Vec3d orbitP[ORBIT_SEGMENTS+1];  // store local coordinate for orbit
+	// Compute the orbit samples which are missing for the given date
+	void computeOrbit(double date);
+	// Free the orbit samples, they are computed again when the orbit is shown
+	void releaseOrbit();
+	// Return the local coordinates of the orbit sample of index d, 0 being the oldest date
+	const Vec3d& getOrbitSample(int d) const {return orbitP.at((orbitStart+d)%orbitP.size());}
+	QVector<Vec3d> orbitP;           // ring buffer of the local coordinates of the orbit, only allocated while the orbit is shown
+	int orbitStart;                  // index in orbitP of the sample with the oldest date
+	int orbitSegments;               // number of samples wanted for the orbit, adapted to its on-screen length
 	double lastOrbitJD;
 	double deltaJD;
 	double deltaOrbitJD;
@@ -279,6 +300,7 @@ protected:
 	double lastJD;
 	// The callback for the calculation of the equatorial rect heliocentric position at time JD.
 	posFuncType coordFunc;
+	posBatchFuncType coordBatchFunc;
 	void* userDataPtr;
 
 	OsculatingFunctType *const osculatingFunc;
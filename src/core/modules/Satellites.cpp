@@ -25,6 +25,7 @@
 #include "StelModuleMgr.hpp"
 #include "StelLocaleMgr.hpp"
 #include "StelFileMgr.hpp"
+#include "StelJsonCache.hpp"
 #include "StelTextureMgr.hpp"
 #include "StelIniParser.hpp"
 #include "Satellites.hpp"
@@ -642,17 +643,19 @@ void Satellites::saveSettings()
 	saveTleSources(updateUrls);
 }
 
+// Parse function used by StelJsonCache for the satellites catalog
+static QVariant parseSatellitesCatalog(const QByteArray& content)
+{
+	return QJsonDocument::fromJson(content).toVariant();
+}
+
 void Satellites::loadCatalog()
 {
 	QVariantMap map;
-	QFile jsonFile(catalogPath);
-	if (!jsonFile.open(QIODevice::ReadOnly))
+	if (!QFile::exists(catalogPath))
 		qWarning() << "Satellites::loadTleMap cannot open " << QDir::toNativeSeparators(catalogPath);
 	else
-	{
-		map = QJsonDocument::fromJson(jsonFile.readAll()).toVariant().toMap();
-		jsonFile.close();
-	}
+		map = StelJsonCache::load(catalogPath, &parseSatellitesCatalog).toMap();
 	setDataMap(map);
 }
 
@@ -1459,6 +1462,14 @@ void Satellites::update(double deltaTime)
 	}
 }
 
+bool Satellites::needsRedraw() const
+{
+	if (StelApp::getInstance().getCore()->getCurrentLocation().planetName != earth->getEnglishName() || !isValidRangeDates() || (!fader && fader.getInterstate() <= 0.))
+		return false;
+	StelObjectMgr* omgr = GETSTELMODULE(StelObjectMgr);
+	return omgr->getFlagSelectedObjectPointer() && !omgr->getSelectedObject("Satellite").isEmpty();
+}
+
 void Satellites::draw(StelCore* core)
 {
 	if (core->getCurrentLocation().planetName != earth->getEnglishName() ||	!isValidRangeDates() || (!fader && fader.getInterstate() <= 0.))
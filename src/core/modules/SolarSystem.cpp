@@ -34,6 +34,7 @@
 #include "StelFileMgr.hpp"
 #include "StelModuleMgr.hpp"
 #include "StelIniParser.hpp"
+#include "StelJsonCache.hpp"
 #include "Planet.hpp"
 #include "MinorPlanet.hpp"
 #include "Comet.hpp"
@@ -41,6 +42,7 @@
 #include "StelSkyDrawer.hpp"
 #include "StelUtils.hpp"
 #include "StelPainter.hpp"
+#include "StelLabelScheduler.hpp"
 #include "TrailGroup.hpp"
 #include "RefractionExtinction.hpp"
 
@@ -57,11 +59,16 @@
 #include <QMapIterator>
 #include <QDebug>
 #include <QDir>
+#include <QBuffer>
+#include <QHash>
+#include <QRunnable>
+#include <QThreadPool>
 
 SolarSystem::SolarSystem()
 	: moonScale(1.),
 	  flagOrbits(false),
 	  flagLightTravelTime(false),
+	  computeThreadPool(NULL),
 	  allTrails(NULL)
 {
 	planetNameFont.setPixelSize(StelApp::getInstance().getSettings()->value("gui/base_font_size", 13).toInt());
@@ -166,6 +173,12 @@ void SolarSystem::recreateTrails()
 	}
 }
 
+bool SolarSystem::needsRedraw() const
+{
+	StelObjectMgr* omgr = GETSTELMODULE(StelObjectMgr);
+	return flagShow && getFlagMarkers() && omgr->getFlagSelectedObjectPointer() && !omgr->getSelectedObject("Planet").isEmpty();
+}
+
 void SolarSystem::drawPointer(const StelCore* core)
 {
 	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
@@ -218,6 +231,38 @@ void cometOrbitPosFunc(double jd,double xyz[3], void* userDataPtr)
 {
 	static_cast<CometOrbit*>(userDataPtr)->positionAtTimevInVSOP87Coordinates(jd, xyz);
 }
+void ellipticalOrbitPosBatchFunc(const double* jd, double* xyz, int n, void* userDataPtr)
+{
+	static_cast<EllipticalOrbit*>(userDataPtr)->positionsAtTimesInVSOP87Coordinates(jd, xyz, n);
+}
+void cometOrbitPosBatchFunc(const double* jd, double* xyz, int n, void* userDataPtr)
+{
+	static_cast<CometOrbit*>(userDataPtr)->positionsAtTimesInVSOP87Coordinates(jd, xyz, n);
+}
+
+// Parse the content of a solar system ini file into a map of sections,
+// each section being the map of its keys and values.
+static QVariant parseSolarSystemIni(const QByteArray& content)
+{
+	QBuffer buffer;
+	buffer.setData(content);
+	buffer.open(QIODevice::ReadOnly);
+	QSettings::SettingsMap settings;
+	if (!readStelIniFile(buffer, settings))
+		return QVariant();
+	QMap<QString, QVariantMap> sections;
+	for (QSettings::SettingsMap::ConstIterator iter=settings.constBegin();iter!=settings.constEnd();++iter)
+	{
+		const int sep = iter.key().lastIndexOf('/');
+		if (sep<0)
+			continue;
+		sections[iter.key().left(sep)].insert(iter.key().mid(sep+1), iter.value());
+	}
+	QVariantMap res;
+	for (QMap<QString, QVariantMap>::ConstIterator iter=sections.constBegin();iter!=sections.constEnd();++iter)
+		res.insert(iter.key(), iter.value());
+	return res;
+}
 
 // Init and load the solar system data
 void SolarSystem::loadPlanets()
@@ -268,19 +313,23 @@ void SolarSystem::loadPlanets()
 	foreach (const PlanetP& planet, systemPlanets)
 		if(planet->parent != sun || !planet->satellites.isEmpty())
 			shadowPlanetCount++;
+
+	buildComputeSchedule();
 }
 
 bool SolarSystem::loadPlanets(const QString& filePath)
 {
-	QSettings pd(filePath, StelIniFormat);
-	if (pd.status() != QSettings::NoError)
+	// The sections of the file, each one being the map of the keys and values of a body.
+	// The parsed content is kept in a binary cache which is regenerated when the file changes.
+	const QVariantMap bodies = StelJsonCache::load(filePath, &parseSolarSystemIni).toMap();
+	if (bodies.isEmpty())
 	{
 		qWarning() << "ERROR while parsing" << QDir::toNativeSeparators(filePath);
 		return false;
 	}
 
-	// QSettings does not allow us to say that the sections of the file
-	// will be listed in the same order  as in the file like the old
+	// The sections of the file are not listed in the same order
+	// as in the file like the old
 	// InitParser used to so we can no longer assume that.
 	//
 	// This means we must first decide what order to read the sections
@@ -309,17 +358,18 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 	//     i.e. [sol, earth, moon] is fine, but not [sol, moon, earth]
 	//
 	// Stage 3: iterate over the ordered sections decided in stage 2,
-	// creating the planet objects from the QSettings data.
+	// creating the planet objects from the parsed data.
 
 	// Stage 1 (as described above).
 	QMap<QString, QString> secNameMap;
 	QMap<QString, QString> parentMap;
-	QStringList sections = pd.childGroups();
+	const QStringList sections = bodies.keys();
 	for (int i=0; i<sections.size(); ++i)
 	{
 		const QString secname = sections.at(i);
-		const QString englishName = pd.value(secname+"/name").toString();
-		const QString strParent = pd.value(secname+"/parent").toString();
+		const QVariantMap body = bodies.value(secname).toMap();
+		const QString englishName = body.value("name").toString();
+		const QString strParent = body.value("parent").toString();
 		secNameMap[englishName] = secname;
 		if (strParent!="none" && !strParent.isEmpty() && !englishName.isEmpty())
 			parentMap[englishName] = strParent;
@@ -329,7 +379,7 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 	QMultiMap<int, QString> depLevelMap;
 	for (int i=0; i<sections.size(); ++i)
 	{
-		const QString englishName = pd.value(sections.at(i)+"/name").toString();
+		const QString englishName = bodies.value(sections.at(i)).toMap().value("name").toString();
 
 		// follow dependencies, incrementing level when we have one
 		// till we run out.
@@ -354,26 +404,22 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 	}
 
 	// Stage 3 (as described above).
+	// Bodies already created, by english name, to find the parents.
+	QHash<QString, PlanetP> planetsByName;
+	planetsByName.reserve(orderedSections.size());
 	int readOk=0;
 	int totalPlanets=0;
 	for (int i = 0;i<orderedSections.size();++i)
 	{
 		totalPlanets++;
 		const QString secname = orderedSections.at(i);
-		const QString englishName = pd.value(secname+"/name").toString();
-		const QString strParent = pd.value(secname+"/parent").toString();
+		const QVariantMap body = bodies.value(secname).toMap();
+		const QString englishName = body.value("name").toString();
+		const QString strParent = body.value("parent").toString();
 		PlanetP parent;
 		if (strParent!="none")
 		{
-			// Look in the other planets the one named with strParent
-			foreach (const PlanetP& p, systemPlanets)
-			{
-				if (p->getEnglishName()==strParent)
-				{
-					parent = p;
-					break;
-				}
-			}
+			parent = planetsByName.value(strParent);
 			if (parent.isNull())
 			{
 				qWarning() << "ERROR : can't find parent solar system body for " << englishName;
@@ -382,22 +428,23 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 			}
 		}
 
-		const QString funcName = pd.value(secname+"/coord_func").toString();
+		const QString funcName = body.value("coord_func").toString();
 		posFuncType posfunc=NULL;
+		posBatchFuncType posBatchFunc=NULL;
 		void* userDataPtr=NULL;
 		OsculatingFunctType *osculatingFunc = 0;
-		bool closeOrbit = pd.value(secname+"/closeOrbit", true).toBool();
+		bool closeOrbit = body.value("closeOrbit", true).toBool();
 
 		if (funcName=="ell_orbit")
 		{
 			// Read the orbital elements
-			const double epoch = pd.value(secname+"/orbit_Epoch",J2000).toDouble();
-			const double eccentricity = pd.value(secname+"/orbit_Eccentricity").toDouble();
+			const double epoch = body.value("orbit_Epoch",J2000).toDouble();
+			const double eccentricity = body.value("orbit_Eccentricity").toDouble();
 			if (eccentricity >= 1.0) closeOrbit = false;
-			double pericenterDistance = pd.value(secname+"/orbit_PericenterDistance",-1e100).toDouble();
+			double pericenterDistance = body.value("orbit_PericenterDistance",-1e100).toDouble();
 			double semi_major_axis;
 			if (pericenterDistance <= 0.0) {
-				semi_major_axis = pd.value(secname+"/orbit_SemiMajorAxis",-1e100).toDouble();
+				semi_major_axis = body.value("orbit_SemiMajorAxis",-1e100).toDouble();
 				if (semi_major_axis <= -1e100) {
 					qDebug() << "ERROR: " << englishName
 						<< ": you must provide orbit_PericenterDistance or orbit_SemiMajorAxis";
@@ -414,10 +461,10 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 								? 0.0 // parabolic orbits have no semi_major_axis
 								: pericenterDistance / (1.0-eccentricity);
 			}
-			double meanMotion = pd.value(secname+"/orbit_MeanMotion",-1e100).toDouble();
+			double meanMotion = body.value("orbit_MeanMotion",-1e100).toDouble();
 			double period;
 			if (meanMotion <= -1e100) {
-				period = pd.value(secname+"/orbit_Period",-1e100).toDouble();
+				period = body.value("orbit_Period",-1e100).toDouble();
 				if (period <= -1e100) {
 					meanMotion = (eccentricity == 1.0)
 								? 0.01720209895 * (1.5/pericenterDistance) * sqrt(0.5/pericenterDistance)
@@ -431,21 +478,21 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 			} else {
 				period = 2.0*M_PI/meanMotion;
 			}
-			const double inclination = pd.value(secname+"/orbit_Inclination").toDouble()*(M_PI/180.0);
-			const double ascending_node = pd.value(secname+"/orbit_AscendingNode").toDouble()*(M_PI/180.0);
-			double arg_of_pericenter = pd.value(secname+"/orbit_ArgOfPericenter",-1e100).toDouble();
+			const double inclination = body.value("orbit_Inclination").toDouble()*(M_PI/180.0);
+			const double ascending_node = body.value("orbit_AscendingNode").toDouble()*(M_PI/180.0);
+			double arg_of_pericenter = body.value("orbit_ArgOfPericenter",-1e100).toDouble();
 			double long_of_pericenter;
 			if (arg_of_pericenter <= -1e100) {
-				long_of_pericenter = pd.value(secname+"/orbit_LongOfPericenter").toDouble()*(M_PI/180.0);
+				long_of_pericenter = body.value("orbit_LongOfPericenter").toDouble()*(M_PI/180.0);
 				arg_of_pericenter = long_of_pericenter - ascending_node;
 			} else {
 				arg_of_pericenter *= (M_PI/180.0);
 				long_of_pericenter = arg_of_pericenter + ascending_node;
 			}
-			double mean_anomaly = pd.value(secname+"/orbit_MeanAnomaly",-1e100).toDouble();
+			double mean_anomaly = body.value("orbit_MeanAnomaly",-1e100).toDouble();
 			double mean_longitude;
 			if (mean_anomaly <= -1e100) {
-				mean_longitude = pd.value(secname+"/orbit_MeanLongitude").toDouble()*(M_PI/180.0);
+				mean_longitude = body.value("orbit_MeanLongitude").toDouble()*(M_PI/180.0);
 				mean_anomaly = mean_longitude - long_of_pericenter;
 			} else {
 				mean_anomaly *= (M_PI/180.0);
@@ -490,6 +537,7 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 
 			userDataPtr = orb;
 			posfunc = &ellipticalOrbitPosFunc;
+			posBatchFunc = &ellipticalOrbitPosBatchFunc;
 		}
 		else if (funcName=="comet_orbit")
 		{
@@ -499,12 +547,12 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 			// orbit_Period: given in days
 			// orbit_TimeAtPericenter,orbit_Epoch: JD
 			// orbit_MeanAnomaly,orbit_Inclination,orbit_ArgOfPericenter,orbit_AscendingNode: given in degrees
-			const double eccentricity = pd.value(secname+"/orbit_Eccentricity",0.0).toDouble();
+			const double eccentricity = body.value("orbit_Eccentricity",0.0).toDouble();
 			if (eccentricity >= 1.0) closeOrbit = false;
-			double pericenterDistance = pd.value(secname+"/orbit_PericenterDistance",-1e100).toDouble();
+			double pericenterDistance = body.value("orbit_PericenterDistance",-1e100).toDouble();
 			double semi_major_axis;
 			if (pericenterDistance <= 0.0) {
-				semi_major_axis = pd.value(secname+"/orbit_SemiMajorAxis",-1e100).toDouble();
+				semi_major_axis = body.value("orbit_SemiMajorAxis",-1e100).toDouble();
 				if (semi_major_axis <= -1e100) {
 					qWarning() << "ERROR: " << englishName
 						<< ": you must provide orbit_PericenterDistance or orbit_SemiMajorAxis";
@@ -519,9 +567,9 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 								? 0.0 // parabolic orbits have no semi_major_axis
 								: pericenterDistance / (1.0-eccentricity);
 			}
-			double meanMotion = pd.value(secname+"/orbit_MeanMotion",-1e100).toDouble();
+			double meanMotion = body.value("orbit_MeanMotion",-1e100).toDouble();
 			if (meanMotion <= -1e100) {
-				const double period = pd.value(secname+"/orbit_Period",-1e100).toDouble();
+				const double period = body.value("orbit_Period",-1e100).toDouble();
 				if (period <= -1e100) {
 					if (parent->getParent()) {
 						qWarning() << "ERROR: " << englishName
@@ -542,10 +590,10 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 			} else {
 				meanMotion *= (M_PI/180.0);
 			}
-			double time_at_pericenter = pd.value(secname+"/orbit_TimeAtPericenter",-1e100).toDouble();
+			double time_at_pericenter = body.value("orbit_TimeAtPericenter",-1e100).toDouble();
 			if (time_at_pericenter <= -1e100) {
-				const double epoch = pd.value(secname+"/orbit_Epoch",-1e100).toDouble();
-				double mean_anomaly = pd.value(secname+"/orbit_MeanAnomaly",-1e100).toDouble();
+				const double epoch = body.value("orbit_Epoch",-1e100).toDouble();
+				double mean_anomaly = body.value("orbit_MeanAnomaly",-1e100).toDouble();
 				if (epoch <= -1e100 || mean_anomaly <= -1e100) {
 					qWarning() << "ERROR: " << englishName
 						<< ": when you do not provide orbit_TimeAtPericenter, you must provide both "
@@ -557,9 +605,9 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 					time_at_pericenter = epoch - mean_anomaly / meanMotion;
 				}
 			}
-			const double inclination = pd.value(secname+"/orbit_Inclination").toDouble()*(M_PI/180.0);
-			const double arg_of_pericenter = pd.value(secname+"/orbit_ArgOfPericenter").toDouble()*(M_PI/180.0);
-			const double ascending_node = pd.value(secname+"/orbit_AscendingNode").toDouble()*(M_PI/180.0);
+			const double inclination = body.value("orbit_Inclination").toDouble()*(M_PI/180.0);
+			const double arg_of_pericenter = body.value("orbit_ArgOfPericenter").toDouble()*(M_PI/180.0);
+			const double ascending_node = body.value("orbit_AscendingNode").toDouble()*(M_PI/180.0);
 			const double parentRotObliquity = parent->getParent() ? parent->getRotObliquity() : 0.0;
 			const double parent_rot_asc_node = parent->getParent() ? parent->getRotAscendingnode() : 0.0;
 			double parent_rot_j2000_longitude = 0.0;
@@ -589,6 +637,7 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 			orbits.push_back(orb);
 			userDataPtr = orb;
 			posfunc = &cometOrbitPosFunc;
+			posBatchFunc = &cometOrbitPosBatchFunc;
 		}
 
 		if (funcName=="sun_special")
@@ -705,7 +754,7 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 		}
 
 		// Create the Solar System body and add it to the list
-		QString type = pd.value(secname+"/type").toString();
+		QString type = body.value("type").toString();
 		PlanetP p;
 		// New class objects, named "plutoid", has properties similar asteroids and we should calculate their
 		// positions like for asteroids. Plutoids having one exception - Pluto - we should use special
@@ -713,23 +762,23 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 		if ((type == "asteroid" || type == "plutoid") && !englishName.contains("Pluto"))
 		{
 			p = PlanetP(new MinorPlanet(englishName,
-						    pd.value(secname+"/lighting").toBool(),
-						    pd.value(secname+"/radius").toDouble()/AU,
-						    pd.value(secname+"/oblateness", 0.0).toDouble(),
-						    StelUtils::strToVec3f(pd.value(secname+"/color").toString()),
-						    pd.value(secname+"/albedo").toFloat(),
-						    pd.value(secname+"/tex_map").toString(),
+						    body.value("lighting").toBool(),
+						    body.value("radius").toDouble()/AU,
+						    body.value("oblateness", 0.0).toDouble(),
+						    StelUtils::strToVec3f(body.value("color").toString()),
+						    body.value("albedo").toFloat(),
+						    body.value("tex_map").toString(),
 						    posfunc,
 						    userDataPtr,
 						    osculatingFunc,
 						    closeOrbit,
-						    pd.value(secname+"/hidden", 0).toBool(),
+						    body.value("hidden", 0).toBool(),
 						    type));
 
 			QSharedPointer<MinorPlanet> mp =  p.dynamicCast<MinorPlanet>();
 
 			//Number
-			int minorPlanetNumber = pd.value(secname+"/minor_planet_number", 0).toInt();
+			int minorPlanetNumber = body.value("minor_planet_number", 0).toInt();
 			if (minorPlanetNumber)
 			{
 
@@ -737,15 +786,15 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 			}
 
 			//Provisional designation
-			QString provisionalDesignation = pd.value(secname+"/provisional_designation").toString();
+			QString provisionalDesignation = body.value("provisional_designation").toString();
 			if (!provisionalDesignation.isEmpty())
 			{
 				mp->setProvisionalDesignation(provisionalDesignation);
 			}
 
 			//H-G magnitude system
-			double magnitude = pd.value(secname+"/absolute_magnitude", -99).toDouble();
-			double slope = pd.value(secname+"/slope_parameter", 0.15).toDouble();
+			double magnitude = body.value("absolute_magnitude", -99).toDouble();
+			double slope = body.value("slope_parameter", 0.15).toDouble();
 			if (magnitude > -99)
 			{
 				if (slope >= 0 && slope <= 1)
@@ -758,30 +807,30 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 				}
 			}
 
-			mp->setSemiMajorAxis(pd.value(secname+"/orbit_SemiMajorAxis", 0).toDouble());
+			mp->setSemiMajorAxis(body.value("orbit_SemiMajorAxis", 0).toDouble());
 
 		}
 		else if (type == "comet")
 		{
 			p = PlanetP(new Comet(englishName,
-			               pd.value(secname+"/lighting").toBool(),
-			               pd.value(secname+"/radius").toDouble()/AU,
-			               pd.value(secname+"/oblateness", 0.0).toDouble(),
-			               StelUtils::strToVec3f(pd.value(secname+"/color").toString()),
-			               pd.value(secname+"/albedo").toFloat(),
-			               pd.value(secname+"/tex_map").toString(),
+			               body.value("lighting").toBool(),
+			               body.value("radius").toDouble()/AU,
+			               body.value("oblateness", 0.0).toDouble(),
+			               StelUtils::strToVec3f(body.value("color").toString()),
+			               body.value("albedo").toFloat(),
+			               body.value("tex_map").toString(),
 			               posfunc,
 			               userDataPtr,
 			               osculatingFunc,
 			               closeOrbit,
-				       pd.value(secname+"/hidden", 0).toBool(),
+				       body.value("hidden", 0).toBool(),
 				       type));
 
 			QSharedPointer<Comet> mp =  p.dynamicCast<Comet>();
 
 			//g,k magnitude system
-			double magnitude = pd.value(secname+"/absolute_magnitude", -99).toDouble();
-			double slope = pd.value(secname+"/slope_parameter", 4.0).toDouble();
+			double magnitude = body.value("absolute_magnitude", -99).toDouble();
+			double slope = body.value("slope_parameter", 4.0).toDouble();
 			if (magnitude > -99)
 			{
 				if (slope >= 0 && slope <= 20)
@@ -794,28 +843,30 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 				}
 			}
 
-			mp->setSemiMajorAxis(pd.value(secname+"/orbit_SemiMajorAxis", 0).toDouble());
+			mp->setSemiMajorAxis(body.value("orbit_SemiMajorAxis", 0).toDouble());
 
 		}
 		else
 		{
 			p = PlanetP(new Planet(englishName,
-					       pd.value(secname+"/lighting").toBool(),
-					       pd.value(secname+"/radius").toDouble()/AU,
-					       pd.value(secname+"/oblateness", 0.0).toDouble(),
-					       StelUtils::strToVec3f(pd.value(secname+"/color").toString()),
-					       pd.value(secname+"/albedo").toFloat(),
-					       pd.value(secname+"/tex_map").toString(),
+					       body.value("lighting").toBool(),
+					       body.value("radius").toDouble()/AU,
+					       body.value("oblateness", 0.0).toDouble(),
+					       StelUtils::strToVec3f(body.value("color").toString()),
+					       body.value("albedo").toFloat(),
+					       body.value("tex_map").toString(),
 					       posfunc,
 					       userDataPtr,
 					       osculatingFunc,
 					       closeOrbit,
-					       pd.value(secname+"/hidden", 0).toBool(),
-					       pd.value(secname+"/atmosphere", false).toBool(),
+					       body.value("hidden", 0).toBool(),
+					       body.value("atmosphere", false).toBool(),
 					       type));
 		}
 
 
+		p->setCoordBatchFunc(posBatchFunc);
+
 		if (!parent.isNull())
 		{
 			parent->satellites.append(p);
@@ -825,14 +876,14 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 		if (secname=="sun") sun = p;
 		if (secname=="moon") moon = p;
 
-		double rotObliquity = pd.value(secname+"/rot_obliquity",0.).toDouble()*(M_PI/180.0);
-		double rotAscNode = pd.value(secname+"/rot_equator_ascending_node",0.).toDouble()*(M_PI/180.0);
+		double rotObliquity = body.value("rot_obliquity",0.).toDouble()*(M_PI/180.0);
+		double rotAscNode = body.value("rot_equator_ascending_node",0.).toDouble()*(M_PI/180.0);
 
 		// Use more common planet North pole data if available
 		// NB: N pole as defined by IAU (NOT right hand rotation rule)
 		// NB: J2000 epoch
-		double J2000NPoleRA = pd.value(secname+"/rot_pole_ra", 0.).toDouble()*M_PI/180.;
-		double J2000NPoleDE = pd.value(secname+"/rot_pole_de", 0.).toDouble()*M_PI/180.;
+		double J2000NPoleRA = body.value("rot_pole_ra", 0.).toDouble()*M_PI/180.;
+		double J2000NPoleDE = body.value("rot_pole_de", 0.).toDouble()*M_PI/180.;
 
 		if(J2000NPoleRA || J2000NPoleDE)
 		{
@@ -852,23 +903,24 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 		}
 
 		p->setRotationElements(
-			pd.value(secname+"/rot_periode", pd.value(secname+"/orbit_Period", 24.).toDouble()).toDouble()/24.,
-			pd.value(secname+"/rot_rotation_offset",0.).toDouble(),
-			pd.value(secname+"/rot_epoch", J2000).toDouble(),
+			body.value("rot_periode", body.value("orbit_Period", 24.).toDouble()).toDouble()/24.,
+			body.value("rot_rotation_offset",0.).toDouble(),
+			body.value("rot_epoch", J2000).toDouble(),
 			rotObliquity,
 			rotAscNode,
-			pd.value(secname+"/rot_precession_rate",0.).toDouble()*M_PI/(180*36525),
-			pd.value(secname+"/orbit_visualization_period",0.).toDouble());
+			body.value("rot_precession_rate",0.).toDouble()*M_PI/(180*36525),
+			body.value("orbit_visualization_period",0.).toDouble());
 
 
-		if (pd.value(secname+"/rings", 0).toBool()) {
-			const double rMin = pd.value(secname+"/ring_inner_size").toDouble()/AU;
-			const double rMax = pd.value(secname+"/ring_outer_size").toDouble()/AU;
-			Ring *r = new Ring(rMin,rMax,pd.value(secname+"/tex_ring").toString());
+		if (body.value("rings", 0).toBool()) {
+			const double rMin = body.value("ring_inner_size").toDouble()/AU;
+			const double rMax = body.value("ring_outer_size").toDouble()/AU;
+			Ring *r = new Ring(rMin,rMax,body.value("tex_ring").toString());
 			p->setRings(r);
 		}
 
 		systemPlanets.push_back(p);
+		planetsByName.insert(englishName, p);
 		readOk++;
 	}
 
@@ -884,28 +936,107 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 	return true;
 }
 
-// Compute the position for every elements of the solar system.
-// The order is not important since the position is computed relatively to the mother body
-void SolarSystem::computePositions(double date, const Vec3d& observerPos)
+// Compute the position of a range of bodies of the same level in a worker thread
+class SolarSystem::ComputeTask : public QRunnable
 {
-	if (flagLightTravelTime)
+public:
+	ComputeTask(Planet* const* planets, int count, ComputeJob job, double date, const Vec3d& observerPos)
+		: planets(planets), count(count), job(job), date(date), observerPos(observerPos) {}
+	virtual void run()
 	{
-		foreach (PlanetP p, systemPlanets)
-		{
+		for (int i=0;i<count;++i)
+			SolarSystem::computePlanet(planets[i], job, date, observerPos);
+	}
+private:
+	Planet* const* planets;
+	int count;
+	ComputeJob job;
+	double date;
+	Vec3d observerPos;
+};
+
+void SolarSystem::buildComputeSchedule()
+{
+	computeLevels.clear();
+	foreach (const PlanetP& p, systemPlanets)
+	{
+		int depth = 0;
+		for (PlanetP pp = p->getParent(); !pp.isNull(); pp = pp->getParent())
+			++depth;
+		if (computeLevels.size()<=depth)
+			computeLevels.resize(depth+1);
+		// Bodies computed from orbital elements only read their own orbit, while the
+		// analytical theories (VSOP87, ELP82B, L1..) keep static caches between calls.
+		if (p->getCoordFunc()==&ellipticalOrbitPosFunc || p->getCoordFunc()==&cometOrbitPosFunc)
+			computeLevels[depth].parallel.append(p.data());
+		else
+			computeLevels[depth].serial.append(p.data());
+	}
+}
+
+void SolarSystem::computePlanet(Planet* p, ComputeJob job, double date, const Vec3d& observerPos)
+{
+	switch (job)
+	{
+		case ComputePositionWithoutOrbits:
 			p->computePositionWithoutOrbits(date);
-		}
-		foreach (PlanetP p, systemPlanets)
+			break;
+		case ComputePosition:
+			p->computePosition(date);
+			break;
+		case ComputePositionLightTime:
 		{
 			const double light_speed_correction = (p->getHeliocentricEclipticPos()-observerPos).length() * (AU / (SPEED_OF_LIGHT * 86400));
 			p->computePosition(date-light_speed_correction);
+			break;
 		}
 	}
-	else
+}
+
+void SolarSystem::runComputeJob(ComputeJob job, double date, const Vec3d& observerPos)
+{
+	// Below this number of bodies in a level, dispatching to threads costs more than it saves
+	static const int minBodiesPerTask = 64;
+
+	foreach (const ComputeLevel& level, computeLevels)
 	{
-		foreach (PlanetP p, systemPlanets)
+		foreach (Planet* p, level.serial)
+			computePlanet(p, job, date, observerPos);
+
+		const int n = level.parallel.size();
+		if (n<2*minBodiesPerTask)
 		{
-			p->computePosition(date);
+			foreach (Planet* p, level.parallel)
+				computePlanet(p, job, date, observerPos);
+			continue;
 		}
+
+		if (!computeThreadPool)
+			computeThreadPool = new QThreadPool(this);
+		// The main thread computes the last chunk while the pool computes the others
+		const int nbTasks = qMin(computeThreadPool->maxThreadCount()+1, n/minBodiesPerTask);
+		const int chunk = (n+nbTasks-1)/nbTasks;
+		Planet* const* planets = level.parallel.constData();
+		for (int start=0; start<n-chunk; start+=chunk)
+			computeThreadPool->start(new ComputeTask(planets+start, chunk, job, date, observerPos));
+		const int last = ((n-1)/chunk)*chunk;
+		ComputeTask(planets+last, n-last, job, date, observerPos).run();
+		computeThreadPool->waitForDone();
+	}
+}
+
+// Compute the position for every elements of the solar system.
+// Each body is computed after its parents, bodies of the same level being computed in parallel.
+void SolarSystem::computePositions(double date, const Vec3d& observerPos)
+{
+	if (flagLightTravelTime)
+	{
+		runComputeJob(ComputePositionWithoutOrbits, date, observerPos);
+		runComputeJob(ComputePositionLightTime, date, observerPos);
+	}
+	else
+	{
+		runComputeJob(ComputePosition, date, observerPos);
 	}
 	computeTransMatrices(date, observerPos);
 }
@@ -976,6 +1107,14 @@ void SolarSystem::draw(StelCore* core)
 		p->draw(core, maxMagLabel, planetNameFont);
 	}
 
+	// Draw the planet labels over the bodies. The painter must be destroyed before
+	// drawPointer() creates its own.
+	{
+		StelPainter sPainter(core->getProjection2d());
+		sPainter.setFont(planetNameFont);
+		core->getLabelScheduler()->flush(sPainter);
+	}
+
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer() && getFlagMarkers())
 		drawPointer(core);
 }
@@ -1456,6 +1595,7 @@ void SolarSystem::reloadPlanets()
 		p.clear();
 	}
 	systemPlanets.clear();
+	computeLevels.clear();
 	// Memory leak? What's the proper way of cleaning shared pointers?
 
 	// Re-load the ssystem.ini file
@@ -81,6 +81,9 @@ public:
 	//! This includes planet motion trails.
 	virtual void update(double deltaTime);
 
+	//! Return true while the animated pointer of a selected planet is displayed.
+	virtual bool needsRedraw() const;
+
 	//! Used to determine what order to draw the various StelModules.
 	virtual double getCallOrder(StelModuleActionName actionName) const;
 
@@ -303,6 +306,26 @@ private:
 	//! observerPos is needed for light travel time computation.
 	void computeTransMatrices(double date, const Vec3d& observerPos = Vec3d(0.));
 
+	//! The different position computations done by computePositions().
+	enum ComputeJob
+	{
+		ComputePositionWithoutOrbits,
+		ComputePosition,
+		ComputePositionLightTime	//!< Position corrected for light travel time to the observer.
+	};
+	class ComputeTask;
+
+	//! Run a position computation for all the bodies, following the hierarchy of the solar system.
+	//! The bodies computed from orbital elements are dispatched to a thread pool.
+	void runComputeJob(ComputeJob job, double date, const Vec3d& observerPos);
+
+	//! Run a position computation for one body.
+	static void computePlanet(Planet* p, ComputeJob job, double date, const Vec3d& observerPos);
+
+	//! Sort the bodies by depth in the hierarchy for runComputeJob().
+	//! Must be called each time systemPlanets changes.
+	void buildComputeSchedule();
+
 	//! Draw a nice animated pointer around the object.
 	void drawPointer(const StelCore* core);
 
@@ -346,6 +369,19 @@ private:
 	//! List of all the bodies of the solar system.
 	QList<PlanetP> systemPlanets;
 
+	//! The bodies at one depth of the hierarchy (0 for the sun, 1 for planets, 2 for moons..).
+	//! A body only depends on its parents, so all the bodies of a level can be computed
+	//! once the previous level is done.
+	struct ComputeLevel
+	{
+		//! Bodies using analytical theories, whose code keeps static caches: computed in the main thread.
+		QVector<Planet*> serial;
+		//! Bodies computed from orbital elements without shared state: computed in parallel.
+		QVector<Planet*> parallel;
+	};
+	QVector<ComputeLevel> computeLevels;
+	class QThreadPool* computeThreadPool;
+
 	// Master settings
 	bool flagOrbits;
 	bool flagLightTravelTime;
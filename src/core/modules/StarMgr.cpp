@@ -29,6 +29,9 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QCryptographicHash>
+#include <QThread>
+#include <QMutex>
+#include <QAtomicInt>
 
 #include "StelProjector.hpp"
 #include "StarMgr.hpp"
@@ -51,8 +54,11 @@
 #include "StelIniParser.hpp"
 #include "StelPainter.hpp"
 #include "StelJsonParser.hpp"
+#include "StelJsonCache.hpp"
+#include "StelRecordReader.hpp"
 #include "ZoneArray.hpp"
 #include "StelSkyDrawer.hpp"
+#include "StelLabelScheduler.hpp"
 #include "RefractionExtinction.hpp"
 
 static QStringList spectral_array;
@@ -65,16 +71,8 @@ static const int StarCatalogFormatVersion = 5;
 
 // Initialise statics
 bool StarMgr::flagSciNames = true;
-QHash<int,QString> StarMgr::commonNamesMap;
-QHash<int,QString> StarMgr::commonNamesMapI18n;
-QMap<QString,int> StarMgr::commonNamesIndexI18n;
-QMap<QString,int> StarMgr::commonNamesIndex;
-QHash<int,QString> StarMgr::sciNamesMapI18n;
-QMap<QString,int> StarMgr::sciNamesIndexI18n;
-QHash<int,QString> StarMgr::sciAdditionalNamesMapI18n;
-QMap<QString,int> StarMgr::sciAdditionalNamesIndexI18n;
+StarNameTable StarMgr::starNames;
 QHash<int, varstar> StarMgr::varStarsMapI18n;
-QMap<QString, int> StarMgr::varStarsIndexI18n;
 
 QStringList initStringListFromFile(const QString& file_name)
 {
@@ -116,11 +114,56 @@ QString StarMgr::convertToComponentIds(int index)
 
 void StarMgr::initTriangle(int lev,int index, const Vec3f &c0, const Vec3f &c1, const Vec3f &c2)
 {
-	gridLevels[lev]->initTriangle(index,c0,c1,c2);
+	// The lower levels were initialized when they were added
+	if (lev==maxGeodesicGridLevel)
+		gridLevels[lev]->initTriangle(index,c0,c1,c2);
+}
+
+/*************************************************************************
+  Class used to load the catalogs of the fainter levels in a thread
+ *************************************************************************/
+class StarMgr::CatalogLoadThread : public QThread
+{
+public:
+	CatalogLoadThread(const QVariantList& catalogs, int zoneCacheSizeMB)
+		: catalogs(catalogs), zoneCacheSizeMB(zoneCacheSizeMB), aborted(0) {}
+	virtual void run()
+	{
+		foreach (const QVariant& catV, catalogs)
+		{
+			if (aborted.load())
+				return;
+			const LoadedCatalog catalog = StarMgr::loadCatalog(catV.toMap(), zoneCacheSizeMB);
+			QMutexLocker locker(&mutex);
+			loaded.append(catalog);
+		}
+	}
+	//! Return the catalogs loaded since the last call, in the order of the levels.
+	QList<LoadedCatalog> takeLoaded()
+	{
+		QMutexLocker locker(&mutex);
+		QList<LoadedCatalog> result = loaded;
+		loaded.clear();
+		return result;
+	}
+	//! Stop after the catalog being loaded.
+	void abort() {aborted.store(1);}
+private:
+	const QVariantList catalogs;
+	const int zoneCacheSizeMB;
+	QAtomicInt aborted;
+	QMutex mutex;
+	QList<LoadedCatalog> loaded;
+};
+
+// Memory used by the decompressed zones of the compressed catalogs
+static int getZoneCacheSizeMB()
+{
+	return StelApp::getInstance().getSettings()->value("stars/compressed_zone_cache_mb", 16).toInt();
 }
 
 
-StarMgr::StarMgr(void) : hipIndex(new HipIndexStruct[NR_OF_HIP+1])
+StarMgr::StarMgr(void) : catalogLoadThread(NULL), hipIndex(new HipIndexStruct[NR_OF_HIP+1]), sciNamesLoaded(false)
 {
 	setObjectName("StarMgr");
 	if (hipIndex == 0)
@@ -147,6 +190,14 @@ double StarMgr::getCallOrder(StelModuleActionName actionName) const
 
 StarMgr::~StarMgr(void)
 {
+	if (catalogLoadThread)
+	{
+		catalogLoadThread->abort();
+		catalogLoadThread->wait();
+		foreach (const LoadedCatalog& catalog, catalogLoadThread->takeLoaded())
+			delete catalog.zoneArray;
+		delete catalogLoadThread;
+	}
 	foreach(ZoneArray* z, gridLevels)
 		delete z;
 	gridLevels.clear();
@@ -156,35 +207,23 @@ StarMgr::~StarMgr(void)
 
 QString StarMgr::getCommonName(int hip)
 {
-	QHash<int,QString>::const_iterator it(commonNamesMapI18n.find(hip));
-	if (it!=commonNamesMapI18n.end())
-		return it.value();
-	return QString();
+	return starNames.getName(StarNameTable::CommonNameI18n, hip);
 }
 
 QString StarMgr::getSciName(int hip)
 {
-	QHash<int,QString>::const_iterator it(sciNamesMapI18n.find(hip));
-	if (it!=sciNamesMapI18n.end())
-		return it.value();
-	return QString();
+	return starNames.getName(StarNameTable::SciName, hip);
 }
 
 QString StarMgr::getSciAdditionalName(int hip)
 {
-	QHash<int,QString>::const_iterator it(sciAdditionalNamesMapI18n.find(hip));
-	if (it!=sciAdditionalNamesMapI18n.end())
-		return it.value();
-	return QString();
+	return starNames.getName(StarNameTable::SciAdditionalName, hip);
 }
 
 
 QString StarMgr::getGcvsName(int hip)
 {
-	QHash<int,varstar>::const_iterator it(varStarsMapI18n.find(hip));
-	if (it!=varStarsMapI18n.end())
-		return it.value().designation;
-	return QString();
+	return starNames.getName(StarNameTable::GcvsName, hip);
 }
 
 QString StarMgr::getGcvsVariabilityType(int hip)
@@ -290,21 +329,15 @@ void StarMgr::init()
 		copyDefaultConfigFile();
 	}
 
-	QFile fic(starConfigFileFullPath);
-	fic.open(QIODevice::ReadOnly);
-	starSettings = StelJsonParser::parse(&fic).toMap();
-	fic.close();
+	starSettings = StelJsonCache::load(starConfigFileFullPath).toMap();
 
 	// Increment the 1 each time any star catalog file change
 	if (starSettings.value("version").toInt()!=StarCatalogFormatVersion)
 	{
 		qWarning() << "Found an old starsConfig.json file, upgrade..";
-		fic.remove();
+		QFile::remove(starConfigFileFullPath);
 		copyDefaultConfigFile();
-		QFile fic2(starConfigFileFullPath);
-		fic2.open(QIODevice::ReadOnly);
-		starSettings = StelJsonParser::parse(&fic2).toMap();
-		fic2.close();
+		starSettings = StelJsonCache::load(starConfigFileFullPath).toMap();
 	}
 
 	loadData(starSettings);
@@ -317,9 +350,6 @@ void StarMgr::init()
 	objectMgr->registerStelObjectMgr(this);
 	texPointer = StelApp::getInstance().getTextureManager().createTexture(StelFileMgr::getInstallationDir()+"/textures/pointeur2.png");   // Load pointer texture
 
-	StelApp::getInstance().getCore()->getGeodesicGrid(maxGeodesicGridLevel)->visitTriangles(maxGeodesicGridLevel,initTriangleFunc,this);
-	foreach(ZoneArray* z, gridLevels)
-		z->scaleAxis();
 	StelApp *app = &StelApp::getInstance();
 	connect(app, SIGNAL(languageChanged()), this, SLOT(updateI18n()));
 	connect(app, SIGNAL(skyCultureChanged(const QString&)), this, SLOT(updateSkyCulture(const QString&)));
@@ -331,6 +361,29 @@ void StarMgr::init()
 }
 
 
+void StarMgr::update(double deltaTime)
+{
+	labelsFader.update((int)(deltaTime*1000));
+	starsFader.update((int)(deltaTime*1000));
+
+	if (!backgroundCatalogs.isEmpty())
+	{
+		catalogLoadThread = new CatalogLoadThread(backgroundCatalogs, getZoneCacheSizeMB());
+		backgroundCatalogs.clear();
+		catalogLoadThread->start(QThread::LowPriority);
+	}
+	if (catalogLoadThread)
+		addBackgroundCatalogs(false);
+}
+
+bool StarMgr::needsRedraw() const
+{
+	// Keep updating to add the catalogs loaded in the background
+	if (catalogLoadThread || !backgroundCatalogs.isEmpty())
+		return true;
+	return starsFader.getInterstate()>0.f && objectMgr->getFlagSelectedObjectPointer() && !objectMgr->getSelectedObject("Star").isEmpty();
+}
+
 void StarMgr::drawPointer(StelPainter& sPainter, const StelCore* core)
 {
 	const QList<StelObjectP> newSelected = objectMgr->getSelectedObject("Star");
@@ -363,15 +416,29 @@ void StarMgr::setStelStyle(const QString& section)
 	setLabelColor(StelUtils::strToVec3f(conf->value(section+"/star_label_color", defaultColor).toString()));
 }
 
-bool StarMgr::checkAndLoadCatalog(const QVariantMap& catDesc)
+// Return the relative or absolute path of the file of a catalog
+static QString getCatalogFileName(const QVariantMap& catDesc)
 {
-	const bool checked = catDesc.value("checked").toBool();
-	QString catalogFileName = catDesc.value("fileName").toString();
-
+	const QString catalogFileName = catDesc.value("fileName").toString();
 	// See if it is an absolute path, else prepend default path
-	if (!(StelFileMgr::isAbsolute(catalogFileName)))
-		catalogFileName = "stars/default/"+catalogFileName;
+	if (StelFileMgr::isAbsolute(catalogFileName))
+		return catalogFileName;
+	return "stars/default/"+catalogFileName;
+}
+
+// Return whether the catalog exists and contains Hipparcos stars
+static bool isHipparcosCatalog(const QVariantMap& catDesc)
+{
+	const QString catalogFilePath = StelFileMgr::findFile(getCatalogFileName(catDesc));
+	return !catalogFilePath.isEmpty() && ZoneArray::readCatalogType(catalogFilePath)==0;
+}
 
+StarMgr::LoadedCatalog StarMgr::loadCatalog(const QVariantMap& catDesc, int zoneCacheSizeMB)
+{
+	LoadedCatalog result;
+	result.catalogId = catDesc.value("id").toString();
+	const bool checked = catDesc.value("checked").toBool();
+	const QString catalogFileName = getCatalogFileName(catDesc);
 	QString catalogFilePath = StelFileMgr::findFile(catalogFileName);
 	if (catalogFilePath.isEmpty())
 	{
@@ -379,15 +446,15 @@ bool StarMgr::checkAndLoadCatalog(const QVariantMap& catDesc)
 		if (checked)
 		{
 			qWarning() << QString("Warning: could not find star catalog %1").arg(QDir::toNativeSeparators(catalogFileName));
-			setCheckFlag(catDesc.value("id").toString(), false);
+			result.checkFlag = 0;
 		}
-		return false;
+		return result;
 	}
 	// Possibly fixes crash on Vista
 	if (!StelFileMgr::isReadable(catalogFilePath))
 	{
 		qWarning() << QString("Warning: User does not have permissions to read catalog %1").arg(QDir::toNativeSeparators(catalogFilePath));
-		return false;
+		return result;
 	}
 
 	if (!checked)
@@ -424,18 +491,27 @@ bool StarMgr::checkAndLoadCatalog(const QVariantMap& catDesc)
 		{
 			qWarning() << "Error: File " << QDir::toNativeSeparators(catalogFileName) << " is corrupt, MD5 mismatch! Found " << md5Hash.result().toHex() << " expected " << catDesc.value("checksum").toByteArray();
 			fic.remove();
-			return false;
+			return result;
 		}
 		qWarning() << "MD5 sum correct!";
-		setCheckFlag(catDesc.value("id").toString(), true);
+		result.checkFlag = 1;
 	}
 
-	ZoneArray* z = ZoneArray::create(catalogFilePath, true);
+	result.zoneArray = ZoneArray::create(catalogFilePath, true, zoneCacheSizeMB);
+	result.ok = true;
+	return result;
+}
+
+bool StarMgr::addCatalog(const LoadedCatalog& catalog)
+{
+	if (catalog.checkFlag>=0)
+		setCheckFlag(catalog.catalogId, catalog.checkFlag==1);
+	ZoneArray* z = catalog.zoneArray;
 	if (z)
 	{
 		if (z->level<gridLevels.size())
 		{
-			qWarning() << QDir::toNativeSeparators(catalogFileName) << ", " << z->level << ": duplicate level";
+			qWarning() << QDir::toNativeSeparators(z->fname) << ", " << z->level << ": duplicate level";
 			delete z;
 			return true;
 		}
@@ -443,8 +519,44 @@ bool StarMgr::checkAndLoadCatalog(const QVariantMap& catDesc)
 		Q_ASSERT(z->level==gridLevels.size());
 		++maxGeodesicGridLevel;
 		gridLevels.append(z);
+		StelApp::getInstance().getCore()->getGeodesicGrid(maxGeodesicGridLevel)->visitTriangles(maxGeodesicGridLevel,initTriangleFunc,this);
+		z->scaleAxis();
+		z->updateHipIndex(hipIndex);
+	}
+	return catalog.ok;
+}
+
+bool StarMgr::checkAndLoadCatalog(const QVariantMap& catDesc)
+{
+	// The levels must be added in order
+	addBackgroundCatalogs(true);
+	return addCatalog(loadCatalog(catDesc, getZoneCacheSizeMB()));
+}
+
+void StarMgr::addBackgroundCatalogs(bool wait)
+{
+	if (!backgroundCatalogs.isEmpty())
+	{
+		// The loading thread is not started yet
+		const int zoneCacheSizeMB = getZoneCacheSizeMB();
+		foreach (const QVariant& catV, backgroundCatalogs)
+			addCatalog(loadCatalog(catV.toMap(), zoneCacheSizeMB));
+		backgroundCatalogs.clear();
+	}
+	if (!catalogLoadThread)
+		return;
+	if (wait)
+		catalogLoadThread->wait();
+	// Check before taking the loaded catalogs so that none is missed
+	const bool finished = catalogLoadThread->isFinished();
+	foreach (const LoadedCatalog& catalog, catalogLoadThread->takeLoaded())
+		addCatalog(catalog);
+	if (finished)
+	{
+		delete catalogLoadThread;
+		catalogLoadThread = NULL;
+		qDebug() << "Finished loading star catalogue data in the background, max_geodesic_level: " << maxGeodesicGridLevel;
 	}
-	return true;
 }
 
 void StarMgr::setCheckFlag(const QString& catId, bool b)
@@ -477,21 +589,21 @@ void StarMgr::loadData(QVariantMap starsConfig)
 
 	qDebug() << "Loading star data ...";
 
+	// The catalogs are sorted by level, i.e. by brightness. The first one and the catalogs of Hipparcos
+	// stars are loaded now because the sky cultures, the scripts and the rise and set calculator search
+	// stars by HIP number during the initialization. The fainter levels are loaded in the background
+	// once the main loop runs and drawn as soon as they are ready.
+	const bool backgroundLoading = StelApp::getInstance().getSettings()->value("stars/flag_background_loading", true).toBool();
+	const int zoneCacheSizeMB = getZoneCacheSizeMB();
 	catalogsDescription = starsConfig.value("catalogs").toList();
 	foreach (const QVariant& catV, catalogsDescription)
 	{
-		QVariantMap m = catV.toMap();
-		checkAndLoadCatalog(m);
-	}
-
-	for (int i=0; i<=NR_OF_HIP; i++)
-	{
-		hipIndex[i].a = 0;
-		hipIndex[i].z = 0;
-		hipIndex[i].s = 0;
+		// The levels must be added in order, so all the catalogs after a deferred one are deferred
+		if (backgroundLoading && !gridLevels.isEmpty() && (!backgroundCatalogs.isEmpty() || !isHipparcosCatalog(catV.toMap())))
+			backgroundCatalogs.append(catV);
+		else
+			addCatalog(loadCatalog(catV.toMap(), zoneCacheSizeMB));
 	}
-	foreach(ZoneArray* z, gridLevels)
-		z->updateHipIndex(hipIndex);
 
 	const QString cat_hip_sp_file_name = starsConfig.value("hipSpectralFile").toString();
 	if (cat_hip_sp_file_name.isEmpty())
@@ -522,20 +634,20 @@ void StarMgr::loadData(QVariantMap starsConfig)
 	}
 
 	lastMaxSearchLevel = maxGeodesicGridLevel;
-	qDebug() << "Finished loading star catalogue data, max_geodesic_level: " << maxGeodesicGridLevel;
+	qDebug() << "Finished loading star catalogue data, max_geodesic_level: " << maxGeodesicGridLevel
+		 << "," << backgroundCatalogs.size() << "catalogs to load in the background";
 }
 
 // Load common names from file
 int StarMgr::loadCommonNames(const QString& commonNameFile)
 {
-	commonNamesMap.clear();
-	commonNamesMapI18n.clear();
-	commonNamesIndexI18n.clear();
-	commonNamesIndex.clear();
+	QHash<int, QString> commonNames;
+	starNames.setNames(StarNameTable::CommonName, commonNames);
+	starNames.setNames(StarNameTable::CommonNameI18n, commonNames);
 
 	qDebug() << "Loading star names from" << QDir::toNativeSeparators(commonNameFile);
-	QFile cnFile(commonNameFile);
-	if (!cnFile.open(QIODevice::ReadOnly | QIODevice::Text))
+	StelRecordReader cnFile(commonNameFile);
+	if (!cnFile.isOpen())
 	{
 		qWarning() << "WARNING - could not open" << QDir::toNativeSeparators(commonNameFile);
 		return 0;
@@ -543,62 +655,48 @@ int StarMgr::loadCommonNames(const QString& commonNameFile)
 
 	int readOk=0;
 	int totalRecords=0;
-	int lineNumber=0;
-	QString record;
-	QRegExp commentRx("^(\\s*#.*|\\s*)$");
-	// record structure is delimited with a | character.  We will
-	// use a QRegExp to extract the fields. with whitespace padding permitted
-	// (i.e. it will be stripped automatically) Example record strings:
+	StelRecordReader::Field record;
+	// record structure is delimited with a | character, with whitespace
+	// padding permitted (i.e. it will be stripped automatically).
+	// Example record strings:
 	// " 10819|c_And"
 	// "113726|1_And"
-	QRegExp recordRx("^\\s*(\\d+)\\s*\\|(.*)\\n");
-
-	while(!cnFile.atEnd())
+	while (cnFile.readLine(record))
 	{
-		record = QString::fromUtf8(cnFile.readLine());
-		lineNumber++;
-		if (commentRx.exactMatch(record))
+		if (StelRecordReader::isComment(record))
 			continue;
 
 		totalRecords++;
-		if (!recordRx.exactMatch(record))
+		if (record.indexOf('|')<0)
 		{
-			qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(commonNameFile)
+			qWarning() << "WARNING - parse error at line" << cnFile.getLineNumber() << "in" << QDir::toNativeSeparators(commonNameFile)
 				   << " - record does not match record pattern";
 			continue;
 		}
-		else
-		{
-			// The record is the right format.  Extract the fields
-			bool ok;
-			unsigned int hip = recordRx.capturedTexts().at(1).toUInt(&ok);
-			if (!ok)
-			{
-				qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(commonNameFile)
-					   << " - failed to convert " << recordRx.capturedTexts().at(1) << "to a number";
-				continue;
-			}
-			QString englishCommonName = recordRx.capturedTexts().at(2).trimmed();
-			if (englishCommonName.isEmpty())
-			{
-				qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(commonNameFile)
-					   << " - empty name field";
-				continue;
-			}
-
-			// Fix for translate star names 
-			// englishCommonName.replace('_', ' ');
-			const QString commonNameI18n = q_(englishCommonName);
-			QString commonNameI18n_cap = commonNameI18n.toUpper();
 
-			commonNamesMap[hip] = englishCommonName;
-			commonNamesMapI18n[hip] = commonNameI18n;
-			commonNamesIndexI18n[commonNameI18n_cap] = hip;
-			commonNamesIndex[englishCommonName.toUpper()] = hip;
-			readOk++;
+		// The record is the right format.  Extract the fields
+		const StelRecordReader::Field hipField = record.takeUntil('|');
+		bool ok;
+		unsigned int hip = hipField.toUInt(&ok);
+		if (!ok)
+		{
+			qWarning() << "WARNING - parse error at line" << cnFile.getLineNumber() << "in" << QDir::toNativeSeparators(commonNameFile)
+				   << " - failed to convert " << hipField.toString() << "to a number";
+			continue;
+		}
+		const StelRecordReader::Field englishCommonName = record.trimmed();
+		if (englishCommonName.isEmpty())
+		{
+			qWarning() << "WARNING - parse error at line" << cnFile.getLineNumber() << "in" << QDir::toNativeSeparators(commonNameFile)
+				   << " - empty name field";
+			continue;
 		}
+
+		// The translated names are set by updateI18n()
+		commonNames[hip] = englishCommonName.toString();
+		readOk++;
 	}
-	cnFile.close();
+	starNames.setNames(StarNameTable::CommonName, commonNames);
 
 	qDebug() << "Loaded" << readOk << "/" << totalRecords << "common star names";
 	return 1;
@@ -608,116 +706,117 @@ int StarMgr::loadCommonNames(const QString& commonNameFile)
 // Load scientific names from file
 void StarMgr::loadSciNames(const QString& sciNameFile)
 {
-	sciNamesMapI18n.clear();
-	sciNamesIndexI18n.clear();
-	sciAdditionalNamesMapI18n.clear();
-	sciAdditionalNamesIndexI18n.clear();
+	QHash<int, QString> sciNames;
+	QHash<int, QString> sciAdditionalNames;
+	starNames.setNames(StarNameTable::SciName, sciNames);
+	starNames.setNames(StarNameTable::SciAdditionalName, sciAdditionalNames);
 
 	qDebug() << "Loading star names from" << QDir::toNativeSeparators(sciNameFile);
-	QFile snFile(sciNameFile);
-	if (!snFile.open(QIODevice::ReadOnly | QIODevice::Text))
+	StelRecordReader snFile(sciNameFile);
+	if (!snFile.isOpen())
 	{
 		qWarning() << "WARNING - could not open" << QDir::toNativeSeparators(sciNameFile);
 		return;
 	}
-	const QStringList& allRecords = QString::fromUtf8(snFile.readAll()).split('\n');
-	snFile.close();
 
 	int readOk=0;
 	int totalRecords=0;
-	int lineNumber=0;
+	StelRecordReader::Field record;
 	// record structure is delimited with a | character. Example record strings:
 	// " 10819|c_And"
 	// "113726|1_And"
-	foreach(const QString& record, allRecords)
+	while (snFile.readLine(record))
 	{
-		++lineNumber;
 		if (record.isEmpty())
 			continue;
 
 		++totalRecords;
-		const QStringList& fields = record.split('|');
-		if (fields.size()!=2)
+		if (record.count('|')!=1)
 		{
-			qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(sciNameFile)
+			qWarning() << "WARNING - parse error at line" << snFile.getLineNumber() << "in" << QDir::toNativeSeparators(sciNameFile)
 				   << " - record does not match record pattern";
 			continue;
 		}
-		else
-		{
-			// The record is the right format.  Extract the fields
-			bool ok;
-			unsigned int hip = fields.at(0).toUInt(&ok);
-			if (!ok)
-			{
-				qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(sciNameFile)
-					   << " - failed to convert " << fields.at(0) << "to a number";
-				continue;
-			}
 
-			QString sci_name_i18n = fields.at(1).trimmed();
-			if (sci_name_i18n.isEmpty())
-			{
-				qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(sciNameFile)
-					   << " - empty name field";
-				continue;
-			}
+		// The record is the right format.  Extract the fields
+		const StelRecordReader::Field hipField = record.takeUntil('|');
+		bool ok;
+		unsigned int hip = hipField.toUInt(&ok);
+		if (!ok)
+		{
+			qWarning() << "WARNING - parse error at line" << snFile.getLineNumber() << "in" << QDir::toNativeSeparators(sciNameFile)
+				   << " - failed to convert " << hipField.toString() << "to a number";
+			continue;
+		}
 
-			sci_name_i18n.replace('_',' ');
-			// Don't set the main sci name if it's already set - it's additional sci name
-			if (sciNamesMapI18n.find(hip)!=sciNamesMapI18n.end())
-			{
-				sciAdditionalNamesMapI18n[hip] = sci_name_i18n;
-				sciAdditionalNamesIndexI18n[sci_name_i18n.toUpper()] = hip;
-			}
-			else
-			{
-				sciNamesMapI18n[hip] = sci_name_i18n;
-				sciNamesIndexI18n[sci_name_i18n.toUpper()] = hip;
-			}
-			++readOk;
+		const StelRecordReader::Field nameField = record.trimmed();
+		if (nameField.isEmpty())
+		{
+			qWarning() << "WARNING - parse error at line" << snFile.getLineNumber() << "in" << QDir::toNativeSeparators(sciNameFile)
+				   << " - empty name field";
+			continue;
 		}
+
+		QString sci_name_i18n = nameField.toString();
+		sci_name_i18n.replace('_',' ');
+		// Don't set the main sci name if it's already set - it's additional sci name
+		if (sciNames.contains(hip))
+			sciAdditionalNames[hip] = sci_name_i18n;
+		else
+			sciNames[hip] = sci_name_i18n;
+		++readOk;
 	}
+	starNames.setNames(StarNameTable::SciName, sciNames);
+	starNames.setNames(StarNameTable::SciAdditionalName, sciAdditionalNames);
 
 	qDebug() << "Loaded" << readOk << "/" << totalRecords << "scientific star names";
 }
 
+// Return the shared copy of a string used by many variable stars
+static QString sharedString(QHash<QByteArray, QString>& strings, const StelRecordReader::Field& field)
+{
+	const QByteArray key = field.trimmed().toByteArray();
+	QHash<QByteArray, QString>::ConstIterator it = strings.constFind(key);
+	if (it==strings.constEnd())
+		it = strings.insert(key, QString::fromUtf8(key));
+	return it.value();
+}
+
 // Load GCVS from file
 void StarMgr::loadGcvs(const QString& GcvsFile)
 {
 	varStarsMapI18n.clear();
-	varStarsIndexI18n.clear();
+	QHash<int, QString> designations;
+	starNames.setNames(StarNameTable::GcvsName, designations);
 
 	qDebug() << "Loading variable stars from" << QDir::toNativeSeparators(GcvsFile);
-	QFile vsFile(GcvsFile);
-	if (!vsFile.open(QIODevice::ReadOnly | QIODevice::Text))
+	StelRecordReader vsFile(GcvsFile);
+	if (!vsFile.isOpen())
 	{
 		qWarning() << "WARNING - could not open" << QDir::toNativeSeparators(GcvsFile);
 		return;
 	}
-	const QStringList& allRecords = QString::fromUtf8(vsFile.readAll()).split('\n');
-	vsFile.close();
 
 	int readOk=0;
 	int totalRecords=0;
-	int lineNumber=0;
+	// The types and systems are repeated for many stars, share a single copy of each
+	QHash<QByteArray, QString> strings;
+	StelRecordReader::Field record;
 
 	// record structure is delimited with a tab character.
-	foreach(const QString& record, allRecords)
+	while (vsFile.readLine(record))
 	{
-		++lineNumber;
 		if (record.isEmpty())
 			continue;
 
 		++totalRecords;
-		const QStringList& fields = record.split('\t');
-
+		const StelRecordReader::Field hipField = record.takeUntil('\t');
 		bool ok;
-		unsigned int hip = fields.at(0).toUInt(&ok);
+		unsigned int hip = hipField.toUInt(&ok);
 		if (!ok)
 		{
-			qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(GcvsFile)
-				   << " - failed to convert " << fields.at(0) << "to a number";
+			qWarning() << "WARNING - parse error at line" << vsFile.getLineNumber() << "in" << QDir::toNativeSeparators(GcvsFile)
+				   << " - failed to convert " << hipField.toString() << "to a number";
 			continue;
 		}
 
@@ -727,25 +826,27 @@ void StarMgr::loadGcvs(const QString& GcvsFile)
 
 		varstar variableStar;
 
-		variableStar.designation = fields.at(1).trimmed();
-		variableStar.vtype = fields.at(2).trimmed();
-		variableStar.maxmag = fields.at(3).toFloat();
-		variableStar.mflag = fields.at(4).toInt();
-		variableStar.min1mag = fields.at(5).toFloat();
-		if (fields.at(6).isEmpty())
+		designations[hip] = record.takeUntil('\t').trimmed().toString();
+		variableStar.vtype = sharedString(strings, record.takeUntil('\t'));
+		variableStar.maxmag = record.takeUntil('\t').toFloat();
+		variableStar.mflag = record.takeUntil('\t').toInt();
+		variableStar.min1mag = record.takeUntil('\t').toFloat();
+		const StelRecordReader::Field min2mag = record.takeUntil('\t');
+		if (min2mag.isEmpty())
 			variableStar.min2mag = 99.f;
 		else
-			variableStar.min2mag = fields.at(6).toFloat();
-		variableStar.photosys = fields.at(7).trimmed();
-		variableStar.epoch = fields.at(8).toDouble();
-		variableStar.period = fields.at(9).toDouble();
-		variableStar.Mm = fields.at(10).toInt();
-		variableStar.stype = fields.at(11).trimmed();
+			variableStar.min2mag = min2mag.toFloat();
+		variableStar.photosys = sharedString(strings, record.takeUntil('\t'));
+		variableStar.epoch = record.takeUntil('\t').toDouble();
+		variableStar.period = record.takeUntil('\t').toDouble();
+		variableStar.Mm = record.takeUntil('\t').toInt();
+		variableStar.stype = sharedString(strings, record.takeUntil('\t'));
 
 		varStarsMapI18n[hip] = variableStar;
-		varStarsIndexI18n[variableStar.designation.toUpper()] = hip;
 		++readOk;
 	}
+	varStarsMapI18n.squeeze();
+	starNames.setNames(StarNameTable::GcvsName, designations);
 
 	qDebug() << "Loaded" << readOk << "/" << totalRecords << "variable stars";
 }
@@ -843,6 +944,9 @@ void StarMgr::draw(StelCore* core)
 	// Finish drawing many stars
 	skyDrawer->postDrawPointSource(&sPainter);
 
+	// Draw the labels which do not overlap the labels already drawn
+	core->getLabelScheduler()->flush(sPainter);
+
 	if (objectMgr->getFlagSelectedObjectPointer())
 		drawPointer(sPainter, core);
 }
@@ -926,20 +1030,18 @@ QList<StelObjectP > StarMgr::searchAround(const Vec3d& vv, double limFov, const
 //! The translation is done using gettext with translated strings defined in translations.h
 void StarMgr::updateI18n()
 {
-	QRegExp transRx("_[(]\"(.*)\"[)]");
 	const StelTranslator& trans = StelApp::getInstance().getLocaleMgr().getSkyTranslator();
-	commonNamesMapI18n.clear();
-	commonNamesIndexI18n.clear();
-	for (QHash<int,QString>::ConstIterator it(commonNamesMap.constBegin());it!=commonNamesMap.constEnd();it++)
+	QHash<int,QString> commonNamesI18n = starNames.getNames(StarNameTable::CommonName);
+	for (QHash<int,QString>::Iterator it(commonNamesI18n.begin());it!=commonNamesI18n.end();it++)
 	{
-		const int i = it.key();
-		transRx.exactMatch(it.value());
-		QString tt = transRx.capturedTexts().at(1);
-		const QString t = trans.qtranslate(tt);
-		//const QString t(trans.qtranslate(it.value()));
-		commonNamesMapI18n[i] = t;
-		commonNamesIndexI18n[t.toUpper()] = i;
+		// The English names are written as _("name") in the names files
+		const QString& name = it.value();
+		if (name.size()>=5 && name.startsWith("_(\"") && name.endsWith("\")"))
+			it.value() = trans.qtranslate(name.mid(3, name.size()-5));
+		else
+			it.value() = trans.qtranslate(name);
 	}
+	starNames.setNames(StarNameTable::CommonNameI18n, commonNamesI18n);
 }
 
 // Search the star by HP number
@@ -947,12 +1049,12 @@ StelObjectP StarMgr::searchHP(int hp) const
 {
 	if (0 < hp && hp <= NR_OF_HIP)
 	{
-		const Star1 *const s = hipIndex[hp].s;
-		if (s)
+		const HipIndexStruct& h = hipIndex[hp];
+		if (!h.isEmpty())
 		{
-			const SpecialZoneArray<Star1> *const a = hipIndex[hp].a;
-			const SpecialZoneData<Star1> *const z = hipIndex[hp].z;
-			return s->createStelObject(a,z);
+			// Only the catalogs of Hipparcos stars are indexed
+			const HipZoneArray* a = static_cast<const HipZoneArray*>(gridLevels.at(h.getLevel()));
+			return a->createStelObject(h.getZone(), h.getOffset());
 		}
 	}
 	return StelObjectP();
@@ -969,33 +1071,14 @@ StelObjectP StarMgr::searchByNameI18n(const QString& nameI18n) const
 		return searchHP(rx.capturedTexts().at(2).toInt());
 	}
 
-	// Search by I18n common name
-	QMap<QString,int>::const_iterator it(commonNamesIndexI18n.find(objw));
-	if (it!=commonNamesIndexI18n.end())
-	{
-		return searchHP(it.value());
-	}
-
-	// Search by sci name
-	QMap<QString,int>::const_iterator it2 = sciNamesIndexI18n.find(objw);
-	if (it2!=sciNamesIndexI18n.end())
+	// Search by I18n common name, sci name, additional sci name and GCVS name
+	static const StarNameTable::Kind kinds[] = {StarNameTable::CommonNameI18n, StarNameTable::SciName,
+						     StarNameTable::SciAdditionalName, StarNameTable::GcvsName};
+	for (unsigned int i=0;i<sizeof(kinds)/sizeof(kinds[0]);++i)
 	{
-		return searchHP(it2.value());
-	}
-
-
-	// Search by additional sci name
-	QMap<QString,int>::const_iterator it3 = sciAdditionalNamesIndexI18n.find(objw);
-	if (it3!=sciAdditionalNamesIndexI18n.end())
-	{
-		return searchHP(it3.value());
-	}
-
-	// Search by GCVS name
-	QMap<QString,int>::const_iterator it4 = varStarsIndexI18n.find(objw);
-	if (it4!=varStarsIndexI18n.end())
-	{
-		return searchHP(it4.value());
+		const int hip = starNames.search(kinds[i], objw);
+		if (hip)
+			return searchHP(hip);
 	}
 
 	return StelObjectP();
@@ -1014,18 +1097,14 @@ StelObjectP StarMgr::searchByName(const QString& name) const
 	}
 
 	// Search by sci name
-	QMap<QString,int>::const_iterator it = sciNamesIndexI18n.find(objw);
-	if (it!=sciNamesIndexI18n.end())
-	{
-		return searchHP(it.value());
-	}
+	int hip = starNames.search(StarNameTable::SciName, objw);
+	if (hip)
+		return searchHP(hip);
 
 	// Search by additional sci name
-	QMap<QString,int>::const_iterator it2 = sciAdditionalNamesIndexI18n.find(objw);
-	if (it2!=sciAdditionalNamesIndexI18n.end())
-	{
-		return searchHP(it2.value());
-	}
+	hip = starNames.search(StarNameTable::SciAdditionalName, objw);
+	if (hip)
+		return searchHP(hip);
 
 	return StelObjectP();
 }
@@ -1040,35 +1119,11 @@ QStringList StarMgr::listMatchingObjectsI18n(const QString& objPrefix, int maxNb
 	QString objw = objPrefix.toUpper();
 
 	// Search for common names
-	if (useStartOfWords) {
-		for (QMap<QString,int>::const_iterator it(commonNamesIndexI18n.lowerBound(objw)); it!=commonNamesIndexI18n.end(); ++it)
-		{
-			if (it.key().startsWith(objw))
-			{
-				if (maxNbItem==0)
-					break;
-				result << getCommonName(it.value());
-				--maxNbItem;
-			}
-			else
-				break;
-		}
-	}
-	else
-	{
-		QMapIterator<QString, int> i(commonNamesIndexI18n);
-		while (i.hasNext())
-		{
-			i.next();
-			if (i.key().contains(objw))
-			{
-				if (maxNbItem==0)
-					break;
-				result << getCommonName(i.value());
-				--maxNbItem;
-			}
-		}
-	}
+	const QList<int> commonHips = useStartOfWords ? starNames.listStartingWith(StarNameTable::CommonNameI18n, objw, maxNbItem)
+						      : starNames.listContaining(StarNameTable::CommonNameI18n, objw, maxNbItem);
+	foreach (int hip, commonHips)
+		result << getCommonName(hip);
+	maxNbItem -= commonHips.size();
 
 	// Search for sci names
 	QString bayerPattern = objw;
@@ -1079,44 +1134,20 @@ QStringList StarMgr::listMatchingObjectsI18n(const QString& objPrefix, int maxNb
 	if (objw.at(0).unicode() >= 0x0391 && objw.at(0).unicode() <= 0x03A9)
 		bayerRegEx.setPattern(bayerPattern.insert(1,"\\d?"));
 
-	for (QMap<QString,int>::const_iterator it(sciNamesIndexI18n.lowerBound(objw)); it!=sciNamesIndexI18n.end(); ++it)
-	{
-		if (it.key().indexOf(bayerRegEx)==0)
-		{
-			if (maxNbItem==0)
-				break;
-			result << getSciName(it.value());
-			--maxNbItem;
-		}
-		else if (it.key().at(0) != objw.at(0))
-			break;
-	}
+	const QList<int> sciHips = starNames.listMatching(StarNameTable::SciName, objw, bayerRegEx, maxNbItem);
+	foreach (int hip, sciHips)
+		result << getSciName(hip);
+	maxNbItem -= sciHips.size();
 
-	for (QMap<QString,int>::const_iterator it(sciAdditionalNamesIndexI18n.lowerBound(objw)); it!=sciAdditionalNamesIndexI18n.end(); ++it)
-	{
-		if (it.key().indexOf(bayerRegEx)==0)
-		{
-			if (maxNbItem==0)
-				break;
-			result << getSciAdditionalName(it.value());
-			--maxNbItem;
-		}
-		else if (it.key().at(0) != objw.at(0))
-			break;
-	}
+	const QList<int> sciAdditionalHips = starNames.listMatching(StarNameTable::SciAdditionalName, objw, bayerRegEx, maxNbItem);
+	foreach (int hip, sciAdditionalHips)
+		result << getSciAdditionalName(hip);
+	maxNbItem -= sciAdditionalHips.size();
 
-	for (QMap<QString,int>::const_iterator it(varStarsIndexI18n.lowerBound(objw)); it!=varStarsIndexI18n.end(); ++it)
-	{
-		if (it.key().startsWith(objw))
-		{
-			if (maxNbItem==0)
-				break;
-			result << getGcvsName(it.value());
-			--maxNbItem;
-		}
-		else
-			break;
-	}
+	const QList<int> varHips = starNames.listStartingWith(StarNameTable::GcvsName, objw, maxNbItem);
+	foreach (int hip, varHips)
+		result << getGcvsName(hip);
+	maxNbItem -= varHips.size();
 
 	// Add exact Hp catalogue numbers
 	QRegExp hpRx("^(HIP|HP)\\s*(\\d+)\\s*$");
@@ -1150,36 +1181,11 @@ QStringList StarMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem
 	QString objw = objPrefix.toUpper();
 
 	// Search for common names
-	if (useStartOfWords)
-	{
-		for (QMap<QString,int>::const_iterator it(commonNamesIndex.lowerBound(objw)); it!=commonNamesIndex.end(); ++it)
-		{
-			if (it.key().startsWith(objw))
-			{
-				if (maxNbItem==0)
-					break;
-				result << getCommonName(it.value());
-				--maxNbItem;
-			}
-			else
-				break;
-		}
-	}
-	else
-	{
-		QMapIterator<QString, int> i(commonNamesIndex);
-		while (i.hasNext())
-		{
-			i.next();
-			if (i.key().contains(objw))
-			{
-				if (maxNbItem==0)
-					break;
-				result << getCommonName(i.value());
-				--maxNbItem;
-			}
-		}
-	}
+	const QList<int> commonHips = useStartOfWords ? starNames.listStartingWith(StarNameTable::CommonName, objw, maxNbItem)
+						      : starNames.listContaining(StarNameTable::CommonName, objw, maxNbItem);
+	foreach (int hip, commonHips)
+		result << getCommonName(hip);
+	maxNbItem -= commonHips.size();
 
 	// Search for sci names
 	QString bayerPattern = objw;
@@ -1190,45 +1196,21 @@ QStringList StarMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem
 	if (objw.at(0).unicode() >= 0x0391 && objw.at(0).unicode() <= 0x03A9)
 		bayerRegEx.setPattern(bayerPattern.insert(1,"\\d?"));
 
-	for (QMap<QString,int>::const_iterator it(sciNamesIndexI18n.lowerBound(objw)); it!=sciNamesIndexI18n.end(); ++it)
-	{
-		if (it.key().indexOf(bayerRegEx)==0)
-		{
-			if (maxNbItem==0)
-				break;
-			result << getSciName(it.value());
-			--maxNbItem;
-		}
-		else if (it.key().at(0) != objw.at(0))
-			break;
-	}
+	const QList<int> sciHips = starNames.listMatching(StarNameTable::SciName, objw, bayerRegEx, maxNbItem);
+	foreach (int hip, sciHips)
+		result << getSciName(hip);
+	maxNbItem -= sciHips.size();
 
-	for (QMap<QString,int>::const_iterator it(sciAdditionalNamesIndexI18n.lowerBound(objw)); it!=sciAdditionalNamesIndexI18n.end(); ++it)
-	{
-		if (it.key().indexOf(bayerRegEx)==0)
-		{
-			if (maxNbItem==0)
-				break;
-			result << getSciAdditionalName(it.value());
-			--maxNbItem;
-		}
-		else if (it.key().at(0) != objw.at(0))
-			break;
-	}
+	const QList<int> sciAdditionalHips = starNames.listMatching(StarNameTable::SciAdditionalName, objw, bayerRegEx, maxNbItem);
+	foreach (int hip, sciAdditionalHips)
+		result << getSciAdditionalName(hip);
+	maxNbItem -= sciAdditionalHips.size();
 
 	// Search for sci names for var stars
-	for (QMap<QString,int>::const_iterator it(varStarsIndexI18n.lowerBound(objw)); it!=varStarsIndexI18n.end(); ++it)
-	{
-		if (it.key().startsWith(objw))
-		{
-			if (maxNbItem==0)
-				break;
-			result << getGcvsName(it.value());
-			--maxNbItem;
-		}
-		else
-			break;
-	}
+	const QList<int> varHips = starNames.listStartingWith(StarNameTable::GcvsName, objw, maxNbItem);
+	foreach (int hip, varHips)
+		result << getGcvsName(hip);
+	maxNbItem -= varHips.size();
 
 	// Add exact Hp catalogue numbers
 	QRegExp hpRx("^(HIP|HP)\\s*(\\d+)\\s*$");
@@ -1268,17 +1250,22 @@ void StarMgr::updateSkyCulture(const QString& skyCultureDir)
 	else
 		loadCommonNames(fic);
 
-	fic = StelFileMgr::findFile("stars/default/name.fab");
-	if (fic.isEmpty())
-		qWarning() << "WARNING: could not load scientific star names file: stars/default/name.fab";
-	else
-		loadSciNames(fic);
-	
-	fic = StelFileMgr::findFile("stars/default/gcvs_hip_part.dat");
-	if (fic.isEmpty())
-		qWarning() << "WARNING: could not load variable stars file: stars/default/gcvs_hip_part.dat";
-	else
-		loadGcvs(fic);
+	// The scientific names and variable stars don't depend on the sky culture
+	if (!sciNamesLoaded)
+	{
+		fic = StelFileMgr::findFile("stars/default/name.fab");
+		if (fic.isEmpty())
+			qWarning() << "WARNING: could not load scientific star names file: stars/default/name.fab";
+		else
+			loadSciNames(fic);
+
+		fic = StelFileMgr::findFile("stars/default/gcvs_hip_part.dat");
+		if (fic.isEmpty())
+			qWarning() << "WARNING: could not load variable stars file: stars/default/gcvs_hip_part.dat";
+		else
+			loadGcvs(fic);
+		sciNamesLoaded = true;
+	}
 
 	// Turn on sci names/catalog names for western culture only
 	setFlagSciNames(skyCultureDir.startsWith("western"));
@@ -27,6 +27,7 @@
 #include "StelObjectModule.hpp"
 #include "StelTextureTypes.hpp"
 #include "StelProjectorType.hpp"
+#include "StarNameTable.hpp"
 
 class StelObject;
 class StelToneReproducer;
@@ -41,7 +42,6 @@ static const int RCMAG_TABLE_SIZE = 4096;
 
 typedef struct
 {
-	QString designation;	//! GCVS designation
 	QString vtype;		//! Type of variability
 	float maxmag;		//! Magnitude at maximum brightness
 	int mflag;		//! Magnitude flag code
@@ -106,8 +106,13 @@ public:
 	virtual void draw(StelCore* core);
 
 	//! Update any time-dependent features.
-	//! Includes fading in and out stars and labels when they are turned on and off.
-	virtual void update(double deltaTime) {labelsFader.update((int)(deltaTime*1000)); starsFader.update((int)(deltaTime*1000));}
+	//! Includes fading in and out stars and labels when they are turned on and off,
+	//! and adding the catalogs loaded in the background.
+	virtual void update(double deltaTime);
+
+	//! Return true while the animated pointer of a selected star is displayed,
+	//! or while catalogs are loaded in the background.
+	virtual bool needsRedraw() const;
 
 	//! Used to determine the order in which the various StelModules are drawn.
 	virtual double getCallOrder(StelModuleActionName actionName) const;
@@ -239,6 +244,7 @@ public:
 
 	//! Try to load the given catalog, even if it is marched as unchecked.
 	//! Mark it as checked if checksum is correct.
+	//! Waits for the catalogs being loaded in the background first.
 	//! @return false in case of failure.
 	bool checkAndLoadCatalog(const QVariantMap& m);
 
@@ -253,6 +259,32 @@ private slots:
 	void updateSkyCulture(const QString& skyCultureDir);
 
 private:
+	class CatalogLoadThread;
+
+	//! A catalog checked and loaded by loadCatalog().
+	struct LoadedCatalog
+	{
+		LoadedCatalog() : ok(false), checkFlag(-1), zoneArray(NULL) {}
+		//! Whether the file was found and is valid.
+		bool ok;
+		QString catalogId;
+		//! The new checked flag of the catalog, 1 or 0, or -1 if unchanged.
+		int checkFlag;
+		ZoneArray* zoneArray;
+	};
+
+	//! Check and load a catalog file.
+	//! Does not change the StarMgr so that it can be called from a background thread.
+	static LoadedCatalog loadCatalog(const QVariantMap& catDesc, int zoneCacheSizeMB);
+
+	//! Update the checked flag of a loaded catalog and add its level to the drawn ones.
+	//! Must be called from the main thread, in the order of the levels.
+	//! @return false if the catalog could not be loaded.
+	bool addCatalog(const LoadedCatalog& catalog);
+
+	//! Add the catalogs loaded in the background since the last call.
+	//! @param wait whether to wait until all the catalogs are loaded
+	void addBackgroundCatalogs(bool wait);
 
 	void setCheckFlag(const QString& catalogId, bool b);
 
@@ -264,7 +296,7 @@ private:
 	int loadCommonNames(const QString& commonNameFile);
 
 	//! Loads scientific names for stars from a file.
-	//! Called when the SkyCulture is updated.
+	//! Called when the SkyCulture is first set.
 	//! @param the path to a file containing the scientific names for bright stars.
 	void loadSciNames(const QString& sciNameFile);
 
@@ -294,6 +326,9 @@ private:
 	
 	// A ZoneArray per grid level
 	QVector<ZoneArray*> gridLevels;
+	//! The catalogs of the fainter levels to load in the background after the first frame.
+	QVariantList backgroundCatalogs;
+	CatalogLoadThread* catalogLoadThread;
 	static void initTriangleFunc(int lev, int index,
 								 const Vec3f &c0,
 								 const Vec3f &c1,
@@ -308,21 +343,15 @@ private:
 					  const Vec3f &c1,
 					  const Vec3f &c2);
 
-	HipIndexStruct *hipIndex; // array of hiparcos stars
-
-	static QHash<int, QString> commonNamesMap;
-	static QHash<int, QString> commonNamesMapI18n;
-	static QMap<QString, int> commonNamesIndexI18n;
-	static QMap<QString, int> commonNamesIndex;
-
-	static QHash<int, QString> sciNamesMapI18n;	
-	static QMap<QString, int> sciNamesIndexI18n;
+	HipIndexStruct *hipIndex; // packed positions of the hiparcos stars by HIP number
 
-	static QHash<int, QString> sciAdditionalNamesMapI18n;
-	static QMap<QString, int> sciAdditionalNamesIndexI18n;
+	//! The common, scientific and GCVS names of the stars.
+	static StarNameTable starNames;
 
+	//! The GCVS data of the variable stars, their designations are in starNames.
 	static QHash<int, varstar> varStarsMapI18n;
-	static QMap<QString, int> varStarsIndexI18n;
+	//! Whether the scientific names and the GCVS, which are the same for all the sky cultures, are loaded.
+	bool sciNamesLoaded;
 
 	QFont starFont;
 	static bool flagSciNames;
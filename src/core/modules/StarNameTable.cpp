@@ -0,0 +1,274 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StarNameTable.hpp"
+
+#include <QPair>
+#include <QRegExp>
+#include <algorithm>
+
+// Compare 2 strings as if they were converted to upper case.
+static int compareUpper(const QChar* a, int na, const QChar* b, int nb)
+{
+	const int n = qMin(na, nb);
+	for (int i=0;i<n;++i)
+	{
+		const ushort ca = a[i].toUpper().unicode();
+		const ushort cb = b[i].toUpper().unicode();
+		if (ca!=cb)
+			return ca<cb ? -1 : 1;
+	}
+	return na-nb;
+}
+
+int StarNameTable::compareUpper(quint32 offset, const QString& upper) const
+{
+	return ::compareUpper(pool.constData()+offset+1, pool.at(offset).unicode(), upper.constData(), upper.size());
+}
+
+// Whether the name at the given offset of the pool starts with a string in upper case.
+static bool startsWithUpper(const QString& pool, quint32 offset, const QString& upper)
+{
+	const int size = pool.at(offset).unicode();
+	return size>=upper.size() && compareUpper(pool.constData()+offset+1, upper.size(), upper.constData(), upper.size())==0;
+}
+
+void StarNameTable::kindRange(const QVector<Entry>& entries, Kind kind, const Entry*& begin, const Entry*& end)
+{
+	const Entry* first = entries.constData();
+	const Entry* last = first+entries.size();
+	// Lower bound of the kind
+	int count = last-first;
+	while (count>0)
+	{
+		const int step = count/2;
+		if ((int)first[step].kind<(int)kind)
+		{
+			first += step+1;
+			count -= step+1;
+		}
+		else
+			count = step;
+	}
+	// Upper bound of the kind
+	const Entry* it = first;
+	count = last-first;
+	while (count>0)
+	{
+		const int step = count/2;
+		if ((int)it[step].kind<=(int)kind)
+		{
+			it += step+1;
+			count -= step+1;
+		}
+		else
+			count = step;
+	}
+	begin = first;
+	end = it;
+}
+
+const StarNameTable::Entry* StarNameTable::lowerBound(Kind kind, const QString& upper, const Entry*& end) const
+{
+	const Entry* first;
+	kindRange(byName, kind, first, end);
+	int count = end-first;
+	while (count>0)
+	{
+		const int step = count/2;
+		if (compareUpper(first[step].name, upper)<0)
+		{
+			first += step+1;
+			count -= step+1;
+		}
+		else
+			count = step;
+	}
+	return first;
+}
+
+struct StarNameTable::HipLessThan
+{
+	bool operator()(const Entry& a, const Entry& b) const
+	{
+		if (a.kind!=b.kind)
+			return a.kind<b.kind;
+		return a.hip<b.hip;
+	}
+};
+
+struct StarNameTable::NameLessThan
+{
+	NameLessThan(const QString& pool) : pool(pool) {}
+	bool operator()(const Entry& a, const Entry& b) const
+	{
+		if (a.kind!=b.kind)
+			return a.kind<b.kind;
+		const int c = ::compareUpper(pool.constData()+a.name+1, pool.at(a.name).unicode(),
+					     pool.constData()+b.name+1, pool.at(b.name).unicode());
+		if (c!=0)
+			return c<0;
+		return a.hip<b.hip;
+	}
+	const QString& pool;
+};
+
+void StarNameTable::setNames(Kind kind, const QHash<int, QString>& names)
+{
+	// Gather the names of the other kinds with the new ones, and rebuild the pool so that
+	// the names which are not used anymore are dropped.
+	QVector<QPair<Entry, QString> > all;
+	all.reserve(byHip.size()+names.size());
+	foreach (const Entry& e, byHip)
+	{
+		if (e.kind!=(quint32)kind)
+			all.append(qMakePair(e, nameAt(e.name)));
+	}
+	for (QHash<int, QString>::ConstIterator it=names.constBegin();it!=names.constEnd();++it)
+	{
+		if (it.key()<=0 || it.value().isEmpty())
+			continue;
+		Entry e;
+		e.hip = it.key();
+		e.kind = kind;
+		e.name = 0;
+		all.append(qMakePair(e, it.value().left(0xffff)));
+	}
+
+	QString newPool;
+	QHash<QString, quint32> interned;
+	byHip.resize(0);
+	byHip.reserve(all.size());
+	for (int i=0;i<all.size();++i)
+	{
+		Entry e = all.at(i).first;
+		const QString& name = all.at(i).second;
+		QHash<QString, quint32>::ConstIterator it = interned.constFind(name);
+		if (it!=interned.constEnd())
+		{
+			e.name = it.value();
+		}
+		else
+		{
+			e.name = newPool.size();
+			newPool.append(QChar((ushort)name.size()));
+			newPool.append(name);
+			interned.insert(name, e.name);
+		}
+		byHip.append(e);
+	}
+	pool = newPool;
+	pool.squeeze();
+
+	std::sort(byHip.begin(), byHip.end(), HipLessThan());
+	byName = byHip;
+	std::sort(byName.begin(), byName.end(), NameLessThan(pool));
+	byHip.squeeze();
+	byName.squeeze();
+}
+
+QHash<int, QString> StarNameTable::getNames(Kind kind) const
+{
+	QHash<int, QString> result;
+	const Entry* begin;
+	const Entry* end;
+	kindRange(byHip, kind, begin, end);
+	result.reserve(end-begin);
+	for (const Entry* e=begin;e<end;++e)
+		result.insert(e->hip, nameAt(e->name));
+	return result;
+}
+
+QString StarNameTable::getName(Kind kind, int hip) const
+{
+	const Entry* first;
+	const Entry* end;
+	kindRange(byHip, kind, first, end);
+	int count = end-first;
+	while (count>0)
+	{
+		const int step = count/2;
+		if ((int)first[step].hip<hip)
+		{
+			first += step+1;
+			count -= step+1;
+		}
+		else
+			count = step;
+	}
+	if (first<end && (int)first->hip==hip)
+		return nameAt(first->name);
+	return QString();
+}
+
+int StarNameTable::search(Kind kind, const QString& name) const
+{
+	const QString upper = name.toUpper();
+	const Entry* end;
+	const Entry* e = lowerBound(kind, upper, end);
+	if (e<end && compareUpper(e->name, upper)==0)
+		return e->hip;
+	return 0;
+}
+
+QList<int> StarNameTable::listStartingWith(Kind kind, const QString& prefix, int maxNbItem) const
+{
+	QList<int> result;
+	const QString upper = prefix.toUpper();
+	const Entry* end;
+	for (const Entry* e=lowerBound(kind, upper, end);e<end && result.size()<maxNbItem;++e)
+	{
+		if (!startsWithUpper(pool, e->name, upper))
+			break;
+		result << e->hip;
+	}
+	return result;
+}
+
+QList<int> StarNameTable::listContaining(Kind kind, const QString& text, int maxNbItem) const
+{
+	QList<int> result;
+	const Entry* begin;
+	const Entry* end;
+	kindRange(byName, kind, begin, end);
+	for (const Entry* e=begin;e<end && result.size()<maxNbItem;++e)
+	{
+		if (nameAt(e->name).contains(text, Qt::CaseInsensitive))
+			result << e->hip;
+	}
+	return result;
+}
+
+QList<int> StarNameTable::listMatching(Kind kind, const QString& prefix, const QRegExp& upperRx, int maxNbItem) const
+{
+	QList<int> result;
+	const QString upper = prefix.toUpper();
+	if (upper.isEmpty())
+		return result;
+	const Entry* end;
+	for (const Entry* e=lowerBound(kind, upper, end);e<end && result.size()<maxNbItem;++e)
+	{
+		const QString name = nameAt(e->name).toUpper();
+		if (name.indexOf(upperRx)==0)
+			result << e->hip;
+		else if (name.at(0)!=upper.at(0))
+			break;
+	}
+	return result;
+}
@@ -0,0 +1,103 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STARNAMETABLE_HPP_
+#define _STARNAMETABLE_HPP_
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+class QRegExp;
+
+//! @class StarNameTable
+//! Compact table of the names of the Hipparcos stars.
+//! All the names are interned in a single string pool. Each name is referenced by its offset in the
+//! pool from two arrays of entries, one sorted by Hipparcos number for the lookups of the names of a
+//! star, and one sorted by upper case name for the searches and completions by name.
+//! A star has at most one name of each kind.
+class StarNameTable
+{
+public:
+	enum Kind
+	{
+		CommonName,		//!< English common name
+		CommonNameI18n,		//!< Translated common name
+		SciName,		//!< Scientific name
+		SciAdditionalName,	//!< Additional scientific name
+		GcvsName		//!< Designation in the General Catalogue of Variable Stars
+	};
+
+	//! Replace all the names of a kind.
+	//! @param names the names by Hipparcos number
+	void setNames(Kind kind, const QHash<int, QString>& names);
+
+	//! Get all the names of a kind by Hipparcos number.
+	QHash<int, QString> getNames(Kind kind) const;
+
+	//! Get the name of a kind of a star, or an empty string.
+	QString getName(Kind kind, int hip) const;
+
+	//! Search a star by name, case insensitively.
+	//! @return the Hipparcos number, or 0 if not found
+	int search(Kind kind, const QString& name) const;
+
+	//! Return the stars whose names start with the passed prefix, case insensitively, in the order of their names.
+	QList<int> listStartingWith(Kind kind, const QString& prefix, int maxNbItem) const;
+
+	//! Return the stars whose names contain the passed text, case insensitively, in the order of their names.
+	QList<int> listContaining(Kind kind, const QString& text, int maxNbItem) const;
+
+	//! Return the stars whose upper case names start with the same character as the passed prefix, and
+	//! are matched by the regular expression at their start, in the order of their names.
+	QList<int> listMatching(Kind kind, const QString& prefix, const QRegExp& upperRx, int maxNbItem) const;
+
+private:
+	struct Entry
+	{
+		quint32 hip:28;
+		quint32 kind:4;
+		//! Offset of the name in the pool.
+		quint32 name;
+	};
+	struct HipLessThan;
+	struct NameLessThan;
+
+	//! Return the name at the given offset of the pool.
+	QString nameAt(quint32 offset) const
+	{
+		return QString(pool.constData()+offset+1, pool.at(offset).unicode());
+	}
+	//! Compare the name at the given offset with a string in upper case.
+	int compareUpper(quint32 offset, const QString& upper) const;
+	//! Return the entries of a kind in an array sorted by kind.
+	static void kindRange(const QVector<Entry>& entries, Kind kind, const Entry*& begin, const Entry*& end);
+	//! Return the first entry of a kind whose name is not less than the passed upper case string.
+	const Entry* lowerBound(Kind kind, const QString& upper, const Entry*& end) const;
+
+	//! The names, each one preceded by its length.
+	QString pool;
+	//! The entries sorted by kind and Hipparcos number.
+	QVector<Entry> byHip;
+	//! The entries sorted by kind and upper case name.
+	QVector<Entry> byName;
+};
+
+#endif // _STARNAMETABLE_HPP_
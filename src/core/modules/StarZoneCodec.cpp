@@ -0,0 +1,205 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StarZoneCodec.hpp"
+
+#include <QVector>
+#include <algorithm>
+
+// Number of byte planes used for the second coordinate, enough for the 20 bits of Star2
+static const int x1Planes = 3;
+
+static void writeVarInt(QByteArray& out, int v)
+{
+	// Zigzag encoding so that small negative values are short too
+	unsigned int u = ((unsigned int)v << 1) ^ (unsigned int)(v >> 31);
+	while (u>=0x80)
+	{
+		out.append((char)(u | 0x80));
+		u >>= 7;
+	}
+	out.append((char)u);
+}
+
+//! Bounds checked reader of the decompressed columns.
+class StarColumnReader
+{
+public:
+	StarColumnReader(const QByteArray& data) : p((const unsigned char*)data.constData()), end(p+data.size()), ok(true) {}
+	int readVarInt()
+	{
+		unsigned int u = 0;
+		for (int shift=0;shift<35;shift+=7)
+		{
+			if (p>=end)
+			{
+				ok = false;
+				return 0;
+			}
+			const unsigned int b = *p++;
+			u |= (b & 0x7f) << shift;
+			if (!(b & 0x80))
+				return (int)(u >> 1) ^ -(int)(u & 1);
+		}
+		ok = false;
+		return 0;
+	}
+	unsigned int readByte()
+	{
+		if (p>=end)
+		{
+			ok = false;
+			return 0;
+		}
+		return *p++;
+	}
+	bool isOk() const {return ok && p==end;}
+	bool hasError() const {return !ok;}
+private:
+	const unsigned char* p;
+	const unsigned char* end;
+	bool ok;
+};
+
+static void writeMotion(QByteArray& out, const Star2* stars, int count)
+{
+	for (int i=0;i<count;++i)
+		writeVarInt(out, stars[i].dx0);
+	for (int i=0;i<count;++i)
+		writeVarInt(out, stars[i].dx1);
+}
+
+static void writeMotion(QByteArray&, const Star3*, int) {}
+
+static void readMotion(StarColumnReader& in, Star2* stars, int count)
+{
+	for (int i=0;i<count;++i)
+		stars[i].dx0 = in.readVarInt();
+	for (int i=0;i<count;++i)
+		stars[i].dx1 = in.readVarInt();
+}
+
+static void readMotion(StarColumnReader&, Star3*, int) {}
+
+template <class Star>
+static bool starLessThan(const Star& a, const Star& b)
+{
+	if (a.mag!=b.mag)
+		return a.mag<b.mag;
+	return a.x0<b.x0;
+}
+
+template <class Star>
+static QByteArray encodeStars(const Star* stars, int count)
+{
+	if (count==0)
+		return QByteArray();
+	QByteArray raw;
+	raw.reserve(count*(int)sizeof(Star)+16);
+	int prev = 0;
+	for (int i=0;i<count;++i)
+	{
+		writeVarInt(raw, stars[i].mag-prev);
+		prev = stars[i].mag;
+	}
+	for (int i=0;i<count;++i)
+		raw.append((char)stars[i].bV);
+	prev = 0;
+	for (int i=0;i<count;++i)
+	{
+		writeVarInt(raw, stars[i].x0-prev);
+		prev = stars[i].x0;
+	}
+	// The second coordinate is random, store it as an unsigned offset split in byte planes
+	// so that the mostly empty high plane is compressed away.
+	for (int plane=0;plane<x1Planes;++plane)
+	{
+		for (int i=0;i<count;++i)
+			raw.append((char)(((unsigned int)(stars[i].x1+Star::MaxPosVal+1) >> (8*plane)) & 0xff));
+	}
+	writeMotion(raw, stars, count);
+	return qCompress(raw, 9);
+}
+
+template <class Star>
+static bool decodeStars(const char* data, int size, Star* stars, int count)
+{
+	if (count==0)
+		return size==0;
+	const QByteArray raw = qUncompress((const uchar*)data, size);
+	if (raw.isEmpty())
+		return false;
+	StarColumnReader in(raw);
+	int prev = 0;
+	for (int i=0;i<count;++i)
+	{
+		prev += in.readVarInt();
+		stars[i].mag = prev;
+	}
+	for (int i=0;i<count;++i)
+		stars[i].bV = in.readByte();
+	prev = 0;
+	for (int i=0;i<count;++i)
+	{
+		prev += in.readVarInt();
+		stars[i].x0 = prev;
+	}
+	if (in.hasError())
+		return false;
+	QVector<unsigned int> x1(count, 0);
+	for (int plane=0;plane<x1Planes;++plane)
+	{
+		for (int i=0;i<count;++i)
+			x1[i] |= in.readByte() << (8*plane);
+	}
+	for (int i=0;i<count;++i)
+		stars[i].x1 = (int)x1.at(i)-Star::MaxPosVal-1;
+	readMotion(in, stars, count);
+	return in.isOk();
+}
+
+void StarZoneCodec::sort(Star2* stars, int count)
+{
+	std::stable_sort(stars, stars+count, starLessThan<Star2>);
+}
+
+void StarZoneCodec::sort(Star3* stars, int count)
+{
+	std::stable_sort(stars, stars+count, starLessThan<Star3>);
+}
+
+QByteArray StarZoneCodec::encode(const Star2* stars, int count)
+{
+	return encodeStars(stars, count);
+}
+
+QByteArray StarZoneCodec::encode(const Star3* stars, int count)
+{
+	return encodeStars(stars, count);
+}
+
+bool StarZoneCodec::decode(const char* data, int size, Star2* stars, int count)
+{
+	return decodeStars(data, size, stars, count);
+}
+
+bool StarZoneCodec::decode(const char* data, int size, Star3* stars, int count)
+{
+	return decodeStars(data, size, stars, count);
+}
@@ -0,0 +1,54 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STARZONECODEC_HPP_
+#define _STARZONECODEC_HPP_
+
+#include "Star.hpp"
+
+#include <QByteArray>
+
+//! @class StarZoneCodec
+//! Encode and decode the stars of one zone of the compressed star catalogs (major version 1).
+//! The fields of the stars are stored in columns: the magnitudes as deltas from the previous star,
+//! the B-V indices, the first coordinates as deltas from the previous star, the second coordinates
+//! split in byte planes and, for Star2, the proper motions. Small values are written as zigzag
+//! variable length integers, and the columns are then compressed with zlib whose Huffman stage
+//! does the entropy coding of the magnitudes and colors.
+//! The stars of a zone must be sorted by magnitude as for the uncompressed catalogs. Sorting the
+//! stars of the same magnitude by their first coordinate with sort() makes the deltas small.
+//! The Hipparcos stars (Star1) are not compressed because the HIP index points to them.
+class StarZoneCodec
+{
+public:
+	//! Sort the stars of a zone by magnitude, then by first coordinate.
+	static void sort(Star2* stars, int count);
+	static void sort(Star3* stars, int count);
+
+	//! Return the compressed block of a zone.
+	static QByteArray encode(const Star2* stars, int count);
+	static QByteArray encode(const Star3* stars, int count);
+
+	//! Decode a compressed block into an array of count stars.
+	//! @return false if the block is corrupted.
+	static bool decode(const char* data, int size, Star2* stars, int count);
+	static bool decode(const char* data, int size, Star3* stars, int count);
+};
+
+#endif // _STARZONECODEC_HPP_
@@ -20,6 +20,7 @@
 #include <QDebug>
 #include <QFile>
 #include <QDir>
+#include <QCryptographicHash>
 #ifdef Q_OS_WIN
 #include <io.h>
 #include <windows.h>
@@ -30,6 +31,8 @@
 #include "StelFileMgr.hpp"
 #include "StelGeodesicGrid.hpp"
 #include "StelObject.hpp"
+#include "StelLabelScheduler.hpp"
+#include "StarZoneCodec.hpp"
 
 static unsigned int stel_bswap_32(unsigned int val) {
   return (((val) & 0xff000000) >> 24) | (((val) & 0x00ff0000) >>  8) |
@@ -87,7 +90,20 @@ static inline int ReadInt(QFile& file, unsigned int &x)
 #endif
 #endif
 
-ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
+int ZoneArray::readCatalogType(const QString& catalogFilePath)
+{
+	QFile file(catalogFilePath);
+	unsigned int magic, type;
+	if (!file.open(QIODevice::ReadOnly) || ReadInt(file,magic) < 0 || ReadInt(file,type) < 0)
+		return -1;
+	if (magic == FILE_MAGIC_OTHER_ENDIAN)
+		return stel_bswap_32(type);
+	if (magic == FILE_MAGIC || magic == FILE_MAGIC_NATIVE)
+		return type;
+	return -1;
+}
+
+ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap, int zoneCacheSizeMB)
 {
 #ifdef Q_OS_ANDROID
 	use_mmap = false;
@@ -188,7 +204,11 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 		}
 		break;
 	case 1:
-		if (major > MAX_MAJOR_FILE_VERSION)
+		if (major == COMPRESSED_MAJOR_FILE_VERSION)
+		{
+			rval = new CompressedZoneArray<Star2>(file, byte_swap, use_mmap, level, mag_min, mag_range, mag_steps, zoneCacheSizeMB*1024*1024);
+		}
+		else if (major > MAX_MAJOR_FILE_VERSION)
 		{
 			dbStr += "warning - unsupported version ";
 		}
@@ -209,7 +229,11 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 		}
 		break;
 	case 2:
-		if (major > MAX_MAJOR_FILE_VERSION)
+		if (major == COMPRESSED_MAJOR_FILE_VERSION)
+		{
+			rval = new CompressedZoneArray<Star3>(file, byte_swap, use_mmap, level, mag_min, mag_range, mag_steps, zoneCacheSizeMB*1024*1024);
+		}
+		else if (major > MAX_MAJOR_FILE_VERSION)
 		{
 			dbStr += "warning - unsupported version ";
 		}
@@ -283,6 +307,99 @@ bool ZoneArray::readFile(QFile& file, void *data, qint64 size)
 	return true;
 }
 
+template<class Star>
+static QByteArray compressZone(ZoneData& zone)
+{
+	Star* stars = reinterpret_cast<Star*>(zone.stars);
+	StarZoneCodec::sort(stars, zone.size);
+	return StarZoneCodec::encode(stars, zone.size);
+}
+
+bool ZoneArray::compressCatalog(const QString& inputFileName, const QString& outputFileName)
+{
+	// Check the header before loading the whole catalog
+	QFile input(inputFileName);
+	if (!input.open(QIODevice::ReadOnly))
+	{
+		qWarning() << "Error while compressing" << QDir::toNativeSeparators(inputFileName) << ": failed to open file.";
+		return false;
+	}
+	unsigned int magic,type,major,minor;
+	if (ReadInt(input,magic) < 0 || ReadInt(input,type) < 0 || ReadInt(input,major) < 0 || ReadInt(input,minor) < 0)
+	{
+		qWarning() << "Error while compressing" << QDir::toNativeSeparators(inputFileName) << ": file format is bad.";
+		return false;
+	}
+	input.close();
+	if (magic == FILE_MAGIC_OTHER_ENDIAN)
+	{
+		type = stel_bswap_32(type);
+		major = stel_bswap_32(major);
+		minor = stel_bswap_32(minor);
+	}
+	else if (magic != FILE_MAGIC && magic != FILE_MAGIC_NATIVE)
+	{
+		qWarning() << "Error while compressing" << QDir::toNativeSeparators(inputFileName) << ": not a catalogue file.";
+		return false;
+	}
+	if ((type != 1 && type != 2) || major > MAX_MAJOR_FILE_VERSION)
+	{
+		qWarning() << "Error while compressing" << QDir::toNativeSeparators(inputFileName)
+			   << ": only the uncompressed catalogues of Star2 or Star3 can be compressed.";
+		return false;
+	}
+
+	// Load the catalog in memory, the stars are converted to the native layout
+	ZoneArray* za = create(inputFileName, false);
+	if (!za)
+		return false;
+
+	QFile output(outputFileName);
+	if (!output.open(QIODevice::ReadWrite | QIODevice::Truncate))
+	{
+		qWarning() << "Error while compressing: failed to create" << QDir::toNativeSeparators(outputFileName);
+		delete za;
+		return false;
+	}
+	const unsigned int header[8] = {FILE_MAGIC, type, COMPRESSED_MAJOR_FILE_VERSION, minor, (unsigned int)za->level,
+					(unsigned int)za->mag_min, (unsigned int)za->mag_range, (unsigned int)za->mag_steps};
+	QVector<unsigned int> zoneSizes(za->nr_of_zones);
+	for (unsigned int z=0;z<za->nr_of_zones;z++)
+		zoneSizes[z] = za->zones[z].size;
+	// The block ends are written once the blocks are known
+	QVector<unsigned int> blockEnds(za->nr_of_zones, 0);
+	bool ok = output.write((const char*)header, sizeof(header)) == (qint64)sizeof(header)
+		&& output.write((const char*)zoneSizes.constData(), sizeof(unsigned int)*za->nr_of_zones) == (qint64)(sizeof(unsigned int)*za->nr_of_zones);
+	const qint64 blockEndsPos = output.pos();
+	ok = ok && output.write((const char*)blockEnds.constData(), sizeof(unsigned int)*za->nr_of_zones) == (qint64)(sizeof(unsigned int)*za->nr_of_zones);
+	qint64 blocksSize = 0;
+	for (unsigned int z=0;ok && z<za->nr_of_zones;z++)
+	{
+		const QByteArray block = (type==1) ? compressZone<Star2>(za->zones[z]) : compressZone<Star3>(za->zones[z]);
+		ok = output.write(block) == block.size();
+		blocksSize += block.size();
+		blockEnds[z] = blocksSize;
+	}
+	ok = ok && output.seek(blockEndsPos)
+		&& output.write((const char*)blockEnds.constData(), sizeof(unsigned int)*za->nr_of_zones) == (qint64)(sizeof(unsigned int)*za->nr_of_zones);
+	const unsigned int nrOfStars = za->getNrOfStars();
+	delete za;
+	if (!ok)
+	{
+		qWarning() << "Error while writing" << QDir::toNativeSeparators(outputFileName) << ":" << output.errorString();
+		output.remove();
+		return false;
+	}
+
+	// The checksum is needed to declare the catalog in the stars.json file
+	output.seek(0);
+	QCryptographicHash md5Hash(QCryptographicHash::Md5);
+	md5Hash.addData(output.readAll());
+	qDebug() << "Compressed" << nrOfStars << "stars from" << QDir::toNativeSeparators(inputFileName) << "(" << input.size() << "bytes ) to"
+		 << QDir::toNativeSeparators(outputFileName) << "(" << output.size() << "bytes ), md5sum" << md5Hash.result().toHex();
+	return true;
+}
+
 void HipZoneArray::updateHipIndex(HipIndexStruct hipIndex[]) const
 {
 	for (const SpecialZoneData<Star1> *z=getZones()+(nr_of_zones-1);z>=getZones();z--)
@@ -297,9 +414,15 @@ void HipZoneArray::updateHipIndex(HipIndexStruct hipIndex[]) const
 			}
 			if (hip != 0)
 			{
-				hipIndex[hip].a = this;
-				hipIndex[hip].z = z;
-				hipIndex[hip].s = s;
+				const int zone = z-getZones();
+				const int offset = s-z->getStars();
+				if (!HipIndexStruct::canPack(level, zone, offset))
+				{
+					qDebug() << "ERROR: HipZoneArray::updateHipIndex: can not index HIP" << hip << "at level" << level
+						 << "zone" << zone << "offset" << offset;
+					continue;
+				}
+				hipIndex[hip].set(level, zone, offset);
 			}
 		}
 	}
@@ -481,11 +604,128 @@ SpecialZoneArray<Star>::~SpecialZoneArray(void)
 	nr_of_stars = 0;
 }
 
+template<class Star>
+CompressedZoneArray<Star>::CompressedZoneArray(QFile* file, bool byte_swap, bool use_mmap, int level, int mag_min,
+					       int mag_range, int mag_steps, int cacheSize)
+	: SpecialZoneArray<Star>(file, level, mag_min, mag_range, mag_steps), blocksStart(0), mmapStart(0)
+{
+	const unsigned int nrOfZones = this->nr_of_zones;
+	if (nrOfZones == 0)
+		return;
+
+	// The zone sizes followed by the end offsets of the blocks
+	QVector<unsigned int> directory(2*nrOfZones);
+	if ((qint64)(sizeof(unsigned int)*directory.size()) != file->read((char*)directory.data(), sizeof(unsigned int)*directory.size()))
+	{
+		qDebug() << "Error reading zones from catalog:" << file->fileName();
+		this->nr_of_zones = 0;
+		return;
+	}
+	if (byte_swap)
+	{
+		for (int i=0;i<directory.size();i++)
+			directory[i] = stel_bswap_32(directory.at(i));
+	}
+
+	SpecialZoneData<Star>* specialZones = new SpecialZoneData<Star>[nrOfZones];
+	this->zones = specialZones;
+	blockEnds.resize(nrOfZones);
+	int largestZone = 0;
+	bool ok = true;
+	for (unsigned int z=0;z<nrOfZones;z++)
+	{
+		specialZones[z].size = directory.at(z);
+		specialZones[z].stars = NULL;
+		this->nr_of_stars += specialZones[z].size;
+		largestZone = qMax(largestZone, specialZones[z].size);
+		blockEnds[z] = directory.at(nrOfZones+z);
+		if (z>0 && blockEnds.at(z)<blockEnds.at(z-1))
+			ok = false;
+	}
+	blocksStart = file->pos();
+	if (!ok || blocksStart+blockEnds.last() > file->size())
+	{
+		qDebug() << "Error: bad zone directory in catalog:" << file->fileName();
+		ok = false;
+	}
+	if (!ok || this->nr_of_stars == 0)
+	{
+		delete[] specialZones;
+		this->zones = 0;
+		this->nr_of_zones = 0;
+		this->nr_of_stars = 0;
+		return;
+	}
+
+	if (use_mmap)
+	{
+		mmapStart = file->map(blocksStart, blockEnds.last());
+		if (mmapStart == 0)
+			qDebug() << "Warning: mmap of" << file->fileName() << "failed, reading the zones from the file:" << file->errorString();
+		else
+			file->close();
+	}
+	// A zone must fit in the cache
+	cache.setMaxCost(qMax(cacheSize, largestZone*(int)sizeof(Star)));
+}
+
+template<class Star>
+CompressedZoneArray<Star>::~CompressedZoneArray(void)
+{
+	// Unload the stars before the zones are deleted by SpecialZoneArray
+	cache.clear();
+	if (mmapStart)
+		this->file->unmap(mmapStart);
+	delete this->file;
+	this->file = NULL;
+}
+
+template<class Star>
+const SpecialZoneData<Star>* CompressedZoneArray<Star>::getZone(int index) const
+{
+	SpecialZoneData<Star>* zone = this->getZones()+index;
+	// QCache::object() also marks the zone as the most recently used
+	if (zone->size == 0 || cache.object(index))
+		return zone;
+
+	const qint64 start = index>0 ? blockEnds.at(index-1) : 0;
+	const int blockSize = blockEnds.at(index)-start;
+	QByteArray block;
+	const char* data;
+	if (mmapStart)
+	{
+		data = (const char*)mmapStart+start;
+	}
+	else
+	{
+		if (this->file->seek(blocksStart+start))
+			block = this->file->read(blockSize);
+		data = block.constData();
+		if (block.size() != blockSize)
+		{
+			qWarning() << "Error reading zone" << index << "from catalog:" << this->fname;
+			return NULL;
+		}
+	}
+	Star* stars = new Star[zone->size];
+	if (!StarZoneCodec::decode(data, blockSize, stars, zone->size))
+	{
+		qWarning() << "Error: zone" << index << "of catalog" << this->fname << "is corrupted, skipping it";
+		delete[] stars;
+		zone->size = 0;
+		return zone;
+	}
+	cache.insert(index, new DecodedZone(zone, stars), zone->size*sizeof(Star));
+	return zone;
+}
+
 template<class Star>
 void SpecialZoneArray<Star>::draw(StelPainter* sPainter, int index, bool isInsideViewport, const RCMag* rcmag_table,
 	int limitMagIndex, StelCore* core, int maxMagStarName, float names_brightness, const QVector<SphericalCap> &boundingCaps) const
 {
     StelSkyDrawer* drawer = core->getSkyDrawer();
+    StelLabelScheduler* labelScheduler = core->getLabelScheduler();
+    const StelProjectorP& prj = sPainter->getProjector();
     Vec3f vf;
     static const double d2000 = 2451545.0;
     const float movementFactor = (M_PI/180)*(0.0001/3600) * ((core->getJDay()-d2000)/365.25) / star_position_scale;
@@ -506,63 +746,98 @@ void SpecialZoneArray<Star>::draw(StelPainter* sPainter, int index, bool isInsid
 	}
 	Q_ASSERT(cutoffMagStep<RCMAG_TABLE_SIZE);
     
-	// Go through all stars, which are sorted by magnitude (bright stars first)
-	const SpecialZoneData<Star>* zoneToDraw = getZones() + index;
+	// Go through all stars, which are sorted by magnitude (bright stars first).
+	// The visible stars are gathered in batches projected with a single call to the projector.
+	static const int BatchSize = 256;
+	const Star* batchStars[BatchSize];
+	const RCMag* batchRcmags[BatchSize];
+	int batchMagIndices[BatchSize];
+	Vec3f batchPos[BatchSize];
+	Vec3f batchWin[BatchSize];
+	bool batchValid[BatchSize];
+	const SpecialZoneData<Star>* zoneToDraw = getZone(index);
+	if (!zoneToDraw)
+		return;
 	const Star* lastStar = zoneToDraw->getStars() + zoneToDraw->size;
-    for (const Star* s=zoneToDraw->getStars();s<lastStar;++s)
-    {
-		// Artifical cutoff per magnitude
-		if (s->mag > cutoffMagStep)
-			break;
-    
-		// Because of the test above, the star should always be visible from this point.
-		
-		// Array of 2 numbers containing radius and magnitude
-		const RCMag* tmpRcmag = &rcmag_table[s->mag];
-		
-		// Get the star position from the array
-		s->getJ2000Pos(zoneToDraw, movementFactor, vf);
-		
-		// If the star zone is not strictly contained inside the viewport, eliminate from the 
-		// beginning the stars actually outside viewport.
-		if (!isInsideViewport)
+	const Star* s = zoneToDraw->getStars();
+	while (s<lastStar)
+	{
+		int n = 0;
+		for (;s<lastStar && n<BatchSize;++s)
 		{
-			bool isVisible = true;
-			vf.normalize();
-			foreach (const SphericalCap& cap, boundingCaps)
+			// Artifical cutoff per magnitude
+			if (s->mag > cutoffMagStep)
 			{
-				if (!cap.contains(vf))
+				s = lastStar;
+				break;
+			}
+
+			// Because of the test above, the star should always be visible from this point.
+
+			// Array of 2 numbers containing radius and magnitude
+			const RCMag* tmpRcmag = &rcmag_table[s->mag];
+
+			// Get the star position from the array
+			s->getJ2000Pos(zoneToDraw, movementFactor, vf);
+
+			// If the star zone is not strictly contained inside the viewport, eliminate from the
+			// beginning the stars actually outside viewport.
+			if (!isInsideViewport)
+			{
+				bool isVisible = true;
+				vf.normalize();
+				foreach (const SphericalCap& cap, boundingCaps)
 				{
-					isVisible = false;
-					continue;
+					if (!cap.contains(vf))
+					{
+						isVisible = false;
+						continue;
+					}
 				}
+				if (!isVisible)
+					continue;
 			}
-			if (!isVisible)
+
+			int extinctedMagIndex = s->mag;
+			if (withExtinction)
+			{
+				Vec3f altAz(vf);
+				altAz.normalize();
+				core->j2000ToAltAzInPlaceNoRefraction(&altAz);
+				float extMagShift=0.0f;
+				extinction.forward(altAz, &extMagShift);
+				extinctedMagIndex = s->mag + (int)(extMagShift/k);
+				if (extinctedMagIndex >= cutoffMagStep) // i.e., if extincted it is dimmer than cutoff, so remove
+					continue;
+				tmpRcmag = &rcmag_table[extinctedMagIndex];
+			}
+			if (tmpRcmag->radius<=0.f)
 				continue;
+
+			batchStars[n] = s;
+			batchRcmags[n] = tmpRcmag;
+			batchMagIndices[n] = extinctedMagIndex;
+			batchPos[n] = vf;
+			++n;
 		}
 
-		int extinctedMagIndex = s->mag;
-		if (withExtinction)
+		prj->project(n, batchPos, batchWin, batchValid);
+		for (int i=0;i<n;++i)
 		{
-			Vec3f altAz(vf);
-			altAz.normalize();
-			core->j2000ToAltAzInPlaceNoRefraction(&altAz);
-			float extMagShift=0.0f;
-			extinction.forward(altAz, &extMagShift);
-			extinctedMagIndex = s->mag + (int)(extMagShift/k);
-			if (extinctedMagIndex >= cutoffMagStep) // i.e., if extincted it is dimmer than cutoff, so remove
+			const Vec3f& win = batchWin[i];
+			if (!batchValid[i] || (!isInsideViewport && !prj->checkInViewport(win)))
 				continue;
-			tmpRcmag = &rcmag_table[extinctedMagIndex];
-		}
-	
-		if (drawer->drawPointSource(sPainter, vf, *tmpRcmag, s->bV, !isInsideViewport) && s->hasName() && extinctedMagIndex < maxMagStarName && s->hasComponentID()<=1)
-		{
-			const float offset = tmpRcmag->radius*0.7f;
-			const Vec3f colorr = StelSkyDrawer::indexToColor(s->bV)*0.75f;
-			sPainter->setColor(colorr[0], colorr[1], colorr[2],names_brightness);
-			sPainter->drawText(Vec3d(vf[0], vf[1], vf[2]), s->getNameI18n(), 0, offset, offset, false);
+			const Star* star = batchStars[i];
+			if (drawer->drawPointSourceProjected(sPainter, win, *batchRcmags[i], star->bV) && star->hasName() && batchMagIndices[i] < maxMagStarName && star->hasComponentID()<=1)
+			{
+				const float offset = batchRcmags[i]->radius*0.7f;
+				const Vec3f colorr = StelSkyDrawer::indexToColor(star->bV)*0.75f;
+				// The label is drawn by StarMgr if it does not overlap a more important one
+				labelScheduler->addLabel(win[0], win[1], star->getNameI18n(), Vec4f(colorr[0], colorr[1], colorr[2], names_brightness),
+							 -0.001f*(mag_min+batchMagIndices[i]*mag_range/mag_steps), offset, offset);
+			}
 		}
-    }
+	}
 }
 
 template<class Star>
@@ -571,7 +846,9 @@ void SpecialZoneArray<Star>::searchAround(const StelCore* core, int index, const
 {
 	static const double d2000 = 2451545.0;
 	const double movementFactor = (M_PI/180.)*(0.0001/3600.) * ((core->getJDay()-d2000)/365.25)/ star_position_scale;
-	const SpecialZoneData<Star> *const z = getZones()+index;
+	const SpecialZoneData<Star> *const z = getZone(index);
+	if (!z)
+		return;
 	Vec3f tmp;
 	Vec3f vf(v[0], v[1], v[2]);
 	for (const Star* s=z->getStars();s<z->getStars()+z->size;++s)
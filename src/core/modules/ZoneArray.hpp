@@ -26,6 +26,8 @@
 #include <QString>
 #include <QFile>
 #include <QDebug>
+#include <QCache>
+#include <QVector>
 
 #include "ZoneData.hpp"
 #include "Star.hpp"
@@ -57,15 +59,34 @@
 #define FILE_MAGIC_OTHER_ENDIAN 0x0a045f83
 #define FILE_MAGIC_NATIVE 0x835f040b
 #define MAX_MAJOR_FILE_VERSION 0
+//! Major version of the catalogs of Star2 or Star3 whose zones are compressed with StarZoneCodec.
+#define COMPRESSED_MAJOR_FILE_VERSION 1
 
 //! @struct HipIndexStruct
-//! Container for Hipparcos information. Stores a pointer to a Hipparcos star,
-//! its catalog and its triangle.
+//! Position of a Hipparcos star in the catalogs, packed in 32 bits: the level of its
+//! catalog in StelGeodesicGrid (3 bits), its zone (15 bits) and its offset in the zone (14 bits).
 struct HipIndexStruct
 {
-	const SpecialZoneArray<Star1> *a;
-	const SpecialZoneData<Star1> *z;
-	const Star1 *s;
+	HipIndexStruct() : packed(Empty) {}
+
+	//! Whether no star is indexed.
+	bool isEmpty() const {return packed==Empty;}
+	//! Whether the position of a star can be packed.
+	static bool canPack(int level, int zone, int offset)
+	{
+		return level>=0 && level<8 && zone>=0 && zone<(1<<15) && offset>=0 && offset<(1<<14);
+	}
+	void set(int level, int zone, int offset)
+	{
+		Q_ASSERT(canPack(level, zone, offset));
+		packed = ((quint32)level<<29) | ((quint32)zone<<14) | (quint32)offset;
+	}
+	int getLevel() const {return packed>>29;}
+	int getZone() const {return (packed>>14) & 0x7fff;}
+	int getOffset() const {return packed & 0x3fff;}
+
+	static const quint32 Empty = 0xffffffff;
+	quint32 packed;
 };
 
 //! @class ZoneArray
@@ -81,8 +102,20 @@ public:
 	//! loading.
 	//! @param extended_file_name path of the star catalog to load from
 	//! @param use_mmap whether or not to mmap the star catalog
-	//! @return an instance of SpecialZoneArray or HipZoneArray
-	static ZoneArray *create(const QString &extended_file_name, bool use_mmap);
+	//! @param zoneCacheSizeMB memory in MB used by the decompressed zones of a compressed catalog
+	//! @return an instance of SpecialZoneArray, CompressedZoneArray or HipZoneArray
+	static ZoneArray *create(const QString &extended_file_name, bool use_mmap, int zoneCacheSizeMB=16);
+
+	//! Return the type of the stars of a catalog from its header without loading it:
+	//! 0 for the Hipparcos stars (Star1), 1 for Star2 and 2 for Star3, or -1 on error.
+	static int readCatalogType(const QString& catalogFilePath);
+
+	//! Convert a catalog of Star2 or Star3 to the compressed format (major version 1).
+	//! The catalogs of Hipparcos stars are not supported because of the HIP index.
+	//! @param inputFileName path of the catalog to convert
+	//! @param outputFileName path of the compressed catalog to write
+	//! @return @c true if successful, or @c false if an error occurred
+	static bool compressCatalog(const QString& inputFileName, const QString& outputFileName);
 	virtual ~ZoneArray()
 	{
 		nr_of_zones = 0;
@@ -164,12 +197,24 @@ public:
 			 int mag_range,int mag_steps);
 	~SpecialZoneArray(void);
 protected:
+	//! Protected constructor for the subclasses loading the stars themselves. Only initializes fields.
+	SpecialZoneArray(QFile* file,int level,int mag_min,int mag_range,int mag_steps)
+		: ZoneArray(file->fileName(), file, level, mag_min, mag_range, mag_steps),
+		  stars(0), mmap_start(0) {}
+
 	//! Get an array of all SpecialZoneData objects in this catalog.
 	SpecialZoneData<Star> *getZones(void) const
 	{
 		return static_cast<SpecialZoneData<Star>*>(zones);
 	}
 
+	//! Get the zone at the given index with its stars loaded in memory.
+	//! @return NULL if the stars of the zone can not be loaded
+	virtual const SpecialZoneData<Star>* getZone(int index) const
+	{
+		return getZones()+index;
+	}
+
 	//! Draw stars and their names onto the viewport.
 	//! @param sPainter the painter to use 
 	//! @param index zone index to draw
@@ -193,6 +238,46 @@ private:
 	uchar *mmap_start;
 };
 
+//! @class CompressedZoneArray
+//! ZoneArray of a compressed catalog of Star2 or Star3 (major version 1).
+//! After the zone sizes, the file contains the end offsets of the compressed block of each zone
+//! relative to the start of the blocks, then the blocks encoded by StarZoneCodec.
+//! The zones are decompressed on demand when they are drawn or searched, and the last used ones
+//! are kept in a cache of limited size.
+template<class Star>
+class CompressedZoneArray : public SpecialZoneArray<Star>
+{
+public:
+	//! @param cacheSize maximum memory in bytes used by the decompressed zones
+	CompressedZoneArray(QFile* file,bool byte_swap,bool use_mmap,int level,int mag_min,
+			    int mag_range,int mag_steps,int cacheSize);
+	~CompressedZoneArray(void);
+protected:
+	virtual const SpecialZoneData<Star>* getZone(int index) const;
+private:
+	//! The stars of a zone in the cache. Unloads them from the zone when evicted.
+	struct DecodedZone
+	{
+		DecodedZone(SpecialZoneData<Star>* zone, Star* stars) : zone(zone)
+		{
+			zone->stars = stars;
+		}
+		~DecodedZone()
+		{
+			delete[] zone->getStars();
+			zone->stars = NULL;
+		}
+		SpecialZoneData<Star>* zone;
+	};
+
+	//! End offset of the block of each zone.
+	QVector<qint64> blockEnds;
+	//! Offset of the first block in the file.
+	qint64 blocksStart;
+	uchar* mmapStart;
+	mutable QCache<int, DecodedZone> cache;
+};
+
 //! @class HipZoneArray
 //! ZoneArray of Hipparcos stars. It's just a SpecialZoneArray<Star1> that
 //! implements updateHipIndex(HipIndexStruct).
@@ -207,6 +292,13 @@ public:
 	//! Add Hipparcos information for all stars in this catalog into @em hipIndex.
 	//! @param hipIndex array of Hipparcos info structs
 	void updateHipIndex(HipIndexStruct hipIndex[]) const;
+
+	//! Create the object of the star at the given position of the catalog, as stored in the HIP index.
+	StelObjectP createStelObject(int zone, int offset) const
+	{
+		const SpecialZoneData<Star1>* z = getZones()+zone;
+		return z->getStars()[offset].createStelObject(this, z);
+	}
 };
 
 #endif // _ZONEARRAY_HPP_
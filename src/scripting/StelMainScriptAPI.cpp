@@ -45,6 +45,8 @@
 #include "StelObject.hpp"
 #include "StelObjectMgr.hpp"
 #include "StelProjector.hpp"
+#include "StelProfiler.hpp"
+#include "StelRiseSetCalculator.hpp"
 #include "StelSkyCultureMgr.hpp"
 #include "StelSkyDrawer.hpp"
 #include "StelSkyLayerMgr.hpp"
@@ -279,6 +281,31 @@ float StelMainScriptAPI::getMaxFps()
 	return StelMainView::getInstance().getMaxFps();
 }
 
+void StelMainScriptAPI::setIdleFps(float m)
+{
+	StelApp::getInstance().setIdleFps(m);
+}
+
+float StelMainScriptAPI::getIdleFps()
+{
+	return StelApp::getInstance().getIdleFps();
+}
+
+void StelMainScriptAPI::setProfilerEnabled(bool b)
+{
+	StelApp::getInstance().getProfiler()->setEnabled(b);
+}
+
+QVariantMap StelMainScriptAPI::getProfilerReport()
+{
+	return StelApp::getInstance().getProfiler()->getReport();
+}
+
+bool StelMainScriptAPI::dumpProfilerTrace(const QString& filename)
+{
+	return StelApp::getInstance().getProfiler()->dumpChromeTrace(filename);
+}
+
 QString StelMainScriptAPI::getMountMode()
 {
 	if (GETSTELMODULE(StelMovementMgr)->getMountMode() == StelMovementMgr::MountEquinoxEquatorial)
@@ -777,6 +804,42 @@ QVariantMap StelMainScriptAPI::getObjectInfo(const QString& name)
 	return map;
 }
 
+QString StelMainScriptAPI::getConstellationAt(double ra, double dec)
+{
+	Vec3d pos;
+	StelUtils::spheToRect(ra*M_PI/180., dec*M_PI/180., pos);
+	return GETSTELMODULE(ConstellationMgr)->getConstellationAt(pos);
+}
+
+QStringList StelMainScriptAPI::getConstellationsAt(const QVariantList& positions)
+{
+	if (positions.size()%2!=0)
+		debug("getConstellationsAt WARNING - odd number of coordinates, the last one is ignored");
+	QVector<Vec3d> v(positions.size()/2);
+	for (int i=0;i<v.size();++i)
+		StelUtils::spheToRect(positions.at(2*i).toDouble()*M_PI/180., positions.at(2*i+1).toDouble()*M_PI/180., v[i]);
+	return GETSTELMODULE(ConstellationMgr)->getConstellationsAt(v);
+}
+
+QVariantList StelMainScriptAPI::getRiseTransitSet(const QStringList& names, const QString& startDate, double days, double altitude, bool useLandscape, double maxSunAltitude)
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	StelRiseSetCalculator::Params params;
+	if (startDate.isEmpty())
+		params.startJD = core->getJDay();
+	else
+	{
+		// Same Delta-T correction as setDate()
+		const double jd = jdFromDateString(startDate, "utc");
+		params.startJD = jd + core->getDeltaT(jd)/86400;
+	}
+	params.endJD = params.startJD + days;
+	params.altitude = altitude;
+	params.flagLandscape = useLandscape;
+	params.maxSunAltitude = maxSunAltitude;
+	return StelRiseSetCalculator(core).compute(names, params);
+}
+
 QVariantMap StelMainScriptAPI::getSelectedObjectInfo()
 {
 	StelObjectMgr* omgr = GETSTELMODULE(StelObjectMgr);
@@ -187,6 +187,39 @@ public slots:
 	//! - localized-name : localized name
 	QVariantMap getSelectedObjectInfo();
 
+	//! Find the constellation containing a position, using the IAU boundaries.
+	//! @param ra the right ascension angle (J2000 frame) in decimal degrees.
+	//! @param dec the declination angle (J2000 frame) in decimal degrees.
+	//! @return the constellation abbreviation, or an empty string if the boundaries are not loaded.
+	QString getConstellationAt(double ra, double dec);
+
+	//! Find the constellations containing a list of positions, e.g. to classify a catalog.
+	//! @param positions a flat list of J2000 coordinates in decimal degrees: ra0, dec0, ra1, dec1...
+	//! @return the constellation abbreviation of each position.
+	QStringList getConstellationsAt(const QVariantList& positions);
+
+	//! Compute the rise, transit and set times and the visibility windows of objects over a date
+	//! range, without changing the current date. The objects are computed in parallel, which is
+	//! much faster than stepping the date and polling the positions.
+	//! @param names the English names of the objects, e.g. ["Mars", "M31", "HIP 27989"].
+	//! @param startDate the start of the range in the formats accepted by setDate(), or an
+	//! empty string for the current date.
+	//! @param days the duration of the range in days.
+	//! @param altitude the threshold apparent altitude in decimal degrees.
+	//! @param useLandscape if true, the objects must also be above the horizon of the current landscape.
+	//! @param maxSunAltitude the visibility windows are limited to when the Sun is below this
+	//! altitude in decimal degrees, e.g. -18 for the astronomical night. 90 means no limit.
+	//! @return a list with a map for each object.  Keys:
+	//! - name : english name
+	//! - found : false if the object was not found
+	//! - rise, transit, set : lists of the dates of the events (ISO 8601)
+	//! - transit-altitude : list of the apparent altitudes at the transits in decimal degrees
+	//! - windows : list of maps with the "start" and "end" dates (ISO 8601) and the duration
+	//! in "hours" of the visibility windows
+	//! - circumpolar : the object stays above the threshold during the whole range
+	//! - never-rises : the object stays below the threshold during the whole range
+	QVariantList getRiseTransitSet(const QStringList& names, const QString& startDate="", double days=1., double altitude=0., bool useLandscape=false, double maxSunAltitude=90.);
+
 	//! Clear the display options, setting a "standard" view.
 	//! Preset states:
 	//! - natural : azimuthal mount, atmosphere, landscape,
@@ -317,6 +350,29 @@ public slots:
 	//! @return The current maximum frames per secon setting.
 	float getMaxFps();
 
+	//! Set the frames per second used when nothing changes in the sky
+	//! (time paused, no movement and no fading).
+	//! @param m the new idle fps setting.
+	void setIdleFps(float m);
+
+	//! Get the current idle frames per second.
+	//! @return The current idle frames per second setting.
+	float getIdleFps();
+
+	//! Start or stop the frame profiler.
+	//! @param b if true, start recording the time spent in each module.
+	void setProfilerEnabled(bool b);
+
+	//! Get the frame profiler statistics.
+	//! @return a map from section names (e.g. "draw:StarMgr") to maps with
+	//! the "last", "average" and "max" durations in milliseconds.
+	QVariantMap getProfilerReport();
+
+	//! Save the events recorded by the frame profiler in the Chrome trace JSON format.
+	//! @param filename the path of the file to write.
+	//! @return true on success.
+	bool dumpProfilerTrace(const QString& filename);
+
 	//! Get the mount mode as a string
 	//! @return "equatorial" or "azimuthal"
 	QString getMountMode();
@@ -0,0 +1,191 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QDebug>
+#include <QTest>
+#include <QFile>
+#include <cmath>
+
+#include "tests/benchmarkCore.hpp"
+#include "StelSphericalIndex.hpp"
+#include "StelJsonParser.hpp"
+#include "StelUtils.hpp"
+
+QTEST_MAIN(BenchmarkCore)
+
+// Fixed seed so that all the runs use the same inputs
+static const uint BenchmarkSeed = 20260101;
+// Level of the geodesic grid searches, as for the stars of the default catalogs
+static const int ZoneLevel = 3;
+
+static double randomDouble()
+{
+	return (double)qrand()/RAND_MAX;
+}
+
+// Return a random point uniformly distributed on the unit sphere
+static Vec3d randomDirection()
+{
+	const double z = 2.*randomDouble()-1.;
+	const double phi = 2.*M_PI*randomDouble();
+	const double r = std::sqrt(1.-z*z);
+	return Vec3d(r*std::cos(phi), r*std::sin(phi), z);
+}
+
+static QVector<Vec3d> randomQuad(double ra, double dec, double size)
+{
+	QVector<Vec3d> contour(4);
+	StelUtils::spheToRect(ra-size, dec-size, contour[0]);
+	StelUtils::spheToRect(ra+size, dec-size, contour[1]);
+	StelUtils::spheToRect(ra+size, dec+size, contour[2]);
+	StelUtils::spheToRect(ra-size, dec+size, contour[3]);
+	return contour;
+}
+
+class BenchmarkRegionObject : public StelRegionObject
+{
+	public:
+		BenchmarkRegionObject(SphericalRegionP reg) : region(reg) {;}
+		virtual SphericalRegionP getRegion() const {return region;}
+		SphericalRegionP region;
+};
+
+struct CountFuncObject
+{
+	CountFuncObject() : count(0) {;}
+	void operator()(const StelRegionObject* /* obj */)
+	{
+		count++;
+	}
+	int count;
+};
+
+void BenchmarkCore::initTestCase()
+{
+	qsrand(BenchmarkSeed);
+
+	grid = new StelGeodesicGrid(ZoneLevel);
+
+	// Viewports of about 60 degrees
+	for (int i=0;i<64;++i)
+		viewportCaps.append(SphericalCap(randomDirection(), std::cos(30.*M_PI/180.)));
+
+	// Pairs of overlapping polygons
+	for (int i=0;i<32;++i)
+	{
+		const double ra = 2.*M_PI*randomDouble();
+		const double dec = (randomDouble()-0.5)*M_PI*0.8;
+		const double size = (1.+9.*randomDouble())*M_PI/180.;
+		polygons.append(SphericalConvexPolygon(randomQuad(ra, dec, size)));
+		polygons.append(SphericalConvexPolygon(randomQuad(ra+size*0.5, dec+size*0.5, size)));
+	}
+}
+
+void BenchmarkCore::cleanupTestCase()
+{
+	delete grid;
+	grid = NULL;
+}
+
+void BenchmarkCore::benchmarkGeodesicSearch()
+{
+	QVector<QVector<SphericalCap> > convexes;
+	foreach (const SphericalCap& cap, viewportCaps)
+		convexes.append(QVector<SphericalCap>() << cap);
+	int nbZones = 0;
+	QBENCHMARK
+	{
+		nbZones = 0;
+		// Successive searches use different regions so that the result cache is not hit
+		foreach (const QVector<SphericalCap>& convex, convexes)
+		{
+			const GeodesicSearchResult* result = grid->search(convex, ZoneLevel);
+			for (int level=0;level<=ZoneLevel;++level)
+			{
+				GeodesicSearchInsideIterator it1(*result, level);
+				while (it1.next()>=0)
+					++nbZones;
+				GeodesicSearchBorderIterator it2(*result, level);
+				while (it2.next()>=0)
+					++nbZones;
+			}
+		}
+	}
+	QVERIFY(nbZones>0);
+}
+
+void BenchmarkCore::benchmarkOctahedronBooleanOps()
+{
+	int nbNonEmpty = 0;
+	QBENCHMARK
+	{
+		nbNonEmpty = 0;
+		for (int i=0;i<polygons.size();i+=2)
+		{
+			const SphericalConvexPolygon& p1 = polygons.at(i);
+			const SphericalConvexPolygon& p2 = polygons.at(i+1);
+			if (!p1.getIntersection(p2)->isEmpty())
+				++nbNonEmpty;
+			if (!p1.getUnion(p2)->isEmpty())
+				++nbNonEmpty;
+			if (!p1.getSubtraction(p2)->isEmpty())
+				++nbNonEmpty;
+		}
+	}
+	QVERIFY(nbNonEmpty>0);
+}
+
+void BenchmarkCore::benchmarkSphericalIndexQuery()
+{
+	StelSphericalIndex index;
+	for (int i=0;i<5000;++i)
+		index.insert(StelRegionObjectP(new BenchmarkRegionObject(SphericalRegionP(new SphericalCap(randomDirection(), std::cos((0.1+randomDouble())*M_PI/180.))))));
+	QVector<SphericalRegionP> queries;
+	foreach (const SphericalCap& cap, viewportCaps)
+		queries.append(SphericalRegionP(new SphericalCap(cap)));
+	CountFuncObject countFunc;
+	QBENCHMARK
+	{
+		countFunc.count = 0;
+		foreach (const SphericalRegionP& region, queries)
+			index.processIntersectingRegions(region.data(), countFunc);
+	}
+	QVERIFY(countFunc.count>0);
+}
+
+void BenchmarkCore::benchmarkJsonParse_data()
+{
+	QTest::addColumn<QString>("fileName");
+	QTest::newRow("nebulae textures") << QFINDTESTDATA("../../nebulae/default/textures.json");
+	QTest::newRow("stars config") << QFINDTESTDATA("../../stars/default/defaultStarsConfig.json");
+}
+
+void BenchmarkCore::benchmarkJsonParse()
+{
+	QFETCH(QString, fileName);
+	QFile file(fileName);
+	QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(QString("cannot open %1").arg(fileName)));
+	const QByteArray content = file.readAll();
+	QVariant result;
+	QBENCHMARK
+	{
+		result = StelJsonParser::parse(content);
+	}
+	QVERIFY(result.isValid());
+}
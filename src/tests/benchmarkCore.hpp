@@ -0,0 +1,51 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _BENCHMARKCORE_HPP_
+#define _BENCHMARKCORE_HPP_
+
+#include <QObject>
+#include <QTest>
+#include <QVector>
+#include <QByteArray>
+
+#include "StelSphereGeometry.hpp"
+#include "StelGeodesicGrid.hpp"
+
+//! Benchmarks of the core geometry hot paths and of the JSON parser.
+//! All the inputs are generated from a fixed seed so that the numbers of two runs can be compared.
+class BenchmarkCore : public QObject
+{
+Q_OBJECT
+private slots:
+	void initTestCase();
+	void cleanupTestCase();
+	void benchmarkGeodesicSearch();
+	void benchmarkOctahedronBooleanOps();
+	void benchmarkSphericalIndexQuery();
+	void benchmarkJsonParse_data();
+	void benchmarkJsonParse();
+private:
+	StelGeodesicGrid* grid;
+	//! Seeded viewports used for the search benchmarks.
+	QVector<SphericalCap> viewportCaps;
+	QVector<SphericalConvexPolygon> polygons;
+};
+
+#endif // _BENCHMARKCORE_HPP_
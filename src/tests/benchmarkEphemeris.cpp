@@ -0,0 +1,171 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QDebug>
+#include <QTest>
+#include <QFile>
+#include <QRegularExpression>
+#include <cmath>
+
+#include "tests/benchmarkEphemeris.hpp"
+#include "vsop87.h"
+#include "elp82b.h"
+#include "gsatellite/gSatTEME.hpp"
+#include "Orbit.hpp"
+
+QTEST_MAIN(BenchmarkEphemeris)
+
+// Fixed seed so that all the runs use the same inputs
+static const uint BenchmarkSeed = 20260101;
+static const double J2000 = 2451545.0;
+
+void BenchmarkEphemeris::initTestCase()
+{
+	qsrand(BenchmarkSeed);
+
+	// Dates spread over a century, far enough apart to defeat the interpolation caches
+	for (int i=0;i<1000;++i)
+		dates.append(J2000 + ((double)qrand()/RAND_MAX-0.5)*36525.);
+
+	// The satellites catalog is not strict JSON (unquoted dates), so only extract the TLE lines
+	QFile file(QFINDTESTDATA("../../data/satellites.json"));
+	QVERIFY2(file.open(QIODevice::ReadOnly | QIODevice::Text), "cannot open data/satellites.json");
+	const QString content = QString::fromUtf8(file.readAll());
+	QRegularExpression tleRx("\"tle1\"\\s*:\\s*\"([^\"]+)\"\\s*,\\s*\"tle2\"\\s*:\\s*\"([^\"]+)\"");
+	QRegularExpressionMatchIterator it = tleRx.globalMatch(content);
+	while (it.hasNext())
+	{
+		const QRegularExpressionMatch m = it.next();
+		QByteArray tle1 = m.captured(1).toLatin1();
+		QByteArray tle2 = m.captured(2).toLatin1();
+		satellites.append(new gSatTEME("benchmark", tle1.data(), tle2.data()));
+	}
+	QVERIFY(!satellites.isEmpty());
+
+}
+
+void BenchmarkEphemeris::cleanupTestCase()
+{
+	qDeleteAll(satellites);
+	satellites.clear();
+}
+
+void BenchmarkEphemeris::benchmarkVsop87()
+{
+	double xyz[6];
+	double sum = 0.;
+	QBENCHMARK
+	{
+		foreach (double jd, dates)
+		{
+			for (int body=VSOP87_MERCURY;body<=VSOP87_NEPTUNE;++body)
+			{
+				GetVsop87Coor(jd, body, xyz);
+				sum += xyz[0];
+			}
+		}
+	}
+	QVERIFY(sum==sum);
+}
+
+void BenchmarkEphemeris::benchmarkElp82b()
+{
+	double xyz[3];
+	double sum = 0.;
+	QBENCHMARK
+	{
+		foreach (double jd, dates)
+		{
+			GetElp82bCoor(jd, xyz);
+			sum += xyz[0];
+		}
+	}
+	QVERIFY(sum==sum);
+}
+
+void BenchmarkEphemeris::benchmarkSgp4()
+{
+	// Propagate each satellite over one day around its catalog epoch
+	static const double epoch = 2455800.5;
+	double sum = 0.;
+	QBENCHMARK
+	{
+		foreach (gSatTEME* sat, satellites)
+		{
+			for (int i=0;i<24;++i)
+			{
+				sat->setEpoch(epoch+i/24.);
+				sum += sat->getPos()[0];
+			}
+		}
+	}
+	QVERIFY(sum==sum);
+}
+
+// Eccentricities covering the low, medium and high eccentricity solvers of EllipticalOrbit
+static const double KeplerEccentricities[] = {0.05, 0.25, 0.6, 0.95};
+
+void BenchmarkEphemeris::benchmarkKeplerScalar()
+{
+	double xyz[3];
+	double sum = 0.;
+	QBENCHMARK
+	{
+		for (int k=0;k<4;++k)
+		{
+			const EllipticalOrbit orbit(1.5, KeplerEccentricities[k], 0.3, 1.2, 0.7, 0.1, 1200., J2000, 0., 0., 0.);
+			foreach (double jd, dates)
+			{
+				orbit.positionAtTimevInVSOP87Coordinates(jd, xyz);
+				sum += xyz[0];
+			}
+		}
+	}
+	QVERIFY(sum==sum);
+}
+
+void BenchmarkEphemeris::benchmarkKeplerBatch()
+{
+	QVector<double> xyz(3*dates.size());
+	double sum = 0.;
+	QBENCHMARK
+	{
+		for (int k=0;k<4;++k)
+		{
+			const EllipticalOrbit orbit(1.5, KeplerEccentricities[k], 0.3, 1.2, 0.7, 0.1, 1200., J2000, 0., 0., 0.);
+			orbit.positionsAtTimesInVSOP87Coordinates(dates.constData(), xyz.data(), dates.size());
+			sum += xyz[0];
+		}
+	}
+	QVERIFY(sum==sum);
+
+	// The batch solver must agree with the scalar one
+	for (int k=0;k<4;++k)
+	{
+		const EllipticalOrbit orbit(1.5, KeplerEccentricities[k], 0.3, 1.2, 0.7, 0.1, 1200., J2000, 0., 0., 0.);
+		orbit.positionsAtTimesInVSOP87Coordinates(dates.constData(), xyz.data(), dates.size());
+		for (int i=0;i<dates.size();++i)
+		{
+			double ref[3];
+			orbit.positionAtTimevInVSOP87Coordinates(dates.at(i), ref);
+			QVERIFY2(std::fabs(ref[0]-xyz[3*i])<1e-6 && std::fabs(ref[1]-xyz[3*i+1])<1e-6 && std::fabs(ref[2]-xyz[3*i+2])<1e-6,
+				 qPrintable(QString("e=%1 jd=%2").arg(KeplerEccentricities[k]).arg(dates.at(i), 0, 'f', 5)));
+		}
+	}
+}
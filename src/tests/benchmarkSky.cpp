@@ -0,0 +1,309 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QDebug>
+#include <QTest>
+#include <QFile>
+#include <QSettings>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <cmath>
+
+#include "tests/benchmarkSky.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelFileMgr.hpp"
+#include "StelIniParser.hpp"
+#include "StelMovementMgr.hpp"
+#include "StelPainter.hpp"
+#include "StelProjector.hpp"
+#include "StelProjectorClasses.hpp"
+#include "StelSkyDrawer.hpp"
+#include "StelGeodesicGrid.hpp"
+#include "ZoneArray.hpp"
+#include "Atmosphere.hpp"
+
+QTEST_MAIN(BenchmarkSky)
+
+// Fixed seed so that all the runs use the same inputs
+static const uint BenchmarkSeed = 20260101;
+static const int ViewportWidth = 1024;
+static const int ViewportHeight = 768;
+// Level, magnitudes and number of stars per zone of the synthetic Star3 catalog. The magnitudes
+// are those of the stars_1 catalog so that the stars are visible in the default field of view.
+static const int SyntheticLevel = 3;
+static const int SyntheticMagMin = 6000;
+static const int SyntheticMagRange = 1500;
+static const int SyntheticMagSteps = 32;
+static const int StarsPerZone = 200;
+
+static double randomDouble()
+{
+	return (double)qrand()/RAND_MAX;
+}
+
+// Write a catalog of Star3 in the uncompressed format, with the stars of each zone sorted by magnitude
+static bool writeSyntheticCatalog(const QString& fileName)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	const int nbZones = StelGeodesicGrid::nrOfZones(SyntheticLevel);
+	const unsigned int header[8] = {FILE_MAGIC, 2, 0, 0, SyntheticLevel, SyntheticMagMin, SyntheticMagRange, SyntheticMagSteps};
+	QVector<unsigned int> zoneSizes(nbZones, StarsPerZone);
+	QVector<Star3> stars(nbZones*StarsPerZone);
+	for (int i=0;i<stars.size();++i)
+	{
+		Star3& s = stars[i];
+		s.x0 = (int)((2.*randomDouble()-1.)*Star3::MaxPosVal);
+		s.x1 = (int)((2.*randomDouble()-1.)*Star3::MaxPosVal);
+		s.bV = qrand()%128;
+		s.mag = (i%StarsPerZone)*SyntheticMagSteps/StarsPerZone;
+	}
+	return file.write((const char*)header, sizeof(header))==(qint64)sizeof(header)
+		&& file.write((const char*)zoneSizes.constData(), sizeof(unsigned int)*nbZones)==(qint64)(sizeof(unsigned int)*nbZones)
+		&& file.write((const char*)stars.constData(), sizeof(Star3)*stars.size())==(qint64)(sizeof(Star3)*stars.size());
+}
+
+static void initZoneTriangle(int lev, int index, const Vec3f& c0, const Vec3f& c1, const Vec3f& c2, void* context)
+{
+	ZoneArray* z = static_cast<ZoneArray*>(context);
+	if (lev==z->level)
+		z->initTriangle(index, c0, c1, c2);
+}
+
+// Load a catalog the same way as StarMgr::loadCatalog() does
+static ZoneArray* loadZoneArray(const QString& fileName, int zoneCacheSizeMB)
+{
+	ZoneArray* z = ZoneArray::create(fileName, true, zoneCacheSizeMB);
+	if (!z)
+		return NULL;
+	StelApp::getInstance().getCore()->getGeodesicGrid(z->level)->visitTriangles(z->level, initZoneTriangle, z);
+	z->scaleAxis();
+	return z;
+}
+
+// A stereographic projector of the alt-azimuthal frame looking at the horizon, which can be
+// created without StelCore
+class AltAzProjector : public StelProjectorStereographic
+{
+public:
+	AltAzProjector(const Mat4d& modelView, const StelProjectorParams& params)
+		: StelProjectorStereographic(ModelViewTranformP(new StelProjector::Mat4dTransform(modelView)))
+	{
+		init(params);
+	}
+};
+
+static StelProjectorP createAltAzProjector()
+{
+	// Same model view matrix as StelCore::lookAtJ2000()
+	Vec3d f(1., 0., 0.3);
+	f.normalize();
+	Vec3d s(f^Vec3d(0., 0., 1.));
+	s.normalize();
+	Vec3d u(s^f);
+	u.normalize();
+	const Mat4d modelView(s[0], u[0], -f[0], 0.,
+			      s[1], u[1], -f[1], 0.,
+			      s[2], u[2], -f[2], 0.,
+			      0., 0., 0., 1.);
+	StelProjector::StelProjectorParams params;
+	params.viewportXywh.set(0, 0, ViewportWidth, ViewportHeight);
+	params.viewportCenter.set(0.5f*ViewportWidth, 0.5f*ViewportHeight);
+	params.viewportFovDiameter = qMin(ViewportWidth, ViewportHeight);
+	params.fov = 60.f;
+	params.zNear = 0.000001f;
+	params.zFar = 50.f;
+	return StelProjectorP(new AltAzProjector(modelView, params));
+}
+
+void BenchmarkSky::initTestCase()
+{
+	qsrand(BenchmarkSeed);
+	fbo = NULL;
+	conf = NULL;
+	stelApp = NULL;
+
+	for (int i=0;i<32;++i)
+	{
+		const double z = 2.*randomDouble()-1.;
+		const double phi = 2.*M_PI*randomDouble();
+		const double r = std::sqrt(1.-z*z);
+		viewDirections.append(Vec3d(r*std::cos(phi), r*std::sin(phi), z));
+	}
+
+	// Without openGL only the benchmarks which don't draw are run
+	surface = new QOffscreenSurface();
+	surface->create();
+	context = new QOpenGLContext();
+	if (!context->create() || !context->makeCurrent(surface))
+	{
+		qWarning() << "Cannot create an OpenGL context: the drawing benchmarks are skipped";
+		delete context;
+		context = NULL;
+		return;
+	}
+	fbo = new QOpenGLFramebufferObject(ViewportWidth, ViewportHeight, QOpenGLFramebufferObject::CombinedDepthStencil);
+	fbo->bind();
+
+	// Use a copy of the default configuration so that the user one is left untouched
+	StelFileMgr::init();
+	QVERIFY(tempDir.isValid());
+	const QString configFile = tempDir.path()+"/config.ini";
+	QVERIFY(QFile::copy(QFINDTESTDATA("../../data/default_config.ini"), configFile));
+	QFile::setPermissions(configFile, QFile::ReadOwner | QFile::WriteOwner);
+	conf = new QSettings(configFile, StelIniFormat);
+
+	StelApp::initStatic();
+	stelApp = new StelApp();
+	stelApp->init(conf);
+	StelPainter::setFlagGpuProjection(conf->value("video/flag_gpu_projection", true).toBool());
+	StelPainter::initGLShaders();
+	stelApp->glWindowHasBeenResized(0, 0, ViewportWidth, ViewportHeight);
+	stelApp->update(0.);
+
+	// The shipped catalog of Hipparcos stars with the most zones
+	ZoneArray* zoneArray = loadZoneArray(StelFileMgr::findFile("stars/default/stars_1_0v0_3.cat"), 16);
+	QVERIFY(zoneArray);
+	zoneArrays.append(zoneArray);
+	// The catalogs of Star2 and Star3 are not shipped: use a synthetic one, uncompressed and compressed
+	const QString syntheticFile = tempDir.path()+"/stars_3_2v0_0.cat";
+	const QString compressedFile = tempDir.path()+"/stars_3_2v1_0.cat";
+	QVERIFY(writeSyntheticCatalog(syntheticFile));
+	QVERIFY(ZoneArray::compressCatalog(syntheticFile, compressedFile));
+	zoneArray = loadZoneArray(syntheticFile, 16);
+	QVERIFY(zoneArray);
+	zoneArrays.append(zoneArray);
+	zoneArray = loadZoneArray(compressedFile, 16);
+	QVERIFY(zoneArray);
+	zoneArrays.append(zoneArray);
+	// A cache smaller than the catalog so that the zones are decompressed again when the view moves
+	zoneArray = loadZoneArray(compressedFile, 1);
+	QVERIFY(zoneArray);
+	zoneArrays.append(zoneArray);
+}
+
+void BenchmarkSky::cleanupTestCase()
+{
+	qDeleteAll(zoneArrays);
+	zoneArrays.clear();
+	if (stelApp)
+	{
+		delete stelApp;
+		stelApp = NULL;
+		StelApp::deinitStatic();
+	}
+	delete conf;
+	conf = NULL;
+	delete fbo;
+	fbo = NULL;
+	if (context)
+		context->doneCurrent();
+	delete context;
+	context = NULL;
+	delete surface;
+	surface = NULL;
+}
+
+void BenchmarkSky::benchmarkZoneDraw_data()
+{
+	QTest::addColumn<int>("catalog");
+	QTest::newRow("Hipparcos stars") << 0;
+	QTest::newRow("Star3") << 1;
+	QTest::newRow("compressed Star3") << 2;
+	QTest::newRow("compressed Star3, small cache") << 3;
+}
+
+void BenchmarkSky::benchmarkZoneDraw()
+{
+	if (!stelApp)
+		QSKIP("The zones are drawn with openGL");
+	QFETCH(int, catalog);
+	const ZoneArray* z = zoneArrays.at(catalog);
+	StelCore* core = stelApp->getCore();
+	StelSkyDrawer* skyDrawer = core->getSkyDrawer();
+
+	// Same magnitude table as StarMgr::draw()
+	RCMag rcmagTable[RCMAG_TABLE_SIZE];
+	int limitMagIndex = RCMAG_TABLE_SIZE;
+	const float magMin = 0.001f*z->mag_min;
+	const float k = (0.001f*z->mag_range)/z->mag_steps;
+	for (int i=0;i<RCMAG_TABLE_SIZE;++i)
+	{
+		if (!skyDrawer->computeRCMag(magMin+k*i, &rcmagTable[i]))
+		{
+			limitMagIndex = i-1;
+			for (;i<RCMAG_TABLE_SIZE;++i)
+			{
+				rcmagTable[i].luminance = 0;
+				rcmagTable[i].radius = 0;
+			}
+			break;
+		}
+	}
+	QVERIFY(limitMagIndex>0);
+
+	int nbZones = 0;
+	QBENCHMARK
+	{
+		nbZones = 0;
+		foreach (const Vec3d& dir, viewDirections)
+		{
+			core->getMovementMgr()->setViewDirectionJ2000(dir);
+			const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
+			QVector<SphericalCap> viewportCaps = prj->getViewportConvexPolygon()->getBoundingSphericalCaps();
+			viewportCaps.append(core->getVisibleSkyArea());
+			const GeodesicSearchResult* result = core->getGeodesicGrid(z->level)->search(viewportCaps, z->level);
+			StelPainter sPainter(prj);
+			skyDrawer->preDrawPointSource(&sPainter);
+			int zone;
+			for (GeodesicSearchInsideIterator it(*result, z->level);(zone = it.next()) >= 0;++nbZones)
+				z->draw(&sPainter, zone, true, rcmagTable, limitMagIndex, core, 0, 0.f, viewportCaps);
+			for (GeodesicSearchBorderIterator it(*result, z->level);(zone = it.next()) >= 0;++nbZones)
+				z->draw(&sPainter, zone, false, rcmagTable, limitMagIndex, core, 0, 0.f, viewportCaps);
+			skyDrawer->postDrawPointSource(&sPainter);
+		}
+	}
+	QVERIFY(nbZones>0);
+}
+
+void BenchmarkSky::benchmarkAtmosphereComputeColor()
+{
+	// Only the grid computed on the CPU is measured, its upload in the openGL buffers is done when drawing
+	const StelProjectorP prj = createAltAzProjector();
+	Atmosphere atmosphere;
+	atmosphere.setFlagShow(true);
+	atmosphere.update(10.);
+	// A low Sun and a bright Moon in the alt-azimuthal frame, in AU
+	const double JD = 2451545.;
+	Vec3d sunPos(0.8, 0., -0.1);
+	sunPos.normalize();
+	Vec3d moonPos(-0.5, 0.5, 0.6);
+	moonPos.normalize();
+	moonPos *= 0.00257;
+	// The first call allocates the grid for the viewport
+	atmosphere.computeColor(JD, sunPos, moonPos, 0.8f, prj, 44);
+	QBENCHMARK
+	{
+		atmosphere.computeColor(JD, sunPos, moonPos, 0.8f, prj, 44);
+	}
+	QVERIFY(atmosphere.getAverageLuminance()>0.f);
+}
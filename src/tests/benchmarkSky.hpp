@@ -0,0 +1,66 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _BENCHMARKSKY_HPP_
+#define _BENCHMARKSKY_HPP_
+
+#include <QObject>
+#include <QTest>
+#include <QList>
+#include <QTemporaryDir>
+#include <QVector>
+
+#include "VecMath.hpp"
+
+class StelApp;
+class ZoneArray;
+class QOffscreenSurface;
+class QOpenGLContext;
+class QOpenGLFramebufferObject;
+class QSettings;
+
+//! Benchmarks of the star zones drawing and of the atmosphere color computation.
+//! They run the real SpecialZoneArray, CompressedZoneArray and Atmosphere code. The zones are drawn
+//! by a StelApp initialized from the default configuration in an offscreen framebuffer, and are
+//! skipped when no openGL context can be created. The atmosphere grid is computed without openGL.
+//! All the inputs are generated from a fixed seed so that the numbers of two runs can be compared.
+class BenchmarkSky : public QObject
+{
+Q_OBJECT
+private slots:
+	void initTestCase();
+	void cleanupTestCase();
+	void benchmarkZoneDraw_data();
+	void benchmarkZoneDraw();
+	void benchmarkAtmosphereComputeColor();
+private:
+	QOffscreenSurface* surface;
+	QOpenGLContext* context;
+	QOpenGLFramebufferObject* fbo;
+	//! Directory of the configuration and of the synthetic catalogs.
+	QTemporaryDir tempDir;
+	QSettings* conf;
+	StelApp* stelApp;
+	//! The catalogs drawn by benchmarkZoneDraw, as loaded by StarMgr.
+	QList<ZoneArray*> zoneArrays;
+	//! Seeded view directions used for the drawing benchmarks.
+	QVector<Vec3d> viewDirections;
+};
+
+#endif // _BENCHMARKSKY_HPP_
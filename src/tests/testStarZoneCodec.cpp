@@ -0,0 +1,118 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testStarZoneCodec.hpp"
+#include "StarZoneCodec.hpp"
+
+#include <QVector>
+
+#include <cstdlib>
+
+QTEST_MAIN(TestStarZoneCodec)
+
+// Fill a zone with random stars sorted by magnitude, including the extreme coordinates.
+static QVector<Star2> makeStars2(int count)
+{
+	srand(42);
+	QVector<Star2> stars(count);
+	for (int i=0;i<count;++i)
+	{
+		Star2& s = stars[i];
+		s.x0 = (i==0) ? -Star2::MaxPosVal : rand()%(2*Star2::MaxPosVal+1)-Star2::MaxPosVal;
+		s.x1 = (i==1) ? Star2::MaxPosVal : rand()%(2*Star2::MaxPosVal+1)-Star2::MaxPosVal;
+		s.dx0 = rand()%16384-8192;
+		s.dx1 = rand()%16384-8192;
+		s.bV = rand()%128;
+		s.mag = i*32/count;
+	}
+	return stars;
+}
+
+static QVector<Star3> makeStars3(int count)
+{
+	srand(42);
+	QVector<Star3> stars(count);
+	for (int i=0;i<count;++i)
+	{
+		Star3& s = stars[i];
+		s.x0 = (i==0) ? Star3::MaxPosVal : rand()%(2*Star3::MaxPosVal+1)-Star3::MaxPosVal;
+		s.x1 = (i==1) ? -Star3::MaxPosVal : rand()%(2*Star3::MaxPosVal+1)-Star3::MaxPosVal;
+		s.bV = rand()%128;
+		s.mag = i*32/count;
+	}
+	return stars;
+}
+
+void TestStarZoneCodec::testRoundTripStar2()
+{
+	QVector<Star2> stars = makeStars2(5000);
+	StarZoneCodec::sort(stars.data(), stars.size());
+	for (int i=1;i<stars.size();++i)
+		QVERIFY(stars.at(i-1).mag<=stars.at(i).mag);
+
+	const QByteArray block = StarZoneCodec::encode(stars.constData(), stars.size());
+	QVERIFY(block.size()<stars.size()*(int)sizeof(Star2));
+	QVector<Star2> decoded(stars.size());
+	QVERIFY(StarZoneCodec::decode(block.constData(), block.size(), decoded.data(), decoded.size()));
+	for (int i=0;i<stars.size();++i)
+	{
+		const Star2& a = stars.at(i);
+		const Star2& b = decoded.at(i);
+		QVERIFY(a.x0==b.x0 && a.x1==b.x1 && a.dx0==b.dx0 && a.dx1==b.dx1 && a.bV==b.bV && a.mag==b.mag);
+	}
+}
+
+void TestStarZoneCodec::testRoundTripStar3()
+{
+	QVector<Star3> stars = makeStars3(5000);
+	StarZoneCodec::sort(stars.data(), stars.size());
+
+	const QByteArray block = StarZoneCodec::encode(stars.constData(), stars.size());
+	QVERIFY(block.size()<stars.size()*(int)sizeof(Star3));
+	QVector<Star3> decoded(stars.size());
+	QVERIFY(StarZoneCodec::decode(block.constData(), block.size(), decoded.data(), decoded.size()));
+	for (int i=0;i<stars.size();++i)
+	{
+		const Star3& a = stars.at(i);
+		const Star3& b = decoded.at(i);
+		QVERIFY(a.x0==b.x0 && a.x1==b.x1 && a.bV==b.bV && a.mag==b.mag);
+	}
+}
+
+void TestStarZoneCodec::testEmptyZone()
+{
+	const QByteArray block = StarZoneCodec::encode((const Star3*)NULL, 0);
+	QVERIFY(block.isEmpty());
+	QVERIFY(StarZoneCodec::decode(block.constData(), 0, (Star3*)NULL, 0));
+}
+
+void TestStarZoneCodec::testCorruptedBlock()
+{
+	QVector<Star2> stars = makeStars2(100);
+	const QByteArray block = StarZoneCodec::encode(stars.constData(), stars.size());
+	QVector<Star2> decoded(stars.size());
+	// Truncated block
+	QVERIFY(!StarZoneCodec::decode(block.constData(), block.size()-4, decoded.data(), decoded.size()));
+	// Wrong number of stars
+	QVERIFY(!StarZoneCodec::decode(block.constData(), block.size(), decoded.data(), decoded.size()-1));
+	// Altered data
+	QByteArray altered = block;
+	altered[block.size()/2] = altered.at(block.size()/2)^0x55;
+	QVERIFY(!StarZoneCodec::decode(altered.constData(), altered.size(), decoded.data(), decoded.size()));
+}
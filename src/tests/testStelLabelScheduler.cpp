@@ -0,0 +1,101 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testStelLabelScheduler.hpp"
+#include "StelLabelScheduler.hpp"
+
+#include <QFont>
+#include <QFontMetrics>
+
+QTEST_MAIN(TestStelLabelScheduler)
+
+static const Vec4i Viewport(0, 0, 800, 600);
+static const Vec4f White(1.f, 1.f, 1.f, 1.f);
+
+// Schedule the labels submitted since the last flush, as flush() does with a painter
+static QStringList schedule(StelLabelScheduler& scheduler)
+{
+	QStringList res;
+	foreach (const StelLabelScheduler::Label& l, scheduler.schedule(QFontMetrics(QFont()), false, 0.f))
+		res << l.text;
+	return res;
+}
+
+void TestStelLabelScheduler::testPriorityOrder()
+{
+	StelLabelScheduler scheduler;
+	scheduler.beginFrame(Viewport);
+	scheduler.addLabel(100.f, 100.f, "faint star", White, -6.f);
+	scheduler.addLabel(102.f, 101.f, "bright star", White, -1.f);
+	scheduler.addLabel(400.f, 300.f, "far star", White, -6.f);
+	QCOMPARE(schedule(scheduler), QStringList() << "bright star" << "far star");
+	QCOMPARE(scheduler.getNbDrawnLabels(), 2);
+	QCOMPARE(scheduler.getNbRejectedLabels(), 1);
+}
+
+void TestStelLabelScheduler::testSamePriority()
+{
+	StelLabelScheduler scheduler;
+	scheduler.beginFrame(Viewport);
+	scheduler.addLabel(100.f, 100.f, "first", White, -3.f);
+	QCOMPARE(schedule(scheduler), QStringList() << "first");
+	// A label of the same priority flushed later does not overlap the first one
+	scheduler.addLabel(101.f, 100.f, "second", White, -3.f);
+	QVERIFY(schedule(scheduler).isEmpty());
+}
+
+void TestStelLabelScheduler::testHigherPriorityFlushedLater()
+{
+	// A star label is flushed before an overlapping planet label, as the modules are drawn
+	StelLabelScheduler scheduler;
+	scheduler.beginFrame(Viewport);
+	scheduler.addLabel(100.f, 100.f, "star", White, -2.f);
+	QCOMPARE(schedule(scheduler), QStringList() << "star");
+	scheduler.addLabel(104.f, 102.f, "planet", White, 4.f);
+	QCOMPARE(schedule(scheduler), QStringList() << "planet");
+
+	// From the next frame the planet keeps its place and the star gives way
+	for (int frame=0;frame<3;++frame)
+	{
+		scheduler.beginFrame(Viewport);
+		scheduler.addLabel(100.f, 100.f, "star", White, -2.f);
+		QVERIFY(schedule(scheduler).isEmpty());
+		scheduler.addLabel(104.f, 102.f, "planet", White, 4.f);
+		QCOMPARE(schedule(scheduler), QStringList() << "planet");
+		QCOMPARE(scheduler.getNbDrawnLabels(), 1);
+		QCOMPARE(scheduler.getNbRejectedLabels(), 1);
+	}
+
+	// The star comes back when the planet is gone
+	scheduler.beginFrame(Viewport);
+	scheduler.beginFrame(Viewport);
+	scheduler.addLabel(100.f, 100.f, "star", White, -2.f);
+	QCOMPARE(schedule(scheduler), QStringList() << "star");
+}
+
+void TestStelLabelScheduler::testDisabled()
+{
+	StelLabelScheduler scheduler;
+	scheduler.setEnabled(false);
+	scheduler.beginFrame(Viewport);
+	scheduler.addLabel(100.f, 100.f, "first", White, -3.f);
+	scheduler.addLabel(100.f, 100.f, "second", White, -3.f);
+	QCOMPARE(schedule(scheduler).size(), 2);
+	QCOMPARE(scheduler.getNbRejectedLabels(), 0);
+}
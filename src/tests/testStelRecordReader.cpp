@@ -0,0 +1,140 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "tests/testStelRecordReader.hpp"
+#include "StelRecordReader.hpp"
+
+#include <QTemporaryFile>
+
+#include <cstring>
+
+QTEST_MAIN(TestStelRecordReader)
+
+// Write the content to a temporary file and return its path.
+static QString writeTemporaryFile(QTemporaryFile& file, const QByteArray& content)
+{
+	file.open();
+	file.write(content);
+	file.close();
+	return file.fileName();
+}
+
+void TestStelRecordReader::testLines()
+{
+	QTemporaryFile file;
+	StelRecordReader reader(writeTemporaryFile(file, "\xef\xbb\xbf# comment\r\n   \n677|_(\"Alpheratz\")\r\n\nlast"));
+	QVERIFY(reader.isOpen());
+	StelRecordReader::Field line;
+	QVERIFY(reader.readLine(line));
+	QVERIFY(StelRecordReader::isComment(line));
+	QCOMPARE(line.toString(), QString("# comment"));
+	QVERIFY(reader.readLine(line));
+	QVERIFY(StelRecordReader::isComment(line));
+	QVERIFY(reader.readLine(line));
+	QVERIFY(!StelRecordReader::isComment(line));
+	QCOMPARE(line.toString(), QString("677|_(\"Alpheratz\")"));
+	QCOMPARE(reader.getLineNumber(), 3);
+	QVERIFY(reader.readLine(line));
+	QVERIFY(line.isEmpty());
+	QVERIFY(reader.readLine(line));
+	QCOMPARE(line.toString(), QString("last"));
+	QCOMPARE(reader.getLineNumber(), 5);
+	QVERIFY(!reader.readLine(line));
+}
+
+void TestStelRecordReader::testFields()
+{
+	const QByteArray data("  And\t\"Andromeda\"\t_(\"Andromeda\")  ");
+	StelRecordReader::Field record(data.constData(), data.constData()+data.size());
+	QCOMPARE(record.trimmed().size(), data.trimmed().size());
+	QCOMPARE(record.count('"'), 4);
+	QCOMPARE(record.indexOf('|'), -1);
+
+	StelRecordReader::Field rest = record;
+	QCOMPARE(rest.takeWord().toString(), QString("And"));
+	const StelRecordReader::Field names = rest.trimmed();
+	const int englishPos = names.lastIndexOf("_(\"");
+	QCOMPARE(englishPos, 12);
+	bool ok;
+	QCOMPARE(names.mid(0, englishPos).trimmed().unwrapped("\"", "\"", &ok).toString(), QString("Andromeda"));
+	QVERIFY(ok);
+	QCOMPARE(names.mid(englishPos).unwrapped("_(\"", "\")", &ok).toString(), QString("Andromeda"));
+	QVERIFY(ok);
+	QCOMPARE(names.unwrapped("[", "]", &ok).toString(), names.toString());
+	QVERIFY(!ok);
+	// The prefix and suffix must not overlap
+	const QByteArray quote("\"");
+	StelRecordReader::Field(quote.constData(), quote.constData()+1).unwrapped("\"", "\"", &ok);
+	QVERIFY(!ok);
+
+	const QByteArray gcvs("123\tV Cas\t\t7.5");
+	rest = StelRecordReader::Field(gcvs.constData(), gcvs.constData()+gcvs.size());
+	QCOMPARE(rest.takeUntil('\t').toString(), QString("123"));
+	QCOMPARE(rest.takeUntil('\t').toString(), QString("V Cas"));
+	QVERIFY(rest.takeUntil('\t').isEmpty());
+	QCOMPARE(rest.takeUntil('\t').toString(), QString("7.5"));
+	QVERIFY(rest.isEmpty());
+	QVERIFY(rest.takeUntil('\t').isEmpty());
+}
+
+void TestStelRecordReader::testNumbers()
+{
+	const char* values[] = {" 677 ", "-42", "+7", "4294967295", "4294967296", "2147483648", "12a", "", "-"};
+	const int ints[] = {677, -42, 7, 0, 0, 0, 0, 0, 0};
+	const bool intsOk[] = {true, true, true, false, false, false, false, false, false};
+	const unsigned int uints[] = {677, 0, 7, 4294967295u, 0, 2147483648u, 0, 0, 0};
+	const bool uintsOk[] = {true, false, true, true, false, true, false, false, false};
+	for (unsigned int i=0;i<sizeof(ints)/sizeof(ints[0]);++i)
+	{
+		const StelRecordReader::Field f(values[i], values[i]+strlen(values[i]));
+		bool ok;
+		QCOMPARE(f.toInt(&ok), ints[i]);
+		QCOMPARE(ok, intsOk[i]);
+		QCOMPARE(f.toUInt(&ok), uints[i]);
+		QCOMPARE(ok, uintsOk[i]);
+	}
+	const char* d = " 2451545.25\t";
+	bool ok;
+	QCOMPARE(StelRecordReader::Field(d, d+strlen(d)).toDouble(&ok), 2451545.25);
+	QVERIFY(ok);
+	const char* bad = "1.5x";
+	StelRecordReader::Field(bad, bad+strlen(bad)).toDouble(&ok);
+	QVERIFY(!ok);
+}
+
+void TestStelRecordReader::testColumns()
+{
+	// The columns of the NGC names file are counted in characters
+	const QByteArray data = QString::fromUtf8("_(\"\xce\xb7 Car nebula\")  I  59").toUtf8();
+	const StelRecordReader::Field record(data.constData(), data.constData()+data.size());
+	QCOMPARE(record.columns(0, 17).toString(), QString::fromUtf8("_(\"\xce\xb7 Car nebula\")"));
+	QCOMPARE(record.columns(19, 1).toString(), QString("I"));
+	QCOMPARE(record.columns(20).toInt(), 59);
+	QVERIFY(record.columns(40, 4).isEmpty());
+	QCOMPARE(record.mid(3, 2).toString(), QString::fromUtf8("\xce\xb7"));
+	QVERIFY(record.mid(100).isEmpty());
+}
+
+void TestStelRecordReader::testMissingFile()
+{
+	StelRecordReader reader("this/file/does/not/exist.fab");
+	QVERIFY(!reader.isOpen());
+	StelRecordReader::Field line;
+	QVERIFY(!reader.readLine(line));
+}
@@ -443,6 +443,24 @@ void TestStelSphericalGeometry::testOctahedronPolygon()
 	QCOMPARE(northPoleSquare.getUnion(northPoleSquare)->getArea(), northPoleSquare.getArea());
 	QCOMPARE(northPoleSquare.getSubtraction(northPoleSquare)->getArea(), 0.);
 
+	// Point containment must give the same result with and without the tesselated triangles
+	OctahedronPolygon lazyHoly(holySquare.getOctahedronPolygon());
+	OctahedronPolygon tesselatedHoly(holySquare.getOctahedronPolygon());
+	tesselatedHoly.getFillVertexArray();
+	lazyHoly.updateVertexArray();
+	QVERIFY(!lazyHoly.fillCachedVertexArrayValid);
+	Vec3d p;
+	for (int i=-10;i<=10;++i)
+	{
+		for (int j=-10;j<=10;++j)
+		{
+			StelUtils::spheToRect(0.061*i, 0.059*j, p);
+			QCOMPARE(lazyHoly.contains(p), tesselatedHoly.contains(p));
+		}
+	}
+	QVERIFY(!lazyHoly.fillCachedVertexArrayValid);
+	QCOMPARE(lazyHoly.getArea(), tesselatedHoly.getArea());
+
 	// Test binary IO
 	QByteArray ar;
 	QBuffer buf(&ar);
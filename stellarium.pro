@@ -171,7 +171,9 @@ HEADERS += \
 	src/core/StelGeodesicGrid.hpp \
 	src/core/StelGuiBase.hpp \
 	src/core/StelIniParser.hpp \
+	src/core/StelJsonCache.hpp \
 	src/core/StelJsonParser.hpp \
+	src/core/StelLabelScheduler.hpp \
 	src/core/StelLocaleMgr.hpp \
 	src/core/StelLocation.hpp \
 	src/core/StelLocationMgr.hpp \
@@ -183,13 +185,16 @@ HEADERS += \
 	src/core/StelObjectModule.hpp \
 	src/core/StelObjectType.hpp \
 	src/core/StelObserver.hpp \
+	src/core/StelProfiler.hpp \
 	src/core/StelPainter.hpp \
 	src/core/StelPluginInterface.hpp \
 	src/core/StelProjectorClasses.hpp \
 	src/core/StelProjector.hpp \
 	src/core/StelProjectorType.hpp \
+	src/core/StelRecordReader.hpp \
 	src/core/StelProgressController.hpp \
 	src/core/StelRegionObject.hpp \
+	src/core/StelRiseSetCalculator.hpp \
 	src/core/StelSkyCultureMgr.hpp \
 	src/core/StelSkyDrawer.hpp \
 	src/core/StelSkyImageTile.hpp \
@@ -235,7 +240,9 @@ HEADERS += \
 	src/core/modules/Solve.hpp \
 	src/core/modules/Star.hpp \
 	src/core/modules/StarMgr.hpp \
+	src/core/modules/StarNameTable.hpp \
 	src/core/modules/StarWrapper.hpp \
+	src/core/modules/StarZoneCodec.hpp \
 	src/core/modules/ZoneArray.hpp \
 	src/core/modules/ZoneData.hpp \
 	src/core/external/glues_stel/source/glues_error.h \
@@ -281,7 +288,9 @@ SOURCES += \
 	src/core/StelGeodesicGrid.cpp \
 	src/core/StelGuiBase.cpp \
 	src/core/StelIniParser.cpp \
+	src/core/StelJsonCache.cpp \
 	src/core/StelJsonParser.cpp \
+	src/core/StelLabelScheduler.cpp \
 	src/core/StelLocaleMgr.cpp \
 	src/core/StelLocation.cpp \
 	src/core/StelLocationMgr.cpp \
@@ -292,9 +301,12 @@ SOURCES += \
 	src/core/StelObjectMgr.cpp \
 	src/core/StelObjectModule.cpp \
 	src/core/StelObserver.cpp \
+	src/core/StelProfiler.cpp \
 	src/core/StelPainter.cpp \
 	src/core/StelProjectorClasses.cpp \
 	src/core/StelProjector.cpp \
+	src/core/StelRecordReader.cpp \
+	src/core/StelRiseSetCalculator.cpp \
 	src/core/StelSkyCultureMgr.cpp \
 	src/core/StelSkyDrawer.cpp \
 	src/core/StelSkyImageTile.cpp \
@@ -338,7 +350,9 @@ SOURCES += \
 	src/core/modules/SolarSystem.cpp \
 	src/core/modules/Star.cpp \
 	src/core/modules/StarMgr.cpp \
+	src/core/modules/StarNameTable.cpp \
 	src/core/modules/StarWrapper.cpp \
+	src/core/modules/StarZoneCodec.cpp \
 	src/core/modules/ZoneArray.cpp \
 	src/core/external/glues_stel/source/glues_error.c \
 	src/core/external/glues_stel/source/libtess/dict.c \